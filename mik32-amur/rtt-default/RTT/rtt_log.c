@@ -0,0 +1,24 @@
+#include "rtt_log.h"
+
+/* CSR разрешения счетчиков SCR1 и бит счетчика тактов */
+#define RTT_LOG_CSR_MCOUNTEN    0x7E0
+#define RTT_LOG_MCOUNTEN_CY     (1 << 0)
+
+
+/* Число отброшенных записей (буфер переполнен). Из прерываний инкремент не атомарен */
+volatile uint32_t RTT_Log_Dropped = 0;
+
+static uint8_t RTT_Log_Buffer[RTT_LOG_BUFFER_SIZE] __attribute__((aligned(4)));
+
+
+/**
+ * @brief Инициализация журнала: настройка буфера RTT_LOG_CHANNEL и разрешение счета mcycle.
+ * Вызывается из основной программы до первого RTT_LOG.
+ */
+void RTT_Log_Init(void)
+{
+    __asm__ volatile ("csrs %0, %1" :: "i"(RTT_LOG_CSR_MCOUNTEN), "i"(RTT_LOG_MCOUNTEN_CY));
+
+    RTT_Log_Dropped = 0;
+    SEGGER_RTT_ConfigUpBuffer(RTT_LOG_CHANNEL, "Log", RTT_Log_Buffer, sizeof(RTT_Log_Buffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
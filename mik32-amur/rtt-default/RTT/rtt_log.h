@@ -0,0 +1,115 @@
+#ifndef RTT_LOG_H
+#define RTT_LOG_H
+
+#include <stdint.h>
+#include "SEGGER_RTT_Fast.h"
+
+
+/*
+ * Двоичный журнал с отложенным форматированием.
+ *
+ * Строки формата RTT_LOG помещаются в секцию .rtt_log_fmt, которая не загружается в память
+ * МК (INFO в сценариях компоновки) и остается только в ELF-файле. Идентификатор записи -
+ * адрес строки в этой секции. На МК в буфер RTT_LOG_CHANNEL записывается только запись из
+ * 32-р слов:
+ *
+ *   слово 0 - идентификатор строки формата (биты 0..23) и число аргументов (биты 24..31);
+ *   слово 1 - метка времени (RTT_LOG_TIMESTAMP, по умолчанию младшие 32 бита mcycle);
+ *   слова 2.. - аргументы, приведенные к uint32_t.
+ *
+ * Текст восстанавливается на стороне ПК сценарием tools/rtt_log_decode.py по ELF-файлу.
+ * Буфер работает в режиме SEGGER_RTT_MODE_NO_BLOCK_SKIP: запись, не поместившаяся в буфер,
+ * отбрасывается целиком (см. RTT_Log_Dropped), поэтому поток не теряет синхронизацию.
+ * RTT_LOG можно вызывать из обработчиков прерываний.
+ *
+ * Ограничения: не более 8 аргументов; 64-р значения и числа с плавающей точкой не
+ * поддерживаются; аргумент %s декодируется, только если строка находится в ELF-файле
+ * (например, строковая константа во flash).
+ */
+
+/* Номер буфера RTT (up-buffer) журнала. Требует SEGGER_RTT_MAX_NUM_UP_BUFFERS > RTT_LOG_CHANNEL */
+#ifndef RTT_LOG_CHANNEL
+    #define RTT_LOG_CHANNEL         1
+#endif
+
+/* Размер буфера журнала, байт */
+#ifndef RTT_LOG_BUFFER_SIZE
+    #define RTT_LOG_BUFFER_SIZE     512
+#endif
+
+/* Источник метки времени. Счет mcycle разрешается в RTT_Log_Init */
+#ifndef RTT_LOG_TIMESTAMP
+    #define RTT_LOG_TIMESTAMP()     RTT_Log_Cycles()
+#endif
+
+#define RTT_LOG_ID_MASK             0x00FFFFFFUL
+#define RTT_LOG_NARGS_POS           24
+
+#define RTT_LOG_MAX_ARGS            8
+
+
+/* Число аргументов макроса (0..8) */
+#define RTT_LOG_NARGS(...)          RTT_LOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define RTT_LOG_NARGS_(_, a1, a2, a3, a4, a5, a6, a7, a8, n, ...)   n
+
+/* Приведение аргументов к uint32_t (с ведущей запятой) */
+#define RTT_LOG_CAT(a, b)           RTT_LOG_CAT_(a, b)
+#define RTT_LOG_CAT_(a, b)          a##b
+#define RTT_LOG_ARGS(...)           RTT_LOG_CAT(RTT_LOG_ARGS_, RTT_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define RTT_LOG_ARGS_0()
+#define RTT_LOG_ARGS_1(a)           , (uint32_t)(a)
+#define RTT_LOG_ARGS_2(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_1(__VA_ARGS__)
+#define RTT_LOG_ARGS_3(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_2(__VA_ARGS__)
+#define RTT_LOG_ARGS_4(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_3(__VA_ARGS__)
+#define RTT_LOG_ARGS_5(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_4(__VA_ARGS__)
+#define RTT_LOG_ARGS_6(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_5(__VA_ARGS__)
+#define RTT_LOG_ARGS_7(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_6(__VA_ARGS__)
+#define RTT_LOG_ARGS_8(a, ...)      , (uint32_t)(a) RTT_LOG_ARGS_7(__VA_ARGS__)
+
+/**
+ * @brief Записать сообщение в журнал.
+ * @param format Строковый литерал в формате printf (%d, %i, %u, %x, %X, %o, %c, %s, %p).
+ */
+#define RTT_LOG(format, ...)                                                                        \
+    do                                                                                              \
+    {                                                                                               \
+        static const char __attribute__((section(".rtt_log_fmt"), used)) rtt_log_format[] = format; \
+        const uint32_t rtt_log_record[] =                                                           \
+        {                                                                                           \
+            ((uint32_t)rtt_log_format & RTT_LOG_ID_MASK) |                                          \
+                ((uint32_t)RTT_LOG_NARGS(__VA_ARGS__) << RTT_LOG_NARGS_POS),                        \
+            RTT_LOG_TIMESTAMP()                                                                     \
+            RTT_LOG_ARGS(__VA_ARGS__)                                                               \
+        };                                                                                          \
+        _Static_assert(RTT_LOG_NARGS(__VA_ARGS__) <= RTT_LOG_MAX_ARGS, "RTT_LOG: too many arguments"); \
+        RTT_Log_Write(rtt_log_record, sizeof(rtt_log_record));                                      \
+    } while (0)
+
+
+extern volatile uint32_t RTT_Log_Dropped;
+
+void RTT_Log_Init(void);
+
+/**
+ * @brief Текущее значение счетчика тактов ядра (младшие 32 бита).
+ */
+static inline __attribute__((always_inline)) uint32_t RTT_Log_Cycles(void)
+{
+    uint32_t cycles;
+    __asm__ volatile ("csrr %0, mcycle" : "=r"(cycles));
+    return cycles;
+}
+
+/**
+ * @brief Записать готовую запись в буфер журнала.
+ * Запись, не поместившаяся в буфер, отбрасывается целиком и учитывается в RTT_Log_Dropped.
+ */
+static inline __attribute__((always_inline)) void RTT_Log_Write(const uint32_t *record, unsigned size)
+{
+    if (SEGGER_RTT_WriteFast(RTT_LOG_CHANNEL, record, size) == 0)
+    {
+        RTT_Log_Dropped++;
+    }
+}
+
+#endif // RTT_LOG_H
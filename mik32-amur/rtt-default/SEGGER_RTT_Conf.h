@@ -76,10 +76,10 @@ Revision: $Rev: 13430 $
 
 // Most common case:
 // Up-channel 0: RTT
-// Up-channel 1: SystemView
+// Up-channel 1: binary log (RTT/rtt_log.h)
 //
 #ifndef   SEGGER_RTT_MAX_NUM_UP_BUFFERS
-  #define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (1)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
+  #define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (2)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
 #endif
 //
 // Most common case:
@@ -143,6 +143,16 @@ Revision: $Rev: 13430 $
 
 #define SEGGER_RTT_MAX_INTERRUPT_PRIORITY         (0x20)   // Interrupt priority to lock on SEGGER_RTT_LOCK on Cortex-M3/4 (Default: 0x20)
 
+//
+// Up-buffers that are written from a single context only (only from main loop or only from
+// one interrupt handler). SEGGER_RTT_WriteFast() writes to them without SEGGER_RTT_LOCK(),
+// since the up-buffer itself is a single-producer/single-consumer ring (target writes WrOff,
+// host reads RdOff). Bit n corresponds to up-buffer n.
+//
+#ifndef   SEGGER_RTT_SPSC_CHANNELS
+  #define SEGGER_RTT_SPSC_CHANNELS                  (0u)
+#endif
+
 /*********************************************************************
 *
 *       RTT lock configuration for SEGGER Embedded Studio,
@@ -210,6 +220,25 @@ Revision: $Rev: 13430 $
                                                 : "r0", "r1"                   \
                                                 );                             \
                             }
+  #elif defined(__riscv)
+    //
+    // RISC-V (SCR1): machine interrupts are masked by clearing mstatus.MIE.
+    // csrrci returns the previous state, so the lock is nestable.
+    //
+    #define SEGGER_RTT_LOCK()   {                                                                   \
+                                    unsigned int LockState;                                         \
+                                  __asm volatile ("csrrci %0, mstatus, 8  \n\t"                     \
+                                                  : "=r" (LockState)                                \
+                                                  :                                                 \
+                                                  : "memory"                                        \
+                                                  );
+
+    #define SEGGER_RTT_UNLOCK()   __asm volatile ("csrs  mstatus, %0  \n\t"                         \
+                                                  :                                                 \
+                                                  : "r" (LockState & 8)                             \
+                                                  : "memory"                                        \
+                                                  );                                                \
+                                }
 #else
     #define SEGGER_RTT_LOCK()
     #define SEGGER_RTT_UNLOCK()
@@ -0,0 +1,31 @@
+/*********************************************************************
+*
+*       SEGGER_RTT_Fast.h
+*
+*       Write to an RTT up-buffer without locking when the buffer has a
+*       single producer (see SEGGER_RTT_SPSC_CHANNELS in SEGGER_RTT_Conf.h).
+*/
+
+#ifndef SEGGER_RTT_FAST_H
+#define SEGGER_RTT_FAST_H
+
+#include "SEGGER_RTT.h"
+
+/*********************************************************************
+*
+*       SEGGER_RTT_WriteFast()
+*
+*  Function description
+*    Same as SEGGER_RTT_Write(). For buffers listed in SEGGER_RTT_SPSC_CHANNELS
+*    the lock is skipped; with a constant BufferIndex the check is resolved
+*    at compile time.
+*/
+static inline __attribute__((always_inline)) unsigned SEGGER_RTT_WriteFast(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes) {
+  if ((SEGGER_RTT_SPSC_CHANNELS >> BufferIndex) & 1u) {
+    return SEGGER_RTT_WriteNoLock(BufferIndex, pBuffer, NumBytes);
+  }
+  return SEGGER_RTT_Write(BufferIndex, pBuffer, NumBytes);
+}
+
+#endif
+/*************************** End of file ****************************/
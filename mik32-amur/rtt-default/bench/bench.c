@@ -0,0 +1,83 @@
+/**
+ * @file
+ * Тесты производительности библиотек HAL.
+ * Собираются при включенной опции MIK32_BENCH (cmake -DMIK32_BENCH=ON), результаты
+ * выводятся в терминал 0 SEGGER RTT в тактах ядра (mcycle).
+ */
+
+#include "bench.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_swtimer.h"
+#ifdef MIK32_STDIO_UART
+#include "stub.h"
+#endif
+
+
+/**
+ * Обработчик прерываний сборки с тестами: внешние прерывания передаются диспетчеру EPIC,
+ * прерывание таймера ядра - программным таймерам. ecall пропускается только во время теста
+ * Bench_Trap, остальные исключения останавливают программу; при выводе printf в USART перед
+ * остановкой передаются данные буфера.
+ */
+void trap_handler( void )
+{
+    uint32_t cause = read_csr( mcause );
+
+    if ( cause == MCAUSE_MACHINE_EXTERNAL_INTERRUPT )
+    {
+        HAL_EPIC_Dispatch();
+    }
+    else if ( cause == MCAUSE_MACHINE_TIMER_INTERRUPT )
+    {
+        HAL_SWTimer_IRQHandler();
+    }
+    else if ( ( cause == MCAUSE_ECALL_FROM_M_MODE ) && bench_trap_ecall )
+    {
+        /* ecall теста Bench_Trap пропускается */
+        write_csr( mepc, read_csr( mepc ) + 4 );
+    }
+    else if ( !( cause & MCAUSE_INT ) )
+    {
+#ifdef MIK32_STDIO_UART
+        write_flush();
+#endif
+        while ( 1 )
+        {
+        }
+    }
+}
+
+
+/**
+ * Разрешает счет тактов ядра.
+ */
+void Bench_Init( void )
+{
+    set_csr( BENCH_CSR_MCOUNTEN, MCOUNTEN_CY );
+}
+
+
+/**
+ * Запускает все тесты производительности.
+ */
+void Bench_Run( void )
+{
+    Bench_Init();
+
+    Bench_TimeBase();
+    Bench_Trap();
+    Bench_AdcDma();
+    Bench_Log();
+    Bench_Usart();
+    Bench_Xprintf();
+    Bench_Crc();
+    Bench_Crypto();
+    Bench_Ssd1306();
+    Bench_Spi();
+    Bench_SpiQueue();
+    Bench_Spifi();
+    Bench_Xip();
+    Bench_FlashWrite();
+    Bench_FlashSched();
+    Bench_Boot();
+}
@@ -0,0 +1,47 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "csr.h"
+#include "scr1_csr_encoding.h"
+#include "SEGGER_RTT.h"
+
+/* CSR разрешения счетчиков SCR1 */
+#define BENCH_CSR_MCOUNTEN      0x7E0
+
+/* Вывод результатов в терминал 0 SEGGER RTT */
+#define bench_printf( format, ... )     SEGGER_RTT_printf( 0, ( const char * ) ( format ), ##__VA_ARGS__ )
+
+
+/**
+ * Возвращает текущее значение счетчика тактов ядра (mcycle).
+ */
+static inline __attribute__((always_inline)) uint32_t Bench_Cycles( void )
+{
+    return read_csr( mcycle );
+}
+
+/* Не ноль во время теста Bench_Trap: trap_handler пропускает ecall */
+extern volatile uint32_t bench_trap_ecall;
+
+void Bench_Init( void );
+void Bench_Run( void );
+
+void Bench_TimeBase( void );
+void Bench_Trap( void );
+void Bench_AdcDma( void );
+void Bench_Log( void );
+void Bench_Usart( void );
+void Bench_Xprintf( void );
+void Bench_Crc( void );
+void Bench_Crypto( void );
+void Bench_Ssd1306( void );
+void Bench_Spi( void );
+void Bench_SpiQueue( void );
+void Bench_Spifi( void );
+void Bench_Xip( void );
+void Bench_FlashWrite( void );
+void Bench_FlashSched( void );
+void Bench_Boot( void );
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * Непрерывное измерение АЦП через DMA (HAL_ADC_DMA_Start): фактическая частота отсчетов
+ * и загрузка процессора при разных частотах таймера.
+ * Загрузка оценивается по числу итераций пустого цикла за окно измерения относительно
+ * того же цикла без DMA.
+ */
+
+#include "bench.h"
+#include "mik32_hal_adc.h"
+#include "mik32_hal_irq.h"
+
+#define BENCH_ADC_BUFFER_LENGTH     256
+#define BENCH_ADC_WINDOW_CYCLES     3200000UL   /* 100 мс при 32 МГц */
+
+static uint16_t adcBuffer[ BENCH_ADC_BUFFER_LENGTH ];
+static volatile uint32_t adcSamples;
+
+
+static void adcHalfDone( ADC_DMA_HandleTypeDef *hadc_dma, uint16_t *samples, uint32_t count )
+{
+    adcSamples += count;
+    HAL_ADC_DMA_Release( hadc_dma, samples );
+}
+
+
+/**
+ * Число итераций пустого цикла за окно измерения.
+ */
+static uint32_t idleLoop( void )
+{
+    uint32_t start = Bench_Cycles();
+    uint32_t iterations = 0;
+
+    while ( Bench_Cycles() - start < BENCH_ADC_WINDOW_CYCLES )
+    {
+        iterations++;
+    }
+
+    return iterations;
+}
+
+
+void Bench_AdcDma( void )
+{
+    static const uint32_t rates[] = { 50000, 100000, 250000, 500000, 1000000 };
+
+    ADC_HandleTypeDef hadc = { 0 };
+    TIMER32_HandleTypeDef htimer32 = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+    ADC_DMA_HandleTypeDef hadc_dma = { 0 };
+
+    hadc.Instance = ANALOG_REG;
+    hadc.Init.Sel = ADC_CHANNEL0;
+    hadc.Init.EXTRef = ADC_EXTREF_OFF;
+    hadc.Init.EXTClb = ADC_EXTCLB_ADCREF;
+    HAL_ADC_Init( &hadc );
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_0;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+
+    uint32_t timer_freq = HAL_PCC_GetSysClockFreq() / ( ( PM->DIV_AHB + 1 ) * ( PM->DIV_APB_P + 1 ) );
+
+    hadc_dma.hadc = &hadc;
+    hadc_dma.htimer32 = &htimer32;
+    hadc_dma.hdma_channel = &hdma_channel;
+    hadc_dma.HalfCpltCallback = adcHalfDone;
+    hadc_dma.CpltCallback = adcHalfDone;
+
+    HAL_EPIC_SetHandler( EPIC_LINE_DMA_S, HAL_DMA_IRQHandler );
+    HAL_EPIC_MaskLevelSet( HAL_EPIC_DMA_MASK );
+    HAL_IRQ_EnableInterrupts();
+
+    uint32_t idle = idleLoop();
+
+    for ( uint32_t i = 0; i < sizeof( rates ) / sizeof( rates[ 0 ] ); i++ )
+    {
+        htimer32.Instance = TIMER32_1;
+        htimer32.Top = timer_freq / rates[ i ] - 1;
+        htimer32.State = TIMER32_STATE_DISABLE;
+        htimer32.Clock.Source = TIMER32_SOURCE_PRESCALER;
+        htimer32.Clock.Prescaler = 0;
+        htimer32.CountMode = TIMER32_COUNTMODE_FORWARD;
+        HAL_Timer32_Init( &htimer32 );
+
+        adcSamples = 0;
+        HAL_ADC_DMA_Start( &hadc_dma, adcBuffer, BENCH_ADC_BUFFER_LENGTH );
+        uint32_t busy = idleLoop();
+        HAL_ADC_DMA_Stop( &hadc_dma );
+
+        uint32_t sps = ( uint32_t ) ( ( uint64_t ) adcSamples * HAL_PCC_GetSysClockFreq() / BENCH_ADC_WINDOW_CYCLES );
+        uint32_t load = ( busy < idle ) ? ( idle - busy ) * 1000 / idle : 0;
+
+        bench_printf( "adc dma: timer %u sps -> %u sps, cpu load %u.%u%%, overruns %u, dropped %u\n",
+                      rates[ i ], sps, load / 10, load % 10, hadc_dma.Overruns, hadc_dma.Dropped );
+    }
+
+    HAL_EPIC_MaskLevelClear( HAL_EPIC_DMA_MASK );
+    HAL_EPIC_SetHandler( EPIC_LINE_DMA_S, NULL );
+}
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * Время проверки образа загрузчиком A/B (mik32_hal_boot.h): CRC-32 области слота
+ * BENCH_BOOT_LENGTH байт, читаемой в режиме памяти SPIFI (1-4-4, без кэша), при записи в блок
+ * CRC процессором и через DMA. Содержимое области не важно - время определяется чтением.
+ *
+ * При выполнении программы из SPIFI используется текущая настройка режима памяти.
+ * Тест пропускается, если флеш-память не отвечает.
+ */
+
+#include "bench.h"
+#include "mik32_hal_boot.h"
+#include "mik32_hal_spifi_w25.h"
+
+#define BENCH_BOOT_LENGTH       ( MIK32_BOOT_SLOT_SIZE - HAL_BOOT_HEADER_SIZE )
+#define BENCH_BOOT_IMAGE        ( MIK32_BOOT_SLOT_B + HAL_BOOT_HEADER_SIZE )
+
+
+static uint32_t bootCrc( CRC_HandleTypeDef *hcrc, uint32_t *crc )
+{
+    uint32_t start = Bench_Cycles();
+
+    HAL_CRC_Begin( hcrc );
+    HAL_CRC_Update( hcrc, ( const void * ) BENCH_BOOT_IMAGE, BENCH_BOOT_LENGTH );
+    *crc = HAL_CRC_Final( hcrc );
+
+    return Bench_Cycles() - start;
+}
+
+
+/**
+ * Время cycles тактов в микросекундах.
+ */
+static uint32_t bootMicroseconds( uint32_t cycles )
+{
+    return ( uint32_t ) ( ( uint64_t ) cycles * 1000000 / HAL_PCC_GetSysClockFreq() );
+}
+
+
+void Bench_Boot( void )
+{
+    SPIFI_HandleTypeDef spifi = { .Instance = SPIFI_CONFIG };
+    CRC_HandleTypeDef hcrc = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+    uint32_t crcCpu, crcDma;
+    int memoryMode = HAL_SPIFI_IsMemoryModeEnabled( &spifi );
+
+    if ( !memoryMode )
+    {
+        SPIFI_MemoryModeConfig_HandleTypeDef config = { 0 };
+
+        HAL_SPIFI_MspInit();
+        HAL_SPIFI_Reset( &spifi );
+
+        W25_ManufacturerDeviceIDTypeDef id = HAL_SPIFI_W25_ReadManufacturerDeviceID( &spifi );
+        if ( ( id.Manufacturer == 0x00 ) || ( id.Manufacturer == 0xFF ) )
+        {
+            bench_printf( "boot: no flash, skipped\n" );
+            return;
+        }
+
+        config.CacheEnable = SPIFI_CACHE_DISABLE;
+        config.Prefetch = SPIFI_PREFETCH_ENABLE;
+        if ( HAL_SPIFI_W25_MemoryMode_Init( &spifi, &config, W25_MEMORY_QUAD_IO ) != HAL_OK )
+        {
+            bench_printf( "boot: memory mode init error\n" );
+            return;
+        }
+    }
+
+    /* CRC-32 */
+    hcrc.Instance = CRC;
+    hcrc.Poly = 0x04C11DB7;
+    hcrc.Init = 0xFFFFFFFF;
+    hcrc.InputReverse = CRC_REFIN_TRUE;
+    hcrc.OutputReverse = CRC_REFOUT_TRUE;
+    hcrc.OutputInversion = CRC_OUTPUTINVERSION_ON;
+    HAL_CRC_Init( &hcrc );
+
+    uint32_t cpuCycles = bootCrc( &hcrc, &crcCpu );
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_2;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+    HAL_CRC_SetDMA( &hcrc, &hdma_channel );
+
+    uint32_t dmaCycles = bootCrc( &hcrc, &crcDma );
+
+    if ( !memoryMode )
+    {
+        HAL_SPIFI_W25_MemoryMode_Exit( &spifi, W25_MEMORY_QUAD_IO );
+    }
+
+    bench_printf( "boot crc32 %u B from SPIFI: cpu %u cyc (%u us), dma %u cyc (%u us)%s\n",
+                  BENCH_BOOT_LENGTH, cpuCycles, bootMicroseconds( cpuCycles ),
+                  dmaCycles, bootMicroseconds( dmaCycles ), crcCpu == crcDma ? "" : ", MISMATCH" );
+}
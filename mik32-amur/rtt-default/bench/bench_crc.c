@@ -0,0 +1,71 @@
+/**
+ * @file
+ * Потоковое вычисление CRC32 (HAL_CRC_Update): такты на блок 4 КБ при записи процессором
+ * и через DMA, а также при разбиении на невыровненные участки.
+ */
+
+#include "bench.h"
+#include "mik32_hal_crc32.h"
+
+#define BENCH_CRC_LENGTH        4096
+
+static uint32_t crcData[ BENCH_CRC_LENGTH / 4 ];
+
+
+static uint32_t crcBlock( CRC_HandleTypeDef *hcrc, uint32_t *crc, uint32_t piece )
+{
+    const uint8_t *data = ( const uint8_t * ) crcData;
+    uint32_t start = Bench_Cycles();
+
+    HAL_CRC_Begin( hcrc );
+    for ( uint32_t offset = 0; offset < BENCH_CRC_LENGTH; offset += piece )
+    {
+        uint32_t length = BENCH_CRC_LENGTH - offset < piece ? BENCH_CRC_LENGTH - offset : piece;
+        HAL_CRC_Update( hcrc, data + offset, length );
+    }
+    *crc = HAL_CRC_Final( hcrc );
+
+    return Bench_Cycles() - start;
+}
+
+
+void Bench_Crc( void )
+{
+    CRC_HandleTypeDef hcrc = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+    uint32_t crcCpu, crcDma, crcPieces;
+
+    for ( uint32_t i = 0; i < BENCH_CRC_LENGTH / 4; i++ )
+    {
+        crcData[ i ] = i * 0x9E3779B9UL;
+    }
+
+    /* CRC-32 */
+    hcrc.Instance = CRC;
+    hcrc.Poly = 0x04C11DB7;
+    hcrc.Init = 0xFFFFFFFF;
+    hcrc.InputReverse = CRC_REFIN_TRUE;
+    hcrc.OutputReverse = CRC_REFOUT_TRUE;
+    hcrc.OutputInversion = CRC_OUTPUTINVERSION_ON;
+    HAL_CRC_Init( &hcrc );
+
+    uint32_t cpuCycles = crcBlock( &hcrc, &crcCpu, BENCH_CRC_LENGTH );
+    /* Участки по 61 байту: каждый вызов начинается с другого выравнивания */
+    uint32_t pieceCycles = crcBlock( &hcrc, &crcPieces, 61 );
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_2;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+    HAL_CRC_SetDMA( &hcrc, &hdma_channel );
+
+    uint32_t dmaCycles = crcBlock( &hcrc, &crcDma, BENCH_CRC_LENGTH );
+
+    bench_printf( "crc32 %u B: cpu %u cyc, dma %u cyc, 61 B pieces %u cyc\n",
+                  BENCH_CRC_LENGTH, cpuCycles, dmaCycles, pieceCycles );
+    bench_printf( "crc32 results: %08X %08X %08X %s\n", crcCpu, crcDma, crcPieces,
+                  ( crcCpu == crcDma ) && ( crcCpu == crcPieces ) ? "match" : "MISMATCH" );
+}
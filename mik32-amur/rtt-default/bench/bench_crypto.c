@@ -0,0 +1,146 @@
+/**
+ * @file
+ * Потоковое шифрование (HAL_Crypto_Stream): проверка по контрольным примерам ГОСТ 34.13-2015
+ * (Кузнечик, те же данные, что в примере mik32-hal-crypto) и скорость в байтах в секунду
+ * для каждого режима: процессор, DMA с выровненными данными и DMA через промежуточный буфер.
+ */
+
+#include "bench.h"
+#include "mik32_hal_crypto_stream.h"
+
+#include <string.h>
+
+#define BENCH_CRYPTO_LENGTH     4096
+
+static uint32_t cryptoIn[ BENCH_CRYPTO_LENGTH / 4 + 1 ];
+static uint32_t cryptoOut[ BENCH_CRYPTO_LENGTH / 4 + 1 ];
+static uint32_t cryptoBuffer[ 256 / 4 ];
+
+static uint32_t gostKey[ CRYPTO_KEY_KUZNECHIK ] =
+{
+    0x8899aabb, 0xccddeeff, 0x00112233, 0x44556677,
+    0xfedcba98, 0x76543210, 0x01234567, 0x89abcdef
+};
+
+static const uint32_t gostPlain[ 16 ] =
+{
+    0x11223344, 0x55667700, 0xffeeddcc, 0xbbaa9988,
+    0x00112233, 0x44556677, 0x8899aabb, 0xcceeff0a,
+    0x11223344, 0x55667788, 0x99aabbcc, 0xeeff0a00,
+    0x22334455, 0x66778899, 0xaabbccee, 0xff0a0011
+};
+
+static const uint32_t gostCipher[ 3 ][ 16 ] =
+{
+    {   /* ECB */
+        0x7f679d90, 0xbebc2430, 0x5a468d42, 0xb9d4edcd,
+        0xb429912c, 0x6e0032f9, 0x285452d7, 0x6718d08b,
+        0xf0ca3354, 0x9d247cee, 0xf3f5a531, 0x3bd4b157,
+        0xd0b09ccd, 0xe830b9eb, 0x3a02c4c5, 0xaa8ada98
+    },
+    {   /* CBC */
+        0x50796e7f, 0x4094ce10, 0xbab7374c, 0x981047e3,
+        0x1ee4f83b, 0x334948ed, 0x86a0873c, 0x86bff9a2,
+        0xa084f5fa, 0x965481e4, 0xb64be9bd, 0x32ef21e3,
+        0xa6e376cf, 0x95e8a097, 0x9a46ba33, 0x152b1843
+    },
+    {   /* CTR */
+        0xf195d8be, 0xc10ed1db, 0xd57b5fa2, 0x40bda1b8,
+        0x85eee733, 0xf6a13e5d, 0xf33ce4b3, 0x3c45dee4,
+        0xa5eae88b, 0xe6356ed3, 0xd5e877f1, 0x3564a3a5,
+        0xcb91fab1, 0xf20cbab6, 0xd1c6d158, 0x20bdba73
+    }
+};
+
+static uint32_t gostIv[ 3 ][ 4 ] =
+{
+    { 0 },
+    { 0x12341234, 0x11114444, 0xABCDABCD, 0xAAAABBBB },
+    { 0x12345678, 0x90ABCEF0 }
+};
+
+static const char * const modeNames[ 3 ] = { "ECB", "CBC", "CTR" };
+
+
+/**
+ * Байт в секунду при обработке length байт за cycles тактов.
+ */
+static uint32_t bytesPerSecond( uint32_t length, uint32_t cycles )
+{
+    uint32_t freq = HAL_PCC_GetSysClockFreq() / ( PM->DIV_AHB + 1 );
+    return ( uint32_t ) ( ( uint64_t ) length * freq / ( cycles ? cycles : 1 ) );
+}
+
+
+static uint32_t encodeCycles( HAL_Crypto_StreamTypeDef *stream, uint32_t mode, const void *in, void *out )
+{
+    uint32_t start = Bench_Cycles();
+
+    HAL_Crypto_Stream_Start( stream, gostKey, gostIv[ mode ], CRYPTO_STREAM_ENCODE );
+    HAL_Crypto_Stream_Update( stream, in, out, BENCH_CRYPTO_LENGTH );
+    HAL_Crypto_Stream_Finish( stream );
+
+    return Bench_Cycles() - start;
+}
+
+
+void Bench_Crypto( void )
+{
+    Crypto_HandleTypeDef hcrypto = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_in = { 0 };
+    DMA_ChannelHandleTypeDef hdma_out = { 0 };
+    HAL_Crypto_StreamTypeDef stream;
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_DISABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_in.dma = &hdma;
+    hdma_in.ChannelInit.Channel = DMA_CHANNEL_0;
+    hdma_in.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+    hdma_out.dma = &hdma;
+    hdma_out.ChannelInit.Channel = DMA_CHANNEL_1;
+    hdma_out.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+
+    for ( uint32_t i = 0; i < BENCH_CRYPTO_LENGTH / 4; i++ )
+    {
+        cryptoIn[ i ] = gostPlain[ i & 15 ];
+    }
+
+    for ( uint32_t alg = CRYPTO_ALG_KUZNECHIK; alg <= CRYPTO_ALG_MAGMA; alg++ )
+    {
+        for ( uint32_t mode = CRYPTO_CIPHER_MODE_ECB; mode <= CRYPTO_CIPHER_MODE_CTR; mode++ )
+        {
+            hcrypto.Instance = CRYPTO;
+            hcrypto.Algorithm = alg;
+            hcrypto.CipherMode = mode;
+            hcrypto.SwapMode = CRYPTO_SWAP_MODE_NONE;
+            hcrypto.OrderMode = CRYPTO_ORDER_MODE_MSW;
+
+            HAL_Crypto_Stream_Init( &stream, &hcrypto, NULL, NULL, NULL, 0 );
+            uint32_t cpu = encodeCycles( &stream, mode, cryptoIn, cryptoOut );
+
+            HAL_Crypto_Stream_Init( &stream, &hcrypto, &hdma_in, &hdma_out, cryptoBuffer, sizeof( cryptoBuffer ) );
+            uint32_t dma = encodeCycles( &stream, mode, cryptoIn, cryptoOut );
+            uint32_t staged = encodeCycles( &stream, mode, ( uint8_t * ) cryptoIn + 1, ( uint8_t * ) cryptoOut + 3 );
+
+            /* Контрольный пример: 64 байта частями 5, 27 и 32 байта */
+            const char *check = "-";
+            if ( alg == CRYPTO_ALG_KUZNECHIK )
+            {
+                uint32_t n;
+                HAL_Crypto_Stream_Start( &stream, gostKey, gostIv[ mode ], CRYPTO_STREAM_ENCODE );
+                n = HAL_Crypto_Stream_Update( &stream, gostPlain, cryptoOut, 5 );
+                n += HAL_Crypto_Stream_Update( &stream, ( const uint8_t * ) gostPlain + 5, ( uint8_t * ) cryptoOut + n, 27 );
+                n += HAL_Crypto_Stream_Update( &stream, ( const uint8_t * ) gostPlain + 32, ( uint8_t * ) cryptoOut + n, 32 );
+                check = ( n == sizeof( gostPlain ) ) && ( HAL_Crypto_Stream_Finish( &stream ) == HAL_OK ) &&
+                        ( memcmp( cryptoOut, gostCipher[ mode ], sizeof( gostPlain ) ) == 0 ) ? "ok" : "FAIL";
+            }
+
+            bench_printf( "%s %s: cpu %u B/s, dma %u B/s, dma unaligned %u B/s, gost %s\n",
+                          alg == CRYPTO_ALG_KUZNECHIK ? "kuznechik" : "magma", modeNames[ mode ],
+                          bytesPerSecond( BENCH_CRYPTO_LENGTH, cpu ), bytesPerSecond( BENCH_CRYPTO_LENGTH, dma ),
+                          bytesPerSecond( BENCH_CRYPTO_LENGTH, staged ), check );
+        }
+    }
+}
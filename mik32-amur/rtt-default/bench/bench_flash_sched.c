@@ -0,0 +1,170 @@
+/**
+ * @file
+ * Чтение флеш-памяти W25 во время стирания блока 64 КБ через планировщик
+ * (HAL_SPIFI_W25_Sched_Read). С приостановкой читается область вне стираемого блока: выводятся
+ * наибольшая и средняя задержка чтения, число приостановок и время стирания. Без приостановки
+ * читается область внутри блока, и чтение ожидает конца стирания. Затем стертый блок читается
+ * целиком (64 КБ, больше 14-разрядного поля DATALEN) и проверяется, что все байты равны 0xFF. ОЗУ
+ * 16 КБ не вмещает такой буфер, поэтому блок читается частями по BENCH_SCHED_LARGE байт, а сборка
+ * с тестами уменьшает HAL_SPIFI_W25_SCHED_READ_CHUNK (bench/CMakeLists.txt), чтобы каждое чтение
+ * разбивалось на несколько команд с неполной последней.
+ *
+ * Опрос планировщика выполняется программным таймером, поэтому тест разрешает прерывание
+ * таймера ядра на время работы. Блок BENCH_SCHED_ERASE стирается дважды. Тест пропускается,
+ * если программа выполняется из SPIFI или флеш-память не отвечает.
+ */
+
+#include "bench.h"
+#include "mik32_hal_spifi_w25_sched.h"
+
+#define BENCH_SCHED_ERASE       0x00130000
+#define BENCH_SCHED_READ        0x00140000
+#define BENCH_SCHED_LENGTH      256
+#define BENCH_SCHED_GAP_US      500
+#define BENCH_SCHED_TICK_SHIFT  5
+#define BENCH_SCHED_BLOCK       ( 64 * 1024 )
+#define BENCH_SCHED_LARGE       2000
+
+static uint8_t schedData[ BENCH_SCHED_LENGTH ];
+static uint8_t schedLarge[ BENCH_SCHED_LARGE ];
+
+
+/**
+ * Время cycles тактов в микросекундах.
+ */
+static uint32_t schedMicroseconds( uint32_t cycles )
+{
+    return ( uint32_t ) ( ( uint64_t ) cycles * 1000000 / HAL_PCC_GetSysClockFreq() );
+}
+
+
+static void schedDelay( uint32_t us )
+{
+    uint32_t cycles = ( uint32_t ) ( ( uint64_t ) us * HAL_PCC_GetSysClockFreq() / 1000000 );
+    uint32_t start = Bench_Cycles();
+
+    while ( Bench_Cycles() - start < cycles )
+    {
+    }
+}
+
+
+/**
+ * Стирание с чтением вне блока каждые BENCH_SCHED_GAP_US мкс до конца стирания.
+ */
+static void schedSuspend( HAL_SPIFI_W25_SchedTypeDef *sched, HAL_SPIFI_W25_SchedOpTypeDef *erase )
+{
+    uint32_t reads = 0, total = 0, worst = 0;
+
+    uint32_t start = Bench_Cycles();
+    HAL_SPIFI_W25_Sched_Submit( sched, erase );
+    while ( !HAL_SPIFI_W25_Sched_IsIdle( sched ) )
+    {
+        schedDelay( BENCH_SCHED_GAP_US );
+
+        uint32_t readStart = Bench_Cycles();
+        HAL_SPIFI_W25_Sched_Read( sched, BENCH_SCHED_READ, BENCH_SCHED_LENGTH, schedData );
+        uint32_t latency = Bench_Cycles() - readStart;
+
+        total += latency;
+        worst = latency > worst ? latency : worst;
+        reads++;
+    }
+    uint32_t erase64k = Bench_Cycles() - start;
+
+    bench_printf( "flash sched suspend: %u reads of %u B, max %u us, avg %u us, %u suspends, erase 64K %u us%s\n",
+                  reads, BENCH_SCHED_LENGTH, schedMicroseconds( worst ), reads ? schedMicroseconds( total / reads ) : 0,
+                  sched->Suspends, schedMicroseconds( erase64k ), erase->Status == HAL_OK ? "" : ", TIMEOUT" );
+}
+
+
+/**
+ * Стирание с одним чтением внутри блока: чтение ожидает конца стирания.
+ */
+static void schedWait( HAL_SPIFI_W25_SchedTypeDef *sched, HAL_SPIFI_W25_SchedOpTypeDef *erase )
+{
+    uint32_t start = Bench_Cycles();
+    HAL_SPIFI_W25_Sched_Submit( sched, erase );
+    schedDelay( BENCH_SCHED_GAP_US );
+
+    uint32_t readStart = Bench_Cycles();
+    HAL_SPIFI_W25_Sched_Read( sched, BENCH_SCHED_ERASE, BENCH_SCHED_LENGTH, schedData );
+    uint32_t latency = Bench_Cycles() - readStart;
+
+    while ( !HAL_SPIFI_W25_Sched_IsIdle( sched ) )
+    {
+    }
+    uint32_t erase64k = Bench_Cycles() - start;
+
+    bench_printf( "flash sched wait: read of %u B %u us, erase 64K %u us%s\n",
+                  BENCH_SCHED_LENGTH, schedMicroseconds( latency ), schedMicroseconds( erase64k ),
+                  erase->Status == HAL_OK ? "" : ", TIMEOUT" );
+}
+
+
+/**
+ * Чтение стертого блока целиком с проверкой: каждое чтение длиннее HAL_SPIFI_W25_SCHED_READ_CHUNK.
+ */
+static void schedReadBlock( HAL_SPIFI_W25_SchedTypeDef *sched )
+{
+    uint32_t errors = 0;
+    HAL_StatusTypeDef status = HAL_OK;
+
+    uint32_t start = Bench_Cycles();
+    for ( uint32_t offset = 0; ( offset < BENCH_SCHED_BLOCK ) && ( status == HAL_OK ); offset += BENCH_SCHED_LARGE )
+    {
+        uint32_t length = BENCH_SCHED_BLOCK - offset < BENCH_SCHED_LARGE ? BENCH_SCHED_BLOCK - offset : BENCH_SCHED_LARGE;
+
+        status = HAL_SPIFI_W25_Sched_Read( sched, BENCH_SCHED_ERASE + offset, length, schedLarge );
+        for ( uint32_t i = 0; i < length; i++ )
+        {
+            errors += schedLarge[ i ] != 0xFF;
+        }
+    }
+    uint32_t cycles = Bench_Cycles() - start;
+
+    bench_printf( "flash sched read 64K in %u B calls: %u us, %u bytes not erased%s\n",
+                  BENCH_SCHED_LARGE, schedMicroseconds( cycles ), errors, status == HAL_OK ? "" : ", ERROR" );
+}
+
+
+void Bench_FlashSched( void )
+{
+    SPIFI_HandleTypeDef spifi = { .Instance = SPIFI_CONFIG };
+    SCR1_TIMER_HandleTypeDef hscr1_timer = {
+        .Instance = SCR1_TIMER,
+        .ClockSource = SCR1_TIMER_CLKSRC_INTERNAL,
+        .Divider = 0,
+    };
+    HAL_SPIFI_W25_SchedTypeDef sched;
+    HAL_SPIFI_W25_SchedOpTypeDef erase = {
+        .Kind = W25_SCHED_ERASE_64K,
+        .Address = BENCH_SCHED_ERASE,
+    };
+
+    if ( HAL_SPIFI_IsMemoryModeEnabled( &spifi ) )
+    {
+        bench_printf( "flash sched: running from SPIFI, skipped\n" );
+        return;
+    }
+
+    HAL_SPIFI_MspInit();
+    HAL_SPIFI_Reset( &spifi );
+
+    W25_ManufacturerDeviceIDTypeDef id = HAL_SPIFI_W25_ReadManufacturerDeviceID( &spifi );
+    if ( ( id.Manufacturer == 0x00 ) || ( id.Manufacturer == 0xFF ) )
+    {
+        bench_printf( "flash sched: no flash, skipped\n" );
+        return;
+    }
+
+    HAL_SWTimer_Init( &hscr1_timer, BENCH_SCHED_TICK_SHIFT );
+    HAL_IRQ_EnableInterrupts();
+    HAL_SPIFI_W25_Sched_Init( &sched, &spifi );
+
+    schedSuspend( &sched, &erase );
+    schedWait( &sched, &erase );
+    schedReadBlock( &sched );
+
+    clear_csr( mie, MIE_MTIE );
+}
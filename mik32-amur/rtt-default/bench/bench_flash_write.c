@@ -0,0 +1,132 @@
+/**
+ * @file
+ * Запись диапазона флеш-памяти W25 (HAL_SPIFI_W25_WriteStream): стирание наибольшими
+ * выровненными блоками и программирование страниц по четырем линиям с подготовкой следующей
+ * страницы во время программирования текущей. Для сравнения тот же диапазон записывается
+ * стиранием секторов 4 КБ и программированием страниц по одной линии с ожиданием каждой команды.
+ *
+ * Диапазон BENCH_FLASH_OFFSET начинается и заканчивается внутри секторов и содержит блоки
+ * 32 КБ и 64 КБ. Записанные данные сравниваются с образцом. Тест пропускается, если программа
+ * выполняется из SPIFI или флеш-память не отвечает.
+ */
+
+#include "bench.h"
+#include "mik32_hal_spifi_w25.h"
+
+#define BENCH_FLASH_OFFSET      0x00101080
+#define BENCH_FLASH_LENGTH      0x0001F000
+
+static uint8_t flashPage[ SPIFI_W25_PAGE_SIZE ];
+
+
+/**
+ * Образец данных: байт по смещению offset от начала диапазона.
+ */
+static inline uint8_t flashPattern( uint32_t offset )
+{
+    return ( uint8_t ) ( ( offset * 7 ) ^ ( offset >> 8 ) );
+}
+
+
+static void flashFill( void *context, uint32_t offset, uint8_t *page, uint16_t length )
+{
+    for ( uint32_t i = 0; i < length; i++ )
+    {
+        page[ i ] = flashPattern( offset + i );
+    }
+}
+
+
+/**
+ * Запись диапазона посекторным стиранием и программированием страниц с ожиданием.
+ */
+static void flashWriteReference( SPIFI_HandleTypeDef *spifi )
+{
+    uint32_t end = BENCH_FLASH_OFFSET + BENCH_FLASH_LENGTH;
+
+    for ( uint32_t sector = BENCH_FLASH_OFFSET & ~( SPIFI_W25_SECTOR_SIZE - 1 ); sector < end; sector += SPIFI_W25_SECTOR_SIZE )
+    {
+        HAL_SPIFI_W25_SectorErase4K( spifi, sector );
+    }
+
+    for ( uint32_t address = BENCH_FLASH_OFFSET; address < end; )
+    {
+        uint32_t length = SPIFI_W25_PAGE_SIZE - ( address % SPIFI_W25_PAGE_SIZE );
+
+        if ( length > end - address )
+        {
+            length = end - address;
+        }
+        flashFill( NULL, address - BENCH_FLASH_OFFSET, flashPage, length );
+        HAL_SPIFI_W25_PageProgram( spifi, address, length, flashPage );
+        address += length;
+    }
+}
+
+
+/**
+ * Число байт диапазона, не совпадающих с образцом.
+ */
+static uint32_t flashVerify( SPIFI_HandleTypeDef *spifi )
+{
+    uint32_t errors = 0;
+
+    for ( uint32_t offset = 0; offset < BENCH_FLASH_LENGTH; offset += SPIFI_W25_PAGE_SIZE )
+    {
+        uint32_t length = BENCH_FLASH_LENGTH - offset < SPIFI_W25_PAGE_SIZE ? BENCH_FLASH_LENGTH - offset : SPIFI_W25_PAGE_SIZE;
+
+        HAL_SPIFI_W25_ReadData( spifi, BENCH_FLASH_OFFSET + offset, length, flashPage );
+        for ( uint32_t i = 0; i < length; i++ )
+        {
+            errors += flashPage[ i ] != flashPattern( offset + i );
+        }
+    }
+    return errors;
+}
+
+
+/**
+ * Время cycles тактов в миллисекундах.
+ */
+static uint32_t flashMilliseconds( uint32_t cycles )
+{
+    return ( uint32_t ) ( ( uint64_t ) cycles * 1000 / HAL_PCC_GetSysClockFreq() );
+}
+
+
+void Bench_FlashWrite( void )
+{
+    SPIFI_HandleTypeDef spifi = { .Instance = SPIFI_CONFIG };
+
+    if ( HAL_SPIFI_IsMemoryModeEnabled( &spifi ) )
+    {
+        bench_printf( "flash write: running from SPIFI, skipped\n" );
+        return;
+    }
+
+    HAL_SPIFI_MspInit();
+    HAL_SPIFI_Reset( &spifi );
+
+    W25_ManufacturerDeviceIDTypeDef id = HAL_SPIFI_W25_ReadManufacturerDeviceID( &spifi );
+    if ( ( id.Manufacturer == 0x00 ) || ( id.Manufacturer == 0xFF ) )
+    {
+        bench_printf( "flash write: no flash, skipped\n" );
+        return;
+    }
+
+    uint32_t start = Bench_Cycles();
+    flashWriteReference( &spifi );
+    uint32_t reference = Bench_Cycles() - start;
+    uint32_t referenceErrors = flashVerify( &spifi );
+
+    start = Bench_Cycles();
+    HAL_StatusTypeDef status = HAL_SPIFI_W25_WriteStream( &spifi, BENCH_FLASH_OFFSET, BENCH_FLASH_LENGTH,
+                                                          flashFill, NULL, flashPage );
+    uint32_t stream = Bench_Cycles() - start;
+    uint32_t streamErrors = flashVerify( &spifi );
+
+    bench_printf( "flash write %u B: 4K erase + page program %u ms%s, range write %u ms%s%s\n",
+                  BENCH_FLASH_LENGTH, flashMilliseconds( reference ), referenceErrors ? " MISMATCH" : "",
+                  flashMilliseconds( stream ), streamErrors ? " MISMATCH" : "",
+                  status == HAL_OK ? "" : ", TIMEOUT" );
+}
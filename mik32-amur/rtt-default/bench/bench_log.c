@@ -0,0 +1,33 @@
+/**
+ * @file
+ * Стоимость вывода сообщения: форматирование на МК (SEGGER_RTT_printf, терминал 0) и
+ * двоичная запись с отложенным форматированием (RTT_LOG, буфер RTT_LOG_CHANNEL).
+ * Число повторов выбрано так, чтобы оба буфера RTT не переполнялись без чтения с ПК.
+ */
+
+#include "bench.h"
+#include "rtt_log.h"
+
+#define BENCH_LOG_LOOPS         8
+
+
+void Bench_Log( void )
+{
+    uint32_t start, printfCycles = 0, logCycles = 0;
+
+    RTT_Log_Init();
+
+    for ( uint32_t i = 0; i < BENCH_LOG_LOOPS; i++ )
+    {
+        start = Bench_Cycles();
+        SEGGER_RTT_printf( 0, "i=%u x=%x\n", i, i * 0x1234U );
+        printfCycles += Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        RTT_LOG( "i=%u x=%x\n", i, i * 0x1234U );
+        logCycles += Bench_Cycles() - start;
+    }
+
+    bench_printf( "log: SEGGER_RTT_printf %u cyc, RTT_LOG %u cyc, dropped %u\n",
+                  printfCycles / BENCH_LOG_LOOPS, logCycles / BENCH_LOG_LOOPS, RTT_Log_Dropped );
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Пропускная способность SPI_1 в режиме ведущего при каждом делителе SPI_BAUDRATE_DIV*:
+ * побайтный обмен HAL_SPI_Exchange и обмен с заполнением буферов HAL_SPI_ExchangeBurst,
+ * HAL_SPI_TransmitBurst, HAL_SPI_ReceiveBurst. Внешние соединения не нужны, принятые данные
+ * не проверяются.
+ */
+
+#include "bench.h"
+#include "mik32_hal_spi.h"
+
+#define BENCH_SPI_BLOCK         512
+
+static uint8_t spiTx[ BENCH_SPI_BLOCK ];
+static uint8_t spiRx[ BENCH_SPI_BLOCK ];
+
+
+static uint32_t spiBytesPerSecond( uint32_t cycles )
+{
+    return ( uint32_t ) ( ( uint64_t ) BENCH_SPI_BLOCK * HAL_PCC_GetSysClockFreq() / cycles );
+}
+
+
+void Bench_Spi( void )
+{
+    SPI_HandleTypeDef hspi = { 0 };
+
+    for ( uint32_t i = 0; i < BENCH_SPI_BLOCK; i++ )
+    {
+        spiTx[ i ] = ( uint8_t ) i;
+    }
+
+    hspi.Instance = SPI_1;
+    hspi.Init.SPI_Mode = HAL_SPI_MODE_MASTER;
+    hspi.Init.CLKPhase = SPI_PHASE_ON;
+    hspi.Init.CLKPolarity = SPI_POLARITY_HIGH;
+    hspi.Init.ThresholdTX = SPI_THRESHOLD_DEFAULT;
+    hspi.Init.Decoder = SPI_DECODER_NONE;
+    hspi.Init.ManualCS = SPI_MANUALCS_OFF;
+    hspi.Init.ChipSelect = SPI_CS_0;
+
+    for ( uint8_t div = SPI_BAUDRATE_DIV4; div <= SPI_BAUDRATE_DIV256; div++ )
+    {
+        hspi.Init.BaudRateDiv = div;
+        HAL_SPI_Init( &hspi );
+
+        uint32_t start = Bench_Cycles();
+        HAL_SPI_Exchange( &hspi, spiTx, spiRx, BENCH_SPI_BLOCK, SPI_TIMEOUT_DEFAULT );
+        uint32_t exchange = Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        HAL_SPI_ExchangeBurst( &hspi, spiTx, spiRx, BENCH_SPI_BLOCK, SPI_TIMEOUT_DEFAULT );
+        uint32_t burst = Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        HAL_SPI_TransmitBurst( &hspi, spiTx, BENCH_SPI_BLOCK, SPI_TIMEOUT_DEFAULT );
+        uint32_t transmit = Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        HAL_SPI_ReceiveBurst( &hspi, spiRx, BENCH_SPI_BLOCK, 0xFF, SPI_TIMEOUT_DEFAULT );
+        uint32_t receive = Bench_Cycles() - start;
+
+        bench_printf( "spi div %u: exchange %u B/s, burst %u B/s, tx-only %u B/s, rx-only %u B/s\n",
+                      2u << div, spiBytesPerSecond( exchange ), spiBytesPerSecond( burst ),
+                      spiBytesPerSecond( transmit ), spiBytesPerSecond( receive ) );
+    }
+
+    HAL_SPI_Disable( &hspi );
+}
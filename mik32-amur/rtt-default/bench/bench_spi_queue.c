@@ -0,0 +1,136 @@
+/**
+ * @file
+ * Очередь обменов SPI_1 через DMA (HAL_SPI_Queue_Submit) с двумя ведомыми на разных CS и с
+ * разной фазой: время серии коротких обменов и такты процессора на постановку в очередь. Для
+ * сравнения та же серия выполняется HAL_SPI_ExchangeBurst с перенастройкой SPI (HAL_SPI_Init)
+ * перед каждым обменом. Внешние соединения не нужны, принятые данные не проверяются.
+ */
+
+#include "bench.h"
+#include "mik32_hal_spi_queue.h"
+
+#define BENCH_SPI_QUEUE_TRANSFERS   16
+#define BENCH_SPI_QUEUE_LENGTH      64
+
+static uint8_t spiQueueTx[ BENCH_SPI_QUEUE_LENGTH ];
+static uint8_t spiQueueRx[ BENCH_SPI_QUEUE_TRANSFERS ][ BENCH_SPI_QUEUE_LENGTH ];
+static HAL_SPI_TransferTypeDef spiQueueTransfers[ BENCH_SPI_QUEUE_TRANSFERS ];
+
+static HAL_SPI_QueueDeviceTypeDef spiQueueDevices[] =
+{
+    { .ChipSelect = SPI_CS_0, .BaudRateDiv = SPI_BAUDRATE_DIV4, .CLKPhase = SPI_PHASE_ON,  .CLKPolarity = SPI_POLARITY_HIGH },
+    { .ChipSelect = SPI_CS_1, .BaudRateDiv = SPI_BAUDRATE_DIV4, .CLKPhase = SPI_PHASE_OFF, .CLKPolarity = SPI_POLARITY_LOW },
+};
+
+
+/**
+ * Время cycles тактов в микросекундах.
+ */
+static uint32_t spiQueueMicroseconds( uint32_t cycles )
+{
+    return ( uint32_t ) ( ( uint64_t ) cycles * 1000000 / HAL_PCC_GetSysClockFreq() );
+}
+
+
+/**
+ * Серия обменов HAL_SPI_ExchangeBurst с перенастройкой SPI под устройство каждого обмена.
+ */
+static uint32_t spiQueueBlocking( void )
+{
+    SPI_HandleTypeDef hspi = { 0 };
+
+    hspi.Instance = SPI_1;
+    hspi.Init.SPI_Mode = HAL_SPI_MODE_MASTER;
+    hspi.Init.ThresholdTX = SPI_THRESHOLD_DEFAULT;
+    hspi.Init.Decoder = SPI_DECODER_NONE;
+    hspi.Init.ManualCS = SPI_MANUALCS_OFF;
+
+    uint32_t start = Bench_Cycles();
+    for ( uint32_t i = 0; i < BENCH_SPI_QUEUE_TRANSFERS; i++ )
+    {
+        HAL_SPI_QueueDeviceTypeDef *device = &spiQueueDevices[ i % 2 ];
+
+        hspi.Init.ChipSelect = device->ChipSelect;
+        hspi.Init.BaudRateDiv = device->BaudRateDiv;
+        hspi.Init.CLKPhase = device->CLKPhase;
+        hspi.Init.CLKPolarity = device->CLKPolarity;
+        HAL_SPI_Init( &hspi );
+        HAL_SPI_ExchangeBurst( &hspi, spiQueueTx, spiQueueRx[ i ], BENCH_SPI_QUEUE_LENGTH, SPI_TIMEOUT_DEFAULT );
+    }
+    uint32_t cycles = Bench_Cycles() - start;
+
+    HAL_SPI_Disable( &hspi );
+    return cycles;
+}
+
+
+void Bench_SpiQueue( void )
+{
+    SPI_HandleTypeDef hspi = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_tx = { 0 };
+    DMA_ChannelHandleTypeDef hdma_rx = { 0 };
+    HAL_SPI_QueueTypeDef queue;
+
+    for ( uint32_t i = 0; i < BENCH_SPI_QUEUE_LENGTH; i++ )
+    {
+        spiQueueTx[ i ] = ( uint8_t ) i;
+    }
+
+    uint32_t blocking = spiQueueBlocking();
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_tx.dma = &hdma;
+    hdma_tx.ChannelInit.Channel = DMA_CHANNEL_0;
+    hdma_tx.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+    hdma_rx.dma = &hdma;
+    hdma_rx.ChannelInit.Channel = DMA_CHANNEL_1;
+    hdma_rx.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+
+    hspi.Instance = SPI_1;
+    hspi.Init.ThresholdTX = SPI_THRESHOLD_DEFAULT;
+    hspi.Init.Decoder = SPI_DECODER_NONE;
+    if ( HAL_SPI_Queue_Init( &queue, &hspi, &hdma_tx, &hdma_rx ) != HAL_OK )
+    {
+        bench_printf( "spi queue: init failed, skipped\n" );
+        return;
+    }
+
+    for ( uint32_t i = 0; i < BENCH_SPI_QUEUE_TRANSFERS; i++ )
+    {
+        spiQueueTransfers[ i ].Device = &spiQueueDevices[ i % 2 ];
+        spiQueueTransfers[ i ].TxData = spiQueueTx;
+        spiQueueTransfers[ i ].RxData = spiQueueRx[ i ];
+        spiQueueTransfers[ i ].Length = BENCH_SPI_QUEUE_LENGTH;
+        spiQueueTransfers[ i ].Callback = NULL;
+    }
+
+    uint32_t submit = 0;
+    uint32_t errors = 0;
+    uint32_t start = Bench_Cycles();
+    for ( uint32_t i = 0; i < BENCH_SPI_QUEUE_TRANSFERS; i++ )
+    {
+        uint32_t submitStart = Bench_Cycles();
+        HAL_SPI_Queue_Submit( &queue, &spiQueueTransfers[ i ] );
+        submit += Bench_Cycles() - submitStart;
+    }
+    while ( !HAL_SPI_Queue_IsIdle( &queue ) )
+    {
+    }
+    uint32_t queued = Bench_Cycles() - start;
+
+    for ( uint32_t i = 0; i < BENCH_SPI_QUEUE_TRANSFERS; i++ )
+    {
+        errors += spiQueueTransfers[ i ].Status != HAL_OK;
+    }
+
+    bench_printf( "spi queue %u x %u B, div 4, 2 devices: blocking %u us, queued %u us, submit %u cyc%s\n",
+                  BENCH_SPI_QUEUE_TRANSFERS, BENCH_SPI_QUEUE_LENGTH, spiQueueMicroseconds( blocking ),
+                  spiQueueMicroseconds( queued ), submit / BENCH_SPI_QUEUE_TRANSFERS, errors ? ", DMA ERROR" : "" );
+
+    HAL_SPI_Disable( &hspi );
+    HAL_EPIC_MaskLevelClear( HAL_EPIC_DMA_MASK );
+    HAL_EPIC_SetHandler( EPIC_LINE_DMA_S, NULL );
+}
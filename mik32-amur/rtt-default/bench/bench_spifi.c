@@ -0,0 +1,124 @@
+/**
+ * @file
+ * Скорость чтения флеш-памяти W25 через SPIFI в периферийном режиме для команд Fast Read,
+ * Fast Read Dual Output, Fast Read Quad Output и Fast Read Quad I/O: побайтное чтение
+ * процессором (HAL_SPIFI_W25_ReadData*) и чтение через DMA (HAL_SPIFI_W25_ReadData_DMA).
+ * Данные DMA сравниваются с прочитанными процессором. Тест пропускается, если программа
+ * выполняется из SPIFI или флеш-память не отвечает.
+ */
+
+#include "bench.h"
+#include "mik32_hal_spifi_w25.h"
+
+#include <string.h>
+
+#define BENCH_SPIFI_BLOCK       4096
+#define BENCH_SPIFI_TOTAL       ( 64 * 1024 )
+
+static uint32_t spifiCpu[ BENCH_SPIFI_BLOCK / 4 ];
+static uint32_t spifiDma[ BENCH_SPIFI_BLOCK / 4 ];
+
+static const char * const spifiModeNames[] = { "single", "dual", "quad", "quad io" };
+
+
+/**
+ * Скорость в тысячных долях МБ/с при чтении BENCH_SPIFI_TOTAL байт за cycles тактов.
+ */
+static uint32_t spifiKiloBytesPerSecond( uint32_t cycles )
+{
+    return ( uint32_t ) ( ( uint64_t ) BENCH_SPIFI_TOTAL * HAL_PCC_GetSysClockFreq() / 1000 / ( cycles ? cycles : 1 ) );
+}
+
+
+static void spifiCpuRead( SPIFI_HandleTypeDef *spifi, HAL_SPIFI_W25_ReadModeTypeDef mode, uint32_t address )
+{
+    switch ( mode )
+    {
+    case W25_READ_SINGLE:
+    case W25_READ_DUAL:
+        /* Побайтного чтения командами Fast Read и Dual Output в драйвере нет, опорное чтение - Read Data (0x03) */
+        HAL_SPIFI_W25_ReadData( spifi, address, BENCH_SPIFI_BLOCK, ( uint8_t * ) spifiCpu );
+        break;
+    case W25_READ_QUAD:
+        HAL_SPIFI_W25_ReadData_Quad( spifi, address, BENCH_SPIFI_BLOCK, ( uint8_t * ) spifiCpu );
+        break;
+    case W25_READ_QUAD_IO:
+        HAL_SPIFI_W25_ReadData_Quad_IO( spifi, address, BENCH_SPIFI_BLOCK, ( uint8_t * ) spifiCpu );
+        break;
+    }
+}
+
+
+void Bench_Spifi( void )
+{
+    SPIFI_HandleTypeDef spifi = { .Instance = SPIFI_CONFIG };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+    HAL_SPIFI_DMA_TypeDef engine = { 0 };
+
+    if ( HAL_SPIFI_IsMemoryModeEnabled( &spifi ) )
+    {
+        bench_printf( "spifi: running from SPIFI, skipped\n" );
+        return;
+    }
+
+    HAL_SPIFI_MspInit();
+    HAL_SPIFI_Reset( &spifi );
+
+    W25_ManufacturerDeviceIDTypeDef id = HAL_SPIFI_W25_ReadManufacturerDeviceID( &spifi );
+    if ( ( id.Manufacturer == 0x00 ) || ( id.Manufacturer == 0xFF ) )
+    {
+        bench_printf( "spifi: no flash, skipped\n" );
+        return;
+    }
+    HAL_SPIFI_W25_QuadEnable( &spifi );
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_DISABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_0;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+    HAL_SPIFI_DMA_Init( &engine, &spifi, &hdma_channel, NULL );
+
+    uint32_t sckDiv = 2u << ( ( spifi.Instance->CTRL & SPIFI_CONFIG_CTRL_SCK_DIV_M ) >> SPIFI_CONFIG_CTRL_SCK_DIV_S );
+    bench_printf( "spifi: id %x/%x, sck = hclk / %u, %u B\n", id.Manufacturer, id.Device, sckDiv, BENCH_SPIFI_TOTAL );
+
+    for ( uint32_t mode = W25_READ_SINGLE; mode <= W25_READ_QUAD_IO; mode++ )
+    {
+        uint32_t cpu = 0;
+        uint32_t dma = 0;
+        uint32_t start = 0;
+        uint32_t errors = 0;
+
+        for ( uint32_t address = 0; address < BENCH_SPIFI_TOTAL; address += BENCH_SPIFI_BLOCK )
+        {
+            uint32_t begin = Bench_Cycles();
+            spifiCpuRead( &spifi, mode, address );
+            cpu += Bench_Cycles() - begin;
+
+            begin = Bench_Cycles();
+            HAL_SPIFI_W25_ReadData_DMA( &engine, mode, address, BENCH_SPIFI_BLOCK, ( uint8_t * ) spifiDma );
+            start += Bench_Cycles() - begin;
+            if ( HAL_SPIFI_DMA_Wait( &engine, HAL_SPIFI_TIMEOUT ) != HAL_OK )
+            {
+                errors++;
+            }
+            dma += Bench_Cycles() - begin;
+
+            if ( memcmp( spifiCpu, spifiDma, BENCH_SPIFI_BLOCK ) != 0 )
+            {
+                errors++;
+            }
+        }
+
+        uint32_t cpuRate = spifiKiloBytesPerSecond( cpu );
+        uint32_t dmaRate = spifiKiloBytesPerSecond( dma );
+        bench_printf( "spifi %s: cpu %u.%03u MB/s, dma %u.%03u MB/s (start %u cyc per %u B)%s\n",
+                      spifiModeNames[ mode ], cpuRate / 1000, cpuRate % 1000, dmaRate / 1000, dmaRate % 1000,
+                      start / ( BENCH_SPIFI_TOTAL / BENCH_SPIFI_BLOCK ), BENCH_SPIFI_BLOCK,
+                      errors ? ", MISMATCH" : "" );
+    }
+
+    HAL_EPIC_MaskLevelClear( HAL_EPIC_SPIFI_MASK );
+}
@@ -0,0 +1,133 @@
+/**
+ * @file
+ * Вывод часов на дисплей SSD1306 128x32 (I2C_0, адрес 0x3C): байт на шине и такты процессора
+ * на кадр. Сравниваются блокирующий вывод символов (HAL_SSD1306_SetBorder + HAL_SSD1306_Write)
+ * и кадровый буфер с выводом измененных участков (HAL_SSD1306_Frame_*) через DMA и по
+ * прерываниям. Для кадрового буфера такты процессора - время HAL_SSD1306_Frame_Flush и
+ * обработчика прерывания I2C, остальное время вывода процессор свободен.
+ */
+
+#include "bench.h"
+#include "mik32_hal_ssd1306.h"
+
+/* Байт на шине за посылку сверх данных: адрес */
+#define BENCH_SSD1306_ADDRESS_BYTES     1
+/* Предел ожидания вывода кадра, тактов */
+#define BENCH_SSD1306_TIMEOUT           64000000UL
+
+static HAL_SSD1306_FrameTypeDef ssdFrame;
+static volatile uint32_t ssdIrqCycles;
+
+/* Символы кадров: часы 12:34, затем смена единиц минут (12:35) */
+static const uint8_t ssdColumns[] = { START_COLUMN_TH, START_COLUMN_H, START_COLUMN_COLON, START_COLUMN_TM, START_COLUMN_M };
+static const uint8_t ssdClock[] = { 1, 2, SYMBOL_COLON, 3, 4 };
+static const uint8_t ssdTick[] = { 1, 2, SYMBOL_COLON, 3, 5 };
+
+
+static void ssdIrqHandler( void )
+{
+    uint32_t start = Bench_Cycles();
+    HAL_SSD1306_Frame_IRQHandler( &ssdFrame );
+    ssdIrqCycles += Bench_Cycles() - start;
+}
+
+
+/**
+ * Блокирующий вывод символов кадра, начиная с first (как в примере часов: только
+ * изменившиеся разряды). Возвращает такты, в bytes - байт на шине.
+ */
+static uint32_t ssdBlocking( I2C_HandleTypeDef *hi2c, const uint8_t *symbols, uint32_t first, uint32_t *bytes )
+{
+    uint32_t start = Bench_Cycles();
+
+    for ( uint32_t i = first; i < sizeof( ssdColumns ); i++ )
+    {
+        HAL_SSD1306_SetBorder( hi2c, ssdColumns[ i ], ssdColumns[ i ] + SYMBOL_WIDTH - 1, START_PAGE, SYMBOL_PAGES - 1 );
+        HAL_SSD1306_Write( hi2c, symbols[ i ] );
+    }
+
+    *bytes = ( sizeof( ssdColumns ) - first ) * ( 12 + BENCH_SSD1306_ADDRESS_BYTES + 1 + SYMBOL_PAGES * SYMBOL_WIDTH + BENCH_SSD1306_ADDRESS_BYTES );
+    return Bench_Cycles() - start;
+}
+
+
+/**
+ * Рисование и вывод кадра через кадровый буфер.
+ */
+static void ssdFrameRun( const char *name, const uint8_t *symbols )
+{
+    for ( uint32_t i = 0; i < sizeof( ssdColumns ); i++ )
+    {
+        HAL_SSD1306_Frame_DrawSymbol( &ssdFrame, ssdColumns[ i ], symbols[ i ] );
+    }
+
+    ssdIrqCycles = 0;
+    uint32_t start = Bench_Cycles();
+    HAL_SSD1306_Frame_Flush( &ssdFrame );
+    uint32_t flushCycles = Bench_Cycles() - start;
+
+    while ( HAL_SSD1306_Frame_IsBusy( &ssdFrame ) && ( Bench_Cycles() - start < BENCH_SSD1306_TIMEOUT ) );
+    uint32_t elapsed = Bench_Cycles() - start;
+
+    bench_printf( "ssd1306 %s %s: %u B in %u transfers, cpu %u cyc (flush %u, irq %u), elapsed %u cyc%s\n",
+                  ssdFrame.Mode == SSD1306_FLUSH_DMA ? "dma" : "it", name, ssdFrame.BusBytes, ssdFrame.Transfers,
+                  flushCycles + ssdIrqCycles, flushCycles, ssdIrqCycles, elapsed,
+                  ssdFrame.Status == HAL_OK ? "" : " ERROR" );
+}
+
+
+void Bench_Ssd1306( void )
+{
+    I2C_HandleTypeDef hi2c = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+    uint32_t bytes;
+
+    hi2c.Instance = I2C_0;
+    hi2c.Init.Mode = HAL_I2C_MODE_MASTER;
+    hi2c.Init.DigitalFilter = I2C_DIGITALFILTER_OFF;
+    hi2c.Init.AnalogFilter = I2C_ANALOGFILTER_DISABLE;
+    hi2c.Init.AutoEnd = I2C_AUTOEND_ENABLE;
+    hi2c.Clock.PRESC = 5;
+    hi2c.Clock.SCLDEL = 10;
+    hi2c.Clock.SDADEL = 10;
+    hi2c.Clock.SCLH = 16;
+    hi2c.Clock.SCLL = 16;
+    HAL_I2C_Init( &hi2c );
+
+    if ( HAL_SSD1306_Init( &hi2c, BRIGHTNESS_FULL ) != HAL_OK )
+    {
+        bench_printf( "ssd1306: no display on I2C_0, skipped\n" );
+        return;
+    }
+    HAL_SSD1306_CLR_SCR( &hi2c );
+
+    uint32_t clockCycles = ssdBlocking( &hi2c, ssdClock, 0, &bytes );
+    bench_printf( "ssd1306 blocking clock: %u B, cpu %u cyc\n", bytes, clockCycles );
+    uint32_t tickCycles = ssdBlocking( &hi2c, ssdTick, sizeof( ssdColumns ) - 1, &bytes );
+    bench_printf( "ssd1306 blocking tick: %u B, cpu %u cyc\n", bytes, tickCycles );
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_3;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_HIGH;
+    hi2c.hdmatx = &hdma_channel;
+
+    static const HAL_SSD1306_FlushModeTypeDef modes[] = { SSD1306_FLUSH_DMA, SSD1306_FLUSH_IT };
+    for ( uint32_t i = 0; i < sizeof( modes ) / sizeof( modes[ 0 ] ); i++ )
+    {
+        HAL_SSD1306_Frame_Init( &ssdFrame, &hi2c, modes[ i ] );
+        HAL_EPIC_SetHandler( EPIC_LINE_I2C_0_S, ssdIrqHandler );
+
+        /* Первый вывод - весь экран */
+        ssdFrameRun( "full", ssdClock );
+        ssdFrameRun( "tick", ssdTick );
+        ssdFrameRun( "tick back", ssdClock );
+        ssdFrameRun( "unchanged", ssdClock );
+    }
+
+    HAL_EPIC_SetHandler( EPIC_LINE_I2C_0_S, NULL );
+    HAL_EPIC_MaskLevelClear( HAL_EPIC_I2C_0_MASK );
+}
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * Сравнение стоимости чтения системного времени на 32-р таймере:
+ * - прежний вариант (чтение частоты из PM, 64-р умножение и деление при каждом вызове);
+ * - вариант с заранее вычисленными коэффициентами (умножение и сдвиг).
+ */
+
+#include "bench.h"
+#include "mik32_hal_timer32.h"
+
+#define BENCH_TIMEBASE_LOOPS    1000
+
+
+/**
+ * Прежняя реализация HAL_Time_TIM32_Micros (для сравнения).
+ */
+static uint32_t __attribute__((noinline)) legacyMicros( TIMER32_TypeDef *timer, uint32_t presc_pt )
+{
+    uint32_t clock_freq = HAL_PCC_GetSysClockFreq();
+
+    return ( uint32_t ) ( ( uint64_t ) timer->VALUE * ( 1000000UL * presc_pt ) / clock_freq );
+}
+
+
+void Bench_TimeBase( void )
+{
+    volatile uint32_t sink;
+    uint32_t start, legacy, fast, fast64;
+
+    HAL_Time_TIM32_Init( TIMER32_0 );
+
+    uint32_t presc_pt = ( PM->DIV_AHB + 1 ) * ( PM->DIV_APB_M + 1 ) * ( ( TIMER32_0->PRESCALER & TIMER32_PRESCALER_M ) + 1 );
+
+    start = Bench_Cycles();
+    for ( uint32_t i = 0; i < BENCH_TIMEBASE_LOOPS; i++ ) sink = legacyMicros( TIMER32_0, presc_pt );
+    legacy = Bench_Cycles() - start;
+
+    start = Bench_Cycles();
+    for ( uint32_t i = 0; i < BENCH_TIMEBASE_LOOPS; i++ ) sink = HAL_Time_TIM32_Micros();
+    fast = Bench_Cycles() - start;
+
+    start = Bench_Cycles();
+    for ( uint32_t i = 0; i < BENCH_TIMEBASE_LOOPS; i++ ) sink = ( uint32_t ) HAL_Time_TIM32_Millis64();
+    fast64 = Bench_Cycles() - start;
+
+    ( void ) sink;
+
+    bench_printf( "timebase: legacy micros %u cyc/call, micros %u cyc/call, millis64 %u cyc/call\n",
+                  legacy / BENCH_TIMEBASE_LOOPS, fast / BENCH_TIMEBASE_LOOPS, fast64 / BENCH_TIMEBASE_LOOPS );
+
+    /* TIMER32_0 используется следующими тестами */
+    TIMER32_0->INT_MASK &= ~TIMER32_INT_OVERFLOW_M;
+    HAL_EPIC_MaskLevelClear( HAL_EPIC_TIMER32_0_MASK );
+    HAL_EPIC_SetHandler( EPIC_LINE_TIMER32_0_S, NULL );
+}
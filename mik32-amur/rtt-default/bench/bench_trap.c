@@ -0,0 +1,41 @@
+/**
+ * @file
+ * Стоимость входа в обработчик ловушки (crt0.S, raw_trap_handler).
+ * Ловушка вызывается инструкцией ecall, crt0 в сборке с MIK32_BENCH сохраняет значение mcycle
+ * перед вызовом trap_handler, trap_handler сборки с тестами пропускает ecall, пока установлен
+ * флаг bench_trap_ecall. Сравнивать результаты сборок с опцией MIK32_TRAP_FULL_SAVE и без нее.
+ */
+
+#include "bench.h"
+
+#define BENCH_TRAP_LOOPS        100
+
+/* Значение mcycle перед вызовом trap_handler (crt0.S) */
+extern volatile uint32_t trap_handler_cycle;
+
+volatile uint32_t bench_trap_ecall;
+
+
+void Bench_Trap( void )
+{
+    uint32_t start, entry = 0, total = 0;
+
+    bench_trap_ecall = 1;
+
+    for ( uint32_t i = 0; i < BENCH_TRAP_LOOPS; i++ )
+    {
+        start = Bench_Cycles();
+        __asm__ volatile ( "ecall" ::: "memory" );
+        total += Bench_Cycles() - start;
+        entry += trap_handler_cycle - start;
+    }
+
+    bench_trap_ecall = 0;
+
+#ifdef MIK32_TRAP_FULL_SAVE
+    bench_printf( "trap (full save): entry %u cyc, round trip %u cyc\n",
+#else
+    bench_printf( "trap (caller-saved): entry %u cyc, round trip %u cyc\n",
+#endif
+                  entry / BENCH_TRAP_LOOPS, total / BENCH_TRAP_LOOPS );
+}
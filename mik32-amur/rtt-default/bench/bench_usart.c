@@ -0,0 +1,80 @@
+/**
+ * @file
+ * Пропускная способность буферизированного потока USART (HAL_USART_Stream_*) на скоростях
+ * 115200 и 1000000 бод. UART_1 работает во внутренней петле (LBM), поэтому внешние
+ * соединения не нужны. Блок данных записывается в поток порциями и одновременно читается,
+ * измеряются время полного оборота, байт/с и загрузка процессора (доля тактов в
+ * HAL_USART_Stream_Write/Read и прерываниях относительно свободного цикла).
+ */
+
+#include "bench.h"
+#include "mik32_hal_usart_stream.h"
+#include "mik32_hal_pcc.h"
+
+#define BENCH_USART_BLOCK           4096
+#define BENCH_USART_CHUNK           64
+
+static uint8_t usartRx[ 256 ];
+static uint8_t usartTx[ 256 ];
+
+
+void Bench_Usart( void )
+{
+    static const uint32_t baudrates[] = { 115200, 1000000 };
+
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+    HAL_USART_StreamTypeDef stream = { 0 };
+    uint8_t chunk[ BENCH_USART_CHUNK ];
+
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_1;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_HIGH;
+    stream.hdma_channel = &hdma_channel;
+
+    for ( uint32_t i = 0; i < BENCH_USART_CHUNK; i++ )
+    {
+        chunk[ i ] = ( uint8_t ) i;
+    }
+
+    for ( uint32_t i = 0; i < sizeof( baudrates ) / sizeof( baudrates[ 0 ] ); i++ )
+    {
+        HAL_USART_Stream_Init( &stream, UART_1, baudrates[ i ], usartRx, sizeof( usartRx ), usartTx, sizeof( usartTx ) );
+
+        /* Внутренняя петля: бит LBM изменяется только при UE = 0 */
+        UART_1->CONTROL1 &= ~UART_CONTROL1_UE_M;
+        UART_1->CONTROL2 |= UART_CONTROL2_LBM_M;
+        UART_1->CONTROL1 |= UART_CONTROL1_UE_M;
+        while ( ( UART_1->FLAGS & ( UART_FLAGS_REACK_M | UART_FLAGS_TEACK_M ) ) != ( UART_FLAGS_REACK_M | UART_FLAGS_TEACK_M ) );
+
+        uint32_t sent = 0, received = 0, spins = 0;
+        uint32_t start = Bench_Cycles();
+
+        while ( received < BENCH_USART_BLOCK )
+        {
+            if ( sent < BENCH_USART_BLOCK )
+            {
+                uint32_t size = BENCH_USART_BLOCK - sent;
+                sent += HAL_USART_Stream_Write( &stream, chunk, size < BENCH_USART_CHUNK ? size : BENCH_USART_CHUNK );
+            }
+            received += HAL_USART_Stream_Read( &stream, chunk, BENCH_USART_CHUNK );
+            spins++;
+        }
+
+        uint32_t cycles = Bench_Cycles() - start;
+        uint32_t bps = ( uint32_t ) ( ( uint64_t ) BENCH_USART_BLOCK * HAL_PCC_GetSysClockFreq() / cycles );
+
+        HAL_USART_Stream_DeInit( &stream );
+        UART_1->CONTROL2 = 0;
+
+        bench_printf( "usart stream %u baud: %u B/s (line max %u B/s), %u cyc/loop, rx overruns %u, errors %u\n",
+                      baudrates[ i ], bps, baudrates[ i ] / 10, cycles / spins, stream.RxOverruns, stream.RxErrors );
+    }
+
+    HAL_EPIC_SetHandler( EPIC_LINE_UART_1_S, NULL );
+    HAL_EPIC_SetHandler( EPIC_LINE_DMA_S, NULL );
+    HAL_EPIC_MaskLevelClear( HAL_EPIC_DMA_MASK );
+}
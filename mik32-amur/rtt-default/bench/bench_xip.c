@@ -0,0 +1,252 @@
+/**
+ * @file
+ * Выполнение кода из флеш-памяти W25 в режиме памяти SPIFI (адрес 0x80000000) для каждой
+ * команды чтения HAL_SPIFI_W25_MemoryMode_Init с кэшем и без него. Ядро теста в духе CoreMark
+ * (произведение матриц, CRC16, конечный автомат) копируется во флеш-память по смещению
+ * BENCH_XIP_OFFSET и вызывается оттуда; выводятся такты первого вызова (пустой кэш) и среднее
+ * на вызов, для сравнения - такты того же кода в памяти программы.
+ *
+ * Сектор 4 КБ по смещению BENCH_XIP_OFFSET стирается, если его содержимое не совпадает с кодом.
+ * Сектор лежит выше слотов загрузчика A/B (до 0x100000), как и области остальных тестов флеш-памяти.
+ * Тест пропускается, если программа выполняется из SPIFI или флеш-память не отвечает.
+ */
+
+#include "bench.h"
+#include "mik32_hal_spifi_w25.h"
+
+#define BENCH_XIP_OFFSET        0x00150000
+#define BENCH_XIP_SECTOR        4096
+#define BENCH_XIP_RUNS          16
+#define BENCH_XIP_N             6
+
+/*
+ * Код ядра размещается в отдельной секции и не обращается к глобальным данным и функциям вне
+ * секции, поэтому выполняется с любого адреса. Преобразование циклов в вызовы memset запрещено,
+ * как и таблицы переходов для switch: они содержат абсолютные адреса исходной секции.
+ */
+#define BENCH_XIP_CODE  __attribute__(( section( "bench_xip" ), noipa, optimize( "no-tree-loop-distribute-patterns", "no-jump-tables" ) ))
+
+typedef uint32_t ( *xipKernelTypeDef )( uint32_t seed );
+
+extern const uint8_t __start_bench_xip[];
+extern const uint8_t __stop_bench_xip[];
+
+static uint8_t xipPage[ SPIFI_W25_PAGE_SIZE ];
+
+static const struct
+{
+    const char *name;
+    HAL_SPIFI_W25_MemoryModeTypeDef mode;
+    HAL_SPIFI_CacheEnableTypeDef cache;
+    HAL_SPIFI_PrefetchEnableTypeDef prefetch;
+} xipConfigs[] =
+{
+    { "fast read",          W25_MEMORY_FAST_READ,   SPIFI_CACHE_DISABLE, SPIFI_PREFETCH_ENABLE },
+    { "fast read cache",    W25_MEMORY_FAST_READ,   SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_ENABLE },
+    { "quad out",           W25_MEMORY_QUAD_OUTPUT, SPIFI_CACHE_DISABLE, SPIFI_PREFETCH_ENABLE },
+    { "quad out cache",     W25_MEMORY_QUAD_OUTPUT, SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_ENABLE },
+    { "quad io",            W25_MEMORY_QUAD_IO,     SPIFI_CACHE_DISABLE, SPIFI_PREFETCH_ENABLE },
+    { "quad io cache",      W25_MEMORY_QUAD_IO,     SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_ENABLE },
+    { "quad io xip",        W25_MEMORY_QUAD_IO_XIP, SPIFI_CACHE_DISABLE, SPIFI_PREFETCH_ENABLE },
+    { "quad io xip cache",  W25_MEMORY_QUAD_IO_XIP, SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_ENABLE },
+    { "quad io xip nopref", W25_MEMORY_QUAD_IO_XIP, SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_DISABLE },
+    { "qpi",                W25_MEMORY_QPI,         SPIFI_CACHE_DISABLE, SPIFI_PREFETCH_ENABLE },
+    { "qpi cache",          W25_MEMORY_QPI,         SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_ENABLE },
+    { "qpi xip",            W25_MEMORY_QPI_XIP,     SPIFI_CACHE_DISABLE, SPIFI_PREFETCH_ENABLE },
+    { "qpi xip cache",      W25_MEMORY_QPI_XIP,     SPIFI_CACHE_ENABLE,  SPIFI_PREFETCH_ENABLE },
+};
+
+
+static inline __attribute__(( always_inline )) uint32_t xipRandom( uint32_t *x )
+{
+    *x = *x * 1664525u + 1013904223u;
+    return *x;
+}
+
+
+static inline __attribute__(( always_inline )) uint32_t xipCrc16( uint32_t crc, uint32_t data )
+{
+    for ( uint32_t bit = 0; bit < 16; bit++ )
+    {
+        uint32_t mix = ( crc ^ data ) & 1;
+        crc >>= 1;
+        data >>= 1;
+        if ( mix )
+        {
+            crc ^= 0xA001;
+        }
+    }
+    return crc;
+}
+
+
+BENCH_XIP_CODE uint32_t xipKernel( uint32_t seed )
+{
+    int16_t a[ BENCH_XIP_N ][ BENCH_XIP_N ];
+    int16_t b[ BENCH_XIP_N ][ BENCH_XIP_N ];
+    uint32_t x = seed;
+    uint32_t crc = 0xFFFF;
+    uint32_t state = 0;
+    uint32_t digits = 0;
+
+    for ( uint32_t i = 0; i < BENCH_XIP_N; i++ )
+    {
+        for ( uint32_t j = 0; j < BENCH_XIP_N; j++ )
+        {
+            a[ i ][ j ] = ( int16_t ) ( xipRandom( &x ) >> 20 );
+            b[ i ][ j ] = ( int16_t ) ( xipRandom( &x ) >> 20 );
+        }
+    }
+
+    for ( uint32_t i = 0; i < BENCH_XIP_N; i++ )
+    {
+        for ( uint32_t j = 0; j < BENCH_XIP_N; j++ )
+        {
+            int32_t sum = 0;
+            for ( uint32_t k = 0; k < BENCH_XIP_N; k++ )
+            {
+                sum += a[ i ][ k ] * b[ k ][ j ];
+            }
+            crc = xipCrc16( crc, ( uint32_t ) sum );
+        }
+    }
+
+    /* Разбор числа со знаком и экспонентой по псевдослучайным символам */
+    for ( uint32_t n = 0; n < 256; n++ )
+    {
+        uint32_t c = xipRandom( &x ) >> 28;
+
+        if ( c < 10 )
+        {
+            digits++;
+            state = ( state == 0 || state == 1 ) ? 2 : ( state == 3 ) ? 4 : ( state == 5 ) ? 6 : state;
+        }
+        else if ( c == 10 )
+        {
+            state = ( state == 0 ) ? 1 : ( state == 5 ) ? 6 : 7;
+        }
+        else if ( c == 11 )
+        {
+            state = ( state == 2 ) ? 3 : 7;
+        }
+        else if ( c == 12 )
+        {
+            state = ( state == 2 || state == 4 ) ? 5 : 7;
+        }
+        else
+        {
+            crc = xipCrc16( crc, state );
+            state = 0;
+        }
+    }
+
+    return crc ^ ( digits << 16 ) ^ state;
+}
+
+
+/**
+ * Записывает код ядра во флеш-память, если он там отсутствует.
+ */
+static void xipProgram( SPIFI_HandleTypeDef *spifi, uint32_t size )
+{
+    int same = 1;
+
+    for ( uint32_t offset = 0; offset < size; offset += SPIFI_W25_PAGE_SIZE )
+    {
+        uint32_t length = size - offset < SPIFI_W25_PAGE_SIZE ? size - offset : SPIFI_W25_PAGE_SIZE;
+
+        HAL_SPIFI_W25_ReadData( spifi, BENCH_XIP_OFFSET + offset, length, xipPage );
+        for ( uint32_t i = 0; i < length; i++ )
+        {
+            same &= xipPage[ i ] == __start_bench_xip[ offset + i ];
+        }
+    }
+    if ( same )
+    {
+        return;
+    }
+
+    HAL_SPIFI_W25_SectorErase4K( spifi, BENCH_XIP_OFFSET );
+    for ( uint32_t offset = 0; offset < size; offset += SPIFI_W25_PAGE_SIZE )
+    {
+        uint32_t length = size - offset < SPIFI_W25_PAGE_SIZE ? size - offset : SPIFI_W25_PAGE_SIZE;
+
+        for ( uint32_t i = 0; i < length; i++ )
+        {
+            xipPage[ i ] = __start_bench_xip[ offset + i ];
+        }
+        HAL_SPIFI_W25_PageProgram( spifi, BENCH_XIP_OFFSET + offset, length, xipPage );
+    }
+}
+
+
+void Bench_Xip( void )
+{
+    SPIFI_HandleTypeDef spifi = { .Instance = SPIFI_CONFIG };
+    uint32_t size = ( uint32_t ) ( __stop_bench_xip - __start_bench_xip );
+
+    if ( HAL_SPIFI_IsMemoryModeEnabled( &spifi ) )
+    {
+        bench_printf( "xip: running from SPIFI, skipped\n" );
+        return;
+    }
+    if ( size > BENCH_XIP_SECTOR )
+    {
+        bench_printf( "xip: kernel %u B does not fit the sector, skipped\n", size );
+        return;
+    }
+
+    HAL_SPIFI_MspInit();
+    HAL_SPIFI_Reset( &spifi );
+
+    W25_ManufacturerDeviceIDTypeDef id = HAL_SPIFI_W25_ReadManufacturerDeviceID( &spifi );
+    if ( ( id.Manufacturer == 0x00 ) || ( id.Manufacturer == 0xFF ) )
+    {
+        bench_printf( "xip: no flash, skipped\n" );
+        return;
+    }
+    xipProgram( &spifi, size );
+
+    uint32_t expected = xipKernel( 1 );
+    uint32_t start = Bench_Cycles();
+    for ( uint32_t run = 0; run < BENCH_XIP_RUNS; run++ )
+    {
+        xipKernel( run );
+    }
+    uint32_t local = ( Bench_Cycles() - start ) / BENCH_XIP_RUNS;
+    bench_printf( "xip: kernel %u B, local %u cyc/run\n", size, local );
+
+    xipKernelTypeDef kernel = ( xipKernelTypeDef ) ( SPIFI_BASE_ADDRESS + BENCH_XIP_OFFSET +
+                                                     ( ( uint32_t ) xipKernel - ( uint32_t ) __start_bench_xip ) );
+
+    for ( uint32_t i = 0; i < sizeof( xipConfigs ) / sizeof( xipConfigs[ 0 ] ); i++ )
+    {
+        SPIFI_MemoryModeConfig_HandleTypeDef config = { 0 };
+
+        config.CacheEnable = xipConfigs[ i ].cache;
+        config.CacheLimit = HAL_SPIFI_CacheLimit( BENCH_XIP_OFFSET + BENCH_XIP_SECTOR );
+        config.Prefetch = xipConfigs[ i ].prefetch;
+
+        if ( HAL_SPIFI_W25_MemoryMode_Init( &spifi, &config, xipConfigs[ i ].mode ) != HAL_OK )
+        {
+            bench_printf( "xip %s: init error\n", xipConfigs[ i ].name );
+            continue;
+        }
+
+        start = Bench_Cycles();
+        uint32_t result = kernel( 1 );
+        uint32_t first = Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        for ( uint32_t run = 0; run < BENCH_XIP_RUNS; run++ )
+        {
+            kernel( run );
+        }
+        uint32_t average = ( Bench_Cycles() - start ) / BENCH_XIP_RUNS;
+
+        HAL_SPIFI_W25_MemoryMode_Exit( &spifi, xipConfigs[ i ].mode );
+
+        bench_printf( "xip %s: first %u cyc, %u cyc/run%s\n", xipConfigs[ i ].name, first, average,
+                      result == expected ? "" : ", MISMATCH" );
+    }
+}
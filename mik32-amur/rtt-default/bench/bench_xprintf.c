@@ -0,0 +1,32 @@
+/**
+ * @file
+ * Стоимость форматирования xprintf (shared/libs/xprintf.c) в память (xsprintf): строка
+ * шестнадцатеричного дампа из четырех слов, как при выводе блоков шифра, и десятичные числа.
+ */
+
+#include "bench.h"
+#include "xprintf.h"
+
+#define BENCH_XPRINTF_LOOPS     16
+
+
+void Bench_Xprintf( void )
+{
+    static const uint32_t words[ 4 ] = { 0x8899AABB, 0xCCDDEEFF, 0x00112233, 0x44556677 };
+    char line[ 64 ];
+    uint32_t start, hexCycles = 0, decCycles = 0;
+
+    for ( uint32_t i = 0; i < BENCH_XPRINTF_LOOPS; i++ )
+    {
+        start = Bench_Cycles();
+        xsprintf( line, "%08X %08X %08X %08X", words[ 0 ] ^ i, words[ 1 ], words[ 2 ], words[ 3 ] );
+        hexCycles += Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        xsprintf( line, "%u %d %10u", 4000000000U - i, -123456789 + ( int ) i, i * 1000003U );
+        decCycles += Bench_Cycles() - start;
+    }
+
+    bench_printf( "xsprintf: 4 x %%08X %u cyc, 3 decimals %u cyc\n",
+                  hexCycles / BENCH_XPRINTF_LOOPS, decCycles / BENCH_XPRINTF_LOOPS );
+}
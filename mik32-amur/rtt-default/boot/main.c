@@ -0,0 +1,119 @@
+/**
+ * @file
+ * Загрузчик A/B: выбор и запуск образа программы из одного из двух слотов флеш-памяти SPIFI
+ * (mik32_hal_boot.h). Собирается вместо main.c при включенной опции MIK32_BOOTLOADER и
+ * выполняется из EEPROM (cmake -DMIK32_BOOTLOADER=ON -DMIK32_LDSCRIPT=eeprom).
+ *
+ * Адреса и размер слотов задаются в CMakeLists.txt (MIK32_BOOT_SLOT_A, MIK32_BOOT_SLOT_B,
+ * MIK32_BOOT_SLOT_SIZE). Программа для слота собирается со сценарием spifi_slot
+ * (-DMIK32_LDSCRIPT=spifi_slot -DMIK32_BOOT_SLOT=A или B): с адреса слота + HAL_BOOT_HEADER_SIZE.
+ * Образ слота с заголовком готовит tools/boot_image.c, обновление записывается в слот,
+ * из которого программа не загружалась.
+ *
+ * Ожидаемое поведение: переход к исправному образу с наибольшей версией; если исправных
+ * образов нет, загрузчик остается в бесконечном цикле.
+ */
+
+#include "mik32_hal_pcc.h"
+#include "mik32_hal_spifi_w25.h"
+#include "mik32_hal_boot.h"
+
+void systemClockConfig( void );
+static HAL_StatusTypeDef initSpifi( void );
+
+
+/**
+ * Настраивает подсистему тактирования и монитор частоты МК.
+ */
+void systemClockConfig( void )
+{
+    PCC_InitTypeDef PCC_OscInit = { 0 };
+
+    PCC_OscInit.OscillatorEnable         = PCC_OSCILLATORTYPE_ALL;
+    PCC_OscInit.FreqMon.OscillatorSystem = PCC_OSCILLATORTYPE_OSC32M;
+    PCC_OscInit.FreqMon.ForceOscSys      = PCC_FORCE_OSC_SYS_UNFIXED;
+    PCC_OscInit.FreqMon.Force32KClk      = PCC_FREQ_MONITOR_SOURCE_OSC32K;
+    PCC_OscInit.AHBDivider               = 0;
+    PCC_OscInit.APBMDivider              = 0;
+    PCC_OscInit.APBPDivider              = 0;
+    PCC_OscInit.HSI32MCalibrationValue   = 128;
+    PCC_OscInit.LSI32KCalibrationValue   = 8;
+    PCC_OscInit.RTCClockSelection        = PCC_RTC_CLOCK_SOURCE_AUTO;
+    PCC_OscInit.RTCClockCPUSelection     = PCC_CPU_RTC_CLOCK_SOURCE_OSC32K;
+
+    HAL_PCC_Config( &PCC_OscInit );
+}
+
+
+/**
+ * Включает режим памяти SPIFI (чтение 1-4-4, команда 0xEB) с кэшированием обоих слотов.
+ */
+static HAL_StatusTypeDef initSpifi( void )
+{
+    SPIFI_HandleTypeDef spifi = { .Instance = SPIFI_CONFIG };
+    SPIFI_MemoryModeConfig_HandleTypeDef config = { 0 };
+
+    HAL_SPIFI_MspInit();
+    HAL_SPIFI_Reset( &spifi );
+
+    config.CacheEnable = SPIFI_CACHE_ENABLE;
+    config.CacheLimit = HAL_SPIFI_CacheLimit( MIK32_BOOT_SLOT_B + MIK32_BOOT_SLOT_SIZE - SPIFI_BASE_ADDRESS );
+    config.Prefetch = SPIFI_PREFETCH_ENABLE;
+
+    return HAL_SPIFI_W25_MemoryMode_Init( &spifi, &config, W25_MEMORY_QUAD_IO );
+}
+
+
+/**
+ * @brief   Точка входа в программу.
+ *
+ */
+int main()
+{
+    CRC_HandleTypeDef hcrc = { 0 };
+    DMA_InitTypeDef hdma = { 0 };
+    DMA_ChannelHandleTypeDef hdma_channel = { 0 };
+
+    systemClockConfig();
+
+    if ( initSpifi() != HAL_OK )
+    {
+        while ( 1 );
+    }
+
+    // CRC-32
+    hcrc.Instance = CRC;
+    hcrc.Poly = 0x04C11DB7;
+    hcrc.Init = 0xFFFFFFFF;
+    hcrc.InputReverse = CRC_REFIN_TRUE;
+    hcrc.OutputReverse = CRC_REFOUT_TRUE;
+    hcrc.OutputInversion = CRC_OUTPUTINVERSION_ON;
+    HAL_CRC_Init( &hcrc );
+
+    // Образ передается в блок CRC из области SPIFI через DMA.
+    hdma.Instance = DMA_CONFIG;
+    hdma.CurrentValue = DMA_CURRENT_VALUE_ENABLE;
+    HAL_DMA_Init( &hdma );
+    hdma_channel.dma = &hdma;
+    hdma_channel.ChannelInit.Channel = DMA_CHANNEL_0;
+    hdma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_VERY_HIGH;
+    HAL_CRC_SetDMA( &hcrc, &hdma_channel );
+
+    // Для проверки имитовставки задать Mac - поток Кузнечик CBC (HAL_Crypto_Stream_Init) и MacKey.
+    HAL_Boot_TypeDef boot = {
+        .Slot = { MIK32_BOOT_SLOT_A, MIK32_BOOT_SLOT_B },
+        .SlotSize = MIK32_BOOT_SLOT_SIZE,
+        .hcrc = &hcrc,
+        .Mac = NULL,
+    };
+
+    int slot = HAL_Boot_Select( &boot );
+    if ( slot >= 0 )
+    {
+        // Адрес входа в прерывание - начало образа (ловушка по смещению 0xC0).
+        HAL_Boot_Jump( &boot, slot );
+    }
+
+    // Исправных образов нет
+    while ( 1 );
+}
@@ -56,6 +56,20 @@ function(mik32_print_size_of_target TARGET)
     )
 endfunction()
 
+# This function adds a target with name '${TARGET}_sections' that prints the size
+# and address of every output section of the final ELF (size -A). Sections at
+# 0x02000000 are in RAM (.ramfunc, .data, .bss), at 0x80000000/0x01000000 in
+# SPIFI/EEPROM. The report is also written to ${TARGET}.sections.
+function(mik32_print_sections_of_target TARGET)
+    add_custom_target(${TARGET}_sections
+        ALL COMMAND ${CMAKE_SIZE} -A -x "$<TARGET_FILE:${TARGET}>"
+        COMMAND ${CMAKE_SIZE} -A -x "$<TARGET_FILE:${TARGET}>" > ${TARGET}.sections
+        BYPRODUCTS ${TARGET}.sections
+        COMMENT "Section sizes: "
+        DEPENDS ${TARGET}
+    )
+endfunction()
+
 # This function calls the objcopy program defined in CMAKE_OBJCOPY to generate
 # file with object format specified in OBJCOPY_BFD_OUTPUT.
 # The generated file has the name of the target output but with extension
@@ -0,0 +1,71 @@
+#ifndef MIK32_HAL_SWTIMER
+#define MIK32_HAL_SWTIMER
+
+#include "mik32_hal_scr1_timer.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_timebase.h"
+
+
+/*
+ * Программные таймеры на иерархическом колесе таймеров.
+ *
+ * Колесо тактируется таймером ядра SCR1: в MTIMECMP записывается только ближайший срок
+ * (срабатывание таймера или перенос с верхнего уровня колеса), периодического прерывания нет,
+ * поэтому между событиями ядро может находиться в wfi. Запуск и остановка таймера выполняются
+ * за O(1). Функции обратного вызова выполняются в обработчике прерывания таймера ядра.
+ *
+ * @warning Счетчик таймера ядра не должен сбрасываться после инициализации колеса, поэтому
+ * функции HAL_SCR1_Timer_Start, HAL_SCR1_Timer_Disable и HAL_DelayMs(SCR1_TIMER_HandleTypeDef*, ...)
+ * использовать совместно с программными таймерами нельзя.
+ */
+
+/* Число бит индекса ячейки одного уровня колеса (32 ячейки) */
+#define HAL_SWTIMER_WHEEL_BITS      5
+#define HAL_SWTIMER_WHEEL_SLOTS     (1UL << HAL_SWTIMER_WHEEL_BITS)
+#define HAL_SWTIMER_WHEEL_MASK      (HAL_SWTIMER_WHEEL_SLOTS - 1)
+
+/* Число уровней колеса. Диапазон без переноса - 2^(5 * 4) тиков колеса */
+#ifndef HAL_SWTIMER_WHEEL_LEVELS
+    #define HAL_SWTIMER_WHEEL_LEVELS    4
+#endif
+
+
+typedef struct __HAL_SWTimer_TypeDef HAL_SWTimer_TypeDef;
+
+typedef void (*HAL_SWTimer_CallbackTypeDef)(HAL_SWTimer_TypeDef *timer);
+
+/**
+ * @brief Программный таймер.
+ * Структура принадлежит вызывающей стороне и должна существовать, пока таймер запущен.
+ */
+struct __HAL_SWTimer_TypeDef
+{
+    HAL_SWTimer_CallbackTypeDef Callback;   /**< Функция, вызываемая при срабатывании (в прерывании). */
+    void *Context;                          /**< Произвольные данные пользователя. */
+
+    /* Служебные поля */
+    HAL_SWTimer_TypeDef *Next;
+    HAL_SWTimer_TypeDef **PPrev;            /**< Указатель на поле, ссылающееся на таймер; NULL - таймер не запущен. */
+    uint64_t Expires;                       /**< Срок срабатывания в тиках таймера ядра. */
+    uint32_t Period;                        /**< Период в тиках таймера ядра, 0 - однократный таймер. */
+    uint8_t Level;
+    uint8_t Slot;
+};
+
+
+void HAL_SWTimer_Init(SCR1_TIMER_HandleTypeDef *hscr1_timer, uint8_t TickShift);
+void HAL_SWTimer_Start(HAL_SWTimer_TypeDef *timer, uint32_t TimeoutUs, uint32_t PeriodUs);
+void HAL_SWTimer_Stop(HAL_SWTimer_TypeDef *timer);
+void HAL_SWTimer_IRQHandler();
+uint64_t HAL_SWTimer_GetTicks();
+uint64_t HAL_SWTimer_UsToTicks(uint32_t us);
+
+/**
+ * @brief Проверить, запущен ли таймер.
+ */
+static inline __attribute__((always_inline)) int HAL_SWTimer_IsActive(HAL_SWTimer_TypeDef *timer)
+{
+    return timer->PPrev != 0;
+}
+
+#endif // MIK32_HAL_SWTIMER
@@ -0,0 +1,371 @@
+#include "mik32_hal_swtimer.h"
+#include "mik32_hal.h"
+
+
+/* Состояние колеса таймеров */
+static struct
+{
+    SCR1_TIMER_TypeDef *Instance;
+    /* Тик колеса = 2^Shift тиков таймера ядра */
+    uint8_t Shift;
+    /* Пересчет микросекунд в тики таймера ядра */
+    HAL_TimeBase_ScaleTypeDef UsToTicks;
+    /* Следующий необработанный тик колеса */
+    uint64_t Time;
+    /* Занятые ячейки каждого уровня */
+    uint32_t Bitmap[HAL_SWTIMER_WHEEL_LEVELS];
+    HAL_SWTimer_TypeDef *Slots[HAL_SWTIMER_WHEEL_LEVELS][HAL_SWTIMER_WHEEL_SLOTS];
+    /* Таймеры обрабатываемой ячейки уровня 0, еще не вызванные */
+    HAL_SWTimer_TypeDef *Pending;
+} HAL_SWTimer_Wheel;
+
+
+/**
+ * @brief Текущее значение 64-р счетчика таймера ядра.
+ */
+MIK32_RAMFUNC uint64_t HAL_SWTimer_GetTicks()
+{
+    uint32_t hi, lo;
+
+    do
+    {
+        hi = HAL_SWTimer_Wheel.Instance->MTIMEH;
+        lo = HAL_SWTimer_Wheel.Instance->MTIME;
+    } while (hi != HAL_SWTimer_Wheel.Instance->MTIMEH);
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/**
+ * @brief Расстояние от ячейки from до ближайшей занятой ячейки (с учетом перехода через 0).
+ * @return Расстояние в ячейках или -1, если уровень пуст.
+ */
+static inline int HAL_SWTimer_NextSlot(uint32_t bitmap, uint32_t from)
+{
+    if (bitmap == 0)
+    {
+        return -1;
+    }
+
+    uint32_t rotated = (bitmap >> from) | (from ? (bitmap << (HAL_SWTIMER_WHEEL_SLOTS - from)) : 0);
+    return HAL_IRQ_Ctz(rotated);
+}
+
+/**
+ * @brief Ближайший тик колеса, на котором есть работа: срабатывание таймера на уровне 0
+ * или перенос занятой ячейки верхнего уровня.
+ * @return Тик колеса или UINT64_MAX, если таймеров нет.
+ */
+MIK32_RAMFUNC static uint64_t HAL_SWTimer_NextEvent()
+{
+    uint64_t time = HAL_SWTimer_Wheel.Time;
+    uint64_t next = UINT64_MAX;
+
+    int d = HAL_SWTimer_NextSlot(HAL_SWTimer_Wheel.Bitmap[0], time & HAL_SWTIMER_WHEEL_MASK);
+    if (d >= 0)
+    {
+        next = time + d;
+    }
+
+    for (uint32_t level = 1; level < HAL_SWTIMER_WHEEL_LEVELS; level++)
+    {
+        if (HAL_SWTimer_Wheel.Bitmap[level] == 0)
+        {
+            continue;
+        }
+
+        uint32_t shift = HAL_SWTIMER_WHEEL_BITS * level;
+        /* Перенос ячейки уровня выполняется на границе, где младшие разряды равны нулю */
+        uint64_t boundary = (time + (1ULL << shift) - 1) & ~((1ULL << shift) - 1);
+        d = HAL_SWTimer_NextSlot(HAL_SWTimer_Wheel.Bitmap[level], (boundary >> shift) & HAL_SWTIMER_WHEEL_MASK);
+        uint64_t candidate = boundary + ((uint64_t)d << shift);
+        if (candidate < next)
+        {
+            next = candidate;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief Поместить таймер в ячейку колеса по его сроку.
+ */
+MIK32_RAMFUNC static void HAL_SWTimer_Link(HAL_SWTimer_TypeDef *timer)
+{
+    uint8_t shift = HAL_SWTimer_Wheel.Shift;
+    uint64_t time = HAL_SWTimer_Wheel.Time;
+    /* Срок округляется вверх до тика колеса, чтобы таймер не сработал раньше */
+    uint64_t expires = (timer->Expires + (1ULL << shift) - 1) >> shift;
+    uint64_t delta = (expires > time) ? (expires - time) : 0;
+
+    uint32_t level = 0;
+    while ((level < HAL_SWTIMER_WHEEL_LEVELS - 1) && (delta >> (HAL_SWTIMER_WHEEL_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    /* Срок за пределами колеса: таймер будет перенесен повторно */
+    uint64_t range = 1ULL << (HAL_SWTIMER_WHEEL_BITS * HAL_SWTIMER_WHEEL_LEVELS);
+    if (delta >= range)
+    {
+        delta = range - 1;
+    }
+
+    uint32_t slot = ((time + delta) >> (HAL_SWTIMER_WHEEL_BITS * level)) & HAL_SWTIMER_WHEEL_MASK;
+    HAL_SWTimer_TypeDef **head = &HAL_SWTimer_Wheel.Slots[level][slot];
+
+    timer->Level = level;
+    timer->Slot = slot;
+    timer->Next = *head;
+    if (*head)
+    {
+        (*head)->PPrev = &timer->Next;
+    }
+    timer->PPrev = head;
+    *head = timer;
+    HAL_SWTimer_Wheel.Bitmap[level] |= 1UL << slot;
+}
+
+/**
+ * @brief Исключить таймер из колеса или из списка Pending. Для таймера из Pending его ячейка
+ * уже забрана, и бит ячейки сбрасывается, только если ячейка пуста.
+ */
+static void HAL_SWTimer_Unlink(HAL_SWTimer_TypeDef *timer)
+{
+    *timer->PPrev = timer->Next;
+    if (timer->Next)
+    {
+        timer->Next->PPrev = timer->PPrev;
+    }
+    if (HAL_SWTimer_Wheel.Slots[timer->Level][timer->Slot] == 0)
+    {
+        HAL_SWTimer_Wheel.Bitmap[timer->Level] &= ~(1UL << timer->Slot);
+    }
+    timer->PPrev = 0;
+    timer->Next = 0;
+}
+
+/**
+ * @brief Забрать весь список таймеров ячейки.
+ */
+MIK32_RAMFUNC static HAL_SWTimer_TypeDef *HAL_SWTimer_TakeSlot(uint32_t level, uint32_t slot)
+{
+    HAL_SWTimer_TypeDef *list = HAL_SWTimer_Wheel.Slots[level][slot];
+
+    HAL_SWTimer_Wheel.Slots[level][slot] = 0;
+    HAL_SWTimer_Wheel.Bitmap[level] &= ~(1UL << slot);
+
+    return list;
+}
+
+/**
+ * @brief Перенос таймеров с верхних уровней на границе уровня 0.
+ */
+MIK32_RAMFUNC static void HAL_SWTimer_Cascade()
+{
+    for (uint32_t level = 1; level < HAL_SWTIMER_WHEEL_LEVELS; level++)
+    {
+        uint32_t slot = (HAL_SWTimer_Wheel.Time >> (HAL_SWTIMER_WHEEL_BITS * level)) & HAL_SWTIMER_WHEEL_MASK;
+        HAL_SWTimer_TypeDef *timer = HAL_SWTimer_TakeSlot(level, slot);
+
+        while (timer)
+        {
+            HAL_SWTimer_TypeDef *next = timer->Next;
+            HAL_SWTimer_Link(timer);
+            timer = next;
+        }
+
+        if (slot != 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Записать в MTIMECMP ближайший срок колеса.
+ */
+MIK32_RAMFUNC static void HAL_SWTimer_Program()
+{
+    uint64_t next = HAL_SWTimer_NextEvent();
+    uint64_t compare = (next == UINT64_MAX) ? UINT64_MAX : (next << HAL_SWTimer_Wheel.Shift);
+
+    /* Запись по частям без ложного срабатывания: сначала младшее слово в максимум */
+    HAL_SWTimer_Wheel.Instance->MTIMECMP = 0xFFFFFFFF;
+    HAL_SWTimer_Wheel.Instance->MTIMECMPH = (uint32_t)(compare >> 32);
+    HAL_SWTimer_Wheel.Instance->MTIMECMP = (uint32_t)compare;
+}
+
+/**
+ * @brief Обработать все тики колеса вплоть до текущего времени.
+ * Пустые участки пропускаются сразу до ближайшего события.
+ */
+MIK32_RAMFUNC static void HAL_SWTimer_Advance()
+{
+    uint64_t now = HAL_SWTimer_GetTicks() >> HAL_SWTimer_Wheel.Shift;
+
+    while (1)
+    {
+        uint64_t next = HAL_SWTimer_NextEvent();
+        if (next > now)
+        {
+            if (HAL_SWTimer_Wheel.Time <= now)
+            {
+                HAL_SWTimer_Wheel.Time = now + 1;
+            }
+            break;
+        }
+
+        HAL_SWTimer_Wheel.Time = next;
+        if ((next & HAL_SWTIMER_WHEEL_MASK) == 0)
+        {
+            HAL_SWTimer_Cascade();
+        }
+
+        /*
+         * Список ячейки переносится в Pending, и таймеры снимаются с его начала по одному:
+         * функция обратного вызова может остановить или перезапустить таймер той же ячейки,
+         * и HAL_SWTimer_Unlink исключит его из Pending до срабатывания.
+         */
+        HAL_SWTimer_Wheel.Pending = HAL_SWTimer_TakeSlot(0, next & HAL_SWTIMER_WHEEL_MASK);
+        if (HAL_SWTimer_Wheel.Pending)
+        {
+            HAL_SWTimer_Wheel.Pending->PPrev = &HAL_SWTimer_Wheel.Pending;
+        }
+        HAL_SWTimer_Wheel.Time = next + 1;
+
+        HAL_SWTimer_TypeDef *timer;
+        while ((timer = HAL_SWTimer_Wheel.Pending) != 0)
+        {
+            HAL_SWTimer_Wheel.Pending = timer->Next;
+            if (timer->Next)
+            {
+                timer->Next->PPrev = &HAL_SWTimer_Wheel.Pending;
+            }
+
+            timer->PPrev = 0;
+            timer->Next = 0;
+            if (timer->Period)
+            {
+                timer->Expires += timer->Period;
+                HAL_SWTimer_Link(timer);
+            }
+            if (timer->Callback)
+            {
+                timer->Callback(timer);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Инициализация колеса программных таймеров.
+ * Таймер ядра включается без сброса счетчика, разрешается прерывание таймера ядра (MTIE).
+ * Глобальные прерывания (mstatus.MIE) разрешает приложение.
+ *
+ * @param hscr1_timer Указатель на структуру с настройками таймера ядра.
+ * @param TickShift Разрешение колеса: тик колеса равен 2^TickShift тиков таймера ядра
+ * (например, 15 - около 1 мс при 32 МГц).
+ */
+void HAL_SWTimer_Init(SCR1_TIMER_HandleTypeDef *hscr1_timer, uint8_t TickShift)
+{
+    uint32_t freq;
+
+    HAL_SWTimer_Wheel.Instance = hscr1_timer->Instance;
+    HAL_SWTimer_Wheel.Shift = TickShift;
+
+    if (hscr1_timer->ClockSource == SCR1_TIMER_CLKSRC_EXTERNAL_RTC)
+        freq = OSC_CLOCK_VALUE / (hscr1_timer->Divider + 1);
+    else
+        freq = HAL_PCC_GetSysClockFreq() / (PM->DIV_AHB + 1) / (hscr1_timer->Divider + 1);
+    HAL_TimeBase_ScaleInit(&HAL_SWTimer_Wheel.UsToTicks, freq, 1000000UL);
+
+    HAL_SWTimer_Wheel.Pending = 0;
+    for (uint32_t level = 0; level < HAL_SWTIMER_WHEEL_LEVELS; level++)
+    {
+        HAL_SWTimer_Wheel.Bitmap[level] = 0;
+        for (uint32_t slot = 0; slot < HAL_SWTIMER_WHEEL_SLOTS; slot++)
+        {
+            HAL_SWTimer_Wheel.Slots[level][slot] = 0;
+        }
+    }
+
+    HAL_SWTimer_Wheel.Instance->MTIMECMP = 0xFFFFFFFF;
+    HAL_SWTimer_Wheel.Instance->MTIMECMPH = 0xFFFFFFFF;
+    /* Уже запущенный таймер не перенастраивается, чтобы не прерывать счет */
+    if (!(HAL_SWTimer_Wheel.Instance->TIMER_CTRL & SCR1_TIMER_CTRL_ENABLE_M))
+    {
+        HAL_SCR1_Timer_Init(hscr1_timer);
+        HAL_SCR1_Timer_Enable(hscr1_timer);
+    }
+
+    HAL_SWTimer_Wheel.Time = HAL_SWTimer_GetTicks() >> TickShift;
+
+    set_csr(mie, MIE_MTIE);
+}
+
+/**
+ * @brief Перевести микросекунды в тики таймера ядра (единицы HAL_SWTimer_GetTicks).
+ */
+uint64_t HAL_SWTimer_UsToTicks(uint32_t us)
+{
+    return HAL_TimeBase_Scale32(&HAL_SWTimer_Wheel.UsToTicks, us);
+}
+
+/**
+ * @brief Запустить (или перезапустить) программный таймер.
+ *
+ * @param timer Указатель на таймер. Поля Callback и Context заполняются заранее.
+ * @param TimeoutUs Время до первого срабатывания, мкс.
+ * @param PeriodUs Период повторения, мкс. 0 - однократный таймер. Таймер срабатывает не чаще
+ * одного раза за тик колеса, поэтому более короткий период не выдерживается.
+ */
+void HAL_SWTimer_Start(HAL_SWTimer_TypeDef *timer, uint32_t TimeoutUs, uint32_t PeriodUs)
+{
+    uint64_t timeout = HAL_TimeBase_Scale32(&HAL_SWTimer_Wheel.UsToTicks, TimeoutUs);
+    uint32_t period = (uint32_t)HAL_TimeBase_Scale32(&HAL_SWTimer_Wheel.UsToTicks, PeriodUs);
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if (timer->PPrev)
+    {
+        HAL_SWTimer_Unlink(timer);
+    }
+
+    timer->Expires = HAL_SWTimer_GetTicks() + timeout;
+    timer->Period = period;
+    HAL_SWTimer_Link(timer);
+    HAL_SWTimer_Program();
+
+    HAL_IRQ_Restore(irq_state);
+}
+
+/**
+ * @brief Остановить программный таймер. Повторная остановка допускается.
+ */
+void HAL_SWTimer_Stop(HAL_SWTimer_TypeDef *timer)
+{
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if (timer->PPrev)
+    {
+        HAL_SWTimer_Unlink(timer);
+    }
+
+    HAL_IRQ_Restore(irq_state);
+}
+
+/**
+ * @brief Обработчик прерывания таймера ядра.
+ * Вызывается из trap_handler, если mcause равен MCAUSE_MACHINE_TIMER_INTERRUPT.
+ */
+MIK32_RAMFUNC void HAL_SWTimer_IRQHandler()
+{
+    /* Снять запрос прерывания до обработки */
+    HAL_SWTimer_Wheel.Instance->MTIMECMP = 0xFFFFFFFF;
+    HAL_SWTimer_Wheel.Instance->MTIMECMPH = 0xFFFFFFFF;
+
+    HAL_SWTimer_Advance();
+    HAL_SWTimer_Program();
+}
@@ -7,6 +7,8 @@
 #include "mik32_hal_pcc.h"
 #include "mik32_hal_gpio.h"
 #include "mik32_memory_map.h"
+#include "mik32_hal_dma.h"
+#include "mik32_hal_timer32.h"
 
 
 /* Title: Макросы */
@@ -163,6 +165,98 @@ typedef struct
     
 } ADC_HandleTypeDef;
 
+typedef struct __ADC_DMA_HandleTypeDef ADC_DMA_HandleTypeDef;
+
+/*
+ * Функция, вызываемая из прерывания DMA после заполнения половины буфера.
+ * Samples - начало заполненной половины, Count - число отсчетов в ней.
+ */
+typedef void (*ADC_DMA_CallbackTypeDef)(ADC_DMA_HandleTypeDef *hadc_dma, uint16_t *Samples, uint32_t Count);
+
+/*
+ * Struct: ADC_DMA_HandleTypeDef
+ * Непрерывное измерение АЦП в кольцевой буфер через DMA
+ *
+ * АЦП работает в режиме непрерывного измерения, канал DMA по запросу 32-р таймера
+ * (переполнение) переписывает регистр ADC_VALUE в буфер. Буфер делится на две половины:
+ * пока DMA заполняет одну, вторая обрабатывается программой. Участие процессора требуется
+ * только один раз на половину буфера.
+ *
+ */
+struct __ADC_DMA_HandleTypeDef
+{
+    /*
+    * Variable: hadc
+    * Настройки АЦП.
+    *
+    */
+    ADC_HandleTypeDef *hadc;
+
+    /*
+    * Variable: htimer32
+    * Таймер, задающий частоту отсчетов (частота переполнения). Инициализируется пользователем.
+    *
+    */
+    TIMER32_HandleTypeDef *htimer32;
+
+    /*
+    * Variable: hdma_channel
+    * Канал DMA. Поле ChannelInit заполняется функцией <HAL_ADC_DMA_Start>, кроме Channel и Priority.
+    *
+    */
+    DMA_ChannelHandleTypeDef *hdma_channel;
+
+    /*
+    * Variable: HalfCpltCallback
+    * Заполнена первая половина буфера. Может быть NULL.
+    *
+    */
+    ADC_DMA_CallbackTypeDef HalfCpltCallback;
+
+    /*
+    * Variable: CpltCallback
+    * Заполнена вторая половина буфера. Может быть NULL.
+    *
+    */
+    ADC_DMA_CallbackTypeDef CpltCallback;
+
+    /*
+    * Variable: Ready
+    * Заполненные и еще не освобожденные (<HAL_ADC_DMA_Release>) половины буфера: бит 0 - первая, бит 1 - вторая.
+    *
+    */
+    volatile uint32_t Ready;
+
+    /*
+    * Variable: Overruns
+    * Число потерь данных: половина буфера перезаписана до освобождения или между половинами
+    * пропущены отсчеты (<Dropped>).
+    *
+    */
+    volatile uint32_t Overruns;
+
+    /*
+    * Variable: Dropped
+    * Число отсчетов, пропущенных между концом половины и запуском следующей (переполнения таймера,
+    * пока канал DMA не был перезапущен из прерывания). Считается, если таймер тактируется от
+    * делителя шины (TIMER32_SOURCE_PRESCALER) и DMA возвращает текущие значения регистров
+    * (DMA_CURRENT_VALUE_ENABLE), иначе всегда 0.
+    *
+    */
+    volatile uint32_t Dropped;
+
+    /* Служебные поля */
+    uint16_t *Buffer;
+    uint32_t Length;
+    uint32_t TickCycles;        /* Тактов ядра на тик таймера, 0 - пропуски не считаются */
+    uint32_t SampleCycles;      /* Тактов ядра на отсчет */
+    uint32_t LastCycles;        /* mcycle последнего учтенного переполнения таймера */
+    uint32_t Periods;           /* Переполнений таймера с запуска */
+    uint32_t Delivered;         /* Отсчетов в заполненных половинах */
+    HAL_DMA_ChainTypeDef Chain;
+    HAL_DMA_DescriptorTypeDef Half[2];
+};
+
 
 /* Сменить канал АЦП */
 #define ADC_SEL_CHANNEL(adc_instance, channel_selection) ((adc_instance)->ADC_CONFIG = (((adc_instance)->ADC_CONFIG & (~ADC_CONFIG_SAH_TIME_M)) & (~ADC_CONFIG_SEL_M)) | (((adc_instance)->ADC_CONFIG >> 1) & ADC_CONFIG_SAH_TIME_M) | ((channel_selection) << ADC_CONFIG_SEL_S))
@@ -346,4 +440,47 @@ uint16_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc);
  */
 uint16_t HAL_ADC_WaitAndGetValue(ADC_HandleTypeDef *hadc);
 
+/*
+ * Function: HAL_ADC_DMA_Start
+ * Запустить непрерывное измерение АЦП в кольцевой буфер через DMA.
+ *
+ * Из обработчика прерывания DMA необходимо вызывать <HAL_DMA_IRQHandler>, линию DMA в EPIC разрешает пользователь.
+ *
+ * Parameters:
+ * hadc_dma - Указатель на структуру непрерывного измерения.
+ * Buffer - Буфер отсчетов.
+ * Length - Число отсчетов в буфере, четное.
+ *
+ * Returns:
+ * (HAL_StatusTypeDef ) - HAL_ERROR при неверной длине буфера, HAL_BUSY если канал DMA занят.
+ */
+HAL_StatusTypeDef HAL_ADC_DMA_Start(ADC_DMA_HandleTypeDef *hadc_dma, uint16_t *Buffer, uint32_t Length);
+
+/*
+ * Function: HAL_ADC_DMA_Stop
+ * Остановить непрерывное измерение АЦП через DMA.
+ *
+ * Parameters:
+ * hadc_dma - Указатель на структуру непрерывного измерения.
+ *
+ * Returns:
+ * void
+ */
+void HAL_ADC_DMA_Stop(ADC_DMA_HandleTypeDef *hadc_dma);
+
+/*
+ * Function: HAL_ADC_DMA_Release
+ * Освободить обработанную половину буфера.
+ *
+ * Если половина не освобождена к моменту ее повторного заполнения, увеличивается счетчик Overruns.
+ *
+ * Parameters:
+ * hadc_dma - Указатель на структуру непрерывного измерения.
+ * Samples - Указатель, переданный в функцию HalfCpltCallback или CpltCallback.
+ *
+ * Returns:
+ * void
+ */
+void HAL_ADC_DMA_Release(ADC_DMA_HandleTypeDef *hadc_dma, uint16_t *Samples);
+
 #endif
@@ -0,0 +1,148 @@
+#ifndef MIK32_HAL_CLOCK
+#define MIK32_HAL_CLOCK
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_pcc.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_timebase.h"
+#include "mik32_memory_map.h"
+#include "power_manager.h"
+
+
+/*
+ * Единые 64-р монотонные часы.
+ *
+ * Источник тиков выбирается при сборке макросом HAL_CLOCK_SOURCE, поэтому функции чтения
+ * времени встраиваются в место вызова без косвенных переходов:
+ * - HAL_CLOCK_SOURCE_SCR1_TIMER - 64-р таймер ядра, прерывания не требуются (по умолчанию);
+ * - HAL_CLOCK_SOURCE_TIMER32    - 32-р таймер, расширение до 64 бит по прерыванию переполнения;
+ * - HAL_CLOCK_SOURCE_TIMER16    - 16-р таймер, расширение до 64 бит по прерыванию ARRM.
+ *
+ * Для 16-р и 32-р таймеров прерывание переполнения обновляет старшую часть счетчика под
+ * счетчиком последовательности (Seq). Чтение не запрещает прерывания: если обработчик сработал
+ * во время чтения, чтение повторяется. Переполнение, которое еще не обработано, учитывается
+ * по флагу таймера. Флаг ARRM 16-р таймера устанавливается при счетчике, равном ARR, то есть
+ * до перехода через 0 (при делителе больше 1 - на несколько тактов раньше), поэтому период
+ * прибавляется только после перехода: и при чтении, и в обработчике.
+ * Из обработчика прерываний (trap_handler) необходимо вызывать HAL_Clock_IRQHandler.
+ */
+
+#define HAL_CLOCK_SOURCE_TIMER16        1
+#define HAL_CLOCK_SOURCE_TIMER32        2
+#define HAL_CLOCK_SOURCE_SCR1_TIMER     3
+
+#ifndef HAL_CLOCK_SOURCE
+    #define HAL_CLOCK_SOURCE HAL_CLOCK_SOURCE_SCR1_TIMER
+#endif
+
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER16
+    #include "timer16.h"
+    #ifndef HAL_CLOCK_INSTANCE
+        #define HAL_CLOCK_INSTANCE TIMER16_0
+    #endif
+    #define HAL_CLOCK_PERIOD                0x10000ULL
+    #define HAL_CLOCK_TOP                   0xFFFFUL
+    #define HAL_CLOCK_COUNTER()             (HAL_CLOCK_INSTANCE->CNT)
+    #define HAL_CLOCK_OVERFLOW_PENDING()    (HAL_CLOCK_INSTANCE->ISR & TIMER16_ISR_ARR_MATCH_M)
+#elif HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER32
+    #include "timer32.h"
+    #ifndef HAL_CLOCK_INSTANCE
+        #define HAL_CLOCK_INSTANCE TIMER32_0
+    #endif
+    #define HAL_CLOCK_PERIOD                0x100000000ULL
+    #define HAL_CLOCK_TOP                   0xFFFFFFFFUL
+    #define HAL_CLOCK_COUNTER()             (HAL_CLOCK_INSTANCE->VALUE)
+    #define HAL_CLOCK_OVERFLOW_PENDING()    (HAL_CLOCK_INSTANCE->INT_FLAGS & TIMER32_INT_OVERFLOW_M)
+#elif HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_SCR1_TIMER
+    #include "scr1_timer.h"
+    #ifndef HAL_CLOCK_INSTANCE
+        #define HAL_CLOCK_INSTANCE SCR1_TIMER
+    #endif
+#else
+    #error "Unknown HAL_CLOCK_SOURCE"
+#endif
+
+
+typedef struct
+{
+    volatile uint32_t Seq;              /* Счетчик последовательности, нечетное значение - идет обновление High */
+    volatile uint64_t High;             /* Тики, накопленные обработчиком переполнения */
+
+    uint32_t Freq;                      /* Частота счета тиков, Гц */
+    HAL_TimeBase_ScaleTypeDef Us;       /* Пересчет тиков в микросекунды */
+    HAL_TimeBase_ScaleTypeDef Ns;       /* Пересчет тиков в наносекунды */
+
+    /* Точка отсчета после последней смены частоты тактирования */
+    uint64_t EpochTicks;
+    uint64_t EpochUs;
+    uint64_t EpochNs;
+} HAL_Clock_HandleTypeDef;
+
+extern HAL_Clock_HandleTypeDef HAL_Clock_Handler;
+
+
+void HAL_Clock_Init();
+void HAL_Clock_ClockUpdate();
+void HAL_Clock_IRQHandler();
+
+
+/**
+ * @brief Текущее значение 64-р монотонного счетчика тиков.
+ * Функция не запрещает прерывания и может вызываться как из основной программы, так и из обработчиков.
+ */
+static inline __attribute__((always_inline)) uint64_t HAL_Clock_NowTicks()
+{
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_SCR1_TIMER
+    uint32_t hi, lo;
+
+    do
+    {
+        hi = HAL_CLOCK_INSTANCE->MTIMEH;
+        lo = HAL_CLOCK_INSTANCE->MTIME;
+    } while (hi != HAL_CLOCK_INSTANCE->MTIMEH);
+
+    return ((uint64_t)hi << 32) | lo;
+#else
+    uint32_t seq;
+    uint64_t high;
+    uint32_t pending;
+    uint32_t lo;
+
+    do
+    {
+        seq = HAL_Clock_Handler.Seq;
+        high = HAL_Clock_Handler.High;
+        pending = HAL_CLOCK_OVERFLOW_PENDING();
+        lo = HAL_CLOCK_COUNTER();
+        /*
+         * Переполнение отмечено, но еще не обработано. Флаг прочитан до счетчика, поэтому
+         * счетчик равен вершине или уже перешел через 0; флаг, установленный после первого
+         * чтения, вызывает повтор.
+         */
+        if (pending && (lo != HAL_CLOCK_TOP))
+        {
+            high += HAL_CLOCK_PERIOD;
+        }
+    } while ((seq & 1) || (seq != HAL_Clock_Handler.Seq) || (pending != HAL_CLOCK_OVERFLOW_PENDING()));
+
+    return high + lo;
+#endif
+}
+
+/**
+ * @brief Текущее время в микросекундах.
+ */
+static inline __attribute__((always_inline)) uint64_t HAL_Clock_NowUs()
+{
+    return HAL_Clock_Handler.EpochUs + HAL_TimeBase_Scale64(&HAL_Clock_Handler.Us, HAL_Clock_NowTicks() - HAL_Clock_Handler.EpochTicks);
+}
+
+/**
+ * @brief Текущее время в наносекундах.
+ */
+static inline __attribute__((always_inline)) uint64_t HAL_Clock_NowNs()
+{
+    return HAL_Clock_Handler.EpochNs + HAL_TimeBase_Scale64(&HAL_Clock_Handler.Ns, HAL_Clock_NowTicks() - HAL_Clock_Handler.EpochTicks);
+}
+
+#endif // MIK32_HAL_CLOCK
@@ -2,6 +2,7 @@
 #define MIK32_HAL_CRC32
 
 #include "mik32_hal_pcc.h"
+#include "mik32_hal_dma.h"
 #include "crc.h"
 #include "mik32_memory_map.h"
 
@@ -77,10 +78,23 @@
  * CRC_MAX_WORDS - Максимальное количество слов в буфере.
  * CRC_MAX_BYTES - Максимальное количество байтов в буфере.
  *
+ * Длина данных больше не ограничивается, макросы оставлены для совместимости.
+ *
  */
 #define CRC_MAX_WORDS   16
 #define CRC_MAX_BYTES   64
 
+/*
+ * Define: CRC_DMA_THRESHOLD
+ * 
+ * Минимальная длина выровненной части данных (байт), начиная с которой <HAL_CRC_Update> передает
+ * слова в блок CRC через DMA. Более короткие участки записываются процессором.
+ *
+ */
+#ifndef CRC_DMA_THRESHOLD
+#define CRC_DMA_THRESHOLD   256
+#endif
+
 /* Title: Структуры */
 
 /*
@@ -151,6 +165,19 @@ typedef struct
  */
     uint8_t OutputInversion;
 
+/*
+ * Variable: hdma_channel
+ * Канал DMA для записи данных в <HAL_CRC_Update>.
+ * 
+ * Пользователь задает поля dma, ChannelInit.Channel и ChannelInit.Priority, остальные настройки канала
+ * задаются при каждой пересылке. Значение NULL - данные записываются только процессором.
+ *
+ * <HAL_CRC_Init> сбрасывает поле в NULL, поэтому неинициализированная структура на стеке не включает DMA.
+ * Канал подключается после <HAL_CRC_Init> функцией <HAL_CRC_SetDMA>.
+ *
+ */
+    DMA_ChannelHandleTypeDef *hdma_channel;
+
 } CRC_HandleTypeDef;
 
 /* Title: Функции */
@@ -205,6 +232,20 @@ void HAL_CRC_SetOutputReverse(CRC_HandleTypeDef *hcrc);
  */
 void HAL_CRC_SetInit(CRC_HandleTypeDef *hcrc);
 
+/*
+ * Function: HAL_CRC_SetDMA
+ * Задать канал DMA для записи данных в <HAL_CRC_Update> (<CRC_HandleTypeDef.hdma_channel>).
+ * Вызывается после <HAL_CRC_Init>.
+ *
+ * Parameters:
+ * hcrc - Указатель на структуру с настройками CRC.
+ * hdma_channel - Указатель на настроенный канал DMA или NULL, чтобы отключить DMA.
+ *
+ * Returns:
+ * void
+ */
+void HAL_CRC_SetDMA(CRC_HandleTypeDef *hcrc, DMA_ChannelHandleTypeDef *hdma_channel);
+
 /*
  * Function: HAL_CRC_Init
  * Инициализировать CRC в соответствии с настройками <CRC_HandleTypeDef> *hcrc.
@@ -230,8 +271,8 @@ void HAL_CRC_Init(CRC_HandleTypeDef *hcrc);
 void HAL_CRC_WaitBusy(CRC_HandleTypeDef *hcrc);
 
 /*
- * Function: HAL_CRC_WaitBusy
- * Записать данные по байтам в буфер CRC.
+ * Function: HAL_CRC_WriteData
+ * Записать данные по байтам в буфер CRC, начиная вычисление заново (<HAL_CRC_Begin> и <HAL_CRC_Update>).
  *
  * Parameters:
  * hcrc - Указатель на структуру с настройками CRC.
@@ -245,18 +286,62 @@ void HAL_CRC_WriteData(CRC_HandleTypeDef *hcrc, uint8_t message[], uint32_t mess
 
 /*
  * Function: HAL_RTC_WriteData32
- * Записать данные по словам в буфер CRC.
+ * Записать данные по словам в буфер CRC, начиная вычисление заново.
  *
  * Parameters:
  * hcrc - Указатель на структуру с настройками CRC.
  * message -  Массив с данными.
- * message_length - Количество передаваемых байтов.
+ * message_length - Количество передаваемых слов.
  *
  * Returns:
  * void
  */
 void HAL_CRC_WriteData32(CRC_HandleTypeDef *hcrc, uint32_t message[], uint32_t message_length);
 
+/*
+ * Function: HAL_CRC_Begin
+ * Начать вычисление CRC: записать начальное значение <CRC_HandleTypeDef.Init>.
+ *
+ * Parameters:
+ * hcrc - Указатель на структуру с настройками CRC.
+ *
+ * Returns:
+ * void
+ */
+void HAL_CRC_Begin(CRC_HandleTypeDef *hcrc);
+
+/*
+ * Function: HAL_CRC_Update
+ * Продолжить вычисление CRC по очередному участку данных.
+ * 
+ * Вызовы можно повторять для любого числа участков любой длины и выравнивания: результат совпадает
+ * с вычислением по всем данным сразу. Невыровненные начало и конец участка записываются процессором
+ * по байтам, выровненная часть - словами. Если задан <CRC_HandleTypeDef.hdma_channel> и длина
+ * выровненной части не меньше <CRC_DMA_THRESHOLD>, слова передаются через DMA, функция ожидает
+ * завершения пересылки.
+ *
+ * Parameters:
+ * hcrc - Указатель на структуру с настройками CRC.
+ * data - Данные (ОЗУ, EEPROM или SPIFI).
+ * length - Количество байтов.
+ *
+ * Returns:
+ * (HAL_StatusTypeDef) - HAL_ERROR при ошибке DMA на шине, иначе HAL_OK.
+ */
+HAL_StatusTypeDef HAL_CRC_Update(CRC_HandleTypeDef *hcrc, const void *data, uint32_t length);
+
+/*
+ * Function: HAL_CRC_Final
+ * Дождаться завершения вычислений и получить значение CRC всех данных, записанных после <HAL_CRC_Begin>.
+ *
+ * Parameters:
+ * hcrc - Указатель на структуру с настройками CRC.
+ *
+ * Returns:
+ * (uint32_t ) - Значение CRC.
+ */
+uint32_t HAL_CRC_Final(CRC_HandleTypeDef *hcrc);
+
 /*
  * Function: HAL_RTC_ReadCRC
  * Получить значение CRC.
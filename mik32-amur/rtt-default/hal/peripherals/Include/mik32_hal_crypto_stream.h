@@ -0,0 +1,60 @@
+#ifndef MIK32_HAL_CRYPTO_STREAM
+#define MIK32_HAL_CRYPTO_STREAM
+
+#include "mik32_hal_crypto.h"
+#include "mik32_hal_dma.h"
+#include "mik32_hal_def.h"
+
+
+/*
+ * Потоковое шифрование блоком Crypto (Кузнечик, Магма, AES) в режимах ECB, CBC и CTR.
+ *
+ * Сообщение передается любым числом вызовов HAL_Crypto_Stream_Update произвольной длины.
+ * Вектор инициализации загружается один раз в HAL_Crypto_Stream_Start, сцепление блоков (CBC)
+ * и счетчик (CTR) продолжаются аппаратно между вызовами. Неполный блок в конце вызова
+ * сохраняется в потоке: в режимах ECB и CBC он дополняется данными следующего вызова,
+ * в режиме CTR остаток гаммы используется следующим вызовом.
+ *
+ * Целые блоки передаются двумя каналами DMA: загрузка (память -> BLOCK) и выгрузка
+ * (BLOCK -> память) идут одновременно по запросам блока Crypto. Если адреса данных не
+ * выровнены на слово, данные проходят через две половины буфера Buffer в ОЗУ: пока DMA
+ * обрабатывает одну половину, процессор копирует результат предыдущей и данные следующей
+ * во вторую.
+ *
+ * Во время сообщения блок Crypto используется только этим потоком.
+ */
+
+/**
+ * @brief Направление преобразования.
+ */
+typedef enum __HAL_Crypto_StreamDirectionTypeDef
+{
+    CRYPTO_STREAM_ENCODE = 0,   /**< Шифрование. */
+    CRYPTO_STREAM_DECODE = 1    /**< Расшифрование. */
+} HAL_Crypto_StreamDirectionTypeDef;
+
+typedef struct __HAL_Crypto_StreamTypeDef
+{
+    Crypto_HandleTypeDef *hcrypto;      /**< Блок Crypto. Поля Algorithm, CipherMode, SwapMode и OrderMode задает пользователь. */
+    DMA_ChannelHandleTypeDef *hdma_in;  /**< Канал DMA загрузки (поля dma и Channel задает пользователь). NULL - данные передает процессор. */
+    DMA_ChannelHandleTypeDef *hdma_out; /**< Канал DMA выгрузки (поля dma и Channel задает пользователь). */
+    uint32_t *Buffer;                   /**< Промежуточный буфер для невыровненных данных или NULL. */
+    uint32_t BufferSize;                /**< Размер Buffer в байтах. */
+
+    /* Служебные поля */
+    uint32_t BlockSize;                 /**< Длина блока алгоритма, байт. */
+    uint32_t HalfSize;                  /**< Длина половины Buffer, кратная BlockSize. */
+    uint32_t PartLength;                /**< ECB, CBC: число байт в Part; CTR: число использованных байт гаммы в Part. */
+    uint32_t Part[4];                   /**< Неполный блок или гамма последнего блока. */
+} HAL_Crypto_StreamTypeDef;
+
+
+HAL_StatusTypeDef HAL_Crypto_Stream_Init(HAL_Crypto_StreamTypeDef *stream, Crypto_HandleTypeDef *hcrypto,
+                                         DMA_ChannelHandleTypeDef *hdma_in, DMA_ChannelHandleTypeDef *hdma_out,
+                                         uint32_t *Buffer, uint32_t BufferSize);
+void HAL_Crypto_Stream_Start(HAL_Crypto_StreamTypeDef *stream, uint32_t Key[], uint32_t InitVector[],
+                             HAL_Crypto_StreamDirectionTypeDef Direction);
+uint32_t HAL_Crypto_Stream_Update(HAL_Crypto_StreamTypeDef *stream, const void *In, void *Out, uint32_t Length);
+HAL_StatusTypeDef HAL_Crypto_Stream_Finish(HAL_Crypto_StreamTypeDef *stream);
+
+#endif // MIK32_HAL_CRYPTO_STREAM
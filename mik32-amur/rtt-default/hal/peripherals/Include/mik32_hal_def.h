@@ -5,6 +5,12 @@
 #define HAL_PIN_MASK 	0xFFFF
 #define HAL_PORT_S 		16
 
+/* Размещение функции в ОЗУ (секция .ramfunc, копируется crt0 при запуске).
+ * Используется для обработчиков прерываний и частых функций при выполнении из SPIFI/EEPROM. */
+#ifndef MIK32_RAMFUNC
+    #define MIK32_RAMFUNC __attribute__((section(".ramfunc")))
+#endif
+
 typedef enum HAL_StatusTypeDef
 {
 	HAL_OK       = 0x00U,
@@ -7,6 +7,7 @@
 #include "dma_config.h"
 #include "mik32_memory_map.h"
 #include "mik32_hal_def.h"
+#include "mik32_hal_irq.h"
 
 
 
@@ -172,6 +173,54 @@ typedef struct __DMA_ChannelHandleTypeDef
     DMA_ChannelInitHandleTypeDef ChannelInit;	/**< Настройки канала DMA. */
 } DMA_ChannelHandleTypeDef;
 
+/**
+ * @brief Дескриптор одной пересылки в цепочке.
+ * 
+ * Дескрипторы связываются в односвязный список полем Next и могут находиться в разных буферах
+ * (например, заголовок, данные и контрольная сумма кадра), копирование в промежуточный буфер не требуется.
+ * Дескриптор должен существовать до завершения цепочки.
+ */
+typedef struct __HAL_DMA_DescriptorTypeDef
+{
+	void *Source;								/**< Адрес источника. */
+	void *Destination;							/**< Адрес назначения. */
+	uint32_t Length;							/**< Количество байт пересылки (фактическое, а не на 1 меньше, как в HAL_DMA_Start). Дескрипторы с нулевой длиной пропускаются. */
+	struct __HAL_DMA_DescriptorTypeDef *Next;	/**< Следующий дескриптор или NULL. */
+} HAL_DMA_DescriptorTypeDef;
+
+typedef struct __HAL_DMA_ChainTypeDef HAL_DMA_ChainTypeDef;
+
+/**
+ * @brief Функция, вызываемая из прерывания после завершения последнего дескриптора цепочки.
+ */
+typedef void (*HAL_DMA_ChainCallbackTypeDef)(HAL_DMA_ChainTypeDef *chain);
+
+/**
+ * @brief Функция, вызываемая из прерывания после завершения каждого дескриптора.
+ */
+typedef void (*HAL_DMA_DescriptorCallbackTypeDef)(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *desc);
+
+/**
+ * @brief Цепочка пересылок канала DMA.
+ * 
+ * Следующий дескриптор запускается из обработчика прерывания завершения канала (HAL_DMA_IRQHandler),
+ * процессор в промежутках между пересылками не ожидает. Кольцевой список дескрипторов
+ * (двойная буферизация) выполняется до вызова HAL_DMA_ChainAbort.
+ */
+struct __HAL_DMA_ChainTypeDef
+{
+	DMA_ChannelHandleTypeDef *hdma_channel;		/**< Канал DMA. */
+	HAL_DMA_ChainCallbackTypeDef Callback;		/**< Функция завершения цепочки. Может быть NULL. */
+	HAL_DMA_DescriptorCallbackTypeDef DescriptorCallback;	/**< Функция завершения каждого дескриптора (вызывается после запуска следующего). Может быть NULL. */
+	void *Context;								/**< Произвольные данные пользователя. */
+	volatile HAL_StatusTypeDef Status;			/**< HAL_BUSY - цепочка выполняется, HAL_OK - завершена, HAL_ERROR - ошибка на шине. */
+
+	/* Служебные поля */
+	HAL_DMA_DescriptorTypeDef * volatile Current;
+	HAL_DMA_DescriptorTypeDef *Tail;
+	uint32_t Config;							/**< Значение CHx_CFG, вычисленное при запуске цепочки. */
+};
+
 
 void HAL_DMA_MspInit(DMA_InitTypeDef* hdma);
 void HAL_DMA_SetChannel(DMA_ChannelHandleTypeDef *hdma_channel, HAL_DMA_ChannelIndexTypeDef ChannelIndex);
@@ -192,6 +241,20 @@ int HAL_DMA_GetBusError(DMA_ChannelHandleTypeDef* hdma_channel);
 void HAL_DMA_ChannelDisable(DMA_ChannelHandleTypeDef *hdma_channel);
 void HAL_DMA_ChannelEnable(DMA_ChannelHandleTypeDef *hdma_channel);
 void HAL_DMA_Start(DMA_ChannelHandleTypeDef *hdma_channel, void* Source, void* Destination, uint32_t Len);
+void HAL_DMA_ClearChannelIrq(DMA_ChannelHandleTypeDef *hdma_channel);
+void HAL_DMA_ChainInit(HAL_DMA_ChainTypeDef *chain, DMA_ChannelHandleTypeDef *hdma_channel, HAL_DMA_ChainCallbackTypeDef Callback);
+HAL_StatusTypeDef HAL_DMA_ChainStart(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *Head);
+HAL_StatusTypeDef HAL_DMA_ChainAppend(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *Head);
+void HAL_DMA_ChainAbort(HAL_DMA_ChainTypeDef *chain);
+void HAL_DMA_IRQHandler();
+
+/**
+ * @brief Проверить, выполняется ли цепочка.
+ */
+static inline __attribute__((always_inline)) int HAL_DMA_ChainIsBusy(HAL_DMA_ChainTypeDef *chain)
+{
+	return chain->Status == HAL_BUSY;
+}
 
 
 #endif
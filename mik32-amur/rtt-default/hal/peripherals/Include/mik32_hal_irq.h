@@ -5,7 +5,7 @@
 #include "csr.h"
 #include "scr1_csr_encoding.h"
 #include "mik32_memory_map.h"
-#include "epic.h"
+#include "mik32_hal_def.h"
 
 
 /* Title: Макросы */
@@ -172,6 +172,59 @@ void HAL_IRQ_EnableInterrupts();
  * void.
  */
 void HAL_IRQ_DisableInterrupts();
+
+/*
+ * Function: HAL_IRQ_SaveDisable
+ * Запретить глобальные прерывания (бит MIE регистра mstatus) с сохранением прежнего состояния.
+ * 
+ * Используется для коротких критических секций, которые могут выполняться как в основной
+ * программе, так и в обработчике прерываний.
+ *
+ * Returns:
+ * (uint32_t ) - прежнее значение бита MIE, передается в <HAL_IRQ_Restore>.
+ */
+static inline __attribute__((always_inline)) uint32_t HAL_IRQ_SaveDisable()
+{
+    return clear_csr(mstatus, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+/*
+ * Function: HAL_IRQ_Restore
+ * Восстановить состояние глобальных прерываний, сохраненное <HAL_IRQ_SaveDisable>.
+ *
+ * Parameters:
+ * State - Значение, возвращенное <HAL_IRQ_SaveDisable>
+ *
+ * Returns:
+ * void.
+ */
+static inline __attribute__((always_inline)) void HAL_IRQ_Restore(uint32_t State)
+{
+    if (State)
+    {
+        set_csr(mstatus, MSTATUS_MIE);
+    }
+}
+extern uint8_t HAL_IRQ_CtzTable[32];
+
+/*
+ * Function: HAL_IRQ_Ctz
+ * Номер младшего установленного бита
+ *
+ * Вычисляется по последовательности де Брёйна без вызова __ctzsi2 из libgcc,
+ * поэтому может использоваться в функциях, размещенных в ОЗУ (MIK32_RAMFUNC).
+ *
+ * Parameters:
+ * Value - Значение, не равное нулю
+ *
+ * Returns:
+ * (uint32_t ) - номер младшего установленного бита
+ */
+static inline __attribute__((always_inline)) uint32_t HAL_IRQ_Ctz(uint32_t Value)
+{
+    return HAL_IRQ_CtzTable[(uint32_t)((Value & -Value) * 0x077CB531U) >> 27];
+}
+
 /* Прерывание по фронту */
 
 /*
@@ -257,4 +310,102 @@ uint32_t HAL_EPIC_GetStatus();
  */
 uint32_t HAL_EPIC_GetRawStatus();
 
+/* Диспетчер прерываний EPIC */
+
+    /*
+    * Defines: Число линий EPIC
+    *
+    * HAL_EPIC_LINE_COUNT - Число линий прерываний EPIC
+    *
+    */
+    #define HAL_EPIC_LINE_COUNT             32
+
+/*
+ * Тип обработчика линии прерывания EPIC.
+ */
+typedef void (*HAL_EPIC_HandlerTypeDef)();
+
+/*
+ * Обработчики линий можно задать двумя способами:
+ * - при сборке - определить функцию HAL_EPIC_<ЛИНИЯ>_IRQHandler (например, HAL_EPIC_UART_0_IRQHandler),
+ *   которая заменит слабый обработчик по умолчанию;
+ * - во время работы - функцией <HAL_EPIC_SetHandler>.
+ *
+ * Обработчик внешних прерываний (trap_handler) в этом случае сводится к вызову <HAL_EPIC_Dispatch>:
+ *
+ * > void trap_handler()
+ * > {
+ * >     if (read_csr(mcause) == MCAUSE_MACHINE_EXTERNAL_INTERRUPT)
+ * >         HAL_EPIC_Dispatch();
+ * > }
+ */
+extern HAL_EPIC_HandlerTypeDef HAL_EPIC_Handlers[HAL_EPIC_LINE_COUNT];
+
+void HAL_EPIC_TIMER32_0_IRQHandler();
+void HAL_EPIC_UART_0_IRQHandler();
+void HAL_EPIC_UART_1_IRQHandler();
+void HAL_EPIC_SPI_0_IRQHandler();
+void HAL_EPIC_SPI_1_IRQHandler();
+void HAL_EPIC_GPIO_IRQHandler();
+void HAL_EPIC_I2C_0_IRQHandler();
+void HAL_EPIC_I2C_1_IRQHandler();
+void HAL_EPIC_WDT_IRQHandler();
+void HAL_EPIC_TIMER16_0_IRQHandler();
+void HAL_EPIC_TIMER16_1_IRQHandler();
+void HAL_EPIC_TIMER16_2_IRQHandler();
+void HAL_EPIC_TIMER32_1_IRQHandler();
+void HAL_EPIC_TIMER32_2_IRQHandler();
+void HAL_EPIC_SPIFI_IRQHandler();
+void HAL_EPIC_RTC_IRQHandler();
+void HAL_EPIC_EEPROM_IRQHandler();
+void HAL_EPIC_WDT_DOM3_IRQHandler();
+void HAL_EPIC_WDT_SPIFI_IRQHandler();
+void HAL_EPIC_WDT_EEPROM_IRQHandler();
+void HAL_EPIC_DMA_IRQHandler();
+void HAL_EPIC_FREQ_MON_IRQHandler();
+void HAL_EPIC_PVD_AVCC_UNDER_IRQHandler();
+void HAL_EPIC_PVD_AVCC_OVER_IRQHandler();
+void HAL_EPIC_PVD_VCC_UNDER_IRQHandler();
+void HAL_EPIC_PVD_VCC_OVER_IRQHandler();
+void HAL_EPIC_BATTERY_NON_GOOD_IRQHandler();
+void HAL_EPIC_BOR_IRQHandler();
+void HAL_EPIC_TSENS_IRQHandler();
+void HAL_EPIC_ADC_IRQHandler();
+void HAL_EPIC_DAC0_IRQHandler();
+void HAL_EPIC_DAC1_IRQHandler();
+
+/*
+ * Function: HAL_EPIC_DefaultHandler
+ * Обработчик по умолчанию для линий без заданного обработчика.
+ *
+ * Returns:
+ * void.
+ */
+void HAL_EPIC_DefaultHandler();
+
+/*
+ * Function: HAL_EPIC_SetHandler
+ * Задать обработчик линии прерывания во время работы программы
+ *
+ * Parameters:
+ * Line - Номер линии прерывания (EPIC_LINE_*_S)
+ * Handler - Обработчик линии. NULL - обработчик по умолчанию
+ *
+ * Returns:
+ * void.
+ */
+void HAL_EPIC_SetHandler(uint8_t Line, HAL_EPIC_HandlerTypeDef Handler);
+
+/*
+ * Function: HAL_EPIC_Dispatch
+ * Вызвать обработчики всех активных линий EPIC
+ *
+ * Статус прерываний читается один раз, сбрасываются только флаги обслуженных линий.
+ * Линия без обработчика маскируется.
+ *
+ * Returns:
+ * void.
+ */
+void HAL_EPIC_Dispatch();
+
 #endif //MIK32_HAL_IRQ
@@ -248,6 +248,9 @@ void HAL_SPI_CS_Enable(SPI_HandleTypeDef *hspi, uint32_t CS_M);
 void HAL_SPI_CS_Disable(SPI_HandleTypeDef *hspi);
 HAL_StatusTypeDef HAL_SPI_Exchange(SPI_HandleTypeDef *hspi, uint8_t TransmitBytes[], uint8_t ReceiveBytes[], uint32_t Size, uint32_t Timeout);
 HAL_StatusTypeDef HAL_SPI_ExchangeThreshold(SPI_HandleTypeDef *hspi, uint8_t TransmitBytes[], uint8_t ReceiveBytes[], uint32_t DataSize, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_ExchangeBurst(SPI_HandleTypeDef *hspi, uint8_t TransmitBytes[], uint8_t ReceiveBytes[], uint32_t DataSize, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitBurst(SPI_HandleTypeDef *hspi, const uint8_t TransmitBytes[], uint32_t DataSize, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_ReceiveBurst(SPI_HandleTypeDef *hspi, uint8_t ReceiveBytes[], uint32_t DataSize, uint8_t FillByte, uint32_t Timeout);
 HAL_StatusTypeDef HAL_SPI_Exchange_IT(SPI_HandleTypeDef *hspi, uint8_t TransmitBytes[], uint8_t ReceiveBytes[], uint32_t Size);
 
 
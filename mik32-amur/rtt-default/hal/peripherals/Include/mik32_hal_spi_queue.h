@@ -0,0 +1,92 @@
+#ifndef MIK32_HAL_SPI_QUEUE
+#define MIK32_HAL_SPI_QUEUE
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_dma.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_spi.h"
+
+
+/*
+ * Очередь обменов ведущего SPI с несколькими ведомыми на одной шине.
+ *
+ * Каждое ведомое описывается структурой HAL_SPI_QueueDeviceTypeDef: вывод CS, делитель частоты,
+ * фаза и полярность. Обмен (HAL_SPI_TransferTypeDef) ставится в очередь функцией
+ * HAL_SPI_Queue_Submit, которая не ожидает его выполнения. Перед каждым обменом шина
+ * перенастраивается под его устройство, CS удерживается вручную на все время обмена, данные
+ * передают два канала DMA (память -> TXDATA и RXDATA -> память). Следующий обмен очереди
+ * запускается из прерывания завершения приема DMA, затем вызывается функция завершения
+ * выполненного обмена.
+ *
+ * Обработчик линии DMA назначается в EPIC при инициализации, из trap_handler необходимо
+ * вызывать HAL_EPIC_Dispatch. Во время работы очереди SPI используется только ею.
+ */
+
+typedef struct __HAL_SPI_TransferTypeDef HAL_SPI_TransferTypeDef;
+
+/**
+ * @brief Функция, вызываемая из прерывания после завершения обмена.
+ */
+typedef void (*HAL_SPI_TransferCallbackTypeDef)(HAL_SPI_TransferTypeDef *transfer);
+
+/**
+ * @brief Ведомое устройство на шине.
+ */
+typedef struct __HAL_SPI_QueueDeviceTypeDef
+{
+    uint8_t ChipSelect;             /**< Вывод CS: SPI_CS_0 - SPI_CS_3 (при внешнем декодере - код на выводах CS0 - CS3). */
+    uint8_t BaudRateDiv;            /**< Делитель частоты: SPI_BAUDRATE_DIV4 - SPI_BAUDRATE_DIV256. */
+    uint8_t CLKPhase;               /**< SPI_PHASE_OFF или SPI_PHASE_ON. */
+    uint8_t CLKPolarity;            /**< SPI_POLARITY_LOW или SPI_POLARITY_HIGH. */
+} HAL_SPI_QueueDeviceTypeDef;
+
+/**
+ * @brief Обмен с ведомым устройством.
+ * Структура должна существовать до вызова функции завершения.
+ */
+struct __HAL_SPI_TransferTypeDef
+{
+    HAL_SPI_QueueDeviceTypeDef *Device;         /**< Ведомое устройство. */
+    const uint8_t *TxData;                      /**< Передаваемые данные или NULL (передается FillByte). */
+    uint8_t *RxData;                            /**< Буфер принятых данных или NULL (принятые байты отбрасываются). */
+    uint32_t Length;                            /**< Число байт обмена, больше 0. */
+    uint8_t FillByte;                           /**< Байт, передаваемый при TxData = NULL. */
+    HAL_SPI_TransferCallbackTypeDef Callback;   /**< Функция завершения или NULL. */
+    void *Context;                              /**< Произвольные данные пользователя. */
+    volatile HAL_StatusTypeDef Status;          /**< HAL_BUSY - в очереди или выполняется, HAL_OK - выполнен, HAL_ERROR - ошибка DMA. */
+
+    /* Служебные поля */
+    HAL_SPI_TransferTypeDef *Next;
+};
+
+typedef struct __HAL_SPI_QueueTypeDef
+{
+    SPI_HandleTypeDef *hspi;                    /**< SPI_0 или SPI_1. */
+    DMA_ChannelHandleTypeDef *hdma_tx;          /**< Канал DMA передачи (поля dma и Channel задает пользователь). */
+    DMA_ChannelHandleTypeDef *hdma_rx;          /**< Канал DMA приема (поля dma и Channel задает пользователь). */
+
+    /* Служебные поля */
+    HAL_SPI_TransferTypeDef *volatile Head;     /**< Выполняемый обмен. Изменяется в прерывании и в Submit при пустой очереди. */
+    HAL_SPI_TransferTypeDef *Tail;
+    HAL_DMA_ChainTypeDef TxChain;
+    HAL_DMA_ChainTypeDef RxChain;
+    HAL_DMA_DescriptorTypeDef TxDesc;
+    HAL_DMA_DescriptorTypeDef RxDesc;
+    uint8_t Fill;                               /**< Источник байта заполнения. */
+    uint8_t Sink;                               /**< Приемник отбрасываемых байт. */
+} HAL_SPI_QueueTypeDef;
+
+
+HAL_StatusTypeDef HAL_SPI_Queue_Init(HAL_SPI_QueueTypeDef *queue, SPI_HandleTypeDef *hspi,
+                                     DMA_ChannelHandleTypeDef *hdma_tx, DMA_ChannelHandleTypeDef *hdma_rx);
+HAL_StatusTypeDef HAL_SPI_Queue_Submit(HAL_SPI_QueueTypeDef *queue, HAL_SPI_TransferTypeDef *transfer);
+
+/**
+ * @brief Проверить, выполнены ли все обмены очереди.
+ */
+static inline __attribute__((always_inline)) int HAL_SPI_Queue_IsIdle(HAL_SPI_QueueTypeDef *queue)
+{
+    return queue->Head == NULL;
+}
+
+#endif // MIK32_HAL_SPI_QUEUE
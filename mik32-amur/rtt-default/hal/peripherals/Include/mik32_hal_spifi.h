@@ -98,10 +98,16 @@ typedef struct __SPIFI_MemoryModeConfig_HandleTypeDef
 
     HAL_SPIFI_CacheEnableTypeDef CacheEnable;
 
-    uint32_t CacheLimit;
+    uint32_t CacheLimit;                        /**< Граница кэширования: кэшируются адреса ниже CacheLimit (см. HAL_SPIFI_CacheLimit). */
 
     SPIFI_MemoryCommandTypeDef Command;
 
+    HAL_SPIFI_DataCacheEnableTypeDef DataCache; /**< Кэширование чтения данных (не только выборок команд). */
+
+    HAL_SPIFI_PrefetchEnableTypeDef Prefetch;   /**< Упреждающая выборка следующей строки кэша. */
+
+    uint8_t CSHigh;                             /**< Число периодов SCK минус один, в течение которых CS неактивен между командами (0..15). */
+
 } SPIFI_MemoryModeConfig_HandleTypeDef;
 
 typedef struct __SPIFI_HandleTypeDef
@@ -158,6 +164,15 @@ static inline __attribute__((always_inline)) void HAL_SPIFI_MspInit_LL()
 
 void HAL_SPIFI_MemoryMode_Init(SPIFI_MemoryModeConfig_HandleTypeDef *spifi);
 
+/**
+ * @brief Граница кэширования для окна [SPIFI_BASE_ADDRESS, SPIFI_BASE_ADDRESS + size).
+ * Адреса от границы и выше читаются из флеш-памяти при каждом обращении.
+ */
+static inline __attribute__((always_inline)) uint32_t HAL_SPIFI_CacheLimit(uint32_t size)
+{
+    return SPIFI_BASE_ADDRESS + size;
+}
+
 HAL_StatusTypeDef HAL_SPIFI_SendCommand(
     SPIFI_HandleTypeDef *spifi,
     SPIFI_CommandTypeDef *cmd,
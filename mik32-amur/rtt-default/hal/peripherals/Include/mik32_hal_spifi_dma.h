@@ -0,0 +1,91 @@
+#ifndef MIK32_HAL_SPIFI_DMA
+#define MIK32_HAL_SPIFI_DMA
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_dma.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_spifi.h"
+
+
+/*
+ * Команды периферийного режима SPIFI с передачей данных через DMA.
+ *
+ * Данные пересылаются каналом DMA словами между регистром DATA32 и памятью по запросу SPIFI
+ * (бит CTRL.DMAEN). Байты до первого выровненного адреса буфера и остаток короче слова
+ * передает процессор. Завершение команды определяется прерыванием SPIFI (бит CTRL.INTEN),
+ * следующая команда запускается из прерывания, поэтому процессор не тратит время на каждый байт.
+ *
+ * Поле DATALEN регистра CMD ограничивает команду HAL_SPIFI_DMA_COMMAND_MAX байтами. Чтение
+ * большего объема разбивается на несколько команд с последовательными адресами. Команды
+ * записи (DOUT) и команды без адреса не разбиваются.
+ *
+ * После данных может быть выполнена команда опроса статуса флеш-памяти (бит POLL): контроллер
+ * сам опрашивает статус, и функция завершения вызывается, когда флеш-память освободится
+ * (например, после программирования страницы).
+ *
+ * SPIFI не должен находиться в режиме памяти, поэтому программа не может выполняться из
+ * SPIFI во время команды. Обработчики линий SPIFI и DMA назначаются в EPIC при инициализации,
+ * из trap_handler необходимо вызывать HAL_EPIC_Dispatch.
+ */
+
+/* Наибольшая длина данных одной команды (DATALEN), кратная слову */
+#define HAL_SPIFI_DMA_COMMAND_MAX   (SPIFI_CONFIG_CMD_DATALEN_M & ~3u)
+
+typedef struct __HAL_SPIFI_DMA_TypeDef HAL_SPIFI_DMA_TypeDef;
+
+/**
+ * @brief Функция, вызываемая из прерывания после завершения команды.
+ */
+typedef void (*HAL_SPIFI_DMA_CallbackTypeDef)(HAL_SPIFI_DMA_TypeDef *engine);
+
+/**
+ * @brief Команда периферийного режима.
+ */
+typedef struct __HAL_SPIFI_DMA_CommandTypeDef
+{
+    uint32_t Command;                   /**< Значение регистра CMD без поля DATALEN (как cmd в HAL_SPIFI_SendCommand_LL). */
+    uint32_t InterimData;               /**< Промежуточные данные (IDATA). */
+    uint32_t Control;                   /**< Биты CTRL на время команды. Бит SPIFI_CONFIG_CTRL_DUAL_M (двухпроводный протокол) задается только этим полем. */
+    uint32_t PollCommand;               /**< Команда опроса статуса после данных (с битом SPIFI_CONFIG_CMD_POLL_M) или 0. */
+} HAL_SPIFI_DMA_CommandTypeDef;
+
+struct __HAL_SPIFI_DMA_TypeDef
+{
+    SPIFI_HandleTypeDef *spifi;         /**< SPIFI (поле Instance). */
+    DMA_ChannelHandleTypeDef *hdma_channel; /**< Канал DMA (поля dma, Channel и Priority задает пользователь). */
+    HAL_SPIFI_DMA_CallbackTypeDef Callback; /**< Функция завершения. Может быть NULL. */
+    void *Context;                      /**< Произвольные данные пользователя. */
+    volatile HAL_StatusTypeDef Status;  /**< HAL_BUSY - команда выполняется, HAL_OK - завершена, HAL_ERROR - ошибка DMA или статуса, HAL_TIMEOUT - прервана HAL_SPIFI_DMA_Wait. */
+
+    /* Служебные поля */
+    HAL_SPIFI_DMA_CommandTypeDef Command;
+    uint32_t SavedControl;              /**< Значение CTRL до запуска команды. */
+    uint32_t Address;                   /**< Адрес следующей команды. */
+    uint8_t *Data;                      /**< Данные следующей команды. */
+    uint32_t Remaining;                 /**< Байт после текущей команды. */
+    uint8_t *Tail;                      /**< Байты текущей команды, передаваемые процессором после DMA. */
+    uint32_t TailLength;
+    volatile uint8_t Pending;           /**< Событий до завершения текущей команды: DMA и прерывание SPIFI. */
+    uint8_t Polling;                    /**< Выполняется команда опроса статуса. */
+    HAL_DMA_DescriptorTypeDef Desc;
+    HAL_DMA_ChainTypeDef Chain;
+};
+
+
+void HAL_SPIFI_DMA_Init(HAL_SPIFI_DMA_TypeDef *engine, SPIFI_HandleTypeDef *spifi, DMA_ChannelHandleTypeDef *hdma_channel,
+                        HAL_SPIFI_DMA_CallbackTypeDef Callback);
+HAL_StatusTypeDef HAL_SPIFI_DMA_Start(HAL_SPIFI_DMA_TypeDef *engine, const HAL_SPIFI_DMA_CommandTypeDef *command,
+                                      uint32_t Address, void *Data, uint32_t Length);
+void HAL_SPIFI_DMA_Abort(HAL_SPIFI_DMA_TypeDef *engine);
+HAL_StatusTypeDef HAL_SPIFI_DMA_Wait(HAL_SPIFI_DMA_TypeDef *engine, uint32_t Timeout);
+void HAL_SPIFI_DMA_IRQHandler();
+
+/**
+ * @brief Проверить, выполняется ли команда.
+ */
+static inline __attribute__((always_inline)) int HAL_SPIFI_DMA_IsBusy(HAL_SPIFI_DMA_TypeDef *engine)
+{
+    return engine->Status == HAL_BUSY;
+}
+
+#endif // MIK32_HAL_SPIFI_DMA
@@ -0,0 +1,61 @@
+#ifndef MIK32_HAL_TIMEBASE
+#define MIK32_HAL_TIMEBASE
+
+#include <stdint.h>
+
+
+/**
+ * @brief Коэффициент пересчета тиков таймера в единицы времени.
+ *
+ * Отношение num/den представляется в виде Mult / 2^Shift, где Mult - 32-битное число.
+ * Коэффициент вычисляется один раз (при инициализации или смене частоты), после чего
+ * пересчет сводится к умножению и сдвигу без деления.
+ */
+typedef struct
+{
+    uint32_t Mult;      /**< Множитель. */
+    uint8_t Shift;      /**< Сдвиг вправо. */
+} HAL_TimeBase_ScaleTypeDef;
+
+
+void HAL_TimeBase_ScaleInit(HAL_TimeBase_ScaleTypeDef *scale, uint64_t num, uint64_t den);
+
+
+/**
+ * @brief Пересчитать 32-битное количество тиков: ticks * num / den.
+ *
+ * Используется одно умножение 32x32->64 и сдвиг.
+ *
+ * @param scale Указатель на коэффициент пересчета.
+ * @param ticks Количество тиков.
+ * @return Результат пересчета.
+ */
+static inline __attribute__((always_inline)) uint64_t HAL_TimeBase_Scale32(const HAL_TimeBase_ScaleTypeDef *scale, uint32_t ticks)
+{
+    return ((uint64_t)ticks * scale->Mult) >> scale->Shift;
+}
+
+/**
+ * @brief Пересчитать 64-битное количество тиков: ticks * num / den.
+ *
+ * Произведение 64x32 вычисляется по частям (96 бит), поэтому переполнения
+ * не возникает на всем диапазоне 64-битного счетчика.
+ *
+ * @param scale Указатель на коэффициент пересчета.
+ * @param ticks Количество тиков.
+ * @return Результат пересчета (младшие 64 бита).
+ */
+static inline __attribute__((always_inline)) uint64_t HAL_TimeBase_Scale64(const HAL_TimeBase_ScaleTypeDef *scale, uint64_t ticks)
+{
+    uint64_t lo = (uint64_t)(uint32_t)ticks * scale->Mult;
+    uint64_t mid = (uint64_t)(uint32_t)(ticks >> 32) * scale->Mult + (lo >> 32);
+
+    if (scale->Shift >= 32)
+    {
+        return mid >> (scale->Shift - 32);
+    }
+
+    return (mid << (32 - scale->Shift)) | ((uint32_t)lo >> scale->Shift);
+}
+
+#endif // MIK32_HAL_TIMEBASE
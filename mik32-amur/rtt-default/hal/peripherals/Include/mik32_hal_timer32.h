@@ -6,6 +6,8 @@
 #include <timer32.h>
 #include <power_manager.h>
 #include "mik32_hal_def.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_timebase.h"
 #include <mik32_memory_map.h>
 
 #define TIMER32_TIMEOUT 10000000
@@ -255,7 +257,19 @@ void HAL_Timer32_Capture_Stop_IT(TIMER32_HandleTypeDef *timer, TIMER32_CHANNEL_H
 void HAL_Timer32_Start_IT(TIMER32_HandleTypeDef *timer, uint32_t intMask);
 void HAL_Timer32_Stop_IT(TIMER32_HandleTypeDef *timer, uint32_t intMask);
 
+/*
+ * Системные часы на 32-р таймере (HAL_Time_TIM32_*). Переполнение счетчика учитывается по
+ * флагу таймера в прерывании (HAL_Time_TIM32_IRQHandler, назначается в EPIC при инициализации)
+ * или при чтении времени, если флаг еще не обработан. Флаг хранит одно переполнение, поэтому
+ * 2^32 тиков теряются, только если после переполнения прерывание запрещено и время не читается
+ * дольше периода таймера: 2^32 тиков, около 134 с при частоте счета 32 МГц.
+ */
 void HAL_Time_TIM32_Init(TIMER32_TypeDef* timer);
+void HAL_Time_TIM32_ClockUpdate();
+void HAL_Time_TIM32_IRQHandler();
+uint64_t HAL_Time_TIM32_Ticks64();
+uint64_t HAL_Time_TIM32_Micros64();
+uint64_t HAL_Time_TIM32_Millis64();
 uint32_t HAL_Time_TIM32_Micros();
 uint32_t HAL_Time_TIM32_Millis();
 void HAL_Time_TIM32_DelayUs(uint32_t time_us);
@@ -0,0 +1,95 @@
+#ifndef MIK32_HAL_USART_STREAM
+#define MIK32_HAL_USART_STREAM
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_dma.h"
+#include "mik32_hal_irq.h"
+#include "mik32_memory_map.h"
+#include "uart.h"
+
+
+/*
+ * Буферизированный неблокирующий поток USART (UART_0, UART_1).
+ *
+ * Прием: прерывание RXNE складывает байты в кольцевой буфер с одним производителем (прерывание)
+ * и одним потребителем (основная программа), запрет прерываний при чтении не требуется.
+ * Прерывание IDLE (линия свободна 8 битовых интервалов после приема) вызывает IdleCallback,
+ * по нему удобно разбирать кадры переменной длины.
+ *
+ * Передача: данные копируются в кольцевой буфер передачи, DMA отправляет его непрерывными
+ * участками (от начала данных до их конца или до конца буфера). Следующий участок запускается
+ * из прерывания завершения DMA.
+ *
+ * Размеры буферов - степени двойки. Обработчики линий UART и DMA назначаются в EPIC при
+ * инициализации, из trap_handler необходимо вызывать HAL_EPIC_Dispatch.
+ */
+
+typedef struct __HAL_USART_StreamTypeDef HAL_USART_StreamTypeDef;
+
+/**
+ * @brief Функция, вызываемая из прерывания при обнаружении паузы на линии RX.
+ */
+typedef void (*HAL_USART_Stream_IdleCallbackTypeDef)(HAL_USART_StreamTypeDef *stream);
+
+struct __HAL_USART_StreamTypeDef
+{
+    UART_TypeDef *Instance;                         /**< UART_0 или UART_1. */
+    DMA_ChannelHandleTypeDef *hdma_channel;         /**< Канал DMA передачи (поля dma и Channel задает пользователь). */
+    HAL_USART_Stream_IdleCallbackTypeDef IdleCallback;  /**< Функция обработки паузы на линии RX. Может быть NULL. */
+    void *Context;                                  /**< Произвольные данные пользователя. */
+
+    volatile uint32_t RxOverruns;                   /**< Число байт, потерянных из-за заполнения буфера приема. */
+    volatile uint32_t RxErrors;                     /**< Число ошибок приема (FE, ORE, NF, PE). */
+
+    /* Служебные поля */
+    uint8_t *RxBuffer;
+    uint32_t RxMask;
+    volatile uint32_t RxHead;                       /**< Изменяется только в прерывании. */
+    volatile uint32_t RxTail;                       /**< Изменяется только в HAL_USART_Stream_Read. */
+
+    uint8_t *TxBuffer;
+    uint32_t TxMask;
+    volatile uint32_t TxHead;                       /**< Изменяется только вызывающей стороной (Write, Discard). */
+    volatile uint32_t TxTail;                       /**< Изменяется в прерывании DMA и в Discard при свободном DMA. */
+    uint32_t TxChunk;                               /**< Длина участка, переданного DMA. */
+    uint32_t TxSkip;                                /**< Байт, отброшенных за участком DMA; освобождаются после его передачи. */
+    HAL_DMA_DescriptorTypeDef TxDesc;
+    HAL_DMA_ChainTypeDef TxChain;
+};
+
+
+HAL_StatusTypeDef HAL_USART_Stream_Init(HAL_USART_StreamTypeDef *stream, UART_TypeDef *Instance, uint32_t Baudrate,
+                                        uint8_t *RxBuffer, uint32_t RxSize, uint8_t *TxBuffer, uint32_t TxSize);
+void HAL_USART_Stream_DeInit(HAL_USART_StreamTypeDef *stream);
+uint32_t HAL_USART_Stream_Write(HAL_USART_StreamTypeDef *stream, const void *Data, uint32_t Size);
+uint32_t HAL_USART_Stream_Discard(HAL_USART_StreamTypeDef *stream, uint32_t Size);
+void HAL_USART_Stream_Poll(HAL_USART_StreamTypeDef *stream);
+void HAL_USART_Stream_Flush(HAL_USART_StreamTypeDef *stream);
+uint32_t HAL_USART_Stream_Read(HAL_USART_StreamTypeDef *stream, void *Data, uint32_t Size);
+void HAL_USART_Stream_IRQHandler(HAL_USART_StreamTypeDef *stream);
+
+/**
+ * @brief Число принятых байт, доступных для чтения.
+ */
+static inline __attribute__((always_inline)) uint32_t HAL_USART_Stream_Available(HAL_USART_StreamTypeDef *stream)
+{
+    return stream->RxHead - stream->RxTail;
+}
+
+/**
+ * @brief Число байт, которые можно записать без потерь.
+ */
+static inline __attribute__((always_inline)) uint32_t HAL_USART_Stream_TxFree(HAL_USART_StreamTypeDef *stream)
+{
+    return (stream->TxMask + 1) - (stream->TxHead - stream->TxTail);
+}
+
+/**
+ * @brief Проверить, переданы ли все записанные данные (в регистр передатчика).
+ */
+static inline __attribute__((always_inline)) int HAL_USART_Stream_TxEmpty(HAL_USART_StreamTypeDef *stream)
+{
+    return stream->TxHead == stream->TxTail;
+}
+
+#endif // MIK32_HAL_USART_STREAM
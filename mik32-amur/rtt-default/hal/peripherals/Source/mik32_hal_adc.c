@@ -1,4 +1,10 @@
 #include "mik32_hal_adc.h"
+#include "csr.h"
+#include "scr1_csr_encoding.h"
+#include "scr1_specific.h"
+
+/* Наибольшая задержка записи отсчета DMA после переполнения таймера, такты ядра */
+#define HAL_ADC_DMA_REQUEST_CYCLES  16
 
 __attribute__((weak)) void HAL_ADC_MspInit(ADC_HandleTypeDef* hadc)
 {
@@ -168,3 +174,170 @@ uint16_t HAL_ADC_WaitAndGetValue(ADC_HandleTypeDef *hadc)
 
     return value;
 }
+
+/**
+ * @brief Подсчет отсчетов, пропущенных до перезапуска канала DMA на половину next.
+ *
+ * Число переполнений таймера с запуска определяется по mcycle и счетчику таймера (момент
+ * последнего переполнения не зависит от задержки прерывания), число записанных отсчетов - по
+ * заполненным половинам и текущему адресу назначения канала. Разница - пропущенные отсчеты.
+ * Переполнение, которое DMA мог еще не обслужить, не учитывается: недосчет исправляется при
+ * следующем вызове, поэтому ложных пропусков нет.
+ */
+static MIK32_RAMFUNC void HAL_ADC_DMA_CountGap(ADC_DMA_HandleTypeDef *hadc_dma, uint32_t count, uint32_t next)
+{
+    DMA_ChannelHandleTypeDef *hdma_channel = hadc_dma->hdma_channel;
+
+    uint32_t since = hadc_dma->htimer32->Instance->VALUE * hadc_dma->TickCycles;
+    uint32_t overflow = (uint32_t)read_csr(mcycle) - since;
+    uint32_t written = (hdma_channel->dma->Instance->CHANNELS[hdma_channel->ChannelInit.Channel].DST -
+                        (uint32_t)hadc_dma->Half[next].Destination) / sizeof(uint16_t);
+
+    uint32_t periods = (overflow - hadc_dma->LastCycles + hadc_dma->SampleCycles / 2) / hadc_dma->SampleCycles;
+    hadc_dma->LastCycles += periods * hadc_dma->SampleCycles;
+    hadc_dma->Periods += periods;
+    hadc_dma->Delivered += count;
+
+    uint32_t due = hadc_dma->Periods - ((since < HAL_ADC_DMA_REQUEST_CYCLES) ? 1 : 0);
+    int32_t dropped = (int32_t)(due - (hadc_dma->Delivered + written));
+    if (dropped > (int32_t)hadc_dma->Dropped)
+    {
+        hadc_dma->Dropped = dropped;
+        hadc_dma->Overruns++;
+    }
+}
+
+/**
+ * @brief Завершено заполнение половины буфера (вызывается из HAL_DMA_IRQHandler).
+ * DMA к этому моменту уже заполняет вторую половину.
+ */
+static MIK32_RAMFUNC void HAL_ADC_DMA_HalfDone(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *desc)
+{
+    ADC_DMA_HandleTypeDef *hadc_dma = chain->Context;
+    uint32_t half = (desc == &hadc_dma->Half[0]) ? 0 : 1;
+    uint32_t count = hadc_dma->Length / 2;
+    uint16_t *samples = hadc_dma->Buffer + half * count;
+
+    if (hadc_dma->TickCycles != 0)
+    {
+        HAL_ADC_DMA_CountGap(hadc_dma, count, half ^ 1);
+    }
+
+    /* Заполняемая сейчас половина не была освобождена - ее данные потеряны */
+    if (hadc_dma->Ready & (1 << (half ^ 1)))
+    {
+        hadc_dma->Overruns++;
+    }
+    hadc_dma->Ready |= 1 << half;
+
+    ADC_DMA_CallbackTypeDef callback = half ? hadc_dma->CpltCallback : hadc_dma->HalfCpltCallback;
+    if (callback != NULL)
+    {
+        callback(hadc_dma, samples, count);
+    }
+}
+
+HAL_StatusTypeDef HAL_ADC_DMA_Start(ADC_DMA_HandleTypeDef *hadc_dma, uint16_t *Buffer, uint32_t Length)
+{
+    if ((Buffer == NULL) || (Length < 2) || (Length & 1))
+    {
+        return HAL_ERROR;
+    }
+
+    DMA_ChannelInitHandleTypeDef *init = &hadc_dma->hdma_channel->ChannelInit;
+    HAL_DMA_ChannelRequestTypeDef request;
+
+    switch ((uint32_t)hadc_dma->htimer32->Instance)
+    {
+    case (uint32_t)TIMER32_0:
+        request = DMA_CHANNEL_TIMER32_0_REQUEST;
+        break;
+    case (uint32_t)TIMER32_1:
+        request = DMA_CHANNEL_TIMER32_1_REQUEST;
+        break;
+    default:
+        request = DMA_CHANNEL_TIMER32_2_REQUEST;
+        break;
+    }
+
+    /* Источник - младшее полуслово ADC_VALUE по запросу таймера, назначение - буфер в памяти */
+    init->ReadMode = DMA_CHANNEL_MODE_PERIPHERY;
+    init->ReadInc = DMA_CHANNEL_INC_DISABLE;
+    init->ReadSize = DMA_CHANNEL_SIZE_HALFWORD;
+    init->ReadBurstSize = 1;
+    init->ReadRequest = request;
+    init->ReadAck = DMA_CHANNEL_ACK_ENABLE;
+    init->WriteMode = DMA_CHANNEL_MODE_MEMORY;
+    init->WriteInc = DMA_CHANNEL_INC_ENABLE;
+    init->WriteSize = DMA_CHANNEL_SIZE_HALFWORD;
+    init->WriteBurstSize = 1;
+    init->WriteRequest = request;
+    init->WriteAck = DMA_CHANNEL_ACK_DISABLE;
+
+    hadc_dma->Buffer = Buffer;
+    hadc_dma->Length = Length;
+    hadc_dma->Ready = 0;
+    hadc_dma->Overruns = 0;
+    hadc_dma->Dropped = 0;
+    hadc_dma->Periods = 0;
+    hadc_dma->Delivered = 0;
+
+    /*
+     * Пропуски между половинами считаются по mcycle: такты ядра на тик таймера известны только
+     * при тактировании от шины, адрес записи DMA - только при чтении текущих значений.
+     * TIMER32_0 тактируется от APB_M, остальные - от APB_P.
+     */
+    hadc_dma->TickCycles = 0;
+    if ((hadc_dma->htimer32->Clock.Source == TIMER32_SOURCE_PRESCALER) &&
+        (hadc_dma->hdma_channel->dma->CurrentValue == DMA_CURRENT_VALUE_ENABLE))
+    {
+        uint32_t apb = (hadc_dma->htimer32->Instance == TIMER32_0) ? PM->DIV_APB_M : PM->DIV_APB_P;
+        hadc_dma->TickCycles = (apb + 1) * (hadc_dma->htimer32->Clock.Prescaler + 1);
+        hadc_dma->SampleCycles = hadc_dma->TickCycles * (hadc_dma->htimer32->Top + 1);
+        set_csr(mcounten, MCOUNTEN_CY);
+    }
+
+    /* Кольцо из двух дескрипторов: половины буфера заполняются поочередно */
+    for (uint32_t half = 0; half < 2; half++)
+    {
+        hadc_dma->Half[half].Source = (void *)&hadc_dma->hadc->Instance->ADC_VALUE;
+        hadc_dma->Half[half].Destination = Buffer + half * (Length / 2);
+        hadc_dma->Half[half].Length = (Length / 2) * sizeof(uint16_t);
+        hadc_dma->Half[half].Next = &hadc_dma->Half[half ^ 1];
+    }
+
+    HAL_DMA_ChainInit(&hadc_dma->Chain, hadc_dma->hdma_channel, NULL);
+    hadc_dma->Chain.DescriptorCallback = HAL_ADC_DMA_HalfDone;
+    hadc_dma->Chain.Context = hadc_dma;
+
+    HAL_ADC_ContinuousEnable(hadc_dma->hadc);
+
+    if (HAL_DMA_ChainStart(&hadc_dma->Chain, &hadc_dma->Half[0]) != HAL_OK)
+    {
+        HAL_ADC_ContinuousDisabled(hadc_dma->hadc);
+        return HAL_BUSY;
+    }
+
+    HAL_Timer32_Value_Clear(hadc_dma->htimer32);
+    hadc_dma->LastCycles = (uint32_t)read_csr(mcycle);
+    HAL_Timer32_Start(hadc_dma->htimer32);
+
+    return HAL_OK;
+}
+
+void HAL_ADC_DMA_Stop(ADC_DMA_HandleTypeDef *hadc_dma)
+{
+    HAL_Timer32_Stop(hadc_dma->htimer32);
+    HAL_DMA_ChainAbort(&hadc_dma->Chain);
+    HAL_ADC_ContinuousDisabled(hadc_dma->hadc);
+}
+
+void HAL_ADC_DMA_Release(ADC_DMA_HandleTypeDef *hadc_dma, uint16_t *Samples)
+{
+    uint32_t half = (Samples == hadc_dma->Buffer) ? 0 : 1;
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    hadc_dma->Ready &= ~(1 << half);
+
+    HAL_IRQ_Restore(irq_state);
+}
@@ -0,0 +1,199 @@
+#include "mik32_hal_clock.h"
+
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER16
+#include "mik32_hal_timer16.h"
+#elif HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER32
+#include "mik32_hal_timer32.h"
+#else
+#include "mik32_hal_scr1_timer.h"
+#endif
+
+
+HAL_Clock_HandleTypeDef HAL_Clock_Handler;
+
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER16
+static Timer16_HandleTypeDef HAL_Clock_Timer;
+#elif HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER32
+static TIMER32_HandleTypeDef HAL_Clock_Timer;
+#else
+static SCR1_TIMER_HandleTypeDef HAL_Clock_Timer;
+#endif
+
+
+/**
+ * @brief Частота счета тиков выбранного таймера при текущих настройках тактирования.
+ */
+static uint32_t HAL_Clock_GetTickFreq()
+{
+    uint32_t clock_freq = HAL_PCC_GetSysClockFreq();
+
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER16
+    /* Таймер тактируется системной частотой, делитель - степень двойки */
+    return clock_freq >> HAL_Clock_Timer.Clock.Prescaler;
+#elif HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER32
+    /* TIMER32_0 тактируется от APB_M, остальные от APB_P */
+    if (HAL_CLOCK_INSTANCE == TIMER32_0)
+        return clock_freq / ((PM->DIV_AHB+1) * (PM->DIV_APB_M+1));
+    else
+        return clock_freq / ((PM->DIV_AHB+1) * (PM->DIV_APB_P+1));
+#else
+    if (HAL_Clock_Timer.ClockSource == SCR1_TIMER_CLKSRC_EXTERNAL_RTC)
+        return OSC_CLOCK_VALUE / (HAL_Clock_Timer.Divider + 1);
+    return clock_freq / (PM->DIV_AHB+1) / (HAL_Clock_Timer.Divider + 1);
+#endif
+}
+
+/**
+ * @brief Пересчет коэффициентов перевода тиков в единицы времени.
+ */
+static void HAL_Clock_ScaleUpdate()
+{
+    HAL_Clock_Handler.Freq = HAL_Clock_GetTickFreq();
+    HAL_TimeBase_ScaleInit(&HAL_Clock_Handler.Us, 1000000ULL, HAL_Clock_Handler.Freq);
+    HAL_TimeBase_ScaleInit(&HAL_Clock_Handler.Ns, 1000000000ULL, HAL_Clock_Handler.Freq);
+}
+
+/**
+ * @brief Инициализация единых системных часов на таймере, выбранном макросом HAL_CLOCK_SOURCE.
+ *
+ * Для 16-р таймера выбирается наибольший делитель, при котором частота счета не ниже 1 МГц
+ * (переполнение примерно раз в 65мс). 32-р таймер и таймер ядра считают без делителя.
+ *
+ * Счетчик таймера ядра не сбрасывается (по нему отсчитываются сроки HAL_SWTimer), отсчет
+ * времени начинается с текущего значения. Уже включенный таймер ядра не перенастраивается,
+ * частота счета определяется по его регистрам. Счетчик 16-р таймера доступен только для
+ * чтения и также не сбрасывается.
+ *
+ * @warning При использовании 16-р или 32-р таймера прерывание таймера разрешается в EPIC, а
+ * глобальные прерывания разрешает приложение; из обработчика прерываний необходимо вызывать
+ * HAL_Clock_IRQHandler. Таймер ядра (SCR1) нельзя одновременно использовать для функции
+ * HAL_DelayMs, так как она сбрасывает его счетчик.
+ */
+void HAL_Clock_Init()
+{
+    HAL_Clock_Handler.Seq = 0;
+    HAL_Clock_Handler.High = 0;
+    HAL_Clock_Handler.EpochTicks = 0;
+    HAL_Clock_Handler.EpochUs = 0;
+    HAL_Clock_Handler.EpochNs = 0;
+
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER16
+    uint32_t clock_freq = HAL_PCC_GetSysClockFreq();
+    uint8_t prescaler = TIMER16_PRESCALER_1;
+    while ((prescaler < TIMER16_PRESCALER_128) && ((clock_freq >> (prescaler + 1)) >= 1000000UL))
+    {
+        prescaler++;
+    }
+
+    HAL_Clock_Timer.Instance = HAL_CLOCK_INSTANCE;
+    HAL_Clock_Timer.Clock.Source = TIMER16_SOURCE_INTERNAL_SYSTEM;
+    HAL_Clock_Timer.Clock.Prescaler = prescaler;
+    HAL_Clock_Timer.CountMode = TIMER16_COUNTMODE_INTERNAL;
+    HAL_Clock_Timer.ActiveEdge = TIMER16_ACTIVEEDGE_RISING;
+    HAL_Clock_Timer.Preload = TIMER16_PRELOAD_AFTERWRITE;
+    HAL_Clock_Timer.Trigger.Source = TIMER16_TRIGGER_TIM1_GPIO1_9;
+    HAL_Clock_Timer.Trigger.ActiveEdge = TIMER16_TRIGGER_ACTIVEEDGE_SOFTWARE;
+    HAL_Clock_Timer.Trigger.TimeOut = TIMER16_TIMEOUT_DISABLE;
+    HAL_Clock_Timer.Filter.ExternalClock = TIMER16_FILTER_NONE;
+    HAL_Clock_Timer.Filter.Trigger = TIMER16_FILTER_NONE;
+    HAL_Clock_Timer.EncoderMode = TIMER16_ENCODER_DISABLE;
+    HAL_Clock_Timer.Waveform.Enable = TIMER16_WAVEFORM_GENERATION_DISABLE;
+    HAL_Clock_Timer.Waveform.Polarity = TIMER16_WAVEFORM_POLARITY_NONINVERTED;
+    HAL_Timer16_Init(&HAL_Clock_Timer);
+
+    HAL_Clock_ScaleUpdate();
+
+    switch ((uint32_t)HAL_CLOCK_INSTANCE)
+    {
+        case (uint32_t)TIMER16_0: HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER16_0_MASK); break;
+        case (uint32_t)TIMER16_1: HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER16_1_MASK); break;
+        case (uint32_t)TIMER16_2: HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER16_2_MASK); break;
+    }
+    /* Для часов нужно только прерывание ARRM */
+    HAL_Timer16_Enable(&HAL_Clock_Timer);
+    HAL_Clock_Timer.Instance->ICR = TIMER16_ICR_ARROKCF_M | TIMER16_ICR_ARRMCF_M;
+    HAL_Timer16_SetARR(&HAL_Clock_Timer, 0xFFFF);
+    HAL_Timer16_SetInterruptARRM(&HAL_Clock_Timer);
+    __HAL_TIMER16_START_CONTINUOUS(&HAL_Clock_Timer);
+#elif HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER32
+    HAL_Clock_Timer.Instance = HAL_CLOCK_INSTANCE;
+    HAL_Clock_Timer.Top = 0xFFFFFFFF;
+    HAL_Clock_Timer.Clock.Source = TIMER32_SOURCE_PRESCALER;
+    HAL_Clock_Timer.Clock.Prescaler = 0;
+    HAL_Clock_Timer.CountMode = TIMER32_COUNTMODE_FORWARD;
+    HAL_Clock_Timer.State = TIMER32_STATE_DISABLE;
+    HAL_Timer32_Init(&HAL_Clock_Timer);
+    HAL_Timer32_Value_Clear(&HAL_Clock_Timer);
+
+    HAL_Clock_ScaleUpdate();
+
+    switch ((uint32_t)HAL_CLOCK_INSTANCE)
+    {
+        case (uint32_t)TIMER32_0: HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER32_0_MASK); break;
+        case (uint32_t)TIMER32_1: HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER32_1_MASK); break;
+        case (uint32_t)TIMER32_2: HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER32_2_MASK); break;
+    }
+    HAL_Timer32_Base_Start_IT(&HAL_Clock_Timer);
+#else
+    HAL_Clock_Timer.Instance = HAL_CLOCK_INSTANCE;
+    /* Уже запущенный таймер (например, HAL_SWTimer_Init) не перенастраивается, чтобы не прерывать счет */
+    if (!(HAL_Clock_Timer.Instance->TIMER_CTRL & SCR1_TIMER_CTRL_ENABLE_M))
+    {
+        HAL_Clock_Timer.ClockSource = SCR1_TIMER_CLKSRC_INTERNAL;
+        HAL_Clock_Timer.Divider = 0;
+        HAL_SCR1_Timer_Init(&HAL_Clock_Timer);
+        HAL_SCR1_Timer_Enable(&HAL_Clock_Timer);
+    }
+    else
+    {
+        /* Частота счета определяется текущими настройками таймера */
+        HAL_Clock_Timer.ClockSource = (HAL_Clock_Timer.Instance->TIMER_CTRL & SCR1_TIMER_CTRL_CLKSRC_M) ?
+                                      SCR1_TIMER_CLKSRC_EXTERNAL_RTC : SCR1_TIMER_CLKSRC_INTERNAL;
+        HAL_Clock_Timer.Divider = HAL_Clock_Timer.Instance->TIMER_DIV;
+    }
+    HAL_Clock_Handler.EpochTicks = HAL_Clock_NowTicks();
+
+    HAL_Clock_ScaleUpdate();
+#endif
+}
+
+/**
+ * @brief Пересчет коэффициентов после смены частоты тактирования или делителей AHB, APB_P и APB_M.
+ * Накопленное время сохраняется. Функция вызывается из основной программы.
+ */
+void HAL_Clock_ClockUpdate()
+{
+    uint64_t ticks = HAL_Clock_NowTicks();
+    uint64_t delta = ticks - HAL_Clock_Handler.EpochTicks;
+
+    HAL_Clock_Handler.EpochUs += HAL_TimeBase_Scale64(&HAL_Clock_Handler.Us, delta);
+    HAL_Clock_Handler.EpochNs += HAL_TimeBase_Scale64(&HAL_Clock_Handler.Ns, delta);
+    HAL_Clock_Handler.EpochTicks = ticks;
+    HAL_Clock_ScaleUpdate();
+}
+
+/**
+ * @brief Обработчик прерывания переполнения таймера системных часов.
+ * Вызывается из trap_handler. Для таймера ядра ничего не делает.
+ */
+MIK32_RAMFUNC void HAL_Clock_IRQHandler()
+{
+#if HAL_CLOCK_SOURCE != HAL_CLOCK_SOURCE_SCR1_TIMER
+    if (!HAL_CLOCK_OVERFLOW_PENDING())
+    {
+        return;
+    }
+    /* Флаг мог установиться раньше перехода счетчика через 0: ожидание не дольше одного тика */
+    while (HAL_CLOCK_COUNTER() == HAL_CLOCK_TOP);
+
+    HAL_Clock_Handler.Seq++;
+    HAL_Clock_Handler.High += HAL_CLOCK_PERIOD;
+    /* Флаг сбрасывается до закрытия последовательности, иначе читатель учтет переполнение дважды */
+#if HAL_CLOCK_SOURCE == HAL_CLOCK_SOURCE_TIMER16
+    HAL_CLOCK_INSTANCE->ICR = TIMER16_ICR_ARRMCF_M;
+#else
+    HAL_CLOCK_INSTANCE->INT_CLEAR = TIMER32_INT_OVERFLOW_M;
+#endif
+    HAL_Clock_Handler.Seq++;
+#endif
+}
@@ -59,6 +59,14 @@ void HAL_CRC_Init(CRC_HandleTypeDef *hcrc)
 
     /* Задается полином */
     HAL_CRC_SetPoly(hcrc);
+
+    /* DMA включается только явно через HAL_CRC_SetDMA */
+    hcrc->hdma_channel = NULL;
+}
+
+void HAL_CRC_SetDMA(CRC_HandleTypeDef *hcrc, DMA_ChannelHandleTypeDef *hdma_channel)
+{
+    hcrc->hdma_channel = hdma_channel;
 }
 
 void HAL_CRC_WaitBusy(CRC_HandleTypeDef *hcrc)
@@ -69,65 +77,153 @@ void HAL_CRC_WaitBusy(CRC_HandleTypeDef *hcrc)
     while (hcrc->Instance->CTRL & CRC_CTRL_BUSY_M);
 }
 
-void HAL_CRC_WriteData(CRC_HandleTypeDef *hcrc, uint8_t message[], uint32_t message_length)
+/**
+ * @brief Записать до 3 байт данных (невыровненные начало и конец участка) так же, как HAL_CRC_WriteData
+ * до перехода на HAL_CRC_Update: полуслово старшим байтом вперед, затем байт.
+ */
+static void HAL_CRC_WriteBytes(CRC_TypeDef *crc, const uint8_t *data, uint32_t length)
 {
-    if(message_length > CRC_MAX_BYTES)
+    if (length >= 2)
     {
-        #ifdef MIK32_CRC_DEBUG
-        xprintf("Ошибка: переполнение буфера\n");
-        #endif
-
-        return;
+        crc->DATA16 = (data[0] << 8) | data[1];
+        data += 2;
+        length -= 2;
     }
-    
+    if (length != 0)
+    {
+        crc->DATA8 = data[0];
+    }
+}
+
+/**
+ * @brief Ожидание сброса флага BUSY.
+ * Первое чтение CTRL выполняется не раньше чем через такт после записи в регистр данных,
+ * поэтому флаг к этому моменту уже установлен.
+ */
+static inline void HAL_CRC_WaitIdle(CRC_TypeDef *crc)
+{
+    while (crc->CTRL & CRC_CTRL_BUSY_M);
+}
+
+/**
+ * @brief Передать слова в регистр DATA32 через DMA и дождаться завершения.
+ */
+static HAL_StatusTypeDef HAL_CRC_WriteWordsDMA(CRC_HandleTypeDef *hcrc, const uint32_t *data, uint32_t count)
+{
+    DMA_ChannelHandleTypeDef *hdma_channel = hcrc->hdma_channel;
+
+    hdma_channel->ChannelInit.ReadMode = DMA_CHANNEL_MODE_MEMORY;
+    hdma_channel->ChannelInit.ReadInc = DMA_CHANNEL_INC_ENABLE;
+    hdma_channel->ChannelInit.ReadSize = DMA_CHANNEL_SIZE_WORD;
+    hdma_channel->ChannelInit.ReadBurstSize = 2;
+    hdma_channel->ChannelInit.ReadRequest = 0;
+    hdma_channel->ChannelInit.ReadAck = DMA_CHANNEL_ACK_DISABLE;
+
+    /* У блока CRC нет линии запроса DMA, регистр данных адресуется как память без инкремента */
+    hdma_channel->ChannelInit.WriteMode = DMA_CHANNEL_MODE_MEMORY;
+    hdma_channel->ChannelInit.WriteInc = DMA_CHANNEL_INC_DISABLE;
+    hdma_channel->ChannelInit.WriteSize = DMA_CHANNEL_SIZE_WORD;
+    hdma_channel->ChannelInit.WriteBurstSize = 2;
+    hdma_channel->ChannelInit.WriteRequest = 0;
+    hdma_channel->ChannelInit.WriteAck = DMA_CHANNEL_ACK_DISABLE;
+
+    HAL_DMA_Start(hdma_channel, (void *)data, (void *)&hcrc->Instance->DATA32, (count << 2) - 1);
+    while (!HAL_DMA_GetChannelReadyStatus(hdma_channel));
+
+    HAL_StatusTypeDef status = HAL_DMA_GetBusError(hdma_channel) ? HAL_ERROR : HAL_OK;
+    HAL_DMA_ClearChannelIrq(hdma_channel);
+
+    return status;
+}
+
+void HAL_CRC_Begin(CRC_HandleTypeDef *hcrc)
+{
     /* Запись начального значения Init */
     HAL_CRC_SetInit(hcrc);
-    
-    uint32_t i = 0; 
-    while (i < message_length)
+}
+
+HAL_StatusTypeDef HAL_CRC_Update(CRC_HandleTypeDef *hcrc, const void *data, uint32_t length)
+{
+    CRC_TypeDef *crc = hcrc->Instance;
+    const uint8_t *bytes = data;
+    HAL_StatusTypeDef status = HAL_OK;
+
+    /* Невыровненное начало */
+    uint32_t head = (-(uint32_t)bytes) & 3;
+    if (head > length)
     {
-        if (i + 3 < message_length)
-        {
-            hcrc->Instance->DATA32 = (message[i+3] << 0) | 
-                                     (message[i+2] << 8) |
-                                     (message[i+1] << 16) |
-                                     (message[i] << 24);
-            i += 4;
-        }
-        else if (i + 1 < message_length)
+        head = length;
+    }
+    HAL_CRC_WriteBytes(crc, bytes, head);
+    bytes += head;
+    length -= head;
+
+    uint32_t count = length >> 2;
+    if (count != 0)
+    {
+        /* 
+         * Слово, прочитанное из памяти, содержит байты в обратном порядке по сравнению со словом,
+         * собранным старшим байтом вперед. Вместо перестановки байтов каждого слова на время
+         * записи инвертируется перестановка байтов входных данных (TOT: 0 <-> 3, 1 <-> 2),
+         * так же слова записывает и DMA.
+         */
+        uint32_t ctrl = crc->CTRL;
+        HAL_CRC_WaitIdle(crc);
+        crc->CTRL = ctrl ^ CRC_CTRL_TOT_M;
+
+        const uint32_t *words = (const uint32_t *)bytes;
+        if ((hcrc->hdma_channel != NULL) && ((count << 2) >= CRC_DMA_THRESHOLD))
         {
-            hcrc->Instance->DATA16 = (message[i+1] << 0) | 
-                          (message[i] << 8);
-            i += 2;
+            status = HAL_CRC_WriteWordsDMA(hcrc, words, count);
         }
         else
         {
-            hcrc->Instance->DATA8 = message[i];
-            i += 1;
+            uint32_t n = count;
+            for (; n >= 4; n -= 4, words += 4)
+            {
+                crc->DATA32 = words[0];
+                crc->DATA32 = words[1];
+                crc->DATA32 = words[2];
+                crc->DATA32 = words[3];
+            }
+            while (n--)
+            {
+                crc->DATA32 = *words++;
+            }
         }
+
+        HAL_CRC_WaitIdle(crc);
+        crc->CTRL = ctrl;
+
+        bytes += count << 2;
+        length &= 3;
     }
+
+    /* Невыровненный конец */
+    HAL_CRC_WriteBytes(crc, bytes, length);
+
+    return status;
 }
 
-void HAL_CRC_WriteData32(CRC_HandleTypeDef *hcrc, uint32_t message[], uint32_t message_length)
+uint32_t HAL_CRC_Final(CRC_HandleTypeDef *hcrc)
 {
-    if(message_length > CRC_MAX_WORDS)
-    {
-        #ifdef MIK32_CRC_DEBUG
-        xprintf("Ошибка: переполнение буфера\n");
-        #endif
+    return HAL_CRC_ReadCRC(hcrc);
+}
 
-        return;
-    }
-    
-    
+void HAL_CRC_WriteData(CRC_HandleTypeDef *hcrc, uint8_t message[], uint32_t message_length)
+{
+    HAL_CRC_Begin(hcrc);
+    HAL_CRC_Update(hcrc, message, message_length);
+}
+
+void HAL_CRC_WriteData32(CRC_HandleTypeDef *hcrc, uint32_t message[], uint32_t message_length)
+{
     /* Запись начального значения Init */
     HAL_CRC_SetInit(hcrc);
     
-    uint32_t data;
     for(uint32_t i = 0; i < message_length; i++)
     {
-        data = message[i]; 
-        hcrc->Instance->DATA32 = data;
+        hcrc->Instance->DATA32 = message[i];
     }
 }
 
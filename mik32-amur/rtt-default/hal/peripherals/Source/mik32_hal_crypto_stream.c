@@ -0,0 +1,329 @@
+#include "mik32_hal_crypto_stream.h"
+
+#include <string.h>
+
+
+/**
+ * @brief Настройки канала DMA для обмена с регистром BLOCK по запросу блока Crypto.
+ */
+static void HAL_Crypto_Stream_ChannelInit(DMA_ChannelHandleTypeDef *hdma_channel, HAL_DMA_ChannelModeTypeDef ReadMode)
+{
+    HAL_DMA_ChannelModeTypeDef WriteMode = (ReadMode == DMA_CHANNEL_MODE_MEMORY) ? DMA_CHANNEL_MODE_PERIPHERY : DMA_CHANNEL_MODE_MEMORY;
+
+    hdma_channel->ChannelInit.ReadMode = ReadMode;
+    hdma_channel->ChannelInit.ReadInc = (ReadMode == DMA_CHANNEL_MODE_MEMORY) ? DMA_CHANNEL_INC_ENABLE : DMA_CHANNEL_INC_DISABLE;
+    hdma_channel->ChannelInit.ReadSize = DMA_CHANNEL_SIZE_WORD;
+    hdma_channel->ChannelInit.ReadBurstSize = 2;
+    hdma_channel->ChannelInit.ReadRequest = DMA_CHANNEL_CRYPTO_REQUEST;
+    hdma_channel->ChannelInit.ReadAck = DMA_CHANNEL_ACK_DISABLE;
+
+    hdma_channel->ChannelInit.WriteMode = WriteMode;
+    hdma_channel->ChannelInit.WriteInc = (WriteMode == DMA_CHANNEL_MODE_MEMORY) ? DMA_CHANNEL_INC_ENABLE : DMA_CHANNEL_INC_DISABLE;
+    hdma_channel->ChannelInit.WriteSize = DMA_CHANNEL_SIZE_WORD;
+    hdma_channel->ChannelInit.WriteBurstSize = 2;
+    hdma_channel->ChannelInit.WriteRequest = DMA_CHANNEL_CRYPTO_REQUEST;
+    hdma_channel->ChannelInit.WriteAck = DMA_CHANNEL_ACK_DISABLE;
+}
+
+/**
+ * @brief Преобразовать один блок процессором. Адреса in и out могут быть не выровнены и совпадать.
+ */
+static void HAL_Crypto_Stream_Block(HAL_Crypto_StreamTypeDef *stream, const uint8_t *in, uint8_t *out)
+{
+    CRYPTO_TypeDef *crypto = stream->hcrypto->Instance;
+    uint32_t words = stream->BlockSize >> 2;
+    uint32_t block[4];
+
+    memcpy(block, in, stream->BlockSize);
+    for (uint32_t i = 0; i < words; i++)
+    {
+        crypto->BLOCK = block[i];
+    }
+
+    HAL_Crypto_WaitReady(stream->hcrypto);
+
+    for (uint32_t i = 0; i < words; i++)
+    {
+        block[i] = crypto->BLOCK;
+    }
+    memcpy(out, block, stream->BlockSize);
+}
+
+/**
+ * @brief Запустить загрузку и выгрузку Length байт (кратно блоку) каналами DMA.
+ * Выгрузка отстает от загрузки на блок, поэтому in и out могут совпадать.
+ */
+static void HAL_Crypto_Stream_DMAStart(HAL_Crypto_StreamTypeDef *stream, const void *in, void *out, uint32_t Length)
+{
+    void *block = (void *)&stream->hcrypto->Instance->BLOCK;
+
+    HAL_DMA_Start(stream->hdma_in, (void *)in, block, Length - 1);
+    HAL_DMA_Start(stream->hdma_out, block, out, Length - 1);
+}
+
+static void HAL_Crypto_Stream_DMAWait(HAL_Crypto_StreamTypeDef *stream)
+{
+    while (!HAL_DMA_GetChannelReadyStatus(stream->hdma_out));
+}
+
+/**
+ * @brief Преобразовать целые блоки.
+ *
+ * Выровненные данные передаются DMA напрямую. Невыровненные - через две половины Buffer:
+ * DMA обрабатывает одну половину на месте, а процессор в это время выгружает из второй
+ * результат предыдущего участка и загружает в нее следующий.
+ */
+static void HAL_Crypto_Stream_Blocks(HAL_Crypto_StreamTypeDef *stream, const uint8_t *in, uint8_t *out, uint32_t Length)
+{
+    if (Length == 0)
+    {
+        return;
+    }
+
+    if (stream->hdma_in != NULL)
+    {
+        if ((((uint32_t)in | (uint32_t)out) & 3) == 0)
+        {
+            HAL_Crypto_Stream_DMAStart(stream, in, out, Length);
+            HAL_Crypto_Stream_DMAWait(stream);
+            return;
+        }
+
+        if (stream->HalfSize != 0)
+        {
+            uint8_t *half[2] = { (uint8_t *)stream->Buffer, (uint8_t *)stream->Buffer + stream->HalfSize };
+            uint32_t current = (Length < stream->HalfSize) ? Length : stream->HalfSize;
+            uint32_t previous = 0;
+            uint32_t k = 0;
+
+            memcpy(half[0], in, current);
+            while (current != 0)
+            {
+                HAL_Crypto_Stream_DMAStart(stream, half[k], half[k], current);
+                in += current;
+                Length -= current;
+
+                /* Пока DMA занят: результат предыдущего участка и данные следующего */
+                if (previous != 0)
+                {
+                    memcpy(out, half[k ^ 1], previous);
+                    out += previous;
+                }
+                uint32_t next = (Length < stream->HalfSize) ? Length : stream->HalfSize;
+                if (next != 0)
+                {
+                    memcpy(half[k ^ 1], in, next);
+                }
+
+                HAL_Crypto_Stream_DMAWait(stream);
+                previous = current;
+                current = next;
+                k ^= 1;
+            }
+            memcpy(out, half[k ^ 1], previous);
+            return;
+        }
+    }
+
+    for (; Length != 0; Length -= stream->BlockSize)
+    {
+        HAL_Crypto_Stream_Block(stream, in, out);
+        in += stream->BlockSize;
+        out += stream->BlockSize;
+    }
+}
+
+/**
+ * @brief Инициализация потока шифрования.
+ *
+ * Включает тактирование и настраивает блок Crypto по полям hcrypto (HAL_Crypto_Init), задает
+ * настройки каналов DMA.
+ *
+ * @param stream Поток.
+ * @param hcrypto Блок Crypto с заданными Instance, Algorithm, CipherMode, SwapMode и OrderMode.
+ * @param hdma_in Канал загрузки или NULL (обмен выполняет процессор).
+ * @param hdma_out Канал выгрузки. Используется вместе с hdma_in.
+ * @param Buffer Буфер в ОЗУ для невыровненных данных или NULL. Без буфера невыровненные данные
+ * передает процессор.
+ * @param BufferSize Размер Buffer в байтах. Каждая половина должна вмещать хотя бы один блок.
+ * @return HAL_ERROR при неверном алгоритме или режиме.
+ */
+HAL_StatusTypeDef HAL_Crypto_Stream_Init(HAL_Crypto_StreamTypeDef *stream, Crypto_HandleTypeDef *hcrypto,
+                                         DMA_ChannelHandleTypeDef *hdma_in, DMA_ChannelHandleTypeDef *hdma_out,
+                                         uint32_t *Buffer, uint32_t BufferSize)
+{
+    switch (hcrypto->Algorithm)
+    {
+    case CRYPTO_ALG_KUZNECHIK:
+        stream->BlockSize = CRYPTO_BLOCK_KUZNECHIK * 4;
+        break;
+    case CRYPTO_ALG_MAGMA:
+        stream->BlockSize = CRYPTO_BLOCK_MAGMA * 4;
+        break;
+    case CRYPTO_ALG_AES:
+        stream->BlockSize = CRYPTO_BLOCK_AES * 4;
+        break;
+    default:
+        return HAL_ERROR;
+    }
+
+    if (hcrypto->CipherMode > CRYPTO_CIPHER_MODE_CTR)
+    {
+        return HAL_ERROR;
+    }
+
+    stream->hcrypto = hcrypto;
+    stream->hdma_in = ((hdma_in != NULL) && (hdma_out != NULL)) ? hdma_in : NULL;
+    stream->hdma_out = hdma_out;
+    stream->Buffer = Buffer;
+    stream->BufferSize = BufferSize;
+    stream->HalfSize = (Buffer != NULL) ? ((BufferSize / 2) & ~(stream->BlockSize - 1)) : 0;
+    stream->PartLength = 0;
+
+    HAL_Crypto_Init(hcrypto);
+
+    if (stream->hdma_in != NULL)
+    {
+        HAL_Crypto_Stream_ChannelInit(stream->hdma_in, DMA_CHANNEL_MODE_MEMORY);
+        HAL_Crypto_Stream_ChannelInit(stream->hdma_out, DMA_CHANNEL_MODE_PERIPHERY);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Начать сообщение: загрузить ключ и вектор инициализации.
+ * @param stream Поток.
+ * @param Key Ключ (CRYPTO_KEY_* слов).
+ * @param InitVector Вектор инициализации (IV_LENGTH_* слов). В режиме ECB не используется, может быть NULL.
+ * @param Direction Шифрование или расшифрование.
+ */
+void HAL_Crypto_Stream_Start(HAL_Crypto_StreamTypeDef *stream, uint32_t Key[], uint32_t InitVector[],
+                             HAL_Crypto_StreamDirectionTypeDef Direction)
+{
+    Crypto_HandleTypeDef *hcrypto = stream->hcrypto;
+    uint32_t IvLength = 0;
+
+    if (hcrypto->CipherMode == CRYPTO_CIPHER_MODE_CBC)
+    {
+        IvLength = (hcrypto->Algorithm == CRYPTO_ALG_KUZNECHIK) ? IV_LENGTH_KUZNECHIK_CBC :
+                   (hcrypto->Algorithm == CRYPTO_ALG_MAGMA) ? IV_LENGTH_MAGMA_CBC : IV_LENGTH_AES_CBC;
+    }
+    else if (hcrypto->CipherMode == CRYPTO_CIPHER_MODE_CTR)
+    {
+        IvLength = (hcrypto->Algorithm == CRYPTO_ALG_KUZNECHIK) ? IV_LENGTH_KUZNECHIK_CTR :
+                   (hcrypto->Algorithm == CRYPTO_ALG_MAGMA) ? IV_LENGTH_MAGMA_CTR : IV_LENGTH_AES_CTR;
+    }
+
+    stream->PartLength = 0;
+
+    HAL_Crypto_CounterReset(hcrypto);
+    if (IvLength != 0)
+    {
+        HAL_Crypto_SetIV(hcrypto, InitVector, IvLength);
+    }
+    /* Ключ загружается в режиме шифрования, направление задается после него */
+    HAL_Crypto_SetKey(hcrypto, Key);
+    if (Direction == CRYPTO_STREAM_DECODE)
+    {
+        hcrypto->Instance->CONFIG |= CRYPTO_CONFIG_DECODE_M;
+    }
+}
+
+/**
+ * @brief Преобразовать очередную часть сообщения.
+ *
+ * В режиме CTR в Out записывается ровно Length байт. В режимах ECB и CBC записываются только
+ * завершенные блоки: неполный блок в конце сохраняется и выводится следующим вызовом, поэтому
+ * Out должен вмещать Length + (длина блока - 1) байт. Out может совпадать с In, если предыдущие
+ * вызовы не оставили неполного блока (например, длины кратны блоку).
+ *
+ * @param stream Поток.
+ * @param In Входные данные.
+ * @param Out Результат.
+ * @param Length Количество байт в In.
+ * @return Количество байт, записанных в Out.
+ */
+uint32_t HAL_Crypto_Stream_Update(HAL_Crypto_StreamTypeDef *stream, const void *In, void *Out, uint32_t Length)
+{
+    const uint8_t *in = In;
+    uint8_t *out = Out;
+    uint8_t *part = (uint8_t *)stream->Part;
+    uint32_t BlockSize = stream->BlockSize;
+    int ctr = (stream->hcrypto->CipherMode == CRYPTO_CIPHER_MODE_CTR);
+
+    if (stream->PartLength != 0)
+    {
+        if (ctr)
+        {
+            /* Остаток гаммы предыдущего вызова */
+            while ((Length != 0) && (stream->PartLength < BlockSize))
+            {
+                *out++ = *in++ ^ part[stream->PartLength++];
+                Length--;
+            }
+        }
+        else
+        {
+            uint32_t fill = BlockSize - stream->PartLength;
+            if (fill > Length)
+            {
+                fill = Length;
+            }
+            memcpy(part + stream->PartLength, in, fill);
+            stream->PartLength += fill;
+            in += fill;
+            Length -= fill;
+
+            if (stream->PartLength == BlockSize)
+            {
+                HAL_Crypto_Stream_Block(stream, part, out);
+                out += BlockSize;
+            }
+        }
+
+        if (stream->PartLength == BlockSize)
+        {
+            stream->PartLength = 0;
+        }
+    }
+
+    uint32_t tail = Length & (BlockSize - 1);
+    HAL_Crypto_Stream_Blocks(stream, in, out, Length - tail);
+    in += Length - tail;
+    out += Length - tail;
+
+    if (tail != 0)
+    {
+        memset(part, 0, BlockSize);
+        memcpy(part, in, tail);
+        if (ctr)
+        {
+            /* Дополнение нулями: в оставшейся части блока остается гамма для следующего вызова */
+            HAL_Crypto_Stream_Block(stream, part, part);
+            memcpy(out, part, tail);
+            out += tail;
+        }
+        stream->PartLength = tail;
+    }
+
+    return out - (uint8_t *)Out;
+}
+
+/**
+ * @brief Завершить сообщение.
+ * @return HAL_ERROR, если в режиме ECB или CBC длина сообщения не кратна блоку (неполный блок
+ * не зашифрован), иначе HAL_OK.
+ */
+HAL_StatusTypeDef HAL_Crypto_Stream_Finish(HAL_Crypto_StreamTypeDef *stream)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    if ((stream->PartLength != 0) && (stream->hcrypto->CipherMode != CRYPTO_CIPHER_MODE_CTR))
+    {
+        status = HAL_ERROR;
+    }
+    stream->PartLength = 0;
+
+    return status;
+}
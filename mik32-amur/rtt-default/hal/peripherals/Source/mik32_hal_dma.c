@@ -12,6 +12,11 @@ static uint32_t CFGWriteBuffer[4] = {0};
  */
 static uint32_t ConfigStatusWriteBuffer = 0;
 
+/** 
+ * @brief Цепочки пересылок, выполняющиеся на каналах. Используется обработчиком прерывания.
+ */
+static HAL_DMA_ChainTypeDef *volatile ChainByChannel[DMA_CHANNEL_COUNT] = {0};
+
 
 /**
  * @brief Включение тактирования модуля OTP.
@@ -104,7 +109,7 @@ void HAL_DMA_SetCurrentValue(DMA_InitTypeDef *hdma, HAL_DMA_CurrentValueTypeDef
  * @param hdma Указатель на структуру для инициализации DMA.
  * @param Permission Разрешение (#DMA_IRQ_ENABLE) или запрет (#DMA_IRQ_DISABLE) прерывания.
  */
-void HAL_DMA_GlobalIRQEnable(DMA_InitTypeDef *hdma, HAL_DMA_IRQTypeDef Permission)
+MIK32_RAMFUNC void HAL_DMA_GlobalIRQEnable(DMA_InitTypeDef *hdma, HAL_DMA_IRQTypeDef Permission)
 {
     ConfigStatusWriteBuffer &= ~DMA_CONFIG_GLOBAL_IRQ_ENA_M;
     ConfigStatusWriteBuffer |= Permission << DMA_CONFIG_GLOBAL_IRQ_ENA_S;
@@ -229,7 +234,7 @@ int HAL_DMA_GetBusError(DMA_ChannelHandleTypeDef* hdma_channel)
  * @brief Принудительная остановка работы канала.
  * @param hdma_channel Структура для инициализации канала DMA.
  */
-void HAL_DMA_ChannelDisable(DMA_ChannelHandleTypeDef *hdma_channel)
+MIK32_RAMFUNC void HAL_DMA_ChannelDisable(DMA_ChannelHandleTypeDef *hdma_channel)
 {
     uint32_t ChannelIndex = hdma_channel->ChannelInit.Channel;
     CFGWriteBuffer[ChannelIndex] &= ~(DMA_CH_CFG_ENABLE_M);
@@ -247,6 +252,26 @@ void HAL_DMA_ChannelEnable(DMA_ChannelHandleTypeDef *hdma_channel)
     hdma_channel->dma->Instance->CHANNELS[ChannelIndex].CFG = CFGWriteBuffer[ChannelIndex];
 }
 
+/**
+ * @brief Значение регистра CHx_CFG (без битов ENABLE и IRQ_EN) по настройкам канала.
+ */
+static MIK32_RAMFUNC uint32_t HAL_DMA_ChannelConfig(DMA_ChannelHandleTypeDef *hdma_channel)
+{
+    return (hdma_channel->ChannelInit.Priority << DMA_CH_CFG_PRIOR_S) 
+        | (hdma_channel->ChannelInit.ReadMode << DMA_CH_CFG_READ_MODE_S) 
+        | (hdma_channel->ChannelInit.ReadInc << DMA_CH_CFG_READ_INCREMENT_S) 
+        | (hdma_channel->ChannelInit.ReadSize << DMA_CH_CFG_READ_SIZE_S) 
+        | (hdma_channel->ChannelInit.ReadBurstSize << DMA_CH_CFG_READ_BURST_SIZE_S) 
+        | (hdma_channel->ChannelInit.ReadRequest << DMA_CH_CFG_READ_REQUEST_S) 
+        | (hdma_channel->ChannelInit.ReadAck << DMA_CH_CFG_READ_ACK_EN_S) 
+        | (hdma_channel->ChannelInit.WriteMode << DMA_CH_CFG_WRITE_MODE_S) 
+        | (hdma_channel->ChannelInit.WriteInc << DMA_CH_CFG_WRITE_INCREMENT_S) 
+        | (hdma_channel->ChannelInit.WriteSize << DMA_CH_CFG_WRITE_SIZE_S) 
+        | (hdma_channel->ChannelInit.WriteBurstSize << DMA_CH_CFG_WRITE_BURST_SIZE_S) 
+        | (hdma_channel->ChannelInit.WriteRequest << DMA_CH_CFG_WRITE_REQUEST_S) 
+        | (hdma_channel->ChannelInit.WriteAck << DMA_CH_CFG_WRITE_ACK_EN_S);
+}
+
 /**
  * @brief Запуск работы канала с настройками из структуры hdma_channel.
  * @param hdma_channel Структура для инициализации канала DMA.
@@ -255,7 +280,7 @@ void HAL_DMA_ChannelEnable(DMA_ChannelHandleTypeDef *hdma_channel)
  * @param Len Количество байт пересылки. Значение следует записывать на 1 меньше числа пересылаемых байт. 
  * Например, для отправки 8 байт значение Len = 7.
  */
-void HAL_DMA_Start(DMA_ChannelHandleTypeDef *hdma_channel, void* SRC, void* DST, uint32_t Len)
+MIK32_RAMFUNC void HAL_DMA_Start(DMA_ChannelHandleTypeDef *hdma_channel, void* SRC, void* DST, uint32_t Len)
 {
     uint32_t ChannelIndex = hdma_channel->ChannelInit.Channel;
 
@@ -264,21 +289,238 @@ void HAL_DMA_Start(DMA_ChannelHandleTypeDef *hdma_channel, void* SRC, void* DST,
     hdma_channel->dma->Instance->CHANNELS[ChannelIndex].LEN = Len;
 
     CFGWriteBuffer[ChannelIndex] &= DMA_CH_CFG_IRQ_EN_M;
-
-    CFGWriteBuffer[ChannelIndex] |= DMA_CH_CFG_ENABLE_M 
-        | (hdma_channel->ChannelInit.Priority << DMA_CH_CFG_PRIOR_S) 
-        | (hdma_channel->ChannelInit.ReadMode << DMA_CH_CFG_READ_MODE_S) 
-        | (hdma_channel->ChannelInit.ReadInc << DMA_CH_CFG_READ_INCREMENT_S) 
-        | (hdma_channel->ChannelInit.ReadSize << DMA_CH_CFG_READ_SIZE_S) 
-        | (hdma_channel->ChannelInit.ReadBurstSize << DMA_CH_CFG_READ_BURST_SIZE_S) 
-        | (hdma_channel->ChannelInit.ReadRequest << DMA_CH_CFG_READ_REQUEST_S) 
-        | (hdma_channel->ChannelInit.ReadAck << DMA_CH_CFG_READ_ACK_EN_S) 
-        | (hdma_channel->ChannelInit.WriteMode << DMA_CH_CFG_WRITE_MODE_S) 
-        | (hdma_channel->ChannelInit.WriteInc << DMA_CH_CFG_WRITE_INCREMENT_S) 
-        | (hdma_channel->ChannelInit.WriteSize << DMA_CH_CFG_WRITE_SIZE_S) 
-        | (hdma_channel->ChannelInit.WriteBurstSize << DMA_CH_CFG_WRITE_BURST_SIZE_S) 
-        | (hdma_channel->ChannelInit.WriteRequest << DMA_CH_CFG_WRITE_REQUEST_S) 
-        | (hdma_channel->ChannelInit.WriteAck << DMA_CH_CFG_WRITE_ACK_EN_S);
+    CFGWriteBuffer[ChannelIndex] |= DMA_CH_CFG_ENABLE_M | HAL_DMA_ChannelConfig(hdma_channel);
 
     hdma_channel->dma->Instance->CHANNELS[ChannelIndex].CFG = CFGWriteBuffer[ChannelIndex];
 }
+
+/**
+ * @brief Очистить флаг локального прерывания одного канала.
+ * 
+ * В отличие от HAL_DMA_ClearLocalIrq флаги остальных каналов не изменяются.
+ * @param hdma_channel Структура для инициализации канала DMA.
+ */
+MIK32_RAMFUNC void HAL_DMA_ClearChannelIrq(DMA_ChannelHandleTypeDef *hdma_channel)
+{
+    hdma_channel->dma->Instance->CONFIG_STATUS = ConfigStatusWriteBuffer | DMA_CONFIG_CLEAR_LOCAL_IRQ(hdma_channel->ChannelInit.Channel);
+}
+
+/**
+ * @brief Запустить на канале первый дескриптор с ненулевой длиной, начиная с desc.
+ * @return Запущенный дескриптор или NULL, если пересылать нечего.
+ */
+static MIK32_RAMFUNC HAL_DMA_DescriptorTypeDef *HAL_DMA_ChainLoad(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *desc)
+{
+    while ((desc != NULL) && (desc->Length == 0))
+    {
+        desc = desc->Next;
+    }
+
+    chain->Current = desc;
+    if (desc == NULL)
+    {
+        return NULL;
+    }
+
+    uint32_t ChannelIndex = chain->hdma_channel->ChannelInit.Channel;
+    DMA_CHANNEL_TypeDef *channel = &chain->hdma_channel->dma->Instance->CHANNELS[ChannelIndex];
+
+    channel->SRC = (uint32_t) desc->Source;
+    channel->DST = (uint32_t) desc->Destination;
+    channel->LEN = desc->Length - 1;
+    CFGWriteBuffer[ChannelIndex] = chain->Config;
+    channel->CFG = chain->Config;
+
+    return desc;
+}
+
+/**
+ * @brief Завершить цепочку и вызвать функцию завершения.
+ */
+static MIK32_RAMFUNC void HAL_DMA_ChainFinish(HAL_DMA_ChainTypeDef *chain, HAL_StatusTypeDef Status)
+{
+    uint32_t ChannelIndex = chain->hdma_channel->ChannelInit.Channel;
+
+    ChainByChannel[ChannelIndex] = NULL;
+    chain->Current = NULL;
+    chain->Tail = NULL;
+    chain->Status = Status;
+
+    if (chain->Callback != NULL)
+    {
+        chain->Callback(chain);
+    }
+}
+
+/**
+ * @brief Инициализация цепочки пересылок.
+ * 
+ * Настройки канала (ChannelInit) считываются при каждом запуске цепочки.
+ * @param chain Цепочка пересылок.
+ * @param hdma_channel Структура для инициализации канала DMA.
+ * @param Callback Функция завершения цепочки (вызывается в прерывании) или NULL.
+ */
+void HAL_DMA_ChainInit(HAL_DMA_ChainTypeDef *chain, DMA_ChannelHandleTypeDef *hdma_channel, HAL_DMA_ChainCallbackTypeDef Callback)
+{
+    chain->hdma_channel = hdma_channel;
+    chain->Callback = Callback;
+    chain->DescriptorCallback = NULL;
+    chain->Status = HAL_OK;
+    chain->Current = NULL;
+    chain->Tail = NULL;
+    chain->Config = 0;
+}
+
+/**
+ * @brief Запустить цепочку дескрипторов.
+ * 
+ * Каждый следующий дескриптор запускается из HAL_DMA_IRQHandler после завершения предыдущего,
+ * после последнего вызывается функция завершения. Включаются локальное прерывание канала
+ * и глобальное прерывание DMA, линию DMA в EPIC разрешает пользователь.
+ * Размещается в ОЗУ вместе с вызываемыми функциями: может вызываться из функции завершения.
+ * @param chain Цепочка пересылок.
+ * @param Head Первый дескриптор списка.
+ * @return HAL_BUSY, если цепочка еще выполняется, иначе HAL_OK.
+ */
+MIK32_RAMFUNC HAL_StatusTypeDef HAL_DMA_ChainStart(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *Head)
+{
+    uint32_t ChannelIndex = chain->hdma_channel->ChannelInit.Channel;
+
+    if (chain->Status == HAL_BUSY)
+    {
+        return HAL_BUSY;
+    }
+
+    chain->Config = DMA_CH_CFG_ENABLE_M | DMA_CH_CFG_IRQ_EN_M | HAL_DMA_ChannelConfig(chain->hdma_channel);
+    HAL_DMA_GlobalIRQEnable(chain->hdma_channel->dma, DMA_IRQ_ENABLE);
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    /* Список может быть кольцевым (Next последнего дескриптора указывает на Head) */
+    chain->Tail = Head;
+    while ((chain->Tail != NULL) && (chain->Tail->Next != NULL) && (chain->Tail->Next != Head))
+    {
+        chain->Tail = chain->Tail->Next;
+    }
+
+    chain->Status = HAL_BUSY;
+    ChainByChannel[ChannelIndex] = chain;
+    HAL_DMA_ClearChannelIrq(chain->hdma_channel);
+    if (HAL_DMA_ChainLoad(chain, Head) == NULL)
+    {
+        HAL_DMA_ChainFinish(chain, HAL_OK);
+    }
+
+    HAL_IRQ_Restore(irq_state);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Добавить дескрипторы в конец цепочки.
+ * 
+ * Если цепочка выполняется, новые дескрипторы будут запущены после текущих без остановки канала,
+ * иначе цепочка запускается заново. К выполняющейся кольцевой цепочке дескрипторы не добавляются.
+ * @param chain Цепочка пересылок.
+ * @param Head Первый дескриптор добавляемого списка.
+ * @return HAL_ERROR, если выполняющаяся цепочка кольцевая, иначе HAL_OK или результат HAL_DMA_ChainStart.
+ */
+HAL_StatusTypeDef HAL_DMA_ChainAppend(HAL_DMA_ChainTypeDef *chain, HAL_DMA_DescriptorTypeDef *Head)
+{
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if ((chain->Status == HAL_BUSY) && (chain->Tail != NULL))
+    {
+        /* У последнего дескриптора кольцевой цепочки Next не NULL: конца у нее нет */
+        if (chain->Tail->Next != NULL)
+        {
+            HAL_IRQ_Restore(irq_state);
+            return HAL_ERROR;
+        }
+
+        /* Добавляемый список тоже может быть кольцевым */
+        if (Head != NULL)
+        {
+            chain->Tail->Next = Head;
+            chain->Tail = Head;
+        }
+        while ((chain->Tail->Next != NULL) && (chain->Tail->Next != Head))
+        {
+            chain->Tail = chain->Tail->Next;
+        }
+        HAL_IRQ_Restore(irq_state);
+        return HAL_OK;
+    }
+
+    HAL_IRQ_Restore(irq_state);
+    return HAL_DMA_ChainStart(chain, Head);
+}
+
+/**
+ * @brief Остановить цепочку. Функция завершения не вызывается.
+ * @param chain Цепочка пересылок.
+ */
+MIK32_RAMFUNC void HAL_DMA_ChainAbort(HAL_DMA_ChainTypeDef *chain)
+{
+    uint32_t ChannelIndex = chain->hdma_channel->ChannelInit.Channel;
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if (ChainByChannel[ChannelIndex] == chain)
+    {
+        ChainByChannel[ChannelIndex] = NULL;
+        HAL_DMA_ChannelDisable(chain->hdma_channel);
+        HAL_DMA_ClearChannelIrq(chain->hdma_channel);
+    }
+    chain->Current = NULL;
+    chain->Tail = NULL;
+    chain->Status = HAL_OK;
+
+    HAL_IRQ_Restore(irq_state);
+}
+
+/**
+ * @brief Обработчик прерывания DMA для цепочек пересылок.
+ * 
+ * Для каждого канала с активной цепочкой и установленным флагом прерывания сбрасывает флаг
+ * этого канала, запускает следующий дескриптор и вызывает DescriptorCallback для завершенного.
+ * Флаги каналов без цепочек не изменяются.
+ * Вызывается из trap_handler или назначается обработчиком линии: HAL_EPIC_SetHandler(EPIC_LINE_DMA_S, HAL_DMA_IRQHandler).
+ */
+MIK32_RAMFUNC void HAL_DMA_IRQHandler()
+{
+    for (uint32_t ChannelIndex = 0; ChannelIndex < DMA_CHANNEL_COUNT; ChannelIndex++)
+    {
+        HAL_DMA_ChainTypeDef *chain = ChainByChannel[ChannelIndex];
+        if (chain == NULL)
+        {
+            continue;
+        }
+
+        uint32_t status = chain->hdma_channel->dma->Instance->CONFIG_STATUS;
+        if ((status & ((1 << ChannelIndex) << DMA_STATUS_CHANNEL_IRQ_S)) == 0)
+        {
+            continue;
+        }
+
+        HAL_DMA_ClearChannelIrq(chain->hdma_channel);
+
+        if (status & ((1 << ChannelIndex) << DMA_STATUS_CHANNEL_BUS_ERROR_S))
+        {
+            HAL_DMA_ChainFinish(chain, HAL_ERROR);
+            continue;
+        }
+
+        /* Следующий дескриптор запускается до вызова функций пользователя */
+        HAL_DMA_DescriptorTypeDef *done = chain->Current;
+        HAL_DMA_DescriptorTypeDef *next = HAL_DMA_ChainLoad(chain, done->Next);
+
+        if (chain->DescriptorCallback != NULL)
+        {
+            chain->DescriptorCallback(chain, done);
+        }
+        if (next == NULL)
+        {
+            HAL_DMA_ChainFinish(chain, HAL_OK);
+        }
+    }
+}
@@ -244,7 +244,7 @@ HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
     return HAL_OK;
 }
 
-void HAL_I2C_AutoEnd(I2C_HandleTypeDef *hi2c, HAL_I2C_AutoEndModeTypeDef AutoEnd)
+MIK32_RAMFUNC void HAL_I2C_AutoEnd(I2C_HandleTypeDef *hi2c, HAL_I2C_AutoEndModeTypeDef AutoEnd)
 {
     hi2c->Instance->CR2 &= ~I2C_CR2_AUTOEND_M;
     hi2c->Instance->CR2 |= AutoEnd << I2C_CR2_AUTOEND_S;
@@ -354,7 +354,7 @@ HAL_StatusTypeDef HAL_I2C_Master_WaitRXNE(I2C_HandleTypeDef *hi2c, uint32_t Time
     return HAL_TIMEOUT;
 }
 
-void HAL_I2C_Master_SlaveAddress(I2C_HandleTypeDef *hi2c, uint16_t SlaveAddress)
+MIK32_RAMFUNC void HAL_I2C_Master_SlaveAddress(I2C_HandleTypeDef *hi2c, uint16_t SlaveAddress)
 {
     hi2c->Instance->CR2 &= ~I2C_CR2_SADD_M;
 
@@ -387,7 +387,7 @@ HAL_StatusTypeDef HAL_I2C_WaitBusy(I2C_HandleTypeDef *hi2c, uint32_t Timeout)
     return HAL_OK;
 }
 
-void HAL_I2C_Master_NBYTES(I2C_HandleTypeDef *hi2c)
+MIK32_RAMFUNC void HAL_I2C_Master_NBYTES(I2C_HandleTypeDef *hi2c)
 {
     hi2c->Instance->CR2 &= ~I2C_CR2_NBYTES_M;
     /* Подготовка перед отправкой */
@@ -980,7 +980,7 @@ HAL_StatusTypeDef HAL_I2C_Slave_ReceiveSBC(I2C_HandleTypeDef *hi2c, uint8_t *pDa
     return error_code;
 }
 
-HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t SlaveAddress, uint8_t *pData, uint16_t DataSize)
+MIK32_RAMFUNC HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t SlaveAddress, uint8_t *pData, uint16_t DataSize)
 {
     HAL_StatusTypeDef error_code = HAL_OK;
 
@@ -1124,19 +1124,19 @@ HAL_StatusTypeDef HAL_I2C_Slave_Receive_DMA(I2C_HandleTypeDef *hi2c, uint8_t *pD
 }
 
 
-void HAL_I2C_InterruptDisable(I2C_HandleTypeDef *hi2c, uint32_t IntDisMask)
+MIK32_RAMFUNC void HAL_I2C_InterruptDisable(I2C_HandleTypeDef *hi2c, uint32_t IntDisMask)
 {
     IntDisMask &= I2C_INTMASK;
     hi2c->Instance->CR1 &= ~IntDisMask;
 }
 
-void HAL_I2C_InterruptEnable(I2C_HandleTypeDef *hi2c, uint32_t IntEnMask)
+MIK32_RAMFUNC void HAL_I2C_InterruptEnable(I2C_HandleTypeDef *hi2c, uint32_t IntEnMask)
 {
     IntEnMask &= I2C_INTMASK;
     hi2c->Instance->CR1 |= IntEnMask;
 }
 
-HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t SlaveAddress, uint8_t *pData, uint16_t DataSize)
+MIK32_RAMFUNC HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t SlaveAddress, uint8_t *pData, uint16_t DataSize)
 {
     HAL_StatusTypeDef error_code = HAL_OK;
     hi2c->State = HAL_I2C_STATE_BUSY;
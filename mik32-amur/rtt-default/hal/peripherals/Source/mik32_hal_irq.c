@@ -44,13 +44,138 @@ uint32_t HAL_EPIC_GetRawStatus()
 }
 
 
+/**
+ * @brief Обработчик по умолчанию для линий, обработчик которых не задан.
+ */
+void HAL_EPIC_DefaultHandler()
+{
+}
 
+/* Обработчики линий, задаваемые при сборке: достаточно определить функцию с тем же именем */
+void HAL_EPIC_TIMER32_0_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_UART_0_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_UART_1_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_SPI_0_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_SPI_1_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_GPIO_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_I2C_0_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_I2C_1_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_WDT_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_TIMER16_0_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_TIMER16_1_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_TIMER16_2_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_TIMER32_1_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_TIMER32_2_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_SPIFI_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_RTC_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_EEPROM_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_WDT_DOM3_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_WDT_SPIFI_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_WDT_EEPROM_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_DMA_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_FREQ_MON_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_PVD_AVCC_UNDER_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_PVD_AVCC_OVER_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_PVD_VCC_UNDER_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_PVD_VCC_OVER_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_BATTERY_NON_GOOD_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_BOR_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_TSENS_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_ADC_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_DAC0_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+void HAL_EPIC_DAC1_IRQHandler() __attribute__((weak, alias("HAL_EPIC_DefaultHandler")));
+
+/* Таблица обработчиков линий EPIC. Находится в ОЗУ, чтобы обработчики можно было менять во время работы */
+HAL_EPIC_HandlerTypeDef HAL_EPIC_Handlers[HAL_EPIC_LINE_COUNT] =
+{
+    HAL_EPIC_TIMER32_0_IRQHandler,               /* 0 */
+    HAL_EPIC_UART_0_IRQHandler,                  /* 1 */
+    HAL_EPIC_UART_1_IRQHandler,                  /* 2 */
+    HAL_EPIC_SPI_0_IRQHandler,                   /* 3 */
+    HAL_EPIC_SPI_1_IRQHandler,                   /* 4 */
+    HAL_EPIC_GPIO_IRQHandler,                    /* 5 */
+    HAL_EPIC_I2C_0_IRQHandler,                   /* 6 */
+    HAL_EPIC_I2C_1_IRQHandler,                   /* 7 */
+    HAL_EPIC_WDT_IRQHandler,                     /* 8 */
+    HAL_EPIC_TIMER16_0_IRQHandler,               /* 9 */
+    HAL_EPIC_TIMER16_1_IRQHandler,               /* 10 */
+    HAL_EPIC_TIMER16_2_IRQHandler,               /* 11 */
+    HAL_EPIC_TIMER32_1_IRQHandler,               /* 12 */
+    HAL_EPIC_TIMER32_2_IRQHandler,               /* 13 */
+    HAL_EPIC_SPIFI_IRQHandler,                   /* 14 */
+    HAL_EPIC_RTC_IRQHandler,                     /* 15 */
+    HAL_EPIC_EEPROM_IRQHandler,                  /* 16 */
+    HAL_EPIC_WDT_DOM3_IRQHandler,                /* 17 */
+    HAL_EPIC_WDT_SPIFI_IRQHandler,               /* 18 */
+    HAL_EPIC_WDT_EEPROM_IRQHandler,              /* 19 */
+    HAL_EPIC_DMA_IRQHandler,                     /* 20 */
+    HAL_EPIC_FREQ_MON_IRQHandler,                /* 21 */
+    HAL_EPIC_PVD_AVCC_UNDER_IRQHandler,          /* 22 */
+    HAL_EPIC_PVD_AVCC_OVER_IRQHandler,           /* 23 */
+    HAL_EPIC_PVD_VCC_UNDER_IRQHandler,           /* 24 */
+    HAL_EPIC_PVD_VCC_OVER_IRQHandler,            /* 25 */
+    HAL_EPIC_BATTERY_NON_GOOD_IRQHandler,        /* 26 */
+    HAL_EPIC_BOR_IRQHandler,                     /* 27 */
+    HAL_EPIC_TSENS_IRQHandler,                   /* 28 */
+    HAL_EPIC_ADC_IRQHandler,                     /* 29 */
+    HAL_EPIC_DAC0_IRQHandler,                    /* 30 */
+    HAL_EPIC_DAC1_IRQHandler,                    /* 31 */
+};
+
+/* Таблица для HAL_IRQ_Ctz. Находится в ОЗУ, так как используется из обработчиков прерываний */
+uint8_t HAL_IRQ_CtzTable[32] =
+{
+    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+/**
+ * @brief Задать обработчик линии прерывания во время работы программы.
+ *
+ * @param Line Номер линии (EPIC_LINE_*_S).
+ * @param Handler Обработчик. NULL - восстановить обработчик по умолчанию.
+ */
+void HAL_EPIC_SetHandler(uint8_t Line, HAL_EPIC_HandlerTypeDef Handler)
+{
+    if (Line >= HAL_EPIC_LINE_COUNT)
+    {
+        return;
+    }
+
+    if (Handler == 0)
+    {
+        Handler = HAL_EPIC_DefaultHandler;
+    }
+    HAL_EPIC_Handlers[Line] = Handler;
+}
 
+/**
+ * @brief Обработать все активные линии EPIC.
+ *
+ * Статус читается один раз, линии обходятся от младшей к старшей по числу младших нулей.
+ * После обработки сбрасываются флаги только обслуженных линий, поэтому запросы, пришедшие
+ * во время обработки, не теряются. Линия без обработчика маскируется, чтобы прерывание
+ * по уровню не повторялось бесконечно.
+ */
+MIK32_RAMFUNC void HAL_EPIC_Dispatch()
+{
+    uint32_t status = EPIC->STATUS;
+    uint32_t serviced = status;
 
+    while (status)
+    {
+        uint32_t line = HAL_IRQ_Ctz(status);
+        HAL_EPIC_HandlerTypeDef handler = HAL_EPIC_Handlers[line];
 
+        if (handler == HAL_EPIC_DefaultHandler)
+        {
+            EPIC->MASK_LEVEL_CLEAR = 1UL << line;
+            EPIC->MASK_EDGE_CLEAR = 1UL << line;
+        }
+        handler();
 
+        status &= status - 1;
+    }
 
-
-
-
-
+    EPIC->CLEAR = serviced;
+}
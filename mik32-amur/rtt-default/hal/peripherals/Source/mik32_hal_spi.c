@@ -571,6 +571,138 @@ error:
     return error_code;
 }
 
+/**
+ * @brief Обмен с заполнением буферов TX и RX (общая часть HAL_SPI_*Burst).
+ *
+ * В буфер TX записывается столько байт, чтобы переданных, но не считанных байт было не больше
+ * @ref SPI_BUFFER_SIZE: тогда ни буфер TX, ни буфер RX не переполняются и флаг TX_FIFO_FULL
+ * проверять не нужно. Пока в буфере RX есть данные, они считываются подряд, и после каждого
+ * считанного байта в буфер TX дописывается следующий, так что передача идет без пауз.
+ *
+ * Функция встраивается в HAL_SPI_ExchangeBurst, HAL_SPI_TransmitBurst и HAL_SPI_ReceiveBurst,
+ * проверки TransmitBytes и ReceiveBytes на NULL при этом исключаются компилятором.
+ */
+static inline __attribute__((always_inline)) HAL_StatusTypeDef HAL_SPI_Burst(SPI_HandleTypeDef *hspi, const uint8_t *TransmitBytes,
+                                                                             uint8_t *ReceiveBytes, uint32_t DataSize, uint8_t FillByte,
+                                                                             uint32_t Timeout)
+{
+    SPI_TypeDef *spi = hspi->Instance;
+    uint32_t tx_offset = 0;
+    uint32_t rx_offset = 0;
+    uint32_t timeout_counter = Timeout;
+    uint32_t status = 0;
+    HAL_StatusTypeDef error_code = HAL_OK;
+
+    hspi->ErrorCode = HAL_SPI_ERROR_NONE;
+
+    /* Заполнение буфера TX до начала обмена */
+    while ((tx_offset < DataSize) && (tx_offset < SPI_BUFFER_SIZE))
+    {
+        spi->TXDATA = (TransmitBytes != NULL) ? TransmitBytes[tx_offset] : FillByte;
+        tx_offset++;
+    }
+
+    /* Включить SPI если выключено */
+    if (!(spi->ENABLE & SPI_ENABLE_M))
+    {
+        __HAL_SPI_ENABLE(hspi);
+    }
+
+    while (rx_offset < DataSize)
+    {
+        status = spi->INT_STATUS;
+        if (status & SPI_INT_STATUS_RX_FIFO_NOT_EMPTY_M)
+        {
+            uint8_t data = spi->RXDATA;
+            if (ReceiveBytes != NULL)
+            {
+                ReceiveBytes[rx_offset] = data;
+            }
+            rx_offset++;
+
+            if (tx_offset < DataSize)
+            {
+                spi->TXDATA = (TransmitBytes != NULL) ? TransmitBytes[tx_offset] : FillByte;
+                tx_offset++;
+            }
+            timeout_counter = Timeout;
+        }
+        else
+        {
+            if (status & (SPI_INT_STATUS_RX_OVERFLOW_M | SPI_INT_STATUS_MODE_FAIL_M))
+            {
+                hspi->ErrorCode |= (status & SPI_INT_STATUS_RX_OVERFLOW_M) ? HAL_SPI_ERROR_OVR : HAL_SPI_ERROR_MODF;
+                error_code = HAL_ERROR;
+                break;
+            }
+            if (timeout_counter-- == 0)
+            {
+                error_code = HAL_TIMEOUT;
+                break;
+            }
+        }
+    }
+
+    if ((error_code != HAL_OK) || !(spi->CONFIG & SPI_CONFIG_MANUAL_CS_M))
+    {
+        __HAL_SPI_DISABLE(hspi);
+        spi->ENABLE |= SPI_ENABLE_CLEAR_TX_FIFO_M | SPI_ENABLE_CLEAR_RX_FIFO_M; /* Очистка буферов RX и TX */
+    }
+
+    status = spi->INT_STATUS; /* Очистка флагов ошибок чтением */
+    (void) status;
+
+    return error_code;
+}
+
+/**
+ * @brief Запустить передачу и прием данных с непрерывным заполнением буферов TX и RX.
+ *
+ * В отличие от @ref HAL_SPI_Exchange, в буфере TX находится до @ref SPI_BUFFER_SIZE байт, а принятые
+ * байты считываются подряд, поэтому между байтами на шине нет пауз. Пороговое значение ThresholdTX
+ * не используется.
+ * @param hspi указатель на структуру SPI_HandleTypeDef, которая содержит
+ *                  информацию о конфигурации для модуля SPI.
+ * @param TransmitBytes указатель на буфер передаваемых данных.
+ * @param ReceiveBytes указатель на буфер считываемых данных.
+ * @param DataSize число байт для отправки и приема.
+ * @param Timeout число опросов флагов без принятого байта до ошибки HAL_TIMEOUT.
+ * @return Статус HAL.
+ */
+HAL_StatusTypeDef HAL_SPI_ExchangeBurst(SPI_HandleTypeDef *hspi, uint8_t TransmitBytes[], uint8_t ReceiveBytes[], uint32_t DataSize, uint32_t Timeout)
+{
+    return HAL_SPI_Burst(hspi, TransmitBytes, ReceiveBytes, DataSize, 0, Timeout);
+}
+
+/**
+ * @brief Передать данные без сохранения принятых байт (см. @ref HAL_SPI_ExchangeBurst).
+ * @param hspi указатель на структуру SPI_HandleTypeDef, которая содержит
+ *                  информацию о конфигурации для модуля SPI.
+ * @param TransmitBytes указатель на буфер передаваемых данных.
+ * @param DataSize число байт для отправки.
+ * @param Timeout число опросов флагов без принятого байта до ошибки HAL_TIMEOUT.
+ * @return Статус HAL.
+ */
+HAL_StatusTypeDef HAL_SPI_TransmitBurst(SPI_HandleTypeDef *hspi, const uint8_t TransmitBytes[], uint32_t DataSize, uint32_t Timeout)
+{
+    return HAL_SPI_Burst(hspi, TransmitBytes, NULL, DataSize, 0, Timeout);
+}
+
+/**
+ * @brief Принять данные, передавая байт заполнения (см. @ref HAL_SPI_ExchangeBurst).
+ * @param hspi указатель на структуру SPI_HandleTypeDef, которая содержит
+ *                  информацию о конфигурации для модуля SPI.
+ * @param ReceiveBytes указатель на буфер считываемых данных.
+ * @param DataSize число байт для приема.
+ * @param FillByte передаваемый байт (обычно 0xFF или 0x00).
+ * @param Timeout число опросов флагов без принятого байта до ошибки HAL_TIMEOUT.
+ * @return Статус HAL.
+ */
+HAL_StatusTypeDef HAL_SPI_ReceiveBurst(SPI_HandleTypeDef *hspi, uint8_t ReceiveBytes[], uint32_t DataSize, uint8_t FillByte, uint32_t Timeout)
+{
+    return HAL_SPI_Burst(hspi, NULL, ReceiveBytes, DataSize, FillByte, Timeout);
+}
+
 /**
  * @brief Запустить передачу и прием данных с прерываниями.
  * 
@@ -0,0 +1,193 @@
+#include "mik32_hal_spi_queue.h"
+
+
+static MIK32_RAMFUNC void HAL_SPI_Queue_Start(HAL_SPI_QueueTypeDef *queue);
+
+/**
+ * @brief Завершение приема обмена (вызывается из HAL_DMA_IRQHandler).
+ * Снимает CS, запускает следующий обмен очереди и вызывает функцию завершения выполненного.
+ */
+static MIK32_RAMFUNC void HAL_SPI_Queue_RxDone(HAL_DMA_ChainTypeDef *chain)
+{
+    HAL_SPI_QueueTypeDef *queue = (HAL_SPI_QueueTypeDef *)chain->Context;
+    SPI_HandleTypeDef *hspi = queue->hspi;
+    HAL_SPI_TransferTypeDef *done = queue->Head;
+    HAL_StatusTypeDef status = chain->Status;
+
+    /* Передача завершилась раньше приема; цепочка сбрасывается, даже если ее прерывание еще не обработано */
+    HAL_DMA_ChainAbort(&queue->TxChain);
+
+    hspi->Instance->CONFIG |= SPI_CONFIG_CS_NONE_M;
+    __HAL_SPI_DISABLE(hspi);
+
+    queue->Head = done->Next;
+    if (queue->Head != NULL)
+    {
+        HAL_SPI_Queue_Start(queue);
+    }
+
+    done->Next = NULL;
+    done->Status = status;
+    if (done->Callback != NULL)
+    {
+        done->Callback(done);
+    }
+}
+
+/**
+ * @brief Настроить шину под устройство обмена queue->Head и запустить обмен.
+ */
+static MIK32_RAMFUNC void HAL_SPI_Queue_Start(HAL_SPI_QueueTypeDef *queue)
+{
+    SPI_TypeDef *spi = queue->hspi->Instance;
+    HAL_SPI_TransferTypeDef *transfer = queue->Head;
+    HAL_SPI_QueueDeviceTypeDef *device = transfer->Device;
+
+    /* Настройки устройства при неактивном CS */
+    spi->CONFIG = (spi->CONFIG & ~(SPI_CONFIG_BAUD_RATE_DIV_M | SPI_CONFIG_CLK_PH_M | SPI_CONFIG_CLK_POL_M | SPI_CONFIG_CS_M))
+                | (device->BaudRateDiv << SPI_CONFIG_BAUD_RATE_DIV_S)
+                | (device->CLKPhase << SPI_CONFIG_CLK_PH_S)
+                | (device->CLKPolarity << SPI_CONFIG_CLK_POL_S)
+                | SPI_CONFIG_CS_NONE_M;
+    spi->ENABLE = SPI_ENABLE_CLEAR_TX_FIFO_M | SPI_ENABLE_CLEAR_RX_FIFO_M;
+    volatile uint32_t unused = spi->INT_STATUS; /* Очистка флагов ошибок чтением */
+    (void) unused;
+
+    spi->CONFIG = (spi->CONFIG & ~SPI_CONFIG_CS_M) | (device->ChipSelect << SPI_CONFIG_CS_S);
+    spi->ENABLE = SPI_ENABLE_M;
+
+    queue->RxDesc.Destination = (transfer->RxData != NULL) ? transfer->RxData : &queue->Sink;
+    queue->RxDesc.Length = transfer->Length;
+    queue->hdma_rx->ChannelInit.WriteInc = (transfer->RxData != NULL) ? DMA_CHANNEL_INC_ENABLE : DMA_CHANNEL_INC_DISABLE;
+
+    queue->Fill = transfer->FillByte;
+    queue->TxDesc.Source = (transfer->TxData != NULL) ? (void *)transfer->TxData : &queue->Fill;
+    queue->TxDesc.Length = transfer->Length;
+    queue->hdma_tx->ChannelInit.ReadInc = (transfer->TxData != NULL) ? DMA_CHANNEL_INC_ENABLE : DMA_CHANNEL_INC_DISABLE;
+
+    /* Прием запускается первым, чтобы не потерять ни одного байта */
+    HAL_DMA_ChainStart(&queue->RxChain, &queue->RxDesc);
+    HAL_DMA_ChainStart(&queue->TxChain, &queue->TxDesc);
+}
+
+/**
+ * @brief Настройки канала DMA для обмена с регистром SPI по запросу SPI.
+ */
+static void HAL_SPI_Queue_ChannelInit(DMA_ChannelHandleTypeDef *hdma_channel, HAL_DMA_ChannelModeTypeDef ReadMode,
+                                      HAL_DMA_ChannelRequestTypeDef Request)
+{
+    DMA_ChannelInitHandleTypeDef *init = &hdma_channel->ChannelInit;
+
+    init->ReadMode = ReadMode;
+    init->ReadInc = (ReadMode == DMA_CHANNEL_MODE_MEMORY) ? DMA_CHANNEL_INC_ENABLE : DMA_CHANNEL_INC_DISABLE;
+    init->ReadSize = DMA_CHANNEL_SIZE_BYTE;
+    init->ReadBurstSize = 0;
+    init->ReadRequest = Request;
+    init->ReadAck = DMA_CHANNEL_ACK_DISABLE;
+    init->WriteMode = (ReadMode == DMA_CHANNEL_MODE_MEMORY) ? DMA_CHANNEL_MODE_PERIPHERY : DMA_CHANNEL_MODE_MEMORY;
+    init->WriteInc = (ReadMode == DMA_CHANNEL_MODE_MEMORY) ? DMA_CHANNEL_INC_DISABLE : DMA_CHANNEL_INC_ENABLE;
+    init->WriteSize = DMA_CHANNEL_SIZE_BYTE;
+    init->WriteBurstSize = 0;
+    init->WriteRequest = Request;
+    init->WriteAck = DMA_CHANNEL_ACK_DISABLE;
+}
+
+/**
+ * @brief Инициализация очереди обменов.
+ *
+ * Настраивает SPI ведущим с ручным управлением CS (HAL_SPI_Init по полям hspi->Init; поля
+ * BaudRateDiv, CLKPhase, CLKPolarity и ChipSelect далее задаются устройством каждого обмена),
+ * задает настройки каналов DMA, назначает обработчик линии DMA в EPIC и разрешает прерывания.
+ *
+ * @param queue Очередь.
+ * @param hspi SPI с заданными Instance и Init.Decoder.
+ * @param hdma_tx Канал передачи.
+ * @param hdma_rx Канал приема.
+ * @return HAL_ERROR при неверном SPI.
+ */
+HAL_StatusTypeDef HAL_SPI_Queue_Init(HAL_SPI_QueueTypeDef *queue, SPI_HandleTypeDef *hspi,
+                                     DMA_ChannelHandleTypeDef *hdma_tx, DMA_ChannelHandleTypeDef *hdma_rx)
+{
+    HAL_DMA_ChannelRequestTypeDef request;
+
+    if (hspi->Instance == SPI_0)
+    {
+        request = DMA_CHANNEL_SPI_0_REQUEST;
+    }
+    else if (hspi->Instance == SPI_1)
+    {
+        request = DMA_CHANNEL_SPI_1_REQUEST;
+    }
+    else
+    {
+        return HAL_ERROR;
+    }
+
+    queue->hspi = hspi;
+    queue->hdma_tx = hdma_tx;
+    queue->hdma_rx = hdma_rx;
+    queue->Head = NULL;
+    queue->Tail = NULL;
+
+    hspi->Init.SPI_Mode = HAL_SPI_MODE_MASTER;
+    hspi->Init.ManualCS = SPI_MANUALCS_ON;
+    if (HAL_SPI_Init(hspi) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    HAL_SPI_Queue_ChannelInit(hdma_tx, DMA_CHANNEL_MODE_MEMORY, request);
+    HAL_SPI_Queue_ChannelInit(hdma_rx, DMA_CHANNEL_MODE_PERIPHERY, request);
+
+    queue->TxDesc.Destination = (void *)&hspi->Instance->TXDATA;
+    queue->TxDesc.Next = NULL;
+    queue->RxDesc.Source = (void *)&hspi->Instance->RXDATA;
+    queue->RxDesc.Next = NULL;
+
+    HAL_DMA_ChainInit(&queue->TxChain, hdma_tx, NULL);
+    HAL_DMA_ChainInit(&queue->RxChain, hdma_rx, HAL_SPI_Queue_RxDone);
+    queue->RxChain.Context = queue;
+
+    HAL_EPIC_SetHandler(EPIC_LINE_DMA_S, HAL_DMA_IRQHandler);
+    HAL_EPIC_MaskLevelSet(HAL_EPIC_DMA_MASK);
+    HAL_IRQ_EnableInterrupts();
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Поставить обмен в очередь без ожидания.
+ * Обмен запускается сразу, если очередь пуста. Можно вызывать из функции завершения.
+ * @param queue Очередь.
+ * @param transfer Обмен. Поле Status задается здесь, до завершения (transfer->Status != HAL_BUSY)
+ * структуру изменять и повторно ставить в очередь нельзя.
+ * @return HAL_ERROR при нулевой длине или отсутствии устройства.
+ */
+HAL_StatusTypeDef HAL_SPI_Queue_Submit(HAL_SPI_QueueTypeDef *queue, HAL_SPI_TransferTypeDef *transfer)
+{
+    if ((transfer->Length == 0) || (transfer->Device == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    transfer->Status = HAL_BUSY;
+    transfer->Next = NULL;
+
+    if (queue->Head == NULL)
+    {
+        queue->Head = transfer;
+        queue->Tail = transfer;
+        HAL_SPI_Queue_Start(queue);
+    }
+    else
+    {
+        queue->Tail->Next = transfer;
+        queue->Tail = transfer;
+    }
+
+    HAL_IRQ_Restore(irq_state);
+
+    return HAL_OK;
+}
@@ -24,15 +24,26 @@ void HAL_SPIFI_MemoryMode_Init(SPIFI_MemoryModeConfig_HandleTypeDef *spifi)
 
     spifi->Instance->STAT |= SPIFI_CONFIG_STAT_RESET_M;
     spifi->Instance->CLIMIT = spifi->CacheLimit; // Граница кеширования
-    spifi->Instance->CTRL &= ~SPIFI_CONFIG_CTRL_CSHIGH(0xF); // Количество дополнительных тактов между операциями снижаем с 15 по умолчанию (итого 16,5) до 0 (итого 1,5).
+
+    uint32_t ctrl = spifi->Instance->CTRL & ~(SPIFI_CONFIG_CTRL_CSHIGH_M | SPIFI_CONFIG_CTRL_CACHE_EN_M |
+                                              SPIFI_CONFIG_CTRL_D_CACHE_DIS_M | SPIFI_CONFIG_CTRL_PREFETCH_DIS_M);
+    ctrl |= SPIFI_CONFIG_CTRL_CSHIGH(spifi->CSHigh); // По умолчанию 0 дополнительных тактов между операциями (итого 1,5) вместо 15 (итого 16,5)
     if (spifi->CacheEnable)
     {
-        spifi->Instance->CTRL |= SPIFI_CONFIG_CTRL_CACHE_EN_M;
+        ctrl |= SPIFI_CONFIG_CTRL_CACHE_EN_M;
     }
-    else
+    if (spifi->DataCache == SPIFI_DATA_CACHE_DISABLE)
     {
-        spifi->Instance->CTRL &= ~SPIFI_CONFIG_CTRL_CACHE_EN_M;
+        ctrl |= SPIFI_CONFIG_CTRL_D_CACHE_DIS_M;
     }
+    if (spifi->Prefetch == SPIFI_PREFETCH_DISABLE)
+    {
+        ctrl |= SPIFI_CONFIG_CTRL_PREFETCH_DIS_M;
+    }
+    spifi->Instance->CTRL = ctrl;
+
+    // Промежуточные данные (биты режима непрерывного чтения) выдаются с каждой командой
+    spifi->Instance->IDATA = spifi->Command.InterimData;
 
     // Настройка команды чтения
     spifi->Instance->MCMD = ((spifi->Command.InterimLength << SPIFI_CONFIG_MCMD_INTLEN_S) |
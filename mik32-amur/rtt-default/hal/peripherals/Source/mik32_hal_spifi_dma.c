@@ -0,0 +1,349 @@
+#include "mik32_hal_spifi_dma.h"
+
+
+/* SPIFI один, команда выполняется только одна */
+static HAL_SPIFI_DMA_TypeDef *volatile ActiveEngine = NULL;
+
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_Issue(HAL_SPIFI_DMA_TypeDef *engine);
+
+/**
+ * @brief Передать байты процессором в направлении команды.
+ */
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_CopyBytes(HAL_SPIFI_DMA_TypeDef *engine, uint8_t *data, uint32_t length)
+{
+    SPIFI_CONFIG_TypeDef *spifi = engine->spifi->Instance;
+
+    if (engine->Command.Command & SPIFI_CONFIG_CMD_DOUT_M)
+    {
+        while (length-- != 0)
+        {
+            spifi->DATA8 = *data++;
+        }
+    }
+    else
+    {
+        while (length-- != 0)
+        {
+            *data++ = spifi->DATA8;
+        }
+    }
+}
+
+/**
+ * @brief Завершить команду: восстановить CTRL и вызвать функцию завершения.
+ */
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_Finish(HAL_SPIFI_DMA_TypeDef *engine, HAL_StatusTypeDef status)
+{
+    engine->spifi->Instance->CTRL = engine->SavedControl;
+    ActiveEngine = NULL;
+    engine->Status = status;
+
+    if (engine->Callback != NULL)
+    {
+        engine->Callback(engine);
+    }
+}
+
+/**
+ * @brief Остановить DMA и прервать команду сбросом SPIFI. Функция завершения не вызывается.
+ */
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_Cancel(HAL_SPIFI_DMA_TypeDef *engine, HAL_StatusTypeDef status)
+{
+    HAL_DMA_ChainAbort(&engine->Chain);
+
+    HAL_SPIFI_Reset(engine->spifi);
+    for (uint32_t timeout = HAL_SPIFI_TIMEOUT; (timeout != 0) && !HAL_SPIFI_IsReady(engine->spifi); timeout--)
+    {
+    }
+
+    engine->spifi->Instance->CTRL = engine->SavedControl;
+    engine->spifi->Instance->STAT |= SPIFI_CONFIG_STAT_INTRQ_M;
+    ActiveEngine = NULL;
+    engine->Status = status;
+}
+
+/**
+ * @brief Учесть событие текущей команды (завершение DMA или прерывание SPIFI).
+ * После обоих событий запускается следующая команда, опрос статуса или команда завершается.
+ */
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_Event(HAL_SPIFI_DMA_TypeDef *engine)
+{
+    if (--engine->Pending != 0)
+    {
+        return;
+    }
+
+    if (engine->Remaining != 0)
+    {
+        HAL_SPIFI_DMA_Issue(engine);
+    }
+    else if ((engine->Command.PollCommand != 0) && !engine->Polling)
+    {
+        SPIFI_CONFIG_TypeDef *spifi = engine->spifi->Instance;
+
+        engine->Polling = 1;
+        engine->Pending = 1;
+        spifi->CMD = engine->Command.PollCommand;
+    }
+    else
+    {
+        HAL_SPIFI_DMA_Finish(engine, HAL_OK);
+    }
+}
+
+/**
+ * @brief Завершение пересылки DMA (вызывается из HAL_DMA_IRQHandler).
+ * Передает остаток команды короче слова процессором.
+ */
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_Done(HAL_DMA_ChainTypeDef *chain)
+{
+    HAL_SPIFI_DMA_TypeDef *engine = (HAL_SPIFI_DMA_TypeDef *)chain->Context;
+
+    if (chain->Status != HAL_OK)
+    {
+        HAL_SPIFI_DMA_Cancel(engine, HAL_ERROR);
+        if (engine->Callback != NULL)
+        {
+            engine->Callback(engine);
+        }
+        return;
+    }
+
+    HAL_SPIFI_DMA_CopyBytes(engine, engine->Tail, engine->TailLength);
+    HAL_SPIFI_DMA_Event(engine);
+}
+
+/**
+ * @brief Обработчик прерывания SPIFI (завершение команды).
+ */
+MIK32_RAMFUNC void HAL_SPIFI_DMA_IRQHandler()
+{
+    HAL_SPIFI_DMA_TypeDef *engine = ActiveEngine;
+
+    SPIFI_CONFIG->STAT |= SPIFI_CONFIG_STAT_INTRQ_M;
+
+    if (engine == NULL)
+    {
+        return;
+    }
+
+    if (engine->Polling)
+    {
+        /* Последний принятый статус остается в DATA и должен быть прочитан */
+        uint32_t poll = engine->Command.PollCommand;
+        uint8_t status = SPIFI_CONFIG->DATA8;
+        uint32_t bit = (status >> ((poll & SPIFI_CONFIG_CMD_POLL_INDEX_M) >> SPIFI_CONFIG_CMD_POLL_INDEX_S)) & 1;
+        uint32_t required = (poll & SPIFI_CONFIG_CMD_POLL_REQUIRED_VALUE_M) != 0;
+
+        HAL_SPIFI_DMA_Finish(engine, (bit == required) ? HAL_OK : HAL_ERROR);
+        return;
+    }
+
+    HAL_SPIFI_DMA_Event(engine);
+}
+
+/**
+ * @brief Запустить очередную команду не длиннее HAL_SPIFI_DMA_COMMAND_MAX байт.
+ *
+ * Байты до выровненного адреса передаются процессором сразу, целые слова - через DMA,
+ * остаток - процессором после DMA. Если слов нет, все байты передаются сразу.
+ */
+static MIK32_RAMFUNC void HAL_SPIFI_DMA_Issue(HAL_SPIFI_DMA_TypeDef *engine)
+{
+    SPIFI_CONFIG_TypeDef *spifi = engine->spifi->Instance;
+    uint8_t *data = engine->Data;
+    uint32_t length = (engine->Remaining < HAL_SPIFI_DMA_COMMAND_MAX) ? engine->Remaining : HAL_SPIFI_DMA_COMMAND_MAX;
+    uint32_t head = (0u - (uint32_t)data) & 3;
+
+    if (head > length)
+    {
+        head = length;
+    }
+    uint32_t words = (length - head) & ~3u;
+
+    engine->Tail = data + head + words;
+    engine->TailLength = length - head - words;
+    engine->Pending = (words != 0) ? 2 : 1;
+
+    spifi->STAT |= SPIFI_CONFIG_STAT_INTRQ_M;
+    spifi->ADDR = engine->Address;
+    spifi->IDATA = engine->Command.InterimData;
+    spifi->CMD = engine->Command.Command | SPIFI_CONFIG_CMD_DATALEN(length);
+
+    engine->Data += length;
+    engine->Address += length;
+    engine->Remaining -= length;
+
+    HAL_SPIFI_DMA_CopyBytes(engine, data, head);
+
+    if (words != 0)
+    {
+        if (engine->Command.Command & SPIFI_CONFIG_CMD_DOUT_M)
+        {
+            engine->Desc.Source = data + head;
+        }
+        else
+        {
+            engine->Desc.Destination = data + head;
+        }
+        engine->Desc.Length = words;
+        HAL_DMA_ChainStart(&engine->Chain, &engine->Desc);
+    }
+    else
+    {
+        HAL_SPIFI_DMA_CopyBytes(engine, engine->Tail, engine->TailLength);
+    }
+}
+
+/**
+ * @brief Инициализация.
+ *
+ * Назначает обработчики линий SPIFI и DMA в EPIC и разрешает прерывания. SPIFI должен быть
+ * инициализирован (HAL_SPIFI_MspInit, HAL_SPIFI_Reset) и находиться в периферийном режиме.
+ *
+ * @param engine Команды с DMA.
+ * @param spifi SPIFI.
+ * @param hdma_channel Канал DMA. Направление и разрядность пересылки задаются при каждом запуске.
+ * @param Callback Функция завершения (вызывается в прерывании) или NULL.
+ */
+void HAL_SPIFI_DMA_Init(HAL_SPIFI_DMA_TypeDef *engine, SPIFI_HandleTypeDef *spifi, DMA_ChannelHandleTypeDef *hdma_channel,
+                        HAL_SPIFI_DMA_CallbackTypeDef Callback)
+{
+    DMA_ChannelInitHandleTypeDef *init = &hdma_channel->ChannelInit;
+
+    engine->spifi = spifi;
+    engine->hdma_channel = hdma_channel;
+    engine->Callback = Callback;
+    engine->Status = HAL_OK;
+
+    init->ReadSize = DMA_CHANNEL_SIZE_WORD;
+    init->ReadBurstSize = 2;
+    init->ReadRequest = DMA_CHANNEL_SPIFI_REQUEST;
+    init->ReadAck = DMA_CHANNEL_ACK_DISABLE;
+    init->WriteSize = DMA_CHANNEL_SIZE_WORD;
+    init->WriteBurstSize = 2;
+    init->WriteRequest = DMA_CHANNEL_SPIFI_REQUEST;
+    init->WriteAck = DMA_CHANNEL_ACK_DISABLE;
+
+    engine->Desc.Next = NULL;
+    HAL_DMA_ChainInit(&engine->Chain, hdma_channel, HAL_SPIFI_DMA_Done);
+    engine->Chain.Context = engine;
+
+    HAL_EPIC_SetHandler(EPIC_LINE_SPIFI_S, HAL_SPIFI_DMA_IRQHandler);
+    HAL_EPIC_SetHandler(EPIC_LINE_DMA_S, HAL_DMA_IRQHandler);
+    HAL_EPIC_MaskLevelSet(HAL_EPIC_SPIFI_MASK | HAL_EPIC_DMA_MASK);
+    HAL_IRQ_EnableInterrupts();
+}
+
+/**
+ * @brief Запустить команду без ожидания.
+ *
+ * @param engine Команды с DMA.
+ * @param command Команда. Копируется, после возврата структуру можно изменять.
+ * @param Address Адрес первой команды.
+ * @param Data Буфер данных. Должен существовать до завершения команды.
+ * @param Length Число байт данных. 0 - команда без данных (например, стирание с опросом статуса).
+ * @return HAL_BUSY, если SPIFI занят командой; HAL_ERROR, если команду записи или команду
+ * без адреса длиннее HAL_SPIFI_DMA_COMMAND_MAX нельзя разбить или не задан буфер.
+ */
+HAL_StatusTypeDef HAL_SPIFI_DMA_Start(HAL_SPIFI_DMA_TypeDef *engine, const HAL_SPIFI_DMA_CommandTypeDef *command,
+                                      uint32_t Address, void *Data, uint32_t Length)
+{
+    SPIFI_CONFIG_TypeDef *spifi = engine->spifi->Instance;
+    DMA_ChannelInitHandleTypeDef *init = &engine->hdma_channel->ChannelInit;
+    uint32_t frame = (command->Command & SPIFI_CONFIG_CMD_FRAMEFORM_M) >> SPIFI_CONFIG_CMD_FRAMEFORM_S;
+
+    if ((Length != 0) && (Data == NULL))
+    {
+        return HAL_ERROR;
+    }
+    if ((Length > HAL_SPIFI_DMA_COMMAND_MAX) &&
+        ((command->Command & SPIFI_CONFIG_CMD_DOUT_M) || (frame == SPIFI_CONFIG_CMD_FRAMEFORM_OPCODE_NOADDR)))
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if (ActiveEngine != NULL)
+    {
+        HAL_IRQ_Restore(irq_state);
+        return HAL_BUSY;
+    }
+
+    ActiveEngine = engine;
+    engine->Status = HAL_BUSY;
+    engine->Command = *command;
+    engine->Address = Address;
+    engine->Data = (uint8_t *)Data;
+    engine->Remaining = Length;
+    engine->Polling = 0;
+
+    if (command->Command & SPIFI_CONFIG_CMD_DOUT_M)
+    {
+        init->ReadMode = DMA_CHANNEL_MODE_MEMORY;
+        init->ReadInc = DMA_CHANNEL_INC_ENABLE;
+        init->WriteMode = DMA_CHANNEL_MODE_PERIPHERY;
+        init->WriteInc = DMA_CHANNEL_INC_DISABLE;
+        engine->Desc.Destination = (void *)&spifi->DATA32;
+    }
+    else
+    {
+        init->ReadMode = DMA_CHANNEL_MODE_PERIPHERY;
+        init->ReadInc = DMA_CHANNEL_INC_DISABLE;
+        init->WriteMode = DMA_CHANNEL_MODE_MEMORY;
+        init->WriteInc = DMA_CHANNEL_INC_ENABLE;
+        engine->Desc.Source = (void *)&spifi->DATA32;
+    }
+
+    /* Флаг предыдущей команды сбрасывается до разрешения прерывания */
+    spifi->STAT |= SPIFI_CONFIG_STAT_INTRQ_M;
+    engine->SavedControl = spifi->CTRL;
+    spifi->CTRL = (engine->SavedControl & ~SPIFI_CONFIG_CTRL_DUAL_M) | SPIFI_CONFIG_CTRL_DMAEN_M | SPIFI_CONFIG_CTRL_INTEN_M | command->Control;
+
+    HAL_SPIFI_DMA_Issue(engine);
+
+    HAL_IRQ_Restore(irq_state);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Прервать команду. Функция завершения не вызывается, Status = HAL_ERROR.
+ */
+void HAL_SPIFI_DMA_Abort(HAL_SPIFI_DMA_TypeDef *engine)
+{
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if (ActiveEngine == engine)
+    {
+        HAL_SPIFI_DMA_Cancel(engine, HAL_ERROR);
+    }
+
+    HAL_IRQ_Restore(irq_state);
+}
+
+/**
+ * @brief Ожидать завершения команды.
+ * @param engine Команды с DMA.
+ * @param Timeout Число циклов ожидания. По истечении команда прерывается.
+ * @return Состояние завершенной команды или HAL_TIMEOUT.
+ */
+HAL_StatusTypeDef HAL_SPIFI_DMA_Wait(HAL_SPIFI_DMA_TypeDef *engine, uint32_t Timeout)
+{
+    while (engine->Status == HAL_BUSY)
+    {
+        if (Timeout-- == 0)
+        {
+            uint32_t irq_state = HAL_IRQ_SaveDisable();
+            if (ActiveEngine == engine)
+            {
+                HAL_SPIFI_DMA_Cancel(engine, HAL_TIMEOUT);
+            }
+            HAL_IRQ_Restore(irq_state);
+            break;
+        }
+    }
+
+    return engine->Status;
+}
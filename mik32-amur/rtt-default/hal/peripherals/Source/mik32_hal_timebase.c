@@ -0,0 +1,36 @@
+#include "mik32_hal_timebase.h"
+
+
+/**
+ * @brief Вычислить коэффициент пересчета num/den в виде Mult / 2^Shift.
+ *
+ * Выбирается максимальный сдвиг, при котором множитель помещается в 32 бита, то есть
+ * относительная погрешность пересчета не превышает 2^-31. Функция использует 64-битное
+ * деление и предназначена для вызова только при инициализации или смене частоты.
+ *
+ * @param scale Указатель на коэффициент пересчета.
+ * @param num Числитель (например, 1000000 * делитель частоты таймера для микросекунд).
+ * @param den Знаменатель (например, частота тактирования таймера).
+ */
+void HAL_TimeBase_ScaleInit(HAL_TimeBase_ScaleTypeDef *scale, uint64_t num, uint64_t den)
+{
+    uint8_t shift = 0;
+
+    if (den == 0)
+    {
+        scale->Mult = 0;
+        scale->Shift = 0;
+        return;
+    }
+
+    while ((shift < 63) && !(num >> 63) && (((num << 1) / den) <= 0xFFFFFFFFULL))
+    {
+        num <<= 1;
+        shift++;
+    }
+
+    uint64_t mult = num / den;
+    /* Отношение больше 2^32 не представимо, ограничиваем множитель */
+    scale->Mult = (mult > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)mult;
+    scale->Shift = shift;
+}
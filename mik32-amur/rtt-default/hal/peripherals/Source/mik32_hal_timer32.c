@@ -510,15 +510,51 @@ struct
     uint32_t presc;
     /* Timer prescaler */
     uint32_t pt;
+    /* Коэффициенты пересчета тиков в мкс и мс */
+    HAL_TimeBase_ScaleTypeDef us;
+    HAL_TimeBase_ScaleTypeDef ms;
+    /* Коэффициенты пересчета мкс и мс в тики (для задержек) */
+    HAL_TimeBase_ScaleTypeDef us_to_ticks;
+    HAL_TimeBase_ScaleTypeDef ms_to_ticks;
+    /* Старшее слово 64-р счетчика тиков (число учтенных переполнений) */
+    uint32_t ticks_high;
+    /* Точка отсчета после последней смены частоты тактирования */
+    uint64_t epoch_ticks;
+    uint64_t epoch_us;
+    uint64_t epoch_ms;
 } HAL_Time_TIM32_Handler;
 
+/**
+ * @brief Пересчет коэффициентов системных часов по текущим делителям и частоте тактирования.
+ * Единственное место, где используется деление.
+*/
+static void HAL_Time_TIM32_ScaleUpdate()
+{
+    uint32_t clock_freq = HAL_PCC_GetSysClockFreq();
+    /* TIMER32_0 тактируется от APB_M, а не APB_P */
+    if (HAL_Time_TIM32_Handler.tim32.Instance == TIMER32_0)
+        HAL_Time_TIM32_Handler.presc = (PM->DIV_AHB+1) * (PM->DIV_APB_M+1);
+    else
+        HAL_Time_TIM32_Handler.presc = (PM->DIV_AHB+1) * (PM->DIV_APB_P+1);
+
+    /* Частота счета таймера: clock_freq / (presc * pt) */
+    uint32_t div = HAL_Time_TIM32_Handler.presc * HAL_Time_TIM32_Handler.pt;
+    HAL_TimeBase_ScaleInit(&HAL_Time_TIM32_Handler.us, 1000000ULL * div, clock_freq);
+    HAL_TimeBase_ScaleInit(&HAL_Time_TIM32_Handler.ms, 1000ULL * div, clock_freq);
+    /* Частота не делится заранее: clock_freq / div теряет дробную часть */
+    HAL_TimeBase_ScaleInit(&HAL_Time_TIM32_Handler.us_to_ticks, clock_freq, 1000000ULL * div);
+    HAL_TimeBase_ScaleInit(&HAL_Time_TIM32_Handler.ms_to_ticks, clock_freq, 1000ULL * div);
+}
+
 /**
  * @brief Инициализация 32-р таймера для работы в качестве системных часов.
- * После инициализации системного таймера не рекомендуется изменять делители тактовой частоты AHB, APB_P и APB_M
- * Если делители такта были изменены или микроконтроллер переключился на другой источник тактирования, необходимо
- * переинициализаровать таймер. При этом прежнее значение системного времени потеряется
+ * Коэффициенты пересчета тиков в единицы времени вычисляются один раз при инициализации, поэтому
+ * функции чтения времени не используют деление. Если делители такта были изменены или микроконтроллер
+ * переключился на другой источник тактирования, необходимо вызвать HAL_Time_TIM32_ClockUpdate.
  * 
- * Время переполнения системных часов зависит от частоты тактирования. Минимальное время переполнения - 4295с
+ * Аппаратный счетчик расширяется до 64 бит по флагу переполнения таймера. Прерывание переполнения
+ * разрешается в таймере и в EPIC, обработчиком линии назначается HAL_Time_TIM32_IRQHandler
+ * (при HAL_EPIC_Dispatch в trap_handler), глобальные прерывания разрешает приложение.
  * 
  * @param timer  TIMER32_0, TIMER32_1 или TIMER32_2
 */
@@ -542,48 +578,144 @@ void HAL_Time_TIM32_Init(TIMER32_TypeDef* timer)
     }
     HAL_Time_TIM32_Handler.tim32.Clock.Prescaler = HAL_Time_TIM32_Handler.pt-1;
 
+    HAL_Time_TIM32_Handler.ticks_high = 0;
+    HAL_Time_TIM32_Handler.epoch_ticks = 0;
+    HAL_Time_TIM32_Handler.epoch_us = 0;
+    HAL_Time_TIM32_Handler.epoch_ms = 0;
+    HAL_Time_TIM32_ScaleUpdate();
+
     HAL_Time_TIM32_Handler.tim32.CountMode = TIMER32_COUNTMODE_FORWARD;
     HAL_Timer32_Init(&HAL_Time_TIM32_Handler.tim32);
     HAL_Timer32_Value_Clear(&HAL_Time_TIM32_Handler.tim32);
-    HAL_Timer32_Start(&HAL_Time_TIM32_Handler.tim32);
+    timer->INT_CLEAR = TIMER32_INT_OVERFLOW_M;
+
+    switch ((uint32_t)timer)
+    {
+        case (uint32_t)TIMER32_0:
+            HAL_EPIC_SetHandler(EPIC_LINE_TIMER32_0_S, HAL_Time_TIM32_IRQHandler);
+            HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER32_0_MASK);
+            break;
+        case (uint32_t)TIMER32_1:
+            HAL_EPIC_SetHandler(EPIC_LINE_TIMER32_1_S, HAL_Time_TIM32_IRQHandler);
+            HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER32_1_MASK);
+            break;
+        case (uint32_t)TIMER32_2:
+            HAL_EPIC_SetHandler(EPIC_LINE_TIMER32_2_S, HAL_Time_TIM32_IRQHandler);
+            HAL_EPIC_MaskLevelSet(HAL_EPIC_TIMER32_2_MASK);
+            break;
+    }
+    HAL_Timer32_Base_Start_IT(&HAL_Time_TIM32_Handler.tim32);
 }
 
 /**
- * @brief Системное время в микросекундах, используется 32-р таймер в качестве системных часов
+ * @brief Пересчет коэффициентов системных часов после смены частоты тактирования или делителей AHB, APB_P и APB_M.
+ * В отличие от повторной инициализации, накопленное системное время сохраняется.
 */
-uint32_t HAL_Time_TIM32_Micros()
+void HAL_Time_TIM32_ClockUpdate()
 {
-    uint32_t clock_freq = HAL_PCC_GetSysClockFreq();
-    return (uint32_t)((uint64_t)HAL_Time_TIM32_Handler.tim32.Instance->VALUE * (1000000UL *
-        HAL_Time_TIM32_Handler.presc * HAL_Time_TIM32_Handler.pt) / clock_freq);
+    uint64_t ticks = HAL_Time_TIM32_Ticks64();
+    uint64_t delta = ticks - HAL_Time_TIM32_Handler.epoch_ticks;
+
+    HAL_Time_TIM32_Handler.epoch_us += HAL_TimeBase_Scale64(&HAL_Time_TIM32_Handler.us, delta);
+    HAL_Time_TIM32_Handler.epoch_ms += HAL_TimeBase_Scale64(&HAL_Time_TIM32_Handler.ms, delta);
+    HAL_Time_TIM32_Handler.epoch_ticks = ticks;
+    HAL_Time_TIM32_ScaleUpdate();
+}
+
+/**
+ * @brief 64-р монотонный счетчик тиков 32-р таймера.
+ * Необработанное переполнение учитывается по флагу таймера и сбрасывается здесь же, поэтому
+ * функция может вызываться и из основной программы, и из обработчика прерывания.
+*/
+MIK32_RAMFUNC uint64_t HAL_Time_TIM32_Ticks64()
+{
+    TIMER32_TypeDef *timer = HAL_Time_TIM32_Handler.tim32.Instance;
+    uint32_t pending, value;
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    /* Флаг, установленный между чтением флага и счетчика, вызывает повтор */
+    do
+    {
+        pending = timer->INT_FLAGS & TIMER32_INT_OVERFLOW_M;
+        value = timer->VALUE;
+    } while (pending != (timer->INT_FLAGS & TIMER32_INT_OVERFLOW_M));
+
+    /* Флаг мог установиться до перехода счетчика через 0: переполнение учитывается после перехода */
+    if (pending && (value != 0xFFFFFFFF))
+    {
+        HAL_Time_TIM32_Handler.ticks_high++;
+        timer->INT_CLEAR = TIMER32_INT_OVERFLOW_M;
+    }
+    uint32_t high = HAL_Time_TIM32_Handler.ticks_high;
+
+    HAL_IRQ_Restore(irq_state);
+
+    return ((uint64_t)high << 32) | value;
+}
+
+/**
+ * @brief Обработчик прерывания переполнения таймера системных часов.
+ * Назначается в EPIC в HAL_Time_TIM32_Init; при собственном обработчике линии его необходимо
+ * вызывать оттуда.
+*/
+MIK32_RAMFUNC void HAL_Time_TIM32_IRQHandler()
+{
+    (void)HAL_Time_TIM32_Ticks64();
+}
+
+/**
+ * @brief 64-р системное время в микросекундах, используется 32-р таймер в качестве системных часов
+*/
+MIK32_RAMFUNC uint64_t HAL_Time_TIM32_Micros64()
+{
+    uint64_t delta = HAL_Time_TIM32_Ticks64() - HAL_Time_TIM32_Handler.epoch_ticks;
+    return HAL_Time_TIM32_Handler.epoch_us + HAL_TimeBase_Scale64(&HAL_Time_TIM32_Handler.us, delta);
+}
+
+/**
+ * @brief 64-р системное время в миллисекундах, используется 32-р таймер в качестве системных часов
+*/
+MIK32_RAMFUNC uint64_t HAL_Time_TIM32_Millis64()
+{
+    uint64_t delta = HAL_Time_TIM32_Ticks64() - HAL_Time_TIM32_Handler.epoch_ticks;
+    return HAL_Time_TIM32_Handler.epoch_ms + HAL_TimeBase_Scale64(&HAL_Time_TIM32_Handler.ms, delta);
 }
 
 /**
  * @brief Системное время в микросекундах, используется 32-р таймер в качестве системных часов
 */
-uint32_t HAL_Time_TIM32_Millis()
+MIK32_RAMFUNC uint32_t HAL_Time_TIM32_Micros()
 {
-    uint32_t clock_freq = HAL_PCC_GetSysClockFreq();
-    return (uint32_t)((uint64_t)HAL_Time_TIM32_Handler.tim32.Instance->VALUE * (1000UL *
-        HAL_Time_TIM32_Handler.presc * HAL_Time_TIM32_Handler.pt) / clock_freq);
+    return (uint32_t)HAL_Time_TIM32_Micros64();
+}
+
+/**
+ * @brief Системное время в миллисекундах, используется 32-р таймер в качестве системных часов
+*/
+MIK32_RAMFUNC uint32_t HAL_Time_TIM32_Millis()
+{
+    return (uint32_t)HAL_Time_TIM32_Millis64();
 }
 
 /**
  * @brief Функция задержки в микросекундах, используется 32-р таймер в качестве системных часов
+ * Длительность задержки переводится в тики один раз, в цикле ожидания пересчет не выполняется.
 */
 void HAL_Time_TIM32_DelayUs(uint32_t time_us)
 {
-    uint32_t metka;
-    metka = HAL_Time_TIM32_Micros();
-    while ((HAL_Time_TIM32_Micros() - metka) < time_us);
+    uint64_t metka;
+    metka = HAL_Time_TIM32_Ticks64() + HAL_TimeBase_Scale32(&HAL_Time_TIM32_Handler.us_to_ticks, time_us);
+    while (HAL_Time_TIM32_Ticks64() < metka);
 }
 
 /**
  * @brief Функция задержки в миллисекундах, используется 32-р таймер в качестве системных часов
+ * Длительность задержки переводится в тики один раз, в цикле ожидания пересчет не выполняется.
 */
 void HAL_Time_TIM32_DelayMs(uint32_t time_ms)
 {
-    uint32_t metka;
-    metka = HAL_Time_TIM32_Millis();
-    while ((HAL_Time_TIM32_Millis() - metka) < time_ms);
+    uint64_t metka;
+    metka = HAL_Time_TIM32_Ticks64() + HAL_TimeBase_Scale32(&HAL_Time_TIM32_Handler.ms_to_ticks, time_ms);
+    while (HAL_Time_TIM32_Ticks64() < metka);
 }
@@ -0,0 +1,358 @@
+#include "mik32_hal_usart_stream.h"
+#include "mik32_hal_pcc.h"
+#include "power_manager.h"
+#include "uart_lib.h"
+
+#include <string.h>
+
+#define USART_STREAM_RX_ERRORS      (UART_FLAGS_ORE_M | UART_FLAGS_FE_M | UART_FLAGS_NF_M | UART_FLAGS_PE_M)
+
+/* Поток каждого USART для обработчиков линий EPIC */
+static HAL_USART_StreamTypeDef *StreamByInstance[2];
+
+
+static MIK32_RAMFUNC void HAL_USART_Stream_TxStart(HAL_USART_StreamTypeDef *stream);
+
+static MIK32_RAMFUNC void HAL_USART_Stream_UART0_IRQHandler()
+{
+    HAL_USART_Stream_IRQHandler(StreamByInstance[0]);
+}
+
+static MIK32_RAMFUNC void HAL_USART_Stream_UART1_IRQHandler()
+{
+    HAL_USART_Stream_IRQHandler(StreamByInstance[1]);
+}
+
+/**
+ * @brief Завершение участка передачи (вызывается из HAL_DMA_IRQHandler).
+ * Освобождает переданный участок и запускает следующий, если в буфере есть данные.
+ */
+static MIK32_RAMFUNC void HAL_USART_Stream_TxDone(HAL_DMA_ChainTypeDef *chain)
+{
+    HAL_USART_StreamTypeDef *stream = chain->Context;
+
+    stream->TxTail += stream->TxChunk + stream->TxSkip;
+    stream->TxChunk = 0;
+    stream->TxSkip = 0;
+    HAL_USART_Stream_TxStart(stream);
+}
+
+/**
+ * @brief Запустить передачу непрерывного участка буфера, если DMA свободен.
+ * Вызывается при запрещенных прерываниях или из прерывания DMA.
+ */
+static MIK32_RAMFUNC void HAL_USART_Stream_TxStart(HAL_USART_StreamTypeDef *stream)
+{
+    if (HAL_DMA_ChainIsBusy(&stream->TxChain))
+    {
+        return;
+    }
+
+    uint32_t pending = stream->TxHead - stream->TxTail;
+    if (pending == 0)
+    {
+        return;
+    }
+
+    /* Участок не переходит через конец буфера */
+    uint32_t offset = stream->TxTail & stream->TxMask;
+    uint32_t chunk = stream->TxMask + 1 - offset;
+    if (chunk > pending)
+    {
+        chunk = pending;
+    }
+
+    stream->TxChunk = chunk;
+    stream->TxDesc.Source = stream->TxBuffer + offset;
+    stream->TxDesc.Destination = (void *)&stream->Instance->TXDATA;
+    stream->TxDesc.Length = chunk;
+    stream->TxDesc.Next = NULL;
+    HAL_DMA_ChainStart(&stream->TxChain, &stream->TxDesc);
+}
+
+/**
+ * @brief Инициализация буферизированного потока USART.
+ *
+ * Включает тактирование и выводы USART (HAL_UART_MspInit), настраивает формат 8N1, прием по
+ * прерываниям RXNE и IDLE, передачу по запросу DMA. Назначает обработчики линий UART и DMA в
+ * EPIC и разрешает прерывания. Частота APB_P должна быть задана до вызова функции.
+ *
+ * @param stream Поток. Поле hdma_channel (dma и ChannelInit.Channel) задается заранее.
+ * @param Instance UART_0 или UART_1.
+ * @param Baudrate Скорость обмена, бод.
+ * @param RxBuffer Буфер приема.
+ * @param RxSize Размер буфера приема, степень двойки.
+ * @param TxBuffer Буфер передачи.
+ * @param TxSize Размер буфера передачи, степень двойки.
+ * @return HAL_ERROR при неверных параметрах (в том числе Instance), иначе HAL_OK.
+ */
+HAL_StatusTypeDef HAL_USART_Stream_Init(HAL_USART_StreamTypeDef *stream, UART_TypeDef *Instance, uint32_t Baudrate,
+                                        uint8_t *RxBuffer, uint32_t RxSize, uint8_t *TxBuffer, uint32_t TxSize)
+{
+    uint32_t index = (Instance == UART_0) ? 0 : 1;
+
+    if (((Instance != UART_0) && (Instance != UART_1)) ||
+        (Baudrate == 0) || (RxSize == 0) || (RxSize & (RxSize - 1)) || (TxSize == 0) || (TxSize & (TxSize - 1)))
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t apb_p = HAL_PCC_GetSysClockFreq() / ((PM->DIV_AHB + 1) * (PM->DIV_APB_P + 1));
+    uint32_t divider = (apb_p + Baudrate / 2) / Baudrate;
+
+    stream->Instance = Instance;
+    stream->RxOverruns = 0;
+    stream->RxErrors = 0;
+    stream->RxBuffer = RxBuffer;
+    stream->RxMask = RxSize - 1;
+    stream->RxHead = 0;
+    stream->RxTail = 0;
+    stream->TxBuffer = TxBuffer;
+    stream->TxMask = TxSize - 1;
+    stream->TxHead = 0;
+    stream->TxTail = 0;
+    stream->TxChunk = 0;
+    stream->TxSkip = 0;
+
+    /* Память -> TXDATA по запросу USART */
+    DMA_ChannelInitHandleTypeDef *init = &stream->hdma_channel->ChannelInit;
+    HAL_DMA_ChannelRequestTypeDef request = index ? DMA_CHANNEL_USART_1_REQUEST : DMA_CHANNEL_USART_0_REQUEST;
+    init->ReadMode = DMA_CHANNEL_MODE_MEMORY;
+    init->ReadInc = DMA_CHANNEL_INC_ENABLE;
+    init->ReadSize = DMA_CHANNEL_SIZE_BYTE;
+    init->ReadBurstSize = 0;
+    init->ReadRequest = request;
+    init->ReadAck = DMA_CHANNEL_ACK_DISABLE;
+    init->WriteMode = DMA_CHANNEL_MODE_PERIPHERY;
+    init->WriteInc = DMA_CHANNEL_INC_DISABLE;
+    init->WriteSize = DMA_CHANNEL_SIZE_BYTE;
+    init->WriteBurstSize = 0;
+    init->WriteRequest = request;
+    init->WriteAck = DMA_CHANNEL_ACK_ENABLE;
+
+    HAL_DMA_ChainInit(&stream->TxChain, stream->hdma_channel, HAL_USART_Stream_TxDone);
+    stream->TxChain.Context = stream;
+
+    if (!UART_Init(Instance, divider,
+                   UART_CONTROL1_TE_M | UART_CONTROL1_RE_M | UART_CONTROL1_RXNEIE_M | UART_CONTROL1_IDLEIE_M,
+                   0, UART_CONTROL3_DMAT_M | UART_CONTROL3_EIE_M, XPRINTF_NO))
+    {
+        return HAL_ERROR;
+    }
+
+    StreamByInstance[index] = stream;
+    if (index == 0)
+    {
+        HAL_EPIC_SetHandler(EPIC_LINE_UART_0_S, HAL_USART_Stream_UART0_IRQHandler);
+        HAL_EPIC_MaskLevelSet(HAL_EPIC_UART_0_MASK);
+    }
+    else
+    {
+        HAL_EPIC_SetHandler(EPIC_LINE_UART_1_S, HAL_USART_Stream_UART1_IRQHandler);
+        HAL_EPIC_MaskLevelSet(HAL_EPIC_UART_1_MASK);
+    }
+    HAL_EPIC_SetHandler(EPIC_LINE_DMA_S, HAL_DMA_IRQHandler);
+    HAL_EPIC_MaskLevelSet(HAL_EPIC_DMA_MASK);
+    HAL_IRQ_EnableInterrupts();
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Остановить поток: выключить USART и прервать передачу. Непереданные данные теряются.
+ */
+void HAL_USART_Stream_DeInit(HAL_USART_StreamTypeDef *stream)
+{
+    uint32_t index = (stream->Instance == UART_0) ? 0 : 1;
+
+    HAL_EPIC_MaskLevelClear(index ? HAL_EPIC_UART_1_MASK : HAL_EPIC_UART_0_MASK);
+    stream->Instance->CONTROL1 = 0;
+    HAL_DMA_ChainAbort(&stream->TxChain);
+    StreamByInstance[index] = NULL;
+    stream->TxTail = stream->TxHead;
+    stream->TxChunk = 0;
+    stream->TxSkip = 0;
+}
+
+/**
+ * @brief Записать данные в буфер передачи без ожидания.
+ * Вызывается из одного контекста (основная программа или один обработчик прерывания).
+ * @param stream Поток.
+ * @param Data Данные.
+ * @param Size Количество байт.
+ * @return Количество записанных байт (меньше Size, если буфер передачи заполнен).
+ */
+uint32_t HAL_USART_Stream_Write(HAL_USART_StreamTypeDef *stream, const void *Data, uint32_t Size)
+{
+    uint32_t free = HAL_USART_Stream_TxFree(stream);
+    if (Size > free)
+    {
+        Size = free;
+    }
+    if (Size == 0)
+    {
+        return 0;
+    }
+
+    uint32_t offset = stream->TxHead & stream->TxMask;
+    uint32_t first = stream->TxMask + 1 - offset;
+    if (first > Size)
+    {
+        first = Size;
+    }
+    memcpy(stream->TxBuffer + offset, Data, first);
+    memcpy(stream->TxBuffer, (const uint8_t *)Data + first, Size - first);
+
+    /* Данные записываются в буфер до публикации нового TxHead */
+    __asm__ volatile ("" ::: "memory");
+    stream->TxHead += Size;
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+    HAL_USART_Stream_TxStart(stream);
+    HAL_IRQ_Restore(irq_state);
+
+    return Size;
+}
+
+/**
+ * @brief Отбросить самые старые данные буфера передачи, еще не переданные DMA.
+ *
+ * Участок, который передает DMA, не изменяется, данные не копируются. Если DMA свободен, место
+ * освобождается сразу, иначе - после передачи текущего участка. Вызывается из того же
+ * контекста, что и HAL_USART_Stream_Write.
+ * @param stream Поток.
+ * @param Size Количество отбрасываемых байт.
+ * @return Количество отброшенных байт.
+ */
+uint32_t HAL_USART_Stream_Discard(HAL_USART_StreamTypeDef *stream, uint32_t Size)
+{
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    uint32_t queued = stream->TxHead - (stream->TxTail + stream->TxChunk + stream->TxSkip);
+    if (Size > queued)
+    {
+        Size = queued;
+    }
+
+    if (HAL_DMA_ChainIsBusy(&stream->TxChain))
+    {
+        /* Участок запускается с TxTail, поэтому отброшенные данные пропускаются после его передачи */
+        stream->TxSkip += Size;
+    }
+    else
+    {
+        stream->TxTail += Size;
+    }
+
+    HAL_IRQ_Restore(irq_state);
+
+    return Size;
+}
+
+/**
+ * @brief Продвинуть передачу без прерываний.
+ * Если DMA завершил участок, а прерывание запрещено (или еще не обработано), выполняет его
+ * обработку и запускает следующий участок.
+ */
+void HAL_USART_Stream_Poll(HAL_USART_StreamTypeDef *stream)
+{
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    if (HAL_DMA_ChainIsBusy(&stream->TxChain) && HAL_DMA_GetChannelIrq(stream->hdma_channel))
+    {
+        HAL_DMA_IRQHandler();
+    }
+
+    HAL_IRQ_Restore(irq_state);
+}
+
+/**
+ * @brief Дождаться передачи всех данных буфера, включая последний стоп-бит.
+ * Не зависит от прерываний, поэтому может вызываться из обработчика исключений.
+ */
+void HAL_USART_Stream_Flush(HAL_USART_StreamTypeDef *stream)
+{
+    while (!HAL_USART_Stream_TxEmpty(stream))
+    {
+        HAL_USART_Stream_Poll(stream);
+    }
+
+    while ((stream->Instance->FLAGS & UART_FLAGS_TC_M) == 0);
+}
+
+/**
+ * @brief Прочитать принятые данные без ожидания.
+ * Вызывается из одного контекста.
+ * @param stream Поток.
+ * @param Data Буфер для данных.
+ * @param Size Размер буфера.
+ * @return Количество прочитанных байт.
+ */
+uint32_t HAL_USART_Stream_Read(HAL_USART_StreamTypeDef *stream, void *Data, uint32_t Size)
+{
+    uint32_t available = HAL_USART_Stream_Available(stream);
+    if (Size > available)
+    {
+        Size = available;
+    }
+    if (Size == 0)
+    {
+        return 0;
+    }
+
+    uint32_t offset = stream->RxTail & stream->RxMask;
+    uint32_t first = stream->RxMask + 1 - offset;
+    if (first > Size)
+    {
+        first = Size;
+    }
+    memcpy(Data, stream->RxBuffer + offset, first);
+    memcpy((uint8_t *)Data + first, stream->RxBuffer, Size - first);
+
+    /* Место в буфере освобождается после копирования */
+    __asm__ volatile ("" ::: "memory");
+    stream->RxTail += Size;
+
+    return Size;
+}
+
+/**
+ * @brief Обработчик прерывания USART потока.
+ * Назначается в EPIC функцией HAL_USART_Stream_Init.
+ */
+MIK32_RAMFUNC void HAL_USART_Stream_IRQHandler(HAL_USART_StreamTypeDef *stream)
+{
+    UART_TypeDef *uart = stream->Instance;
+    uint32_t flags = uart->FLAGS;
+
+    if (flags & USART_STREAM_RX_ERRORS)
+    {
+        uart->FLAGS = flags & USART_STREAM_RX_ERRORS;
+        stream->RxErrors++;
+    }
+
+    /* Чтение RXDATA сбрасывает RXNE */
+    while (uart->FLAGS & UART_FLAGS_RXNE_M)
+    {
+        uint8_t byte = uart->RXDATA;
+        uint32_t head = stream->RxHead;
+
+        if ((head - stream->RxTail) > stream->RxMask)
+        {
+            stream->RxOverruns++;
+            continue;
+        }
+        stream->RxBuffer[head & stream->RxMask] = byte;
+        __asm__ volatile ("" ::: "memory");
+        stream->RxHead = head + 1;
+    }
+
+    if (flags & UART_FLAGS_IDLE_M)
+    {
+        uart->FLAGS = UART_FLAGS_IDLE_M;
+        if (stream->IdleCallback != NULL)
+        {
+            stream->IdleCallback(stream);
+        }
+    }
+}
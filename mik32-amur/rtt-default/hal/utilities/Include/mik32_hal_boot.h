@@ -0,0 +1,70 @@
+#ifndef MIK32_HAL_BOOT
+#define MIK32_HAL_BOOT
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_crc32.h"
+#include "mik32_hal_crypto_stream.h"
+
+
+/*
+ * Выбор одного из двух образов программы во флеш-памяти SPIFI (A/B) с проверкой целостности.
+ *
+ * Слот начинается с заголовка HAL_Boot_HeaderTypeDef, образ следует за ним со смещения
+ * HAL_BOOT_HEADER_SIZE и собирается для выполнения с этого адреса. Слоты читаются в режиме
+ * памяти SPIFI (0x80000000 + смещение), поэтому SPIFI должен быть настроен заранее.
+ *
+ * CRC-32 вычисляется блоком CRC по первым 16 байтам заголовка (Magic, Version, Length, Flags) и
+ * образу; слова передаются из области SPIFI через DMA, если задан hcrc->hdma_channel. Если задан
+ * поток Mac, дополнительно проверяется имитовставка по ГОСТ Р 34.13-2015 (Кузнечик) по тем же
+ * данным, и образы без нее не загружаются. Поток Mac настраивается пользователем: алгоритм
+ * Кузнечик, режим CBC, порядок байтов, при котором блок загружается в порядке стандарта.
+ *
+ * HAL_Boot_Select выбирает образ с наибольшей версией; если он поврежден, проверяется второй.
+ * Обновление записывается в слот, не выбранный при загрузке: сначала образ, затем заголовок
+ * (tools/boot_image.c). Прерванная запись не проходит проверку, и загружается прежний образ.
+ *
+ * Время проверки определяется скоростью чтения SPIFI: образ 512 КБ читается за 512 КБ / (SCK / 2)
+ * в режиме 1-4-4, не менее 33 мс при SCK 32 МГц (измерение - bench/bench_boot.c).
+ *
+ * Загрузчик - boot/main.c (MIK32_BOOTLOADER), образ слота собирается со сценарием spifi_slot.
+ */
+
+#define HAL_BOOT_MAGIC          0x544F4F42  /* "BOOT" */
+#define HAL_BOOT_HEADER_SIZE    0x100       /* Выравнивание mtvec образа */
+#define HAL_BOOT_FLAG_MAC       (1 << 0)    /* Заголовок содержит имитовставку */
+#define HAL_BOOT_MAC_CHUNK      256         /* Байт образа за вызов HAL_Crypto_Stream_Update */
+
+typedef struct __HAL_Boot_HeaderTypeDef
+{
+    uint32_t Magic;                     /**< HAL_BOOT_MAGIC. */
+    uint32_t Version;                   /**< Больше - новее. */
+    uint32_t Length;                    /**< Длина образа, байт. С имитовставкой - кратна 16. */
+    uint32_t Flags;                     /**< HAL_BOOT_FLAG_*. */
+    uint32_t Crc;                       /**< CRC-32 первых 16 байт заголовка и образа. */
+    uint32_t Reserved[3];
+    uint8_t Mac[16];                    /**< Имитовставка Кузнечик тех же данных. */
+} HAL_Boot_HeaderTypeDef;
+
+typedef struct __HAL_Boot_TypeDef
+{
+    uint32_t Slot[2];                   /**< Адреса слотов в адресном пространстве SPIFI. */
+    uint32_t SlotSize;                  /**< Размер слота, байт. */
+    CRC_HandleTypeDef *hcrc;            /**< Блок CRC, настроенный на CRC-32. */
+    HAL_Crypto_StreamTypeDef *Mac;      /**< Поток Кузнечик CBC или NULL - имитовставка не проверяется. */
+    uint32_t *MacKey;                   /**< Ключ имитовставки, CRYPTO_KEY_KUZNECHIK слов. */
+} HAL_Boot_TypeDef;
+
+
+HAL_StatusTypeDef HAL_Boot_Verify(HAL_Boot_TypeDef *boot, uint32_t slot);
+int HAL_Boot_Select(HAL_Boot_TypeDef *boot);
+void HAL_Boot_Jump(HAL_Boot_TypeDef *boot, uint32_t slot) __attribute__((noreturn));
+
+/**
+ * @brief Адрес начала образа слота slot.
+ */
+static inline uint32_t HAL_Boot_Entry(HAL_Boot_TypeDef *boot, uint32_t slot)
+{
+    return boot->Slot[slot] + HAL_BOOT_HEADER_SIZE;
+}
+
+#endif // MIK32_HAL_BOOT
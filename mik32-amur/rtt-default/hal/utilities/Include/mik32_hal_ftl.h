@@ -0,0 +1,122 @@
+#ifndef MIK32_HAL_FTL
+#define MIK32_HAL_FTL
+
+#include <stdint.h>
+#include "mik32_hal_def.h"
+
+
+/*
+ * Блочное устройство с журнальной записью на NOR флеш-памяти (слой трансляции, FTL).
+ *
+ * Логический блок размером HAL_FTL_BLOCK_SIZE (страница W25) никогда не перезаписывается на
+ * месте: новая версия дописывается в следующий свободный слот активного сектора, а таблица
+ * отображения в ОЗУ переключается на нее. Старая версия становится недействительной и
+ * освобождается сборкой мусора, которая переносит действительные блоки сектора с наименьшим
+ * числом действительных блоков и стирает его. Поэтому небольшое обновление стоит записи одной
+ * страницы вместо стирания и перезаписи сектора 4 КБ. Перенесенные блоки дописываются в
+ * отдельный активный сектор: они изменяются реже новых, и разделение потоков уменьшает
+ * число переносов при неравномерной записи.
+ *
+ * Выравнивание износа: для записи открывается свободный сектор с наименьшим счетчиком
+ * стираний (динамическое), а HAL_FTL_Collect при разнице счетчиков больше WearThreshold
+ * переносит сектор с наименьшим счетчиком, освобождая его из-под редко изменяемых данных.
+ *
+ * Сектор 4 КБ: первая страница - заголовок (признак, счетчик стираний, номер записи сектора)
+ * и теги слотов (номер записи, номер блока и контрольная сумма), далее HAL_FTL_SLOTS слотов
+ * данных. Данные слота записываются раньше его тега, поэтому прерванная запись не видна после
+ * HAL_FTL_Mount.
+ * Страница заголовка программируется по частям (только сброс битов в 0), что допускает W25.
+ *
+ * Таблица отображения занимает 2 байта на логический блок, состояние сектора - 12 байт:
+ * для области 256 КБ (64 сектора, 930 блоков) это около 2.6 КБ ОЗУ. Массивы выделяет
+ * пользователь, размеры задают HAL_FTL_BLOCKS и число секторов.
+ *
+ * Чем меньше доля логических блоков в области, тем меньше действительных блоков переносит
+ * сборка мусора. При случайной записи и заполнении 100% (HAL_FTL_BLOCKS) усиление записи
+ * велико, поэтому BlockCount обычно уменьшают до 70-85%: оценку дает tools/ftl_sim.c.
+ *
+ * Функции не реентерабельны и выполняют операции с флеш-памятью синхронно.
+ */
+
+#define HAL_FTL_SECTOR_SIZE     4096
+#define HAL_FTL_BLOCK_SIZE      256
+#define HAL_FTL_SLOTS           (HAL_FTL_SECTOR_SIZE / HAL_FTL_BLOCK_SIZE - 1)  /* Слотов данных в секторе */
+#define HAL_FTL_RESERVE         2       /* Секторов, не входящих в логическую емкость */
+
+/* Число логических блоков для области из sectors секторов */
+#define HAL_FTL_BLOCKS(sectors) (((sectors) - HAL_FTL_RESERVE) * HAL_FTL_SLOTS)
+
+#define HAL_FTL_UNMAPPED        0xFFFF
+#define HAL_FTL_NONE            0xFFFFFFFF
+
+/* Потоки записи: блоки пользователя и блоки, перенесенные сборкой мусора */
+#define HAL_FTL_STREAM_HOST     0
+#define HAL_FTL_STREAM_COLLECT  1
+
+/**
+ * @brief Операции с флеш-памятью. Адреса - смещения во флеш-памяти.
+ */
+typedef struct __HAL_FTL_FlashTypeDef
+{
+    HAL_StatusTypeDef (*Read)(void *context, uint32_t address, void *data, uint32_t length);
+    HAL_StatusTypeDef (*Program)(void *context, uint32_t address, const void *data, uint32_t length);  /**< В пределах одной страницы. */
+    HAL_StatusTypeDef (*Erase)(void *context, uint32_t address);                                       /**< Сектор HAL_FTL_SECTOR_SIZE. */
+} HAL_FTL_FlashTypeDef;
+
+typedef enum __HAL_FTL_SectorStateTypeDef
+{
+    FTL_SECTOR_FREE = 0,                /**< Стерт, заголовок записан. */
+    FTL_SECTOR_ACTIVE = 1,              /**< Открыт для записи. */
+    FTL_SECTOR_FULL = 2,                /**< Закрыт, ожидает сборки мусора. */
+    FTL_SECTOR_DIRTY = 3,               /**< Заголовок поврежден, требуется стирание. */
+} HAL_FTL_SectorStateTypeDef;
+
+/**
+ * @brief Состояние сектора в ОЗУ.
+ */
+typedef struct __HAL_FTL_SectorTypeDef
+{
+    uint32_t EraseCount;                /**< Счетчик стираний. */
+    uint32_t Sequence;                  /**< Номер записи при открытии сектора. */
+    uint8_t Valid;                      /**< Действительных слотов. */
+    uint8_t Written;                    /**< Занятых слотов. */
+    uint8_t State;                      /**< HAL_FTL_SectorStateTypeDef. */
+} HAL_FTL_SectorTypeDef;
+
+typedef struct __HAL_FTL_TypeDef
+{
+    const HAL_FTL_FlashTypeDef *Flash;  /**< Операции с флеш-памятью. */
+    void *Context;                      /**< Первый аргумент операций (например, SPIFI_HandleTypeDef*). */
+    uint32_t BaseAddress;               /**< Начало области, кратно HAL_FTL_SECTOR_SIZE. */
+    uint32_t SectorCount;               /**< Секторов в области, не больше 4369. */
+    uint16_t *Map;                      /**< Таблица отображения, HAL_FTL_BLOCKS(SectorCount) элементов. */
+    uint32_t BlockCount;                /**< Логических блоков, по умолчанию HAL_FTL_BLOCKS(SectorCount). Меньшее значение снижает усиление записи. */
+    HAL_FTL_SectorTypeDef *Sectors;     /**< Состояние секторов, SectorCount элементов. */
+    uint32_t WearThreshold;             /**< Разница счетчиков стираний для переноса редко изменяемых данных, 0 - не переносить. */
+    uint32_t CollectThreshold;          /**< HAL_FTL_Collect работает, пока свободных секторов меньше. */
+
+    /* Статистика */
+    uint32_t HostWrites;                /**< Записано логических блоков. */
+    uint32_t FlashWrites;               /**< Записано слотов с учетом сборки мусора. */
+    uint32_t Erases;                    /**< Стерто секторов. */
+
+    /* Служебные поля */
+    uint32_t Sequence;                  /**< Следующий номер записи (открытие сектора или запись блока). */
+    uint32_t Active[2];                 /**< Активный сектор потока HAL_FTL_STREAM_* или HAL_FTL_NONE. */
+    uint32_t FreeCount;                 /**< Свободных секторов. */
+    uint8_t Buffer[HAL_FTL_BLOCK_SIZE]; /**< Перенос блока при сборке мусора. */
+} HAL_FTL_TypeDef;
+
+
+void HAL_FTL_Init(HAL_FTL_TypeDef *ftl, const HAL_FTL_FlashTypeDef *flash, void *context, uint32_t BaseAddress,
+                  uint32_t SectorCount, uint16_t *Map, HAL_FTL_SectorTypeDef *Sectors);
+HAL_StatusTypeDef HAL_FTL_Format(HAL_FTL_TypeDef *ftl);
+HAL_StatusTypeDef HAL_FTL_Mount(HAL_FTL_TypeDef *ftl);
+HAL_StatusTypeDef HAL_FTL_Read(HAL_FTL_TypeDef *ftl, uint32_t Block, void *Data);
+HAL_StatusTypeDef HAL_FTL_Write(HAL_FTL_TypeDef *ftl, uint32_t Block, const void *Data);
+int HAL_FTL_Collect(HAL_FTL_TypeDef *ftl);
+
+/* Операции для флеш-памяти W25 (mik32_hal_spifi_w25.h), Context - SPIFI_HandleTypeDef* */
+extern const HAL_FTL_FlashTypeDef HAL_FTL_W25_Flash;
+
+#endif // MIK32_HAL_FTL
@@ -0,0 +1,98 @@
+#ifndef MIK32_HAL_SFDP
+#define MIK32_HAL_SFDP
+
+#include <stdint.h>
+#include "mik32_hal_def.h"
+
+
+/*
+ * Разбор таблиц SFDP (JESD216) флеш-памяти с последовательным интерфейсом.
+ *
+ * Из основной таблицы параметров JEDEC (BFPT) извлекаются объем, размер страницы, типы
+ * стирания, команды чтения 1-1-4, 1-4-4 и 4-4-4 с числом холостых тактов, способ установки
+ * бита QE, команды входа в режим QPI и выхода из него, команды приостановки стирания.
+ * HAL_SFDP_SelectRead выбирает самую быструю команду чтения, которую можно выполнить
+ * контроллером с промежуточными данными целыми байтами (SPIFI).
+ *
+ * Разбор не зависит от SPIFI: данные читаются функцией HAL_SFDP_ReadFuncTypeDef, поэтому
+ * модуль собирается и на компьютере (tools/sfdp_check.c). Настройку SPIFI по результату
+ * выполняет mik32_hal_spifi_sfdp.h.
+ *
+ * Таблицы ревизии 1.0 (9 слов) не содержат способа установки QE: QuadEnable равно
+ * SFDP_QE_UNKNOWN, и четырехпроводные команды не выбираются, пока поле не задаст пользователь.
+ */
+
+#define HAL_SFDP_SIGNATURE          0x50444653  /* "SFDP" */
+#define HAL_SFDP_BFPT_ID            0xFF00      /* Идентификатор основной таблицы JEDEC */
+#define HAL_SFDP_BFPT_DWORDS        23          /* Читается слов основной таблицы (JESD216F) */
+#define HAL_SFDP_HEADERS_MAX        16          /* Просматривается заголовков параметров */
+#define HAL_SFDP_INTERIM_MAX        7           /* Наибольшее число промежуточных байт команды */
+
+/* Команды чтения в порядке возрастания скорости: линии кода операции - адреса - данных */
+typedef enum __HAL_SFDP_ReadModeTypeDef
+{
+    SFDP_READ_1_1_1 = 0,    /* Fast Read (0x0B), 8 холостых тактов */
+    SFDP_READ_1_1_4 = 1,
+    SFDP_READ_1_4_4 = 2,
+    SFDP_READ_4_4_4 = 3,    /* Режим QPI */
+} HAL_SFDP_ReadModeTypeDef;
+
+/* Способ установки бита QE (DWORD15 биты 22:20) */
+typedef enum __HAL_SFDP_QuadEnableTypeDef
+{
+    SFDP_QE_NONE = 0,               /* Бита QE нет */
+    SFDP_QE_SR2_BIT1_NO_READ = 1,   /* SR2 бит 1, запись 0x01 двумя байтами, чтение SR2 не поддерживается */
+    SFDP_QE_SR1_BIT6 = 2,           /* SR1 бит 6, запись 0x01 одним байтом */
+    SFDP_QE_SR2_BIT7 = 3,           /* SR2 бит 7, чтение 0x3F, запись 0x3E */
+    SFDP_QE_SR2_BIT1 = 4,           /* SR2 бит 1, чтение 0x35, запись 0x01 двумя байтами (одним SR2 не изменяется) */
+    SFDP_QE_SR2_BIT1_35H = 5,       /* SR2 бит 1, чтение 0x35, запись 0x01 двумя байтами (одним SR2 сбрасывается) */
+    SFDP_QE_SR2_BIT1_31H = 6,       /* SR2 бит 1, чтение 0x35, запись 0x31 одним байтом */
+    SFDP_QE_UNKNOWN = 0xFF,
+} HAL_SFDP_QuadEnableTypeDef;
+
+/**
+ * @brief Команда чтения. Opcode = 0 - не поддерживается.
+ */
+typedef struct __HAL_SFDP_ReadTypeDef
+{
+    uint8_t Opcode;
+    uint8_t Dummy;                      /**< Холостых тактов, включая такты битов режима. */
+    uint8_t ModeClocks;                 /**< Тактов битов режима. */
+} HAL_SFDP_ReadTypeDef;
+
+/**
+ * @brief Тип стирания. SizeShift = 0 - не поддерживается.
+ */
+typedef struct __HAL_SFDP_EraseTypeDef
+{
+    uint8_t Opcode;
+    uint8_t SizeShift;                  /**< Размер 2^SizeShift байт. */
+} HAL_SFDP_EraseTypeDef;
+
+typedef struct __HAL_SFDP_TypeDef
+{
+    uint8_t Major;                      /**< Ревизия основной таблицы. */
+    uint8_t Minor;
+    uint8_t Dwords;                     /**< Слов основной таблицы. */
+    uint32_t Size;                      /**< Объем, байт. */
+    uint32_t PageSize;                  /**< Размер страницы программирования, байт. */
+    HAL_SFDP_ReadTypeDef Read[4];       /**< Команды чтения по HAL_SFDP_ReadModeTypeDef. */
+    HAL_SFDP_EraseTypeDef Erase[4];     /**< Типы стирания по возрастанию размера. */
+    uint8_t QuadEnable;                 /**< HAL_SFDP_QuadEnableTypeDef. */
+    uint8_t QpiEnterOpcode;             /**< Вход в режим 4-4-4, 0 - неизвестен. */
+    uint8_t QpiExitOpcode;              /**< Выход из режима 4-4-4, 0 - неизвестен. */
+    uint8_t SuspendOpcode;              /**< Приостановка стирания, 0 - не поддерживается. */
+    uint8_t ResumeOpcode;
+} HAL_SFDP_TypeDef;
+
+/**
+ * @brief Чтение length байт пространства SFDP начиная с address.
+ */
+typedef HAL_StatusTypeDef (*HAL_SFDP_ReadFuncTypeDef)(void *context, uint32_t address, void *data, uint32_t length);
+
+
+HAL_StatusTypeDef HAL_SFDP_Parse(HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadFuncTypeDef read, void *context);
+int HAL_SFDP_InterimLength(const HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadModeTypeDef mode);
+HAL_SFDP_ReadModeTypeDef HAL_SFDP_SelectRead(const HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadModeTypeDef MaxMode);
+
+#endif // MIK32_HAL_SFDP
@@ -0,0 +1,47 @@
+#ifndef MIK32_HAL_SPIFI_SFDP
+#define MIK32_HAL_SPIFI_SFDP
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_spifi.h"
+#include "mik32_hal_sfdp.h"
+
+
+/*
+ * Флеш-память с последовательным интерфейсом на SPIFI, настроенная по таблицам SFDP.
+ *
+ * HAL_SPIFI_SFDP_Init читает SFDP (команда 0x5A) и разбирает основную таблицу JEDEC.
+ * HAL_SPIFI_SFDP_Configure выбирает самую быструю поддерживаемую команду чтения (1-1-4, 1-4-4
+ * или 4-4-4), устанавливает бит QE способом из таблицы и при необходимости переводит
+ * флеш-память в режим QPI. Между этими вызовами поля flash->Sfdp можно уточнить, например,
+ * задать QuadEnable для таблиц ревизии 1.0.
+ *
+ * Команда чтения ReadCommand используется функциями периферийного режима, ее можно передать в
+ * HAL_SPIFI_DMA_CommandTypeDef.Command; HAL_SPIFI_SFDP_MemoryMode_Init настраивает ею режим
+ * памяти. В режиме QPI все команды передаются по четырем линиям. Перед переходом к драйверу
+ * конкретной микросхемы (mik32_hal_spifi_w25.h) необходимо вызвать HAL_SPIFI_SFDP_Deinit.
+ *
+ * Поддерживается 3-байтовая адресация (первые 16 МБ).
+ */
+
+#define HAL_SPIFI_SFDP_BUSY     1000000     /* Опросов BUSY при стирании и программировании */
+
+typedef struct __HAL_SPIFI_SFDP_TypeDef
+{
+    SPIFI_HandleTypeDef *spifi;         /**< SPIFI в периферийном режиме. */
+    HAL_SFDP_TypeDef Sfdp;              /**< Параметры из SFDP. */
+    uint8_t Mode;                       /**< Выбранная команда чтения, HAL_SFDP_ReadModeTypeDef. */
+    uint8_t Qpi;                        /**< Флеш-память в режиме QPI (4-4-4). */
+    uint32_t ReadCommand;               /**< Значение регистра CMD для чтения. */
+} HAL_SPIFI_SFDP_TypeDef;
+
+
+HAL_StatusTypeDef HAL_SPIFI_SFDP_Init(HAL_SPIFI_SFDP_TypeDef *flash, SPIFI_HandleTypeDef *spifi);
+HAL_StatusTypeDef HAL_SPIFI_SFDP_Configure(HAL_SPIFI_SFDP_TypeDef *flash, HAL_SFDP_ReadModeTypeDef MaxMode);
+void HAL_SPIFI_SFDP_Deinit(HAL_SPIFI_SFDP_TypeDef *flash);
+HAL_StatusTypeDef HAL_SPIFI_SFDP_WaitBusy(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t timeout);
+HAL_StatusTypeDef HAL_SPIFI_SFDP_ReadData(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
+HAL_StatusTypeDef HAL_SPIFI_SFDP_PageProgram(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
+HAL_StatusTypeDef HAL_SPIFI_SFDP_Erase(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t address, uint32_t size);
+void HAL_SPIFI_SFDP_MemoryMode_Init(HAL_SPIFI_SFDP_TypeDef *flash, SPIFI_MemoryModeConfig_HandleTypeDef *config);
+
+#endif // MIK32_HAL_SPIFI_SFDP
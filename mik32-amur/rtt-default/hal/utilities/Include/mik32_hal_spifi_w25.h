@@ -3,6 +3,7 @@
 
 #include "mik32_hal_def.h"
 #include "mik32_hal_spifi.h"
+#include "mik32_hal_spifi_dma.h"
 
 typedef enum __HAL_SPIFI_W25_SREGTypeDef
 {
@@ -10,6 +11,34 @@ typedef enum __HAL_SPIFI_W25_SREGTypeDef
     W25_SREG2 = 2,
 } HAL_SPIFI_W25_SREGTypeDef;
 
+/* Команда чтения для HAL_SPIFI_W25_ReadData_DMA */
+typedef enum __HAL_SPIFI_W25_ReadModeTypeDef
+{
+    W25_READ_SINGLE = 0,    /* Fast Read (0x0B) */
+    W25_READ_DUAL = 1,      /* Fast Read Dual Output (0x3B) */
+    W25_READ_QUAD = 2,      /* Fast Read Quad Output (0x6B), требуется бит QE */
+    W25_READ_QUAD_IO = 3,   /* Fast Read Quad I/O (0xEB), требуется бит QE */
+} HAL_SPIFI_W25_ReadModeTypeDef;
+
+/* Команда чтения режима памяти для HAL_SPIFI_W25_MemoryMode_Init */
+typedef enum __HAL_SPIFI_W25_MemoryModeTypeDef
+{
+    W25_MEMORY_FAST_READ = 0,       /* Fast Read (0x0B) */
+    W25_MEMORY_QUAD_OUTPUT = 1,     /* Fast Read Quad Output (0x6B) */
+    W25_MEMORY_QUAD_IO = 2,         /* Fast Read Quad I/O (0xEB) */
+    W25_MEMORY_QUAD_IO_XIP = 3,     /* Fast Read Quad I/O в режиме непрерывного чтения: код операции не передается */
+    W25_MEMORY_QPI = 4,             /* Fast Read Quad I/O (0xEB) в режиме QPI */
+    W25_MEMORY_QPI_XIP = 5,         /* QPI в режиме непрерывного чтения */
+} HAL_SPIFI_W25_MemoryModeTypeDef;
+
+/* Команда стирания для HAL_SPIFI_W25_Erase_NoWait */
+typedef enum __HAL_SPIFI_W25_EraseTypeDef
+{
+    W25_ERASE_4K = 0,       /* Sector Erase (0x20) */
+    W25_ERASE_32K = 1,      /* Block Erase 32 КБ (0x52) */
+    W25_ERASE_64K = 2,      /* Block Erase 64 КБ (0xD8) */
+} HAL_SPIFI_W25_EraseTypeDef;
+
 typedef struct __SPIFI_W25_ManufacturerDeviceIDTypeDef
 {
     uint8_t Manufacturer;
@@ -20,6 +49,18 @@ typedef struct __SPIFI_W25_ManufacturerDeviceIDTypeDef
 
 #define SPIFI_W25_XIP_NO_OPCODE 0x20
 
+#define SPIFI_W25_PAGE_SIZE 256
+#define SPIFI_W25_SECTOR_SIZE 0x1000
+#define SPIFI_W25_BLOCK_32K_SIZE 0x8000
+#define SPIFI_W25_BLOCK_64K_SIZE 0x10000
+
+/**
+ * @brief Подготовка данных для HAL_SPIFI_W25_WriteStream.
+ * Записывает в page length байт, начиная со смещения offset от начала диапазона. Вызывается,
+ * пока флеш-память стирает блок или программирует предыдущую страницу.
+ */
+typedef void (*HAL_SPIFI_W25_FillTypeDef)(void *context, uint32_t offset, uint8_t *page, uint16_t length);
+
 #define SPIFI_W25_SREG1_BUSY_S 0
 #define SPIFI_W25_SREG1_BUSY_M (1 << SPIFI_W25_SREG1_BUSY_S)
 #define SPIFI_W25_SREG1_WRITE_ENABLE_S 1
@@ -82,6 +123,22 @@ void HAL_SPIFI_W25_PageProgram(SPIFI_HandleTypeDef *spifi, uint32_t address, uin
 
 void HAL_SPIFI_W25_SectorErase4K(SPIFI_HandleTypeDef *spifi, uint32_t address);
 
+void HAL_SPIFI_W25_PageProgram_NoWait(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
+
+void HAL_SPIFI_W25_Erase_NoWait(SPIFI_HandleTypeDef *spifi, HAL_SPIFI_W25_EraseTypeDef type, uint32_t address);
+
+void HAL_SPIFI_W25_PageProgram_Quad_NoWait(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
+
+HAL_StatusTypeDef HAL_SPIFI_W25_EraseRange(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length);
+
+HAL_StatusTypeDef HAL_SPIFI_W25_WriteStream(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length, HAL_SPIFI_W25_FillTypeDef fill, void *context, uint8_t *page);
+
+HAL_StatusTypeDef HAL_SPIFI_W25_WriteRange(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length, const uint8_t *data);
+
+void HAL_SPIFI_W25_Suspend(SPIFI_HandleTypeDef *spifi);
+
+void HAL_SPIFI_W25_Resume(SPIFI_HandleTypeDef *spifi);
+
 void HAL_SPIFI_W25_ReadData(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
 
 void HAL_SPIFI_W25_ReadData_4addr(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
@@ -116,4 +173,14 @@ HAL_StatusTypeDef HAL_SPIFI_W25_QuadEnable(SPIFI_HandleTypeDef *spifi);
 
 HAL_StatusTypeDef HAL_SPIFI_W25_QuadDisable(SPIFI_HandleTypeDef *spifi);
 
+HAL_StatusTypeDef HAL_SPIFI_W25_MemoryMode_Init(SPIFI_HandleTypeDef *spifi, SPIFI_MemoryModeConfig_HandleTypeDef *config, HAL_SPIFI_W25_MemoryModeTypeDef mode);
+
+void HAL_SPIFI_W25_MemoryMode_Exit(SPIFI_HandleTypeDef *spifi, HAL_SPIFI_W25_MemoryModeTypeDef mode);
+
+HAL_StatusTypeDef HAL_SPIFI_W25_ReadData_DMA(HAL_SPIFI_DMA_TypeDef *engine, HAL_SPIFI_W25_ReadModeTypeDef mode, uint32_t address, uint32_t dataLength, uint8_t *dataBytes);
+
+HAL_StatusTypeDef HAL_SPIFI_W25_PageProgram_DMA(HAL_SPIFI_DMA_TypeDef *engine, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
+
+HAL_StatusTypeDef HAL_SPIFI_W25_PageProgram_Quad_DMA(HAL_SPIFI_DMA_TypeDef *engine, uint32_t address, uint16_t dataLength, uint8_t *dataBytes);
+
 #endif // MIK32_HAL_SPIFI_W25
@@ -0,0 +1,101 @@
+#ifndef MIK32_HAL_SPIFI_W25_SCHED
+#define MIK32_HAL_SPIFI_W25_SCHED
+
+#include "mik32_hal_def.h"
+#include "mik32_hal_irq.h"
+#include "mik32_hal_swtimer.h"
+#include "mik32_hal_spifi_w25.h"
+
+
+/*
+ * Планировщик стирания и программирования флеш-памяти W25 с приостановкой для чтения.
+ *
+ * Операции (HAL_SPIFI_W25_SchedOpTypeDef) ставятся в очередь функцией HAL_SPIFI_W25_Sched_Submit
+ * и выполняются по одной в фоне: команда только запускается, а бит BUSY опрашивается программным
+ * таймером (mik32_hal_swtimer.h) с периодом PollUs. После завершения операции из обработчика
+ * таймера запускается следующая и вызывается функция завершения выполненной.
+ *
+ * HAL_SPIFI_W25_Sched_Read не ждет конца стирания: выполняемая операция приостанавливается
+ * командой Erase/Program Suspend (0x75), данные читаются, и операция продолжается командой
+ * Resume (0x7A). Чтобы частые чтения не останавливали стирание, следующая приостановка
+ * выполняется не раньше, чем через ResumeHoldUs после продолжения. Задержка начала чтения
+ * ограничена ResumeHoldUs + tSUS (20 мкс), а не временем стирания (до 400 мс для сектора
+ * 4 КБ и до 2 с для блока 64 КБ). Чтение области, которую затрагивает выполняемая операция,
+ * во время приостановки недопустимо, поэтому такое чтение ожидает завершения операции.
+ *
+ * Требуется HAL_SWTimer_Init и вызов HAL_SWTimer_IRQHandler из trap_handler. Пока в очереди
+ * есть операции, к SPIFI нельзя обращаться в обход планировщика (в том числе в режиме памяти),
+ * а Submit и Read нельзя вызывать из прерываний, кроме функции завершения.
+ */
+
+#define HAL_SPIFI_W25_SCHED_POLL_US         1000
+#define HAL_SPIFI_W25_SCHED_RESUME_HOLD_US  100
+#define HAL_SPIFI_W25_SCHED_TSUS_US         20          /* Минимальный интервал между Resume и Suspend */
+#define HAL_SPIFI_W25_SCHED_TIMEOUT_US      4000000     /* Наибольшее время выполнения операции */
+
+typedef enum __HAL_SPIFI_W25_SchedKindTypeDef
+{
+    W25_SCHED_ERASE_4K = W25_ERASE_4K,
+    W25_SCHED_ERASE_32K = W25_ERASE_32K,
+    W25_SCHED_ERASE_64K = W25_ERASE_64K,
+    W25_SCHED_PROGRAM = 3,                  /* Page Program (0x02) в пределах одной страницы */
+} HAL_SPIFI_W25_SchedKindTypeDef;
+
+typedef struct __HAL_SPIFI_W25_SchedOpTypeDef HAL_SPIFI_W25_SchedOpTypeDef;
+
+/**
+ * @brief Функция, вызываемая из прерывания таймера после завершения операции.
+ */
+typedef void (*HAL_SPIFI_W25_SchedCallbackTypeDef)(HAL_SPIFI_W25_SchedOpTypeDef *op);
+
+/**
+ * @brief Операция стирания или программирования.
+ * Структура и данные программирования должны существовать до вызова функции завершения.
+ */
+struct __HAL_SPIFI_W25_SchedOpTypeDef
+{
+    uint8_t Kind;                                   /**< HAL_SPIFI_W25_SchedKindTypeDef. */
+    uint32_t Address;                               /**< Адрес во флеш-памяти; при стирании - любой адрес сектора или блока. */
+    const uint8_t *Data;                            /**< Данные программирования. */
+    uint32_t Length;                                /**< Байт программирования, 1 - SPIFI_W25_PAGE_SIZE. */
+    HAL_SPIFI_W25_SchedCallbackTypeDef Callback;    /**< Функция завершения или NULL. */
+    void *Context;                                  /**< Произвольные данные пользователя. */
+    volatile HAL_StatusTypeDef Status;              /**< HAL_BUSY - в очереди или выполняется, HAL_OK - выполнена, HAL_TIMEOUT - флеш-память не ответила. */
+
+    /* Служебные поля */
+    HAL_SPIFI_W25_SchedOpTypeDef *Next;
+};
+
+typedef struct __HAL_SPIFI_W25_SchedTypeDef
+{
+    SPIFI_HandleTypeDef *spifi;                     /**< SPIFI в периферийном режиме. */
+    uint32_t PollUs;                                /**< Период опроса BUSY, мкс, больше нуля. */
+    uint32_t ResumeHoldUs;                          /**< Наименьшее время работы операции между приостановками, мкс, не меньше tSUS. */
+
+    /* Статистика */
+    uint32_t Suspends;                              /**< Число приостановок. */
+    uint32_t ReadLatencyMax;                        /**< Наибольшая задержка HAL_SPIFI_W25_Sched_Read до начала чтения, тики таймера ядра. */
+
+    /* Служебные поля */
+    HAL_SPIFI_W25_SchedOpTypeDef *volatile Head;    /**< Выполняемая операция. Изменяется в прерывании и в Submit при пустой очереди. */
+    HAL_SPIFI_W25_SchedOpTypeDef *Tail;
+    HAL_SWTimer_TypeDef Timer;
+    volatile uint8_t Lock;                          /**< SPIFI занят функцией Read, опрос пропускается. */
+    uint32_t Polls;                                 /**< Опросов выполняемой операции. */
+    uint64_t ResumeTicks;                           /**< Время запуска или продолжения выполняемой операции. */
+} HAL_SPIFI_W25_SchedTypeDef;
+
+
+void HAL_SPIFI_W25_Sched_Init(HAL_SPIFI_W25_SchedTypeDef *sched, SPIFI_HandleTypeDef *spifi);
+HAL_StatusTypeDef HAL_SPIFI_W25_Sched_Submit(HAL_SPIFI_W25_SchedTypeDef *sched, HAL_SPIFI_W25_SchedOpTypeDef *op);
+HAL_StatusTypeDef HAL_SPIFI_W25_Sched_Read(HAL_SPIFI_W25_SchedTypeDef *sched, uint32_t Address, uint32_t Length, uint8_t *Data);
+
+/**
+ * @brief Проверить, выполнены ли все операции очереди.
+ */
+static inline __attribute__((always_inline)) int HAL_SPIFI_W25_Sched_IsIdle(HAL_SPIFI_W25_SchedTypeDef *sched)
+{
+    return sched->Head == NULL;
+}
+
+#endif // MIK32_HAL_SPIFI_W25_SCHED
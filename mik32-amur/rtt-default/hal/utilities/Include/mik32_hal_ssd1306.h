@@ -34,13 +34,20 @@
 #define SYMBOL_COLON            58
 #define SYMBOL_SMILE            13
 
+/* Размер символа: 25 столбцов на 4 страницы */
+#define SYMBOL_WIDTH            25
+#define SYMBOL_PAGES            4
+
 #include <stdint.h>
 #include "mik32_hal_i2c.h"
+#include "mik32_hal_irq.h"
 
 /* COM (СЛЕДУЮЩИЙ БАЙТ будет командой), DAT (СЛЕДУЮЩИЙ БАЙТ будет данными) и DATS (ВСЕ СЛЕДУЮЩИЕ БАЙТЫ будут данными) */	
 #define DATS 0b01000000
 #define DAT 0b11000000	
 #define COM 0b10000000
+/* COMS (ВСЕ СЛЕДУЮЩИЕ БАЙТЫ будут командами) */
+#define COMS 0b00000000
 
 
 HAL_StatusTypeDef HAL_SSD1306_Init(I2C_HandleTypeDef *hi2c, uint8_t brightness);
@@ -48,4 +55,81 @@ HAL_StatusTypeDef HAL_SSD1306_SetBorder(I2C_HandleTypeDef *hi2c, uint8_t start_c
 HAL_StatusTypeDef HAL_SSD1306_CLR_SCR(I2C_HandleTypeDef *hi2c);
 HAL_StatusTypeDef HAL_SSD1306_Write(I2C_HandleTypeDef *hi2c, uint8_t symbol);
 
+
+/*
+ * Кадровый буфер в ОЗУ с выводом измененных участков.
+ *
+ * Рисование изменяет только Buffer и запоминает для каждой страницы границы измененных
+ * столбцов (байты, записанные с прежним значением, не отмечаются). HAL_SSD1306_Frame_Flush
+ * передает на дисплей только эти участки и не ждет окончания: каждый участок - посылка
+ * команд границ (0x21, 0x22) и посылка данных, передаваемые через DMA (hi2c->hdmatx) или по
+ * прерываниям I2C, следующая посылка запускается из прерывания STOP. Соседние страницы
+ * передаются одним окном, если это короче отдельных участков.
+ *
+ * Рисовать можно и во время вывода: новые изменения попадут в следующий вывод. Дисплей
+ * должен быть инициализирован (HAL_SSD1306_Init); HAL_SSD1306_Frame_Init включает
+ * горизонтальную адресацию и назначает обработчик линии I2C в EPIC, из trap_handler
+ * необходимо вызывать HAL_EPIC_Dispatch.
+ */
+
+#ifdef SSD1306_128x64
+#define SSD1306_PAGES           8
+#else
+#define SSD1306_PAGES           4
+#endif
+#define SSD1306_WIDTH           128
+#define SSD1306_HEIGHT          (SSD1306_PAGES * 8)
+
+/* Наибольшее число байт данных в одной посылке (NBYTES - 1 байт DATS) */
+#define SSD1306_FRAME_TX_MAX    (I2C_NBYTE_MAX - 1)
+
+/**
+ * @brief Способ передачи посылок.
+ */
+typedef enum __HAL_SSD1306_FlushModeTypeDef
+{
+    SSD1306_FLUSH_DMA = 0,      /**< Канал DMA hi2c->hdmatx, прерывание только по окончании посылки. */
+    SSD1306_FLUSH_IT = 1        /**< Прерывание TXIS на каждый байт. */
+} HAL_SSD1306_FlushModeTypeDef;
+
+typedef struct __HAL_SSD1306_FrameTypeDef
+{
+    I2C_HandleTypeDef *hi2c;                        /**< I2C_0 или I2C_1. В режиме DMA поля dma и Channel в hi2c->hdmatx задает пользователь. */
+    HAL_SSD1306_FlushModeTypeDef Mode;              /**< Способ передачи. */
+    uint8_t Buffer[SSD1306_PAGES][SSD1306_WIDTH];   /**< Кадр: байт - 8 точек столбца страницы, бит 0 сверху. */
+
+    volatile HAL_StatusTypeDef Status;              /**< HAL_BUSY - идет вывод, HAL_OK - вывод завершен, HAL_ERROR - ошибка на шине. */
+    uint32_t BusBytes;                              /**< Число байт на шине (с байтами адреса) последнего вывода. */
+    uint32_t Transfers;                             /**< Число посылок последнего вывода. */
+
+    /* Служебные поля */
+    uint8_t DirtyStart[SSD1306_PAGES];              /**< Первый измененный столбец страницы. Страница не изменена, если DirtyStart > DirtyEnd. */
+    uint8_t DirtyEnd[SSD1306_PAGES];                /**< Последний измененный столбец страницы. */
+    uint8_t FlushStart[SSD1306_PAGES];              /**< Участки текущего вывода. Изменяются только в прерывании во время вывода. */
+    uint8_t FlushEnd[SSD1306_PAGES];
+    uint8_t Page;                                   /**< Первая страница текущего окна. */
+    uint8_t PageEnd;                                /**< Последняя страница текущего окна. */
+    uint8_t Column;                                 /**< Первый столбец текущего окна. */
+    uint8_t ColumnEnd;                              /**< Последний столбец текущего окна. */
+    uint8_t Stage;                                  /**< 0 - передаются команды границ окна, 1 - данные. */
+    uint8_t Tx[1 + SSD1306_FRAME_TX_MAX];           /**< Текущая посылка. */
+} HAL_SSD1306_FrameTypeDef;
+
+
+HAL_StatusTypeDef HAL_SSD1306_Frame_Init(HAL_SSD1306_FrameTypeDef *frame, I2C_HandleTypeDef *hi2c, HAL_SSD1306_FlushModeTypeDef Mode);
+void HAL_SSD1306_Frame_Clear(HAL_SSD1306_FrameTypeDef *frame);
+void HAL_SSD1306_Frame_SetPixel(HAL_SSD1306_FrameTypeDef *frame, uint8_t x, uint8_t y, uint8_t on);
+void HAL_SSD1306_Frame_WriteColumns(HAL_SSD1306_FrameTypeDef *frame, uint8_t page, uint8_t column, const uint8_t *data, uint8_t length);
+void HAL_SSD1306_Frame_DrawSymbol(HAL_SSD1306_FrameTypeDef *frame, uint8_t column, uint8_t symbol);
+HAL_StatusTypeDef HAL_SSD1306_Frame_Flush(HAL_SSD1306_FrameTypeDef *frame);
+void HAL_SSD1306_Frame_IRQHandler(HAL_SSD1306_FrameTypeDef *frame);
+
+/**
+ * @brief Проверить, идет ли вывод кадра.
+ */
+static inline __attribute__((always_inline)) int HAL_SSD1306_Frame_IsBusy(HAL_SSD1306_FrameTypeDef *frame)
+{
+    return frame->Status == HAL_BUSY;
+}
+
 #endif
@@ -0,0 +1,154 @@
+#include "mik32_hal_boot.h"
+#include "csr.h"
+
+#define HAL_BOOT_SIGNED_LENGTH  16          /* Начало заголовка, входящее в CRC и имитовставку */
+#define HAL_BOOT_MAC_BLOCK      16
+#define HAL_BOOT_MAC_B          0x87        /* Константа B выработки K1 для n = 128 */
+
+/* Результат шифрования участка образа: вне стека (1 КБ), проверка слотов не вызывается повторно */
+static uint32_t HAL_Boot_MacOut[HAL_BOOT_MAC_CHUNK / 4];
+
+static const HAL_Boot_HeaderTypeDef *HAL_Boot_Header(HAL_Boot_TypeDef *boot, uint32_t slot)
+{
+    return (const HAL_Boot_HeaderTypeDef *)boot->Slot[slot];
+}
+
+/**
+ * @brief Заголовок слота записан и длина образа помещается в слот.
+ */
+static int HAL_Boot_HeaderValid(HAL_Boot_TypeDef *boot, uint32_t slot)
+{
+    const HAL_Boot_HeaderTypeDef *header = HAL_Boot_Header(boot, slot);
+
+    return (header->Magic == HAL_BOOT_MAGIC) && (header->Length != 0) &&
+           (header->Length <= boot->SlotSize - HAL_BOOT_HEADER_SIZE);
+}
+
+/**
+ * @brief Проверить имитовставку по ГОСТ Р 34.13-2015 (раздел 5.6).
+ *
+ * Сообщение - первые 16 байт заголовка и образ, длина кратна блоку. Вспомогательный ключ
+ * K1 = R << 1 (с B при старшем бите R), R = E(0). Последний блок складывается с K1, и результат
+ * шифрования в режиме CBC с нулевым вектором после последнего блока сравнивается с Mac.
+ */
+static HAL_StatusTypeDef HAL_Boot_CheckMac(HAL_Boot_TypeDef *boot, const HAL_Boot_HeaderTypeDef *header, const uint8_t *image)
+{
+    HAL_Crypto_StreamTypeDef *stream = boot->Mac;
+    uint32_t iv[IV_LENGTH_KUZNECHIK_CBC] = {0};
+    uint32_t block[HAL_BOOT_MAC_BLOCK / 4] = {0};
+    uint32_t *out = HAL_Boot_MacOut;
+    uint8_t *bytes = (uint8_t *)block;
+    const uint8_t *result = (const uint8_t *)out;
+    uint8_t key1[HAL_BOOT_MAC_BLOCK];
+
+    if (!(header->Flags & HAL_BOOT_FLAG_MAC) || ((header->Length % HAL_BOOT_MAC_BLOCK) != 0))
+    {
+        return HAL_ERROR;
+    }
+
+    HAL_Crypto_Stream_Start(stream, boot->MacKey, iv, CRYPTO_STREAM_ENCODE);
+    HAL_Crypto_Stream_Update(stream, block, out, HAL_BOOT_MAC_BLOCK);
+    for (uint32_t i = 0; i < HAL_BOOT_MAC_BLOCK; i++)
+    {
+        key1[i] = (result[i] << 1) | ((i + 1 < HAL_BOOT_MAC_BLOCK) ? (result[i + 1] >> 7) : 0);
+    }
+    if (result[0] & 0x80)
+    {
+        key1[HAL_BOOT_MAC_BLOCK - 1] ^= HAL_BOOT_MAC_B;
+    }
+
+    /* Все блоки, кроме последнего: результат нужен только после последнего */
+    uint32_t length = header->Length - HAL_BOOT_MAC_BLOCK;
+    HAL_Crypto_Stream_Start(stream, boot->MacKey, iv, CRYPTO_STREAM_ENCODE);
+    HAL_Crypto_Stream_Update(stream, header, out, HAL_BOOT_SIGNED_LENGTH);
+    for (uint32_t offset = 0; offset < length; offset += HAL_BOOT_MAC_CHUNK)
+    {
+        uint32_t chunk = (length - offset < HAL_BOOT_MAC_CHUNK) ? (length - offset) : HAL_BOOT_MAC_CHUNK;
+        HAL_Crypto_Stream_Update(stream, image + offset, out, chunk);
+    }
+
+    for (uint32_t i = 0; i < HAL_BOOT_MAC_BLOCK; i++)
+    {
+        bytes[i] = image[length + i] ^ key1[i];
+    }
+    HAL_Crypto_Stream_Update(stream, block, out, HAL_BOOT_MAC_BLOCK);
+    HAL_Crypto_Stream_Finish(stream);
+
+    uint8_t diff = 0;
+    for (uint32_t i = 0; i < HAL_BOOT_MAC_BLOCK; i++)
+    {
+        diff |= result[i] ^ header->Mac[i];
+    }
+    return (diff == 0) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Проверить образ слота slot.
+ *
+ * @return HAL_ERROR, если заголовок не записан, длина образа больше слота, CRC-32 или
+ * имитовставка (при заданном boot->Mac) не совпадают.
+ */
+HAL_StatusTypeDef HAL_Boot_Verify(HAL_Boot_TypeDef *boot, uint32_t slot)
+{
+    const HAL_Boot_HeaderTypeDef *header = HAL_Boot_Header(boot, slot);
+    const uint8_t *image = (const uint8_t *)HAL_Boot_Entry(boot, slot);
+
+    if (!HAL_Boot_HeaderValid(boot, slot))
+    {
+        return HAL_ERROR;
+    }
+
+    HAL_CRC_Begin(boot->hcrc);
+    HAL_CRC_Update(boot->hcrc, header, HAL_BOOT_SIGNED_LENGTH);
+    if ((HAL_CRC_Update(boot->hcrc, image, header->Length) != HAL_OK) || (HAL_CRC_Final(boot->hcrc) != header->Crc))
+    {
+        return HAL_ERROR;
+    }
+
+    if (boot->Mac != NULL)
+    {
+        return HAL_Boot_CheckMac(boot, header, image);
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Выбрать слот для загрузки.
+ *
+ * Полностью проверяется только слот с наибольшей версией, второй - если первый поврежден.
+ *
+ * @return Номер слота или -1, если исправных образов нет.
+ */
+int HAL_Boot_Select(HAL_Boot_TypeDef *boot)
+{
+    uint32_t first = 0;
+
+    if (HAL_Boot_HeaderValid(boot, 1) &&
+        (!HAL_Boot_HeaderValid(boot, 0) || (HAL_Boot_Header(boot, 1)->Version > HAL_Boot_Header(boot, 0)->Version)))
+    {
+        first = 1;
+    }
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        if (HAL_Boot_Verify(boot, first ^ i) == HAL_OK)
+        {
+            return first ^ i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Перейти к образу слота slot.
+ * Адрес входа в прерывание (mtvec) устанавливается на начало образа.
+ */
+void HAL_Boot_Jump(HAL_Boot_TypeDef *boot, uint32_t slot)
+{
+    uint32_t entry = HAL_Boot_Entry(boot, slot);
+
+    write_csr(mtvec, entry);
+    ((void (*)(void))entry)();
+
+    while (1);
+}
@@ -0,0 +1,623 @@
+#include "mik32_hal_ftl.h"
+
+#include <string.h>
+
+/* Страница заголовка сектора: признак, счетчик стираний, номер записи и его инверсия, теги слотов */
+#define HAL_FTL_MAGIC           0x314C5446  /* "FTL1" */
+#define HAL_FTL_HEADER_MAGIC    0
+#define HAL_FTL_HEADER_ERASE    1
+#define HAL_FTL_HEADER_SEQUENCE 2
+#define HAL_FTL_HEADER_CHECK    3
+#define HAL_FTL_HEADER_WORDS    4           /* Слов до первого тега */
+
+#define HAL_FTL_EMPTY           0xFFFFFFFF
+
+/* Тег слота: номер записи блока и номер блока с контрольной суммой в старшей половине */
+typedef struct __HAL_FTL_TagTypeDef
+{
+    uint32_t Sequence;
+    uint32_t Block;
+} HAL_FTL_TagTypeDef;
+
+
+static uint32_t HAL_FTL_SectorAddress(HAL_FTL_TypeDef *ftl, uint32_t sector)
+{
+    return ftl->BaseAddress + sector * HAL_FTL_SECTOR_SIZE;
+}
+
+static uint32_t HAL_FTL_SlotAddress(HAL_FTL_TypeDef *ftl, uint32_t physical)
+{
+    return HAL_FTL_SectorAddress(ftl, physical / HAL_FTL_SLOTS) + HAL_FTL_BLOCK_SIZE * (1 + physical % HAL_FTL_SLOTS);
+}
+
+static uint32_t HAL_FTL_TagAddress(HAL_FTL_TypeDef *ftl, uint32_t physical)
+{
+    return HAL_FTL_SectorAddress(ftl, physical / HAL_FTL_SLOTS) +
+           4 * HAL_FTL_HEADER_WORDS + sizeof(HAL_FTL_TagTypeDef) * (physical % HAL_FTL_SLOTS);
+}
+
+static uint32_t HAL_FTL_TagCheck(uint32_t block, uint32_t sequence)
+{
+    return (block ^ sequence ^ (sequence >> 16) ^ 0xFFFF) & 0xFFFF;
+}
+
+/**
+ * @brief Номер блока из тега или HAL_FTL_NONE, если тег пуст или поврежден.
+ */
+static uint32_t HAL_FTL_TagBlock(HAL_FTL_TypeDef *ftl, const HAL_FTL_TagTypeDef *tag)
+{
+    uint32_t block = tag->Block & 0xFFFF;
+
+    if (((tag->Block >> 16) != HAL_FTL_TagCheck(block, tag->Sequence)) || (block >= ftl->BlockCount))
+    {
+        return HAL_FTL_NONE;
+    }
+    return block;
+}
+
+static void HAL_FTL_Remap(HAL_FTL_TypeDef *ftl, uint32_t block, uint32_t physical)
+{
+    uint32_t old = ftl->Map[block];
+
+    if (old != HAL_FTL_UNMAPPED)
+    {
+        ftl->Sectors[old / HAL_FTL_SLOTS].Valid--;
+    }
+    ftl->Map[block] = physical;
+    ftl->Sectors[physical / HAL_FTL_SLOTS].Valid++;
+}
+
+/**
+ * @brief Стереть сектор и записать заголовок со счетчиком стираний eraseCount.
+ */
+static HAL_StatusTypeDef HAL_FTL_EraseSector(HAL_FTL_TypeDef *ftl, uint32_t sector, uint32_t eraseCount)
+{
+    HAL_FTL_SectorTypeDef *s = &ftl->Sectors[sector];
+    uint32_t header[2] = {HAL_FTL_MAGIC, eraseCount};
+    uint32_t address = HAL_FTL_SectorAddress(ftl, sector);
+
+    s->EraseCount = eraseCount;
+    s->Sequence = HAL_FTL_NONE;
+    s->Valid = 0;
+    s->Written = 0;
+    s->State = FTL_SECTOR_DIRTY;
+
+    ftl->Erases++;
+    if ((ftl->Flash->Erase(ftl->Context, address) != HAL_OK) ||
+        (ftl->Flash->Program(ftl->Context, address, header, sizeof(header)) != HAL_OK))
+    {
+        return HAL_ERROR;
+    }
+
+    s->State = FTL_SECTOR_FREE;
+    ftl->FreeCount++;
+    return HAL_OK;
+}
+
+/**
+ * @brief Открыть для записи потока stream свободный сектор с наименьшим счетчиком стираний.
+ *
+ * @param reserve наименьшее число свободных секторов, при котором сектор может быть открыт.
+ */
+static HAL_StatusTypeDef HAL_FTL_Open(HAL_FTL_TypeDef *ftl, uint32_t stream, uint32_t reserve)
+{
+    uint32_t sector = HAL_FTL_NONE;
+
+    if (ftl->FreeCount < reserve)
+    {
+        return HAL_ERROR;
+    }
+
+    for (uint32_t i = 0; i < ftl->SectorCount; i++)
+    {
+        if ((ftl->Sectors[i].State == FTL_SECTOR_FREE) &&
+            ((sector == HAL_FTL_NONE) || (ftl->Sectors[i].EraseCount < ftl->Sectors[sector].EraseCount)))
+        {
+            sector = i;
+        }
+    }
+    if (sector == HAL_FTL_NONE)
+    {
+        return HAL_ERROR;
+    }
+
+    HAL_FTL_SectorTypeDef *s = &ftl->Sectors[sector];
+    uint32_t sequence[2] = {ftl->Sequence, ~ftl->Sequence};
+
+    /* Сектор с записанным номером не считается свободным и при ошибке записи */
+    s->Sequence = ftl->Sequence++;
+    s->State = FTL_SECTOR_ACTIVE;
+    ftl->FreeCount--;
+    ftl->Active[stream] = sector;
+
+    return ftl->Flash->Program(ftl->Context, HAL_FTL_SectorAddress(ftl, sector) + 4 * HAL_FTL_HEADER_SEQUENCE,
+                               sequence, sizeof(sequence));
+}
+
+/**
+ * @brief Дописать блок в активный сектор потока stream, при необходимости открыв новый. Если
+ * открыть сектор нельзя, блок дописывается в активный сектор другого потока.
+ */
+static HAL_StatusTypeDef HAL_FTL_Append(HAL_FTL_TypeDef *ftl, uint32_t stream, uint32_t block, const void *data,
+                                        uint32_t reserve)
+{
+    HAL_StatusTypeDef status;
+
+    if (ftl->Active[stream] == HAL_FTL_NONE)
+    {
+        status = HAL_FTL_Open(ftl, stream, reserve);
+        if (status != HAL_OK)
+        {
+            stream ^= 1;
+            if (ftl->Active[stream] == HAL_FTL_NONE)
+            {
+                return status;
+            }
+        }
+    }
+
+    uint32_t sector = ftl->Active[stream];
+    HAL_FTL_SectorTypeDef *s = &ftl->Sectors[sector];
+    uint32_t slot = s->Written++;
+    uint32_t physical = sector * HAL_FTL_SLOTS + slot;
+    uint32_t sequence = ftl->Sequence++;
+    HAL_FTL_TagTypeDef tag = {sequence, block | (HAL_FTL_TagCheck(block, sequence) << 16)};
+
+    /* Заполненный сектор сразу становится кандидатом для сборки мусора */
+    if (s->Written == HAL_FTL_SLOTS)
+    {
+        s->State = FTL_SECTOR_FULL;
+        ftl->Active[stream] = HAL_FTL_NONE;
+    }
+
+    /* Данные раньше тега: без тега слот считается пустым */
+    status = ftl->Flash->Program(ftl->Context, HAL_FTL_SlotAddress(ftl, physical), data, HAL_FTL_BLOCK_SIZE);
+    if (status == HAL_OK)
+    {
+        status = ftl->Flash->Program(ftl->Context, HAL_FTL_TagAddress(ftl, physical), &tag, sizeof(tag));
+    }
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    ftl->FlashWrites++;
+    HAL_FTL_Remap(ftl, block, physical);
+    return HAL_OK;
+}
+
+/**
+ * @brief Перенести действительные блоки сектора в поток сборки мусора и стереть сектор.
+ */
+static HAL_StatusTypeDef HAL_FTL_Relocate(HAL_FTL_TypeDef *ftl, uint32_t sector)
+{
+    HAL_FTL_SectorTypeDef *s = &ftl->Sectors[sector];
+    HAL_FTL_TagTypeDef tags[HAL_FTL_SLOTS];
+    HAL_StatusTypeDef status;
+
+    if (s->Valid != 0)
+    {
+        status = ftl->Flash->Read(ftl->Context, HAL_FTL_TagAddress(ftl, sector * HAL_FTL_SLOTS), tags, sizeof(tags));
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+    }
+
+    for (uint32_t slot = 0; (slot < s->Written) && (s->Valid != 0); slot++)
+    {
+        uint32_t physical = sector * HAL_FTL_SLOTS + slot;
+        uint32_t block = HAL_FTL_TagBlock(ftl, &tags[slot]);
+
+        if ((block == HAL_FTL_NONE) || (ftl->Map[block] != physical))
+        {
+            continue;
+        }
+
+        status = ftl->Flash->Read(ftl->Context, HAL_FTL_SlotAddress(ftl, physical), ftl->Buffer, HAL_FTL_BLOCK_SIZE);
+        if (status == HAL_OK)
+        {
+            status = HAL_FTL_Append(ftl, HAL_FTL_STREAM_COLLECT, block, ftl->Buffer, 1);
+        }
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+    }
+
+    return HAL_FTL_EraseSector(ftl, sector, s->EraseCount + 1);
+}
+
+/**
+ * @brief Заполненный сектор с наименьшим числом действительных блоков, при равенстве - с наименьшим
+ * счетчиком стираний. HAL_FTL_NONE, если освободить слоты нельзя.
+ */
+static uint32_t HAL_FTL_Victim(HAL_FTL_TypeDef *ftl)
+{
+    uint32_t victim = HAL_FTL_NONE;
+
+    for (uint32_t i = 0; i < ftl->SectorCount; i++)
+    {
+        HAL_FTL_SectorTypeDef *s = &ftl->Sectors[i];
+
+        if ((s->State != FTL_SECTOR_FULL) || (s->Valid == HAL_FTL_SLOTS))
+        {
+            continue;
+        }
+        if ((victim == HAL_FTL_NONE) || (s->Valid < ftl->Sectors[victim].Valid) ||
+            ((s->Valid == ftl->Sectors[victim].Valid) && (s->EraseCount < ftl->Sectors[victim].EraseCount)))
+        {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/**
+ * @brief Инициализация структуры. Перед использованием необходимо вызвать HAL_FTL_Mount или HAL_FTL_Format.
+ * До этого можно изменить BlockCount, WearThreshold и CollectThreshold; BlockCount не должен меняться
+ * между монтированиями.
+ *
+ * @param flash операции с флеш-памятью (например, &HAL_FTL_W25_Flash).
+ * @param context первый аргумент операций.
+ * @param BaseAddress начало области во флеш-памяти, кратно HAL_FTL_SECTOR_SIZE.
+ * @param SectorCount число секторов области, больше HAL_FTL_RESERVE.
+ * @param Map таблица отображения на HAL_FTL_BLOCKS(SectorCount) элементов.
+ * @param Sectors массив состояний на SectorCount элементов.
+ */
+void HAL_FTL_Init(HAL_FTL_TypeDef *ftl, const HAL_FTL_FlashTypeDef *flash, void *context, uint32_t BaseAddress,
+                  uint32_t SectorCount, uint16_t *Map, HAL_FTL_SectorTypeDef *Sectors)
+{
+    ftl->Flash = flash;
+    ftl->Context = context;
+    ftl->BaseAddress = BaseAddress;
+    ftl->SectorCount = SectorCount;
+    ftl->Map = Map;
+    ftl->Sectors = Sectors;
+    ftl->WearThreshold = 0;
+    ftl->CollectThreshold = HAL_FTL_RESERVE + 1;
+    ftl->HostWrites = 0;
+    ftl->FlashWrites = 0;
+    ftl->Erases = 0;
+    ftl->BlockCount = HAL_FTL_BLOCKS(SectorCount);
+    ftl->Sequence = 0;
+    ftl->Active[HAL_FTL_STREAM_HOST] = HAL_FTL_NONE;
+    ftl->Active[HAL_FTL_STREAM_COLLECT] = HAL_FTL_NONE;
+    ftl->FreeCount = 0;
+}
+
+/**
+ * @brief Стереть все секторы области. Счетчики стираний из действительных заголовков сохраняются.
+ */
+HAL_StatusTypeDef HAL_FTL_Format(HAL_FTL_TypeDef *ftl)
+{
+    ftl->Sequence = 0;
+    ftl->Active[HAL_FTL_STREAM_HOST] = HAL_FTL_NONE;
+    ftl->Active[HAL_FTL_STREAM_COLLECT] = HAL_FTL_NONE;
+    ftl->FreeCount = 0;
+    memset(ftl->Map, 0xFF, ftl->BlockCount * sizeof(ftl->Map[0]));
+
+    for (uint32_t i = 0; i < ftl->SectorCount; i++)
+    {
+        uint32_t header[2];
+        HAL_StatusTypeDef status = ftl->Flash->Read(ftl->Context, HAL_FTL_SectorAddress(ftl, i), header, sizeof(header));
+
+        if (status == HAL_OK)
+        {
+            status = HAL_FTL_EraseSector(ftl, i, header[HAL_FTL_HEADER_MAGIC] == HAL_FTL_MAGIC ? header[HAL_FTL_HEADER_ERASE] + 1 : 0);
+        }
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Восстановить таблицу отображения по заголовкам секторов.
+ *
+ * Из нескольких версий блока действительна версия с наибольшим номером записи в теге. Секторы с поврежденным заголовком (прерванное стирание)
+ * стираются повторно. Запись продолжается в последние открытые секторы; слот, запись в который
+ * могла быть прервана, пропускается.
+ *
+ * @return HAL_ERROR, если область не отформатирована (нет ни одного действительного заголовка).
+ */
+HAL_StatusTypeDef HAL_FTL_Mount(HAL_FTL_TypeDef *ftl)
+{
+    uint32_t header[HAL_FTL_HEADER_WORDS];
+    HAL_FTL_TagTypeDef tags[HAL_FTL_SLOTS];
+    uint32_t maxErase = 0;
+    uint32_t formatted = 0;
+    HAL_StatusTypeDef status;
+
+    ftl->Sequence = 0;
+    ftl->Active[HAL_FTL_STREAM_HOST] = HAL_FTL_NONE;
+    ftl->Active[HAL_FTL_STREAM_COLLECT] = HAL_FTL_NONE;
+    ftl->FreeCount = 0;
+    memset(ftl->Map, 0xFF, ftl->BlockCount * sizeof(ftl->Map[0]));
+
+    for (uint32_t i = 0; i < ftl->SectorCount; i++)
+    {
+        HAL_FTL_SectorTypeDef *s = &ftl->Sectors[i];
+
+        status = ftl->Flash->Read(ftl->Context, HAL_FTL_SectorAddress(ftl, i), header, sizeof(header));
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+
+        s->EraseCount = 0;
+        s->Sequence = HAL_FTL_NONE;
+        s->Valid = 0;
+        s->Written = 0;
+        s->State = FTL_SECTOR_DIRTY;
+
+        if (header[HAL_FTL_HEADER_MAGIC] != HAL_FTL_MAGIC)
+        {
+            continue;
+        }
+        formatted = 1;
+        s->EraseCount = header[HAL_FTL_HEADER_ERASE];
+        if (s->EraseCount > maxErase)
+        {
+            maxErase = s->EraseCount;
+        }
+
+        s->Sequence = header[HAL_FTL_HEADER_SEQUENCE];
+        if ((s->Sequence == HAL_FTL_NONE) && (header[HAL_FTL_HEADER_CHECK] == HAL_FTL_EMPTY))
+        {
+            s->State = FTL_SECTOR_FREE;
+            ftl->FreeCount++;
+            continue;
+        }
+        /* Запись номера прервана: данных в секторе еще нет */
+        if ((s->Sequence ^ header[HAL_FTL_HEADER_CHECK]) != HAL_FTL_EMPTY)
+        {
+            s->Sequence = HAL_FTL_NONE;
+            continue;
+        }
+        s->State = FTL_SECTOR_FULL;
+        if (s->Sequence >= ftl->Sequence)
+        {
+            ftl->Sequence = s->Sequence + 1;
+        }
+    }
+
+    if (!formatted)
+    {
+        return HAL_ERROR;
+    }
+
+    /* Теги разбираются после того, как известны номера записи всех секторов */
+    for (uint32_t i = 0; i < ftl->SectorCount; i++)
+    {
+        HAL_FTL_SectorTypeDef *s = &ftl->Sectors[i];
+
+        if (s->State != FTL_SECTOR_FULL)
+        {
+            continue;
+        }
+
+        status = ftl->Flash->Read(ftl->Context, HAL_FTL_TagAddress(ftl, i * HAL_FTL_SLOTS), tags, sizeof(tags));
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+
+        for (uint32_t slot = 0; slot < HAL_FTL_SLOTS; slot++)
+        {
+            uint32_t block = HAL_FTL_TagBlock(ftl, &tags[slot]);
+            uint32_t current;
+            HAL_FTL_TagTypeDef mapped;
+
+            if ((tags[slot].Sequence != HAL_FTL_EMPTY) || (tags[slot].Block != HAL_FTL_EMPTY))
+            {
+                s->Written = slot + 1;
+            }
+            if (block == HAL_FTL_NONE)
+            {
+                continue;
+            }
+            if (tags[slot].Sequence >= ftl->Sequence)
+            {
+                ftl->Sequence = tags[slot].Sequence + 1;
+            }
+
+            current = ftl->Map[block];
+            if (current == HAL_FTL_UNMAPPED)
+            {
+                HAL_FTL_Remap(ftl, block, i * HAL_FTL_SLOTS + slot);
+                continue;
+            }
+
+            /* Версии блока упорядочены номером записи тега: секторы потоков заполняются одновременно */
+            if (current / HAL_FTL_SLOTS == i)
+            {
+                mapped = tags[current % HAL_FTL_SLOTS];
+            }
+            else
+            {
+                status = ftl->Flash->Read(ftl->Context, HAL_FTL_TagAddress(ftl, current), &mapped, sizeof(mapped));
+                if (status != HAL_OK)
+                {
+                    return status;
+                }
+            }
+            if (tags[slot].Sequence > mapped.Sequence)
+            {
+                HAL_FTL_Remap(ftl, block, i * HAL_FTL_SLOTS + slot);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < ftl->SectorCount; i++)
+    {
+        if (ftl->Sectors[i].State == FTL_SECTOR_DIRTY)
+        {
+            status = HAL_FTL_EraseSector(ftl, i, maxErase);
+            if (status != HAL_OK)
+            {
+                return status;
+            }
+        }
+    }
+
+    /* Запись продолжается в два последних открытых сектора, в которых есть свободные слоты */
+    for (uint32_t stream = HAL_FTL_STREAM_HOST; stream <= HAL_FTL_STREAM_COLLECT; stream++)
+    {
+        uint32_t sector = HAL_FTL_NONE;
+
+        for (uint32_t i = 0; i < ftl->SectorCount; i++)
+        {
+            HAL_FTL_SectorTypeDef *s = &ftl->Sectors[i];
+
+            if ((s->State == FTL_SECTOR_FULL) && (s->Written < HAL_FTL_SLOTS) &&
+                ((sector == HAL_FTL_NONE) || (s->Sequence > ftl->Sectors[sector].Sequence)))
+            {
+                sector = i;
+            }
+        }
+        if (sector == HAL_FTL_NONE)
+        {
+            break;
+        }
+
+        /* Данные первого слота без тега могли быть записаны частично */
+        HAL_FTL_SectorTypeDef *s = &ftl->Sectors[sector];
+        status = ftl->Flash->Read(ftl->Context, HAL_FTL_SlotAddress(ftl, sector * HAL_FTL_SLOTS + s->Written),
+                                  ftl->Buffer, HAL_FTL_BLOCK_SIZE);
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+        for (uint32_t j = 0; j < HAL_FTL_BLOCK_SIZE; j++)
+        {
+            if (ftl->Buffer[j] != 0xFF)
+            {
+                s->Written++;
+                break;
+            }
+        }
+        if (s->Written < HAL_FTL_SLOTS)
+        {
+            s->State = FTL_SECTOR_ACTIVE;
+            ftl->Active[stream] = sector;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Прочитать логический блок. Блок, который ни разу не записывался, заполняется 0xFF.
+ *
+ * @param Data HAL_FTL_BLOCK_SIZE байт.
+ */
+HAL_StatusTypeDef HAL_FTL_Read(HAL_FTL_TypeDef *ftl, uint32_t Block, void *Data)
+{
+    if (Block >= ftl->BlockCount)
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t physical = ftl->Map[Block];
+    if (physical == HAL_FTL_UNMAPPED)
+    {
+        memset(Data, 0xFF, HAL_FTL_BLOCK_SIZE);
+        return HAL_OK;
+    }
+    return ftl->Flash->Read(ftl->Context, HAL_FTL_SlotAddress(ftl, physical), Data, HAL_FTL_BLOCK_SIZE);
+}
+
+/**
+ * @brief Записать логический блок.
+ *
+ * Если свободных слотов не осталось, перед записью выполняется сборка мусора (перенос не более
+ * HAL_FTL_SLOTS - 1 блоков и стирание сектора). Чтобы запись не ждала стирания, вызывайте
+ * HAL_FTL_Collect в свободное время.
+ *
+ * @param Data HAL_FTL_BLOCK_SIZE байт.
+ */
+HAL_StatusTypeDef HAL_FTL_Write(HAL_FTL_TypeDef *ftl, uint32_t Block, const void *Data)
+{
+    if (Block >= ftl->BlockCount)
+    {
+        return HAL_ERROR;
+    }
+
+    /*
+     * Последний свободный сектор остается для сборки мусора. Если его нет (питание пропало во
+     * время сборки), сборка завершается до записи: переносимые блоки помещаются в активный сектор.
+     * Если освобождать нечего, блок дописывается в сектор потока сборки мусора.
+     */
+    while (((ftl->Active[HAL_FTL_STREAM_HOST] == HAL_FTL_NONE) && (ftl->FreeCount < HAL_FTL_RESERVE)) ||
+           (ftl->FreeCount == 0))
+    {
+        uint32_t victim = HAL_FTL_Victim(ftl);
+        HAL_StatusTypeDef status;
+
+        if (victim == HAL_FTL_NONE)
+        {
+            break;
+        }
+        status = HAL_FTL_Relocate(ftl, victim);
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+    }
+
+    ftl->HostWrites++;
+    return HAL_FTL_Append(ftl, HAL_FTL_STREAM_HOST, Block, Data, HAL_FTL_RESERVE);
+}
+
+/**
+ * @brief Фоновая сборка мусора и выравнивание износа: освобождает не более одного сектора.
+ *
+ * Сектор с наименьшим числом действительных блоков освобождается, если свободных секторов
+ * меньше CollectThreshold. Если разница счетчиков стираний превышает WearThreshold, вместо
+ * него освобождается заполненный сектор с наименьшим счетчиком.
+ *
+ * @return 1, если сектор освобожден, 0, если работы нет или произошла ошибка.
+ */
+int HAL_FTL_Collect(HAL_FTL_TypeDef *ftl)
+{
+    uint32_t victim = HAL_FTL_NONE;
+
+    /* Перенос заполненного сектора требует до HAL_FTL_SLOTS слотов: активный сектор и один свободный */
+    if ((ftl->WearThreshold != 0) && (ftl->FreeCount >= HAL_FTL_RESERVE))
+    {
+        uint32_t maxErase = 0;
+
+        for (uint32_t i = 0; i < ftl->SectorCount; i++)
+        {
+            HAL_FTL_SectorTypeDef *s = &ftl->Sectors[i];
+
+            if (s->EraseCount > maxErase)
+            {
+                maxErase = s->EraseCount;
+            }
+            if ((s->State == FTL_SECTOR_FULL) &&
+                ((victim == HAL_FTL_NONE) || (s->EraseCount < ftl->Sectors[victim].EraseCount)))
+            {
+                victim = i;
+            }
+        }
+        if ((victim != HAL_FTL_NONE) && (maxErase - ftl->Sectors[victim].EraseCount <= ftl->WearThreshold))
+        {
+            victim = HAL_FTL_NONE;
+        }
+    }
+
+    if ((victim == HAL_FTL_NONE) && (ftl->FreeCount < ftl->CollectThreshold))
+    {
+        victim = HAL_FTL_Victim(ftl);
+    }
+    if (victim == HAL_FTL_NONE)
+    {
+        return 0;
+    }
+
+    return HAL_FTL_Relocate(ftl, victim) == HAL_OK;
+}
@@ -0,0 +1,34 @@
+#include "mik32_hal_ftl.h"
+#include "mik32_hal_spifi_w25.h"
+
+#define HAL_FTL_W25_BUSY 1000000
+
+
+static HAL_StatusTypeDef HAL_FTL_W25_Read(void *context, uint32_t address, void *data, uint32_t length)
+{
+    HAL_SPIFI_W25_ReadData((SPIFI_HandleTypeDef *)context, address, length, (uint8_t *)data);
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef HAL_FTL_W25_Program(void *context, uint32_t address, const void *data, uint32_t length)
+{
+    SPIFI_HandleTypeDef *spifi = (SPIFI_HandleTypeDef *)context;
+
+    HAL_SPIFI_W25_PageProgram(spifi, address, length, (uint8_t *)data);
+    return HAL_SPIFI_W25_WaitBusy(spifi, HAL_FTL_W25_BUSY);
+}
+
+static HAL_StatusTypeDef HAL_FTL_W25_Erase(void *context, uint32_t address)
+{
+    SPIFI_HandleTypeDef *spifi = (SPIFI_HandleTypeDef *)context;
+
+    /* HAL_SPIFI_W25_SectorErase4K ожидает меньше типового времени стирания, ожидание продолжается здесь */
+    HAL_SPIFI_W25_SectorErase4K(spifi, address);
+    return HAL_SPIFI_W25_WaitBusy(spifi, HAL_FTL_W25_BUSY);
+}
+
+const HAL_FTL_FlashTypeDef HAL_FTL_W25_Flash = {
+    .Read = HAL_FTL_W25_Read,
+    .Program = HAL_FTL_W25_Program,
+    .Erase = HAL_FTL_W25_Erase,
+};
@@ -0,0 +1,243 @@
+#include "mik32_hal_sfdp.h"
+
+#include <string.h>
+
+/* Слова основной таблицы (нумерация JESD216 с 1) */
+#define HAL_SFDP_DWORD(n)           ((n) - 1)
+#define HAL_SFDP_BFPT_MIN_DWORDS    9           /* Ревизия 1.0 */
+
+#define HAL_SFDP_FAST_READ          0x0B
+
+
+static uint32_t HAL_SFDP_Word(const uint8_t *bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+/**
+ * @brief Команда чтения из 16-р поля таблицы: биты 4:0 - холостые такты, 7:5 - такты битов режима, 15:8 - код операции.
+ */
+static void HAL_SFDP_ReadEntry(HAL_SFDP_ReadTypeDef *entry, uint32_t field)
+{
+    entry->Opcode = (field >> 8) & 0xFF;
+    entry->ModeClocks = (field >> 5) & 0x7;
+    entry->Dummy = (field & 0x1F) + entry->ModeClocks;
+}
+
+/**
+ * @brief Найти основную таблицу с наибольшей младшей ревизией.
+ * @return HAL_ERROR, если заголовок SFDP неверен или таблицы нет.
+ */
+static HAL_StatusTypeDef HAL_SFDP_FindBFPT(HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadFuncTypeDef read, void *context, uint32_t *pointer)
+{
+    uint8_t header[8];
+
+    if ((read(context, 0, header, sizeof(header)) != HAL_OK) || (HAL_SFDP_Word(header) != HAL_SFDP_SIGNATURE) || (header[5] != 1))
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t headers = header[6] + 1;
+    if (headers > HAL_SFDP_HEADERS_MAX)
+    {
+        headers = HAL_SFDP_HEADERS_MAX;
+    }
+
+    for (uint32_t i = 0; i < headers; i++)
+    {
+        if (read(context, sizeof(header) * (i + 1), header, sizeof(header)) != HAL_OK)
+        {
+            return HAL_ERROR;
+        }
+
+        uint32_t id = header[0] | (header[7] << 8);
+        if ((id == HAL_SFDP_BFPT_ID) && (header[2] == 1) && (header[3] >= HAL_SFDP_BFPT_MIN_DWORDS) &&
+            ((sfdp->Major == 0) || (header[1] > sfdp->Minor)))
+        {
+            sfdp->Major = header[2];
+            sfdp->Minor = header[1];
+            sfdp->Dwords = header[3];
+            *pointer = header[4] | (header[5] << 8) | (header[6] << 16);
+        }
+    }
+
+    return (sfdp->Major != 0) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Прочитать и разобрать основную таблицу параметров JEDEC.
+ *
+ * @param sfdp Результат. Поля неподдерживаемых возможностей обнуляются.
+ * @param read Чтение пространства SFDP.
+ * @param context Первый аргумент read.
+ * @return HAL_ERROR, если признак SFDP или основная таблица не найдены, таблица повреждена или
+ * флеш-память поддерживает только 4-байтовые адреса.
+ */
+HAL_StatusTypeDef HAL_SFDP_Parse(HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadFuncTypeDef read, void *context)
+{
+    uint8_t bytes[4 * HAL_SFDP_BFPT_DWORDS];
+    uint32_t bfpt[HAL_SFDP_BFPT_DWORDS];
+    uint32_t pointer = 0;
+
+    memset(sfdp, 0, sizeof(*sfdp));
+    sfdp->QuadEnable = SFDP_QE_UNKNOWN;
+
+    if (HAL_SFDP_FindBFPT(sfdp, read, context, &pointer) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t count = sfdp->Dwords < HAL_SFDP_BFPT_DWORDS ? sfdp->Dwords : HAL_SFDP_BFPT_DWORDS;
+    if (read(context, pointer, bytes, 4 * count) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bfpt[i] = HAL_SFDP_Word(&bytes[4 * i]);
+    }
+
+    /* Адресация: 0 - 3 байта, 1 - 3 или 4 байта, 2 - только 4 байта */
+    uint32_t dword = bfpt[HAL_SFDP_DWORD(1)];
+    if (((dword >> 17) & 0x3) == 2)
+    {
+        return HAL_ERROR;
+    }
+
+    /* Объем в битах: N + 1 или 2^N при установленном старшем бите */
+    uint32_t density = bfpt[HAL_SFDP_DWORD(2)];
+    if (density & 0x80000000)
+    {
+        density &= 0x7FFFFFFF;
+        if ((density < 3) || (density > 34))
+        {
+            return HAL_ERROR;
+        }
+        sfdp->Size = 1UL << (density - 3);
+    }
+    else
+    {
+        sfdp->Size = (density + 1) / 8;
+    }
+
+    sfdp->Read[SFDP_READ_1_1_1] = (HAL_SFDP_ReadTypeDef){.Opcode = HAL_SFDP_FAST_READ, .Dummy = 8};
+    if (dword & (1UL << 22))
+    {
+        HAL_SFDP_ReadEntry(&sfdp->Read[SFDP_READ_1_1_4], bfpt[HAL_SFDP_DWORD(3)] >> 16);
+    }
+    if (dword & (1UL << 21))
+    {
+        HAL_SFDP_ReadEntry(&sfdp->Read[SFDP_READ_1_4_4], bfpt[HAL_SFDP_DWORD(3)]);
+    }
+    if (bfpt[HAL_SFDP_DWORD(5)] & (1UL << 4))
+    {
+        HAL_SFDP_ReadEntry(&sfdp->Read[SFDP_READ_4_4_4], bfpt[HAL_SFDP_DWORD(7)] >> 16);
+    }
+
+    /* Типы стирания 1 - 4: размер 2^N и код операции, упорядочиваются по размеру */
+    uint32_t erases = 0;
+    for (uint32_t type = 0; type < 4; type++)
+    {
+        uint32_t field = bfpt[HAL_SFDP_DWORD(8) + type / 2] >> (16 * (type % 2));
+        HAL_SFDP_EraseTypeDef erase = {.Opcode = (field >> 8) & 0xFF, .SizeShift = field & 0xFF};
+
+        if (erase.SizeShift == 0)
+        {
+            continue;
+        }
+        uint32_t i = erases++;
+        while ((i > 0) && (sfdp->Erase[i - 1].SizeShift > erase.SizeShift))
+        {
+            sfdp->Erase[i] = sfdp->Erase[i - 1];
+            i--;
+        }
+        sfdp->Erase[i] = erase;
+    }
+
+    sfdp->PageSize = 256;
+    if (count >= 11)
+    {
+        sfdp->PageSize = 1UL << ((bfpt[HAL_SFDP_DWORD(11)] >> 4) & 0xF);
+    }
+
+    /* Бит 31 слова 12: 0 - приостановка поддерживается */
+    if ((count >= 13) && !(bfpt[HAL_SFDP_DWORD(12)] & 0x80000000))
+    {
+        sfdp->SuspendOpcode = bfpt[HAL_SFDP_DWORD(13)] >> 24;
+        sfdp->ResumeOpcode = (bfpt[HAL_SFDP_DWORD(13)] >> 16) & 0xFF;
+    }
+
+    if (count >= 15)
+    {
+        dword = bfpt[HAL_SFDP_DWORD(15)];
+
+        uint32_t qer = (dword >> 20) & 0x7;
+        sfdp->QuadEnable = (qer <= SFDP_QE_SR2_BIT1_31H) ? qer : SFDP_QE_UNKNOWN;
+
+        /* Вход в 4-4-4: биты 8:4, 0x38 (после установки QE или без нее) или 0x35 */
+        uint32_t enter = (dword >> 4) & 0x1F;
+        if (enter & 0x03)
+        {
+            sfdp->QpiEnterOpcode = 0x38;
+        }
+        else if (enter & 0x04)
+        {
+            sfdp->QpiEnterOpcode = 0x35;
+        }
+
+        /* Выход из 4-4-4: биты 3:0, 0xFF или 0xF5 */
+        if (dword & 0x1)
+        {
+            sfdp->QpiExitOpcode = 0xFF;
+        }
+        else if (dword & 0x2)
+        {
+            sfdp->QpiExitOpcode = 0xF5;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Число промежуточных байт команды чтения mode.
+ *
+ * Холостые такты передаются по линиям адреса: 8 тактов на байт для 1-1-1 и 1-1-4, 2 такта
+ * для 1-4-4 и 4-4-4.
+ *
+ * @return -1, если команда не поддерживается или такты не составляют целого числа байт не больше HAL_SFDP_INTERIM_MAX.
+ */
+int HAL_SFDP_InterimLength(const HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadModeTypeDef mode)
+{
+    const HAL_SFDP_ReadTypeDef *entry = &sfdp->Read[mode];
+    uint32_t clocks = ((mode == SFDP_READ_1_1_1) || (mode == SFDP_READ_1_1_4)) ? 8 : 2;
+
+    if ((entry->Opcode == 0) || (entry->Dummy % clocks != 0) || (entry->Dummy / clocks > HAL_SFDP_INTERIM_MAX))
+    {
+        return -1;
+    }
+    return entry->Dummy / clocks;
+}
+
+/**
+ * @brief Выбрать самую быструю команду чтения не выше MaxMode.
+ *
+ * Четырехпроводные команды выбираются при известном способе установки QE, 4-4-4 - также при
+ * известных командах входа в QPI и выхода из него.
+ */
+HAL_SFDP_ReadModeTypeDef HAL_SFDP_SelectRead(const HAL_SFDP_TypeDef *sfdp, HAL_SFDP_ReadModeTypeDef MaxMode)
+{
+    for (int mode = MaxMode; mode > SFDP_READ_1_1_1; mode--)
+    {
+        if ((HAL_SFDP_InterimLength(sfdp, mode) < 0) || (sfdp->QuadEnable == SFDP_QE_UNKNOWN))
+        {
+            continue;
+        }
+        if ((mode == SFDP_READ_4_4_4) && ((sfdp->QpiEnterOpcode == 0) || (sfdp->QpiExitOpcode == 0)))
+        {
+            continue;
+        }
+        return mode;
+    }
+    return SFDP_READ_1_1_1;
+}
@@ -0,0 +1,301 @@
+#include "mik32_hal_spifi_sfdp.h"
+
+/* Команды, общие для флеш-памяти разных производителей */
+#define SPIFI_SFDP_WRITE_ENABLE     0x06
+#define SPIFI_SFDP_READ_SREG1       0x05
+#define SPIFI_SFDP_READ_SREG2       0x35
+#define SPIFI_SFDP_READ_SREG2_3F    0x3F
+#define SPIFI_SFDP_WRITE_SREG       0x01
+#define SPIFI_SFDP_WRITE_SREG2      0x31
+#define SPIFI_SFDP_WRITE_SREG2_3E   0x3E
+#define SPIFI_SFDP_PAGE_PROGRAM     0x02
+#define SPIFI_SFDP_READ_SFDP        0x5A
+
+#define SPIFI_SFDP_SREG1_BUSY_M     (1 << 0)
+
+/* Ожидание записи регистра состояния */
+#define SPIFI_SFDP_WRITE_SREG_BUSY  10000
+
+/* Чтение SFDP: всегда по одной линии, 8 холостых тактов */
+static const uint32_t cmd_read_sfdp =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(1) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
+    SPIFI_CONFIG_CMD_OPCODE(SPIFI_SFDP_READ_SFDP);
+
+
+/**
+ * @brief Команда без промежуточных данных: по одной линии или по четырем в режиме QPI.
+ */
+static uint32_t HAL_SPIFI_SFDP_Command(HAL_SPIFI_SFDP_TypeDef *flash, HAL_SPIFI_DirectionTypeDef direction,
+                                       HAL_SPIFI_FrameFormTypeDef frameForm, uint8_t opcode)
+{
+    return direction |
+           SPIFI_CONFIG_CMD_INTLEN(0) |
+           SPIFI_CONFIG_CMD_FIELDFORM(flash->Qpi ? SPIFI_FIELDFORM_ALL_PARALLEL : SPIFI_FIELDFORM_ALL_SERIAL) |
+           SPIFI_CONFIG_CMD_FRAMEFORM(frameForm) |
+           SPIFI_CONFIG_CMD_OPCODE(opcode);
+}
+
+static HAL_StatusTypeDef HAL_SPIFI_SFDP_ReadSFDP(void *context, uint32_t address, void *data, uint32_t length)
+{
+    return HAL_SPIFI_SendCommand_LL((SPIFI_HandleTypeDef *)context, cmd_read_sfdp, address, length, data, 0, 0, HAL_SPIFI_TIMEOUT);
+}
+
+static uint8_t HAL_SPIFI_SFDP_ReadRegister(HAL_SPIFI_SFDP_TypeDef *flash, uint8_t opcode)
+{
+    uint8_t byte = 0;
+
+    HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_INPUT, SPIFI_FRAMEFORM_OPCODE, opcode),
+                             0, 1, &byte, 0, 0, HAL_SPIFI_TIMEOUT);
+    return byte;
+}
+
+static void HAL_SPIFI_SFDP_WriteEnable(HAL_SPIFI_SFDP_TypeDef *flash)
+{
+    HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_INPUT, SPIFI_FRAMEFORM_OPCODE, SPIFI_SFDP_WRITE_ENABLE),
+                             0, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+}
+
+static HAL_StatusTypeDef HAL_SPIFI_SFDP_WriteRegister(HAL_SPIFI_SFDP_TypeDef *flash, uint8_t opcode, uint8_t *data, uint16_t length)
+{
+    HAL_SPIFI_SFDP_WriteEnable(flash);
+    HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_OUTPUT, SPIFI_FRAMEFORM_OPCODE, opcode),
+                             0, length, 0, data, 0, HAL_SPIFI_TIMEOUT);
+    return HAL_SPIFI_SFDP_WaitBusy(flash, SPIFI_SFDP_WRITE_SREG_BUSY);
+}
+
+/**
+ * @brief Установить бит mask регистра, читаемого командой readOpcode, записью командой writeOpcode.
+ * @param withSreg1 Запись двумя байтами: SR1 и регистр с битом.
+ */
+static HAL_StatusTypeDef HAL_SPIFI_SFDP_SetBit(HAL_SPIFI_SFDP_TypeDef *flash, uint8_t readOpcode, uint8_t writeOpcode,
+                                               uint8_t mask, int withSreg1)
+{
+    uint8_t data[2];
+    uint8_t value = HAL_SPIFI_SFDP_ReadRegister(flash, readOpcode);
+
+    if (value & mask)
+    {
+        return HAL_OK;
+    }
+    if (withSreg1)
+    {
+        data[0] = HAL_SPIFI_SFDP_ReadRegister(flash, SPIFI_SFDP_READ_SREG1);
+        data[1] = value | mask;
+    }
+    else
+    {
+        data[0] = value | mask;
+    }
+
+    HAL_StatusTypeDef status = HAL_SPIFI_SFDP_WriteRegister(flash, writeOpcode, data, withSreg1 ? 2 : 1);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+    return (HAL_SPIFI_SFDP_ReadRegister(flash, readOpcode) & mask) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+ * @brief Установить бит QE способом flash->Sfdp.QuadEnable.
+ */
+static HAL_StatusTypeDef HAL_SPIFI_SFDP_QuadEnable(HAL_SPIFI_SFDP_TypeDef *flash)
+{
+    uint8_t data[2];
+
+    switch (flash->Sfdp.QuadEnable)
+    {
+    case SFDP_QE_NONE:
+        return HAL_OK;
+    case SFDP_QE_SR2_BIT1_NO_READ:
+        /* SR2 не читается: записывается целиком */
+        data[0] = HAL_SPIFI_SFDP_ReadRegister(flash, SPIFI_SFDP_READ_SREG1);
+        data[1] = 1 << 1;
+        return HAL_SPIFI_SFDP_WriteRegister(flash, SPIFI_SFDP_WRITE_SREG, data, 2);
+    case SFDP_QE_SR1_BIT6:
+        return HAL_SPIFI_SFDP_SetBit(flash, SPIFI_SFDP_READ_SREG1, SPIFI_SFDP_WRITE_SREG, 1 << 6, 0);
+    case SFDP_QE_SR2_BIT7:
+        return HAL_SPIFI_SFDP_SetBit(flash, SPIFI_SFDP_READ_SREG2_3F, SPIFI_SFDP_WRITE_SREG2_3E, 1 << 7, 0);
+    case SFDP_QE_SR2_BIT1:
+    case SFDP_QE_SR2_BIT1_35H:
+        return HAL_SPIFI_SFDP_SetBit(flash, SPIFI_SFDP_READ_SREG2, SPIFI_SFDP_WRITE_SREG, 1 << 1, 1);
+    case SFDP_QE_SR2_BIT1_31H:
+        return HAL_SPIFI_SFDP_SetBit(flash, SPIFI_SFDP_READ_SREG2, SPIFI_SFDP_WRITE_SREG2, 1 << 1, 0);
+    default:
+        return HAL_ERROR;
+    }
+}
+
+/**
+ * @brief Прочитать SFDP и разобрать основную таблицу параметров.
+ *
+ * Флеш-память должна находиться в режиме SPI (не QPI).
+ *
+ * @param flash Флеш-память.
+ * @param spifi SPIFI в периферийном режиме.
+ * @return Результат HAL_SFDP_Parse.
+ */
+HAL_StatusTypeDef HAL_SPIFI_SFDP_Init(HAL_SPIFI_SFDP_TypeDef *flash, SPIFI_HandleTypeDef *spifi)
+{
+    flash->spifi = spifi;
+    flash->Mode = SFDP_READ_1_1_1;
+    flash->Qpi = 0;
+    flash->ReadCommand = 0;
+
+    return HAL_SFDP_Parse(&flash->Sfdp, HAL_SPIFI_SFDP_ReadSFDP, spifi);
+}
+
+/**
+ * @brief Выбрать команду чтения и подготовить к ней флеш-память.
+ *
+ * Для четырехпроводных команд устанавливается бит QE, для 4-4-4 флеш-память переводится в
+ * режим QPI. Заполняются поля Mode и ReadCommand.
+ *
+ * @param flash Флеш-память после HAL_SPIFI_SFDP_Init.
+ * @param MaxMode Самая быстрая допустимая команда, например SFDP_READ_1_4_4, если режим QPI
+ * не нужен.
+ * @return HAL_ERROR, если бит QE не установился.
+ */
+HAL_StatusTypeDef HAL_SPIFI_SFDP_Configure(HAL_SPIFI_SFDP_TypeDef *flash, HAL_SFDP_ReadModeTypeDef MaxMode)
+{
+    static const HAL_SPIFI_FieldFormTypeDef fieldForms[] = {
+        [SFDP_READ_1_1_1] = SPIFI_FIELDFORM_ALL_SERIAL,
+        [SFDP_READ_1_1_4] = SPIFI_FIELDFORM_DATA_PARALLEL,
+        [SFDP_READ_1_4_4] = SPIFI_FIELDFORM_OPCODE_SERIAL,
+        [SFDP_READ_4_4_4] = SPIFI_FIELDFORM_ALL_PARALLEL,
+    };
+
+    HAL_SPIFI_SFDP_Deinit(flash);
+
+    HAL_SFDP_ReadModeTypeDef mode = HAL_SFDP_SelectRead(&flash->Sfdp, MaxMode);
+    if (mode != SFDP_READ_1_1_1)
+    {
+        HAL_StatusTypeDef status = HAL_SPIFI_SFDP_QuadEnable(flash);
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+    }
+    if (mode == SFDP_READ_4_4_4)
+    {
+        HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_INPUT, SPIFI_FRAMEFORM_OPCODE, flash->Sfdp.QpiEnterOpcode),
+                                 0, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+        flash->Qpi = 1;
+    }
+
+    flash->spifi->Instance->CTRL &= ~SPIFI_CONFIG_CTRL_DUAL_M;
+    flash->Mode = mode;
+    flash->ReadCommand =
+        SPIFI_DIRECTION_INPUT |
+        SPIFI_CONFIG_CMD_INTLEN(HAL_SFDP_InterimLength(&flash->Sfdp, mode)) |
+        SPIFI_CONFIG_CMD_FIELDFORM(fieldForms[mode]) |
+        SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
+        SPIFI_CONFIG_CMD_OPCODE(flash->Sfdp.Read[mode].Opcode);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Вывести флеш-память из режима QPI. Бит QE не сбрасывается.
+ */
+void HAL_SPIFI_SFDP_Deinit(HAL_SPIFI_SFDP_TypeDef *flash)
+{
+    if (flash->Qpi)
+    {
+        HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_INPUT, SPIFI_FRAMEFORM_OPCODE, flash->Sfdp.QpiExitOpcode),
+                                 0, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+        flash->Qpi = 0;
+    }
+}
+
+/**
+ * @brief Ожидать сброса бита BUSY регистра SR1 не более timeout опросов.
+ */
+HAL_StatusTypeDef HAL_SPIFI_SFDP_WaitBusy(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t timeout)
+{
+    while (timeout-- != 0)
+    {
+        if ((HAL_SPIFI_SFDP_ReadRegister(flash, SPIFI_SFDP_READ_SREG1) & SPIFI_SFDP_SREG1_BUSY_M) == 0)
+        {
+            return HAL_OK;
+        }
+    }
+    return HAL_TIMEOUT;
+}
+
+/**
+ * @brief Чтение выбранной командой HAL_SPIFI_SFDP_Configure.
+ */
+HAL_StatusTypeDef HAL_SPIFI_SFDP_ReadData(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    return HAL_SPIFI_SendCommand_LL(flash->spifi, flash->ReadCommand, address, dataLength, dataBytes, 0, 0, HAL_SPIFI_TIMEOUT);
+}
+
+/**
+ * @brief Программирование в пределах страницы Sfdp.PageSize с ожиданием завершения.
+ * @return HAL_ERROR при выходе за границу страницы.
+ */
+HAL_StatusTypeDef HAL_SPIFI_SFDP_PageProgram(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    if ((dataLength == 0) || ((address % flash->Sfdp.PageSize) + dataLength > flash->Sfdp.PageSize))
+    {
+        return HAL_ERROR;
+    }
+
+    HAL_SPIFI_SFDP_WriteEnable(flash);
+    HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_OUTPUT, SPIFI_FRAMEFORM_OPCODE_3ADDR, SPIFI_SFDP_PAGE_PROGRAM),
+                             address, dataLength, 0, dataBytes, 0, HAL_SPIFI_TIMEOUT);
+    return HAL_SPIFI_SFDP_WaitBusy(flash, HAL_SPIFI_SFDP_BUSY);
+}
+
+/**
+ * @brief Стирание области size байт с ожиданием завершения.
+ * @param size Размер одного из типов стирания Sfdp.Erase.
+ * @return HAL_ERROR, если такого типа стирания нет или адрес не выровнен на size.
+ */
+HAL_StatusTypeDef HAL_SPIFI_SFDP_Erase(HAL_SPIFI_SFDP_TypeDef *flash, uint32_t address, uint32_t size)
+{
+    for (uint32_t i = 0; i < sizeof(flash->Sfdp.Erase) / sizeof(flash->Sfdp.Erase[0]); i++)
+    {
+        const HAL_SFDP_EraseTypeDef *erase = &flash->Sfdp.Erase[i];
+
+        if ((erase->SizeShift == 0) || ((1UL << erase->SizeShift) != size))
+        {
+            continue;
+        }
+        if (address & (size - 1))
+        {
+            return HAL_ERROR;
+        }
+
+        HAL_SPIFI_SFDP_WriteEnable(flash);
+        HAL_SPIFI_SendCommand_LL(flash->spifi, HAL_SPIFI_SFDP_Command(flash, SPIFI_DIRECTION_INPUT, SPIFI_FRAMEFORM_OPCODE_3ADDR, erase->Opcode),
+                                 address, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+        return HAL_SPIFI_SFDP_WaitBusy(flash, HAL_SPIFI_SFDP_BUSY);
+    }
+    return HAL_ERROR;
+}
+
+/**
+ * @brief Перевести SPIFI в режим памяти с командой чтения ReadCommand.
+ *
+ * Заполняет поля Instance и Command и вызывает HAL_SPIFI_MemoryMode_Init; настройки кэша задает
+ * вызывающая сторона. Возврат в периферийный режим - HAL_SPIFI_Reset, режим QPI сохраняется.
+ * Функцию нельзя вызывать при выполнении программы из SPIFI.
+ */
+void HAL_SPIFI_SFDP_MemoryMode_Init(HAL_SPIFI_SFDP_TypeDef *flash, SPIFI_MemoryModeConfig_HandleTypeDef *config)
+{
+    uint32_t cmd = flash->ReadCommand;
+
+    config->Instance = flash->spifi->Instance;
+    config->Command = (SPIFI_MemoryCommandTypeDef){
+        .InterimData = 0,
+        .InterimLength = (cmd & SPIFI_CONFIG_CMD_INTLEN_M) >> SPIFI_CONFIG_CMD_INTLEN_S,
+        .FieldForm = (cmd & SPIFI_CONFIG_CMD_FIELDFORM_M) >> SPIFI_CONFIG_CMD_FIELDFORM_S,
+        .FrameForm = (cmd & SPIFI_CONFIG_CMD_FRAMEFORM_M) >> SPIFI_CONFIG_CMD_FRAMEFORM_S,
+        .OpCode = (cmd & SPIFI_CONFIG_CMD_OPCODE_M) >> SPIFI_CONFIG_CMD_OPCODE_S,
+    };
+    HAL_SPIFI_MemoryMode_Init(config);
+}
@@ -2,6 +2,7 @@
 
 #define SPIFI_W25_WRITE_SREG_BUSY 10000
 #define SPIFI_W25_PROGRAM_BUSY 100000
+#define SPIFI_W25_ERASE_BUSY 2000000    /* Block Erase 64 КБ - до 2 с */
 
 typedef enum __HAL_SPIFI_W25_OPCodesTypeDef
 {
@@ -35,6 +36,9 @@ typedef enum __HAL_SPIFI_W25_OPCodesTypeDef
     ENABLE_RESET = 0x66,
     RESET = 0x99,
 
+    // Dual SPI Instructions
+    FAST_READ_DUAL_OUTPUT = 0x3B,
+
     // Quad SPI Instructions
     QUAD_PAGE_PROGRAM = 0x32,
     FAST_READ_QUAD_OUTPUT = 0x6B,
@@ -106,6 +110,34 @@ const uint32_t cmd_sector_erase_4k =
     SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
     SPIFI_CONFIG_CMD_OPCODE(SECTOR_ERASE_4K);
 
+const uint32_t cmd_block_erase_32k =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(0) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
+    SPIFI_CONFIG_CMD_OPCODE(BLOCK_ERASE_32K);
+
+const uint32_t cmd_block_erase_64k =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(0) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
+    SPIFI_CONFIG_CMD_OPCODE(BLOCK_ERASE_64K);
+
+const uint32_t cmd_erase_program_suspend =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(0) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE) |
+    SPIFI_CONFIG_CMD_OPCODE(ERASE_PROGRAM_SUSPEND);
+
+const uint32_t cmd_erase_program_resume =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(0) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE) |
+    SPIFI_CONFIG_CMD_OPCODE(ERASE_PROGRAM_RESUME);
+
 const uint32_t cmd_read_data =
     SPIFI_DIRECTION_INPUT |
     SPIFI_CONFIG_CMD_INTLEN(0) |
@@ -120,6 +152,21 @@ const uint32_t cmd_read_data_4addr =
     SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_4ADDR) |
     SPIFI_CONFIG_CMD_OPCODE(READ_DATA_4ADDR);
 
+const uint32_t cmd_fast_read =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(1) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
+    SPIFI_CONFIG_CMD_OPCODE(FAST_READ);
+
+/* Данные по двум линиям при установленном бите CTRL.DUAL */
+const uint32_t cmd_fast_read_dual_output =
+    SPIFI_DIRECTION_INPUT |
+    SPIFI_CONFIG_CMD_INTLEN(1) |
+    SPIFI_CONFIG_CMD_FIELDFORM(SPIFI_FIELDFORM_DATA_PARALLEL) |
+    SPIFI_CONFIG_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OPCODE_3ADDR) |
+    SPIFI_CONFIG_CMD_OPCODE(FAST_READ_DUAL_OUTPUT);
+
 const uint32_t cmd_manufacturer_device_id =
     SPIFI_DIRECTION_INPUT |
     SPIFI_CONFIG_CMD_INTLEN(0) |
@@ -292,6 +339,214 @@ void HAL_SPIFI_W25_SectorErase4K(SPIFI_HandleTypeDef *spifi, uint32_t address)
     HAL_SPIFI_W25_WaitBusy(spifi, SPIFI_W25_PROGRAM_BUSY);
 }
 
+/**
+ * @brief Запустить программирование страницы без ожидания завершения.
+ * Завершение определяется по биту BUSY регистра SREG1.
+ */
+void HAL_SPIFI_W25_PageProgram_NoWait(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    HAL_SPIFI_W25_WriteEnable(spifi);
+    HAL_SPIFI_SendCommand_LL(spifi, cmd_page_program, address, dataLength, 0, dataBytes, 0, HAL_SPIFI_TIMEOUT);
+}
+
+/**
+ * @brief Запустить стирание сектора 4 КБ или блока 32/64 КБ без ожидания завершения.
+ * Завершение определяется по биту BUSY регистра SREG1.
+ */
+void HAL_SPIFI_W25_Erase_NoWait(SPIFI_HandleTypeDef *spifi, HAL_SPIFI_W25_EraseTypeDef type, uint32_t address)
+{
+    uint32_t cmd = cmd_sector_erase_4k;
+    if (type == W25_ERASE_32K)
+    {
+        cmd = cmd_block_erase_32k;
+    }
+    else if (type == W25_ERASE_64K)
+    {
+        cmd = cmd_block_erase_64k;
+    }
+
+    HAL_SPIFI_W25_WriteEnable(spifi);
+    HAL_SPIFI_SendCommand_LL(spifi, cmd, address, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+}
+
+/**
+ * @brief Запустить программирование страницы по четырем линиям (Quad Page Program 0x32) без ожидания завершения.
+ * Требуется бит QE.
+ */
+void HAL_SPIFI_W25_PageProgram_Quad_NoWait(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    HAL_SPIFI_W25_WriteEnable(spifi);
+    HAL_SPIFI_SendCommand_LL(spifi, cmd_quad_page_program, address, dataLength, 0, dataBytes, 0, HAL_SPIFI_TIMEOUT);
+}
+
+/**
+ * @brief Запустить стирание наибольшего блока (64 КБ, 32 КБ или сектора 4 КБ), выровненного
+ * по *address и не выходящего за end, и сдвинуть *address на его размер.
+ */
+static void HAL_SPIFI_W25_EraseNext(SPIFI_HandleTypeDef *spifi, uint32_t *address, uint32_t end)
+{
+    HAL_SPIFI_W25_EraseTypeDef type = W25_ERASE_4K;
+    uint32_t size = SPIFI_W25_SECTOR_SIZE;
+
+    if (((*address % SPIFI_W25_BLOCK_64K_SIZE) == 0) && (end - *address >= SPIFI_W25_BLOCK_64K_SIZE))
+    {
+        type = W25_ERASE_64K;
+        size = SPIFI_W25_BLOCK_64K_SIZE;
+    }
+    else if (((*address % SPIFI_W25_BLOCK_32K_SIZE) == 0) && (end - *address >= SPIFI_W25_BLOCK_32K_SIZE))
+    {
+        type = W25_ERASE_32K;
+        size = SPIFI_W25_BLOCK_32K_SIZE;
+    }
+
+    HAL_SPIFI_W25_Erase_NoWait(spifi, type, *address);
+    *address += size;
+}
+
+/**
+ * @brief Стереть все секторы 4 КБ, которые затрагивает диапазон.
+ *
+ * Диапазон расширяется до границ секторов и покрывается наибольшими выровненными блоками:
+ * 64 КБ стирается примерно за то же время, что и 4 КБ (tBE2 150 мс против tSE 45 мс у W25Q).
+ * Данные вне диапазона в крайних секторах стираются.
+ *
+ * @return HAL_TIMEOUT, если флеш-память не завершила стирание.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_EraseRange(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length)
+{
+    uint32_t end = (address + length + SPIFI_W25_SECTOR_SIZE - 1) & ~(SPIFI_W25_SECTOR_SIZE - 1);
+
+    address &= ~(SPIFI_W25_SECTOR_SIZE - 1);
+    while (address < end)
+    {
+        HAL_SPIFI_W25_EraseNext(spifi, &address, end);
+        if (HAL_SPIFI_W25_WaitBusy(spifi, SPIFI_W25_ERASE_BUSY) != HAL_OK)
+        {
+            return HAL_TIMEOUT;
+        }
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Стереть диапазон и запрограммировать его страницами по четырем линиям.
+ * Данные страницы готовит fill в буфер page, а при fill == NULL они берутся из context.
+ */
+static HAL_StatusTypeDef HAL_SPIFI_W25_Write(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length,
+                                             HAL_SPIFI_W25_FillTypeDef fill, void *context, uint8_t *page)
+{
+    uint32_t offset = 0;
+    uint32_t chunk = SPIFI_W25_PAGE_SIZE - (address % SPIFI_W25_PAGE_SIZE);
+
+    if (length == 0)
+    {
+        return HAL_OK;
+    }
+    HAL_StatusTypeDef status = HAL_SPIFI_W25_QuadEnable(spifi);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+    if (chunk > length)
+    {
+        chunk = length;
+    }
+
+    uint32_t erase = address & ~(SPIFI_W25_SECTOR_SIZE - 1);
+    uint32_t end = (address + length + SPIFI_W25_SECTOR_SIZE - 1) & ~(SPIFI_W25_SECTOR_SIZE - 1);
+    while (erase < end)
+    {
+        HAL_SPIFI_W25_EraseNext(spifi, &erase, end);
+        if ((offset == 0) && (fill != NULL))
+        {
+            fill(context, 0, page, chunk);
+        }
+        offset = chunk;
+        if (HAL_SPIFI_W25_WaitBusy(spifi, SPIFI_W25_ERASE_BUSY) != HAL_OK)
+        {
+            return HAL_TIMEOUT;
+        }
+    }
+
+    /* offset - конец подготовленной страницы */
+    while (1)
+    {
+        uint8_t *data = (fill != NULL) ? page : (uint8_t *)context + offset - chunk;
+
+        HAL_SPIFI_W25_PageProgram_Quad_NoWait(spifi, address + offset - chunk, chunk, data);
+        if (offset == length)
+        {
+            break;
+        }
+
+        chunk = (length - offset < SPIFI_W25_PAGE_SIZE) ? (length - offset) : SPIFI_W25_PAGE_SIZE;
+        if (fill != NULL)
+        {
+            fill(context, offset, page, chunk);
+        }
+        offset += chunk;
+
+        if (HAL_SPIFI_W25_WaitBusy(spifi, SPIFI_W25_PROGRAM_BUSY) != HAL_OK)
+        {
+            return HAL_TIMEOUT;
+        }
+    }
+    return HAL_SPIFI_W25_WaitBusy(spifi, SPIFI_W25_PROGRAM_BUSY);
+}
+
+/**
+ * @brief Стереть диапазон и записать в него данные, подготавливаемые функцией fill.
+ *
+ * Диапазон стирается как в HAL_SPIFI_W25_EraseRange и программируется страницами по
+ * четырем линиям; первая и последняя страницы могут быть неполными. Данные страницы
+ * передаются в SPIFI до возврата из HAL_SPIFI_SendCommand_LL, поэтому следующая страница
+ * готовится в тот же буфер, пока флеш-память программирует текущую (tPP до 3 мс): время
+ * подготовки, например распаковки или приема образа, не добавляется ко времени записи.
+ * Первая страница готовится во время стирания первого блока.
+ *
+ * Бит QE устанавливается функцией.
+ *
+ * @param address Адрес во флеш-памяти.
+ * @param length Число байт.
+ * @param fill Подготовка данных страницы.
+ * @param context Первый аргумент fill.
+ * @param page Буфер страницы, SPIFI_W25_PAGE_SIZE байт.
+ * @return HAL_TIMEOUT, если флеш-память не завершила стирание или программирование.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_WriteStream(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length,
+                                            HAL_SPIFI_W25_FillTypeDef fill, void *context, uint8_t *page)
+{
+    return HAL_SPIFI_W25_Write(spifi, address, length, fill, context, page);
+}
+
+/**
+ * @brief Стереть диапазон и записать в него data, см. HAL_SPIFI_W25_WriteStream.
+ * Страницы программируются непосредственно из data, без копирования.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_WriteRange(SPIFI_HandleTypeDef *spifi, uint32_t address, uint32_t length, const uint8_t *data)
+{
+    return HAL_SPIFI_W25_Write(spifi, address, length, NULL, (void *)data, NULL);
+}
+
+/**
+ * @brief Приостановить стирание или программирование (Erase/Program Suspend, 0x75).
+ * Команда игнорируется, если операция не выполняется. Флеш-память готова к чтению после
+ * сброса бита BUSY (не более tSUS = 20 мкс), бит SUS регистра SREG2 показывает приостановку.
+ */
+void HAL_SPIFI_W25_Suspend(SPIFI_HandleTypeDef *spifi)
+{
+    HAL_SPIFI_SendCommand_LL(spifi, cmd_erase_program_suspend, 0, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+}
+
+/**
+ * @brief Продолжить приостановленную операцию (Erase/Program Resume, 0x7A).
+ * Следующая приостановка допускается не раньше, чем через tSUS.
+ */
+void HAL_SPIFI_W25_Resume(SPIFI_HandleTypeDef *spifi)
+{
+    HAL_SPIFI_SendCommand_LL(spifi, cmd_erase_program_resume, 0, 0, 0, 0, 0, HAL_SPIFI_TIMEOUT);
+}
+
 void HAL_SPIFI_W25_ReadData(SPIFI_HandleTypeDef *spifi, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
 {
     HAL_SPIFI_SendCommand_LL(spifi, cmd_read_data, address, dataLength, dataBytes, 0, 0, HAL_SPIFI_TIMEOUT);
@@ -403,3 +658,204 @@ void HAL_SPIFI_W25_ReadData_Quad_IO_QPI_XIP_Init(SPIFI_HandleTypeDef *spifi, uin
 {
     HAL_SPIFI_SendCommand_LL(spifi, cmd_fast_read_quad_io_qpi, address, dataLength, dataBytes, 0, SPIFI_W25_XIP_NO_OPCODE, HAL_SPIFI_TIMEOUT);
 }
+
+/**
+ * @brief Команда режима памяти с полями команды периферийного режима cmd.
+ */
+static SPIFI_MemoryCommandTypeDef HAL_SPIFI_W25_MemoryCommand(uint32_t cmd, uint32_t interimData)
+{
+    return (SPIFI_MemoryCommandTypeDef){
+        .InterimData = interimData,
+        .InterimLength = (cmd & SPIFI_CONFIG_CMD_INTLEN_M) >> SPIFI_CONFIG_CMD_INTLEN_S,
+        .FieldForm = (cmd & SPIFI_CONFIG_CMD_FIELDFORM_M) >> SPIFI_CONFIG_CMD_FIELDFORM_S,
+        .FrameForm = (cmd & SPIFI_CONFIG_CMD_FRAMEFORM_M) >> SPIFI_CONFIG_CMD_FRAMEFORM_S,
+        .OpCode = (cmd & SPIFI_CONFIG_CMD_OPCODE_M) >> SPIFI_CONFIG_CMD_OPCODE_S,
+    };
+}
+
+/**
+ * @brief Перевести SPIFI в режим памяти с чтением командой mode.
+ *
+ * Подготавливает флеш-память (бит QE для четырехпроводных команд, переход в QPI, первое чтение
+ * с битами режима 0x20 для режимов непрерывного чтения), заполняет поля Instance и Command
+ * и вызывает HAL_SPIFI_MemoryMode_Init. Настройки кэша (CacheEnable, CacheLimit, DataCache,
+ * Prefetch, CSHigh) задает вызывающая сторона.
+ *
+ * В режимах *_XIP флеш-память после каждой команды ожидает следующий адрес без кода операции,
+ * поэтому перед любой командой периферийного режима необходимо вызвать HAL_SPIFI_W25_MemoryMode_Exit.
+ * Функцию нельзя вызывать при выполнении программы из SPIFI.
+ *
+ * @param spifi SPIFI в периферийном режиме.
+ * @param config Настройки режима памяти.
+ * @param mode Команда чтения.
+ * @return HAL_ERROR при неверном режиме, результат HAL_SPIFI_W25_QuadEnable.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_MemoryMode_Init(SPIFI_HandleTypeDef *spifi, SPIFI_MemoryModeConfig_HandleTypeDef *config, HAL_SPIFI_W25_MemoryModeTypeDef mode)
+{
+    uint8_t unused;
+
+    if (mode > W25_MEMORY_QPI_XIP)
+    {
+        return HAL_ERROR;
+    }
+    if (mode != W25_MEMORY_FAST_READ)
+    {
+        HAL_StatusTypeDef status = HAL_SPIFI_W25_QuadEnable(spifi);
+        if (status != HAL_OK)
+        {
+            return status;
+        }
+    }
+
+    spifi->Instance->CTRL &= ~SPIFI_CONFIG_CTRL_DUAL_M;
+
+    switch (mode)
+    {
+    case W25_MEMORY_FAST_READ:
+        config->Command = HAL_SPIFI_W25_MemoryCommand(cmd_fast_read, 0);
+        break;
+    case W25_MEMORY_QUAD_OUTPUT:
+        config->Command = HAL_SPIFI_W25_MemoryCommand(cmd_fast_read_quad_output, 0);
+        break;
+    case W25_MEMORY_QUAD_IO:
+        config->Command = HAL_SPIFI_W25_MemoryCommand(cmd_fast_read_quad_io, 0);
+        break;
+    case W25_MEMORY_QUAD_IO_XIP:
+        HAL_SPIFI_W25_ReadData_Quad_IO_XIP_Init(spifi, 0, 1, &unused);
+        config->Command = HAL_SPIFI_W25_MemoryCommand(cmd_fast_read_quad_io_xip, SPIFI_W25_XIP_NO_OPCODE);
+        break;
+    case W25_MEMORY_QPI:
+        HAL_SPIFI_W25_QPIEnable(spifi);
+        config->Command = HAL_SPIFI_W25_MemoryCommand(cmd_fast_read_quad_io_qpi, 0);
+        break;
+    case W25_MEMORY_QPI_XIP:
+        HAL_SPIFI_W25_QPIEnable(spifi);
+        HAL_SPIFI_W25_ReadData_Quad_IO_QPI_XIP_Init(spifi, 0, 1, &unused);
+        config->Command = HAL_SPIFI_W25_MemoryCommand(cmd_fast_read_quad_io_qpi_xip, SPIFI_W25_XIP_NO_OPCODE);
+        break;
+    }
+
+    config->Instance = spifi->Instance;
+    HAL_SPIFI_MemoryMode_Init(config);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Вернуть SPIFI и флеш-память в периферийный режим после HAL_SPIFI_W25_MemoryMode_Init.
+ *
+ * Сбрасывает SPIFI, выводит флеш-память из режима непрерывного чтения (чтение без кода
+ * операции с битами режима, отличными от 0x20) и из режима QPI.
+ * Функцию нельзя вызывать при выполнении программы из SPIFI.
+ */
+void HAL_SPIFI_W25_MemoryMode_Exit(SPIFI_HandleTypeDef *spifi, HAL_SPIFI_W25_MemoryModeTypeDef mode)
+{
+    uint8_t unused;
+
+    HAL_SPIFI_Reset(spifi);
+    for (uint32_t timeout = HAL_SPIFI_TIMEOUT; (timeout != 0) && !HAL_SPIFI_IsReady(spifi); timeout--)
+    {
+    }
+
+    if (mode == W25_MEMORY_QUAD_IO_XIP)
+    {
+        HAL_SPIFI_SendCommand_LL(spifi, cmd_fast_read_quad_io_xip, 0, 1, &unused, 0, 0, HAL_SPIFI_TIMEOUT);
+    }
+    else if (mode == W25_MEMORY_QPI_XIP)
+    {
+        HAL_SPIFI_SendCommand_LL(spifi, cmd_fast_read_quad_io_qpi_xip, 0, 1, &unused, 0, 0, HAL_SPIFI_TIMEOUT);
+    }
+
+    if ((mode == W25_MEMORY_QPI) || (mode == W25_MEMORY_QPI_XIP))
+    {
+        HAL_SPIFI_W25_QPIDisable(spifi);
+    }
+}
+
+/**
+ * @brief Запустить чтение через DMA без ожидания.
+ *
+ * Объем не ограничен DATALEN: чтение разбивается на команды по HAL_SPIFI_DMA_COMMAND_MAX байт.
+ * Для W25_READ_DUAL на время чтения устанавливается бит CTRL.DUAL.
+ *
+ * @param engine Команды SPIFI с DMA.
+ * @param mode Команда чтения.
+ * @param address Адрес во флеш-памяти.
+ * @param dataLength Число байт.
+ * @param dataBytes Буфер. Должен существовать до завершения (engine->Status != HAL_BUSY).
+ * @return Результат HAL_SPIFI_DMA_Start, HAL_ERROR при неверном режиме.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_ReadData_DMA(HAL_SPIFI_DMA_TypeDef *engine, HAL_SPIFI_W25_ReadModeTypeDef mode, uint32_t address, uint32_t dataLength, uint8_t *dataBytes)
+{
+    HAL_SPIFI_DMA_CommandTypeDef command = {0};
+
+    switch (mode)
+    {
+    case W25_READ_SINGLE:
+        command.Command = cmd_fast_read;
+        break;
+    case W25_READ_DUAL:
+        command.Command = cmd_fast_read_dual_output;
+        command.Control = SPIFI_CONFIG_CTRL_DUAL_M;
+        break;
+    case W25_READ_QUAD:
+        command.Command = cmd_fast_read_quad_output;
+        break;
+    case W25_READ_QUAD_IO:
+        command.Command = cmd_fast_read_quad_io;
+        break;
+    default:
+        return HAL_ERROR;
+    }
+
+    return HAL_SPIFI_DMA_Start(engine, &command, address, dataBytes, dataLength);
+}
+
+/**
+ * @brief Программирование страницы через DMA без ожидания.
+ *
+ * Команда Write Enable выполняется сразу, данные передаются через DMA, затем контроллер
+ * опрашивает бит BUSY. Функция завершения вызывается после окончания программирования.
+ */
+static HAL_StatusTypeDef HAL_SPIFI_W25_PageProgram_Start(HAL_SPIFI_DMA_TypeDef *engine, uint32_t cmd, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    HAL_SPIFI_DMA_CommandTypeDef command = {
+        .Command = cmd,
+        .PollCommand = cmd_read_sreg1_polling,
+    };
+
+    if ((dataLength == 0) || ((address % SPIFI_W25_PAGE_SIZE) + dataLength > SPIFI_W25_PAGE_SIZE))
+    {
+        return HAL_ERROR;
+    }
+    /* Write Enable нельзя выдать во время выполняемой команды */
+    if (HAL_SPIFI_DMA_IsBusy(engine))
+    {
+        return HAL_BUSY;
+    }
+
+    HAL_SPIFI_W25_WriteEnable(engine->spifi);
+    return HAL_SPIFI_DMA_Start(engine, &command, address, dataBytes, dataLength);
+}
+
+/**
+ * @brief Программирование страницы (Page Program 0x02) через DMA без ожидания.
+ * @param engine Команды SPIFI с DMA.
+ * @param address Адрес во флеш-памяти.
+ * @param dataLength Число байт, данные не должны пересекать границу страницы SPIFI_W25_PAGE_SIZE.
+ * @param dataBytes Данные. Должны существовать до завершения (engine->Status != HAL_BUSY).
+ * @return HAL_ERROR при пересечении границы страницы, HAL_BUSY, если SPIFI занят.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_PageProgram_DMA(HAL_SPIFI_DMA_TypeDef *engine, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    return HAL_SPIFI_W25_PageProgram_Start(engine, cmd_page_program, address, dataLength, dataBytes);
+}
+
+/**
+ * @brief Программирование страницы по четырем линиям (Quad Page Program 0x32) через DMA без ожидания.
+ * Требуется бит QE. Параметры как у HAL_SPIFI_W25_PageProgram_DMA.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_PageProgram_Quad_DMA(HAL_SPIFI_DMA_TypeDef *engine, uint32_t address, uint16_t dataLength, uint8_t *dataBytes)
+{
+    return HAL_SPIFI_W25_PageProgram_Start(engine, cmd_quad_page_program, address, dataLength, dataBytes);
+}
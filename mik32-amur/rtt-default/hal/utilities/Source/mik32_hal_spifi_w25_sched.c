@@ -0,0 +1,282 @@
+#include "mik32_hal_spifi_w25_sched.h"
+
+/* Ожидание сброса BUSY после команды Suspend, мкс (по документации не больше tSUS) */
+#define HAL_SPIFI_W25_SCHED_SUSPEND_US  1000
+
+/* Наибольшая длина одной команды чтения: поле DATALEN регистра CMD 14-разрядное */
+#ifndef HAL_SPIFI_W25_SCHED_READ_CHUNK
+    #define HAL_SPIFI_W25_SCHED_READ_CHUNK  HAL_SPIFI_DMA_COMMAND_MAX
+#endif
+
+#if (HAL_SPIFI_W25_SCHED_READ_CHUNK == 0) || (HAL_SPIFI_W25_SCHED_READ_CHUNK > SPIFI_CONFIG_CMD_DATALEN_M)
+    #error "HAL_SPIFI_W25_SCHED_READ_CHUNK exceeds SPIFI CMD.DATALEN"
+#endif
+
+
+static inline __attribute__((always_inline)) int HAL_SPIFI_W25_Sched_IsBusy(SPIFI_HandleTypeDef *spifi)
+{
+    return (HAL_SPIFI_W25_ReadSREG(spifi, W25_SREG1) & SPIFI_W25_SREG1_BUSY_M) != 0;
+}
+
+/**
+ * @brief Размер области, которую изменяет операция.
+ */
+static uint32_t HAL_SPIFI_W25_Sched_OpSize(HAL_SPIFI_W25_SchedOpTypeDef *op)
+{
+    switch (op->Kind)
+    {
+    case W25_SCHED_ERASE_32K:
+        return 32 * 1024;
+    case W25_SCHED_ERASE_64K:
+        return 64 * 1024;
+    case W25_SCHED_PROGRAM:
+        return op->Length;
+    default:
+        return 4 * 1024;
+    }
+}
+
+/**
+ * @brief Проверить, пересекается ли область чтения с областью выполняемой операции.
+ */
+static int HAL_SPIFI_W25_Sched_Overlaps(HAL_SPIFI_W25_SchedOpTypeDef *op, uint32_t Address, uint32_t Length)
+{
+    uint32_t size = HAL_SPIFI_W25_Sched_OpSize(op);
+    uint32_t start = (op->Kind == W25_SCHED_PROGRAM) ? op->Address : (op->Address & ~(size - 1));
+
+    return (Address < start + size) && (start < Address + Length);
+}
+
+/**
+ * @brief Запустить операцию sched->Head без ожидания завершения.
+ */
+static void HAL_SPIFI_W25_Sched_Start(HAL_SPIFI_W25_SchedTypeDef *sched)
+{
+    HAL_SPIFI_W25_SchedOpTypeDef *op = sched->Head;
+
+    if (op->Kind == W25_SCHED_PROGRAM)
+    {
+        HAL_SPIFI_W25_PageProgram_NoWait(sched->spifi, op->Address, op->Length, (uint8_t *)op->Data);
+    }
+    else
+    {
+        HAL_SPIFI_W25_Erase_NoWait(sched->spifi, (HAL_SPIFI_W25_EraseTypeDef)op->Kind, op->Address);
+    }
+    sched->Polls = 0;
+    sched->ResumeTicks = HAL_SWTimer_GetTicks();
+}
+
+/**
+ * @brief Ожидать сброса BUSY не дольше TimeoutUs.
+ */
+static HAL_StatusTypeDef HAL_SPIFI_W25_Sched_WaitReady(HAL_SPIFI_W25_SchedTypeDef *sched, uint32_t TimeoutUs)
+{
+    uint64_t start = HAL_SWTimer_GetTicks();
+    uint64_t timeout = HAL_SWTimer_UsToTicks(TimeoutUs);
+
+    while (HAL_SPIFI_W25_Sched_IsBusy(sched->spifi))
+    {
+        if (HAL_SWTimer_GetTicks() - start > timeout)
+        {
+            return HAL_TIMEOUT;
+        }
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Опрос выполняемой операции (вызывается из HAL_SWTimer_IRQHandler).
+ * После завершения запускает следующую операцию очереди и вызывает функцию завершения выполненной.
+ */
+static void HAL_SPIFI_W25_Sched_Poll(HAL_SWTimer_TypeDef *timer)
+{
+    HAL_SPIFI_W25_SchedTypeDef *sched = (HAL_SPIFI_W25_SchedTypeDef *)timer->Context;
+    HAL_SPIFI_W25_SchedOpTypeDef *done = sched->Head;
+    HAL_StatusTypeDef status = HAL_OK;
+
+    /* Прерванная функция Read сама обращается к флеш-памяти, операция проверяется на следующем опросе */
+    if (sched->Lock)
+    {
+        return;
+    }
+    if (done == NULL)
+    {
+        HAL_SWTimer_Stop(timer);
+        return;
+    }
+    if (HAL_SPIFI_W25_Sched_IsBusy(sched->spifi))
+    {
+        if (++sched->Polls <= HAL_SPIFI_W25_SCHED_TIMEOUT_US / sched->PollUs)
+        {
+            return;
+        }
+        status = HAL_TIMEOUT;
+    }
+
+    sched->Head = done->Next;
+    if (sched->Head != NULL)
+    {
+        HAL_SPIFI_W25_Sched_Start(sched);
+    }
+    else
+    {
+        HAL_SWTimer_Stop(timer);
+    }
+
+    done->Next = NULL;
+    done->Status = status;
+    if (done->Callback != NULL)
+    {
+        done->Callback(done);
+    }
+}
+
+/**
+ * @brief Инициализация планировщика.
+ *
+ * Задает PollUs и ResumeHoldUs по умолчанию, их можно изменить до первой операции.
+ * PollUs должен быть больше нуля, иначе Submit возвращает HAL_ERROR.
+ * Программные таймеры должны быть инициализированы (HAL_SWTimer_Init).
+ *
+ * @param sched Планировщик.
+ * @param spifi SPIFI с подключенной флеш-памятью W25 в периферийном режиме.
+ */
+void HAL_SPIFI_W25_Sched_Init(HAL_SPIFI_W25_SchedTypeDef *sched, SPIFI_HandleTypeDef *spifi)
+{
+    sched->spifi = spifi;
+    sched->PollUs = HAL_SPIFI_W25_SCHED_POLL_US;
+    sched->ResumeHoldUs = HAL_SPIFI_W25_SCHED_RESUME_HOLD_US;
+    sched->Suspends = 0;
+    sched->ReadLatencyMax = 0;
+
+    sched->Head = NULL;
+    sched->Tail = NULL;
+    sched->Lock = 0;
+    sched->Polls = 0;
+    sched->ResumeTicks = 0;
+
+    sched->Timer.Callback = HAL_SPIFI_W25_Sched_Poll;
+    sched->Timer.Context = sched;
+    sched->Timer.PPrev = NULL;
+}
+
+/**
+ * @brief Поставить операцию в очередь без ожидания.
+ * Операция запускается сразу, если очередь пуста. Можно вызывать из функции завершения.
+ * @param sched Планировщик.
+ * @param op Операция. Поле Status задается здесь, до завершения (op->Status != HAL_BUSY)
+ * структуру изменять и повторно ставить в очередь нельзя.
+ * @return HAL_ERROR при неверном виде операции, программировании за границу страницы или
+ * нулевом периоде опроса.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_Sched_Submit(HAL_SPIFI_W25_SchedTypeDef *sched, HAL_SPIFI_W25_SchedOpTypeDef *op)
+{
+    if ((op->Kind > W25_SCHED_PROGRAM) || (sched->PollUs == 0))
+    {
+        return HAL_ERROR;
+    }
+    if ((op->Kind == W25_SCHED_PROGRAM) &&
+        ((op->Data == NULL) || (op->Length == 0) || (op->Length > SPIFI_W25_PAGE_SIZE - op->Address % SPIFI_W25_PAGE_SIZE)))
+    {
+        return HAL_ERROR;
+    }
+
+    uint32_t irq_state = HAL_IRQ_SaveDisable();
+
+    op->Status = HAL_BUSY;
+    op->Next = NULL;
+
+    if (sched->Head == NULL)
+    {
+        sched->Head = op;
+        sched->Tail = op;
+        HAL_SPIFI_W25_Sched_Start(sched);
+        HAL_SWTimer_Start(&sched->Timer, sched->PollUs, sched->PollUs);
+    }
+    else
+    {
+        sched->Tail->Next = op;
+        sched->Tail = op;
+    }
+
+    HAL_IRQ_Restore(irq_state);
+    return HAL_OK;
+}
+
+/**
+ * @brief Прочитать данные, не дожидаясь завершения операций очереди.
+ *
+ * Если выполняется стирание или программирование, оно приостанавливается на время чтения (не
+ * раньше, чем через ResumeHoldUs после предыдущего продолжения) и затем продолжается. Если
+ * область чтения пересекается с областью выполняемой операции, чтение ожидает ее завершения.
+ *
+ * @param sched Планировщик.
+ * @param Address Адрес во флеш-памяти.
+ * @param Length Число байт.
+ * @param Data Буфер.
+ * @return HAL_TIMEOUT, если флеш-память не освободилась.
+ */
+HAL_StatusTypeDef HAL_SPIFI_W25_Sched_Read(HAL_SPIFI_W25_SchedTypeDef *sched, uint32_t Address, uint32_t Length, uint8_t *Data)
+{
+    uint64_t start = HAL_SWTimer_GetTicks();
+    HAL_StatusTypeDef status = HAL_OK;
+    int suspended = 0;
+
+    /* После установки Lock обработчик таймера не изменяет Head и не обращается к SPIFI */
+    sched->Lock = 1;
+
+    HAL_SPIFI_W25_SchedOpTypeDef *op = sched->Head;
+    if ((op != NULL) && HAL_SPIFI_W25_Sched_IsBusy(sched->spifi))
+    {
+        if (HAL_SPIFI_W25_Sched_Overlaps(op, Address, Length))
+        {
+            status = HAL_SPIFI_W25_Sched_WaitReady(sched, HAL_SPIFI_W25_SCHED_TIMEOUT_US);
+        }
+        else
+        {
+            uint32_t holdUs = sched->ResumeHoldUs > HAL_SPIFI_W25_SCHED_TSUS_US ? sched->ResumeHoldUs : HAL_SPIFI_W25_SCHED_TSUS_US;
+            uint64_t hold = HAL_SWTimer_UsToTicks(holdUs);
+
+            while (HAL_SWTimer_GetTicks() - sched->ResumeTicks < hold)
+            {
+            }
+
+            HAL_SPIFI_W25_Suspend(sched->spifi);
+            status = HAL_SPIFI_W25_Sched_WaitReady(sched, HAL_SPIFI_W25_SCHED_SUSPEND_US);
+            /* Операция могла завершиться до приостановки, тогда команда игнорируется и бит SUS не установлен */
+            suspended = (HAL_SPIFI_W25_ReadSREG(sched->spifi, W25_SREG2) & SPIFI_W25_SREG2_SUSPEND_STATUS_M) != 0;
+            if (suspended)
+            {
+                sched->Suspends++;
+            }
+        }
+    }
+
+    if (status == HAL_OK)
+    {
+        uint32_t latency = (uint32_t)(HAL_SWTimer_GetTicks() - start);
+        if (latency > sched->ReadLatencyMax)
+        {
+            sched->ReadLatencyMax = latency;
+        }
+
+        while (Length != 0)
+        {
+            uint32_t chunk = Length < HAL_SPIFI_W25_SCHED_READ_CHUNK ? Length : HAL_SPIFI_W25_SCHED_READ_CHUNK;
+
+            HAL_SPIFI_W25_ReadData(sched->spifi, Address, chunk, Data);
+            Address += chunk;
+            Data += chunk;
+            Length -= chunk;
+        }
+    }
+
+    if (suspended)
+    {
+        HAL_SPIFI_W25_Resume(sched->spifi);
+        sched->ResumeTicks = HAL_SWTimer_GetTicks();
+    }
+
+    sched->Lock = 0;
+    return status;
+}
@@ -1,5 +1,7 @@
 #include "mik32_hal_ssd1306.h"
 
+#include <string.h>
+
 // Адрес ведомого
 uint16_t slave_address = 0b00111100;
 
@@ -192,50 +194,466 @@ HAL_StatusTypeDef HAL_SSD1306_CLR_SCR(I2C_HandleTypeDef *hi2c)
 
 }
 
-HAL_StatusTypeDef HAL_SSD1306_Write(I2C_HandleTypeDef *hi2c, uint8_t symbol)
+/**
+ * @brief Посылка символа: DATS и SYMBOL_PAGES * SYMBOL_WIDTH байт. Неизвестный символ - двоеточие.
+ */
+static uint8_t *HAL_SSD1306_Symbol(uint8_t symbol)
 {
-    // for (volatile int i = 0; i < 1000; i++);
-    HAL_StatusTypeDef error_code = HAL_OK;
     switch (symbol)
     {
     case 0:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_null, sizeof(data_symbol_null), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_null;
     case 1:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_one, sizeof(data_symbol_one), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_one;
     case 2:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_two, sizeof(data_symbol_two), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_two;
     case 3:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_three, sizeof(data_symbol_three), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_three;
     case 4:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_four, sizeof(data_symbol_four), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_four;
     case 5:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_five, sizeof(data_symbol_five), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_five;
     case 6:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_six, sizeof(data_symbol_six), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_six;
     case 7:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_seven, sizeof(data_symbol_seven), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_seven;
     case 8:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_eight, sizeof(data_symbol_eight), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_eight;
     case 9:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_nine, sizeof(data_symbol_nine), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_nine;
     case SYMBOL_SMILE:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_smile, sizeof(data_symbol_smile), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_smile;
     default:
-        error_code = HAL_I2C_Master_Transmit(hi2c, slave_address, data_symbol_colon, sizeof(data_symbol_colon), I2C_TIMEOUT_DEFAULT);
-        break;
+        return data_symbol_colon;
+    }
+}
+
+HAL_StatusTypeDef HAL_SSD1306_Write(I2C_HandleTypeDef *hi2c, uint8_t symbol)
+{
+    return HAL_I2C_Master_Transmit(hi2c, slave_address, HAL_SSD1306_Symbol(symbol), 1 + SYMBOL_PAGES * SYMBOL_WIDTH, I2C_TIMEOUT_DEFAULT);
+}
+
+
+/* Кадровый буфер */
+
+/* Байт на шине для окна сверх данных: адрес и 7 байт команд, адрес и DATS */
+#define SSD1306_FRAME_WINDOW_COST   10
+
+/* Кадр каждого I2C для обработчиков линий EPIC */
+static HAL_SSD1306_FrameTypeDef *FrameByInstance[2];
+
+
+static MIK32_RAMFUNC void HAL_SSD1306_Frame_I2C0_IRQHandler()
+{
+    HAL_SSD1306_Frame_IRQHandler(FrameByInstance[0]);
+}
+
+static MIK32_RAMFUNC void HAL_SSD1306_Frame_I2C1_IRQHandler()
+{
+    HAL_SSD1306_Frame_IRQHandler(FrameByInstance[1]);
+}
+
+/**
+ * @brief Расширить измененный участок страницы до столбцов start..end.
+ */
+static inline __attribute__((always_inline)) void HAL_SSD1306_Frame_Mark(HAL_SSD1306_FrameTypeDef *frame, uint32_t page, uint32_t start, uint32_t end)
+{
+    if (start < frame->DirtyStart[page])
+    {
+        frame->DirtyStart[page] = start;
+    }
+    if (end > frame->DirtyEnd[page])
+    {
+        frame->DirtyEnd[page] = end;
+    }
+}
+
+/**
+ * @brief Выбрать окно вывода, начиная со страницы frame->Page.
+ * Соседние страницы объединяются в одно окно (по объединению участков), пока это не
+ * увеличивает число байт на шине и данные помещаются в одну посылку.
+ * @return 0, если участков для вывода не осталось.
+ */
+static MIK32_RAMFUNC int HAL_SSD1306_Frame_NextWindow(HAL_SSD1306_FrameTypeDef *frame)
+{
+    uint32_t page = frame->Page;
+    while ((page < SSD1306_PAGES) && (frame->FlushStart[page] > frame->FlushEnd[page]))
+    {
+        page++;
+    }
+    if (page == SSD1306_PAGES)
+    {
+        return 0;
+    }
+
+    uint32_t start = frame->FlushStart[page];
+    uint32_t end = frame->FlushEnd[page];
+    uint32_t separate = SSD1306_FRAME_WINDOW_COST + end - start + 1;
+    uint32_t last = page;
+    while ((last + 1 < SSD1306_PAGES) && (frame->FlushStart[last + 1] <= frame->FlushEnd[last + 1]))
+    {
+        uint32_t next_start = frame->FlushStart[last + 1];
+        uint32_t next_end = frame->FlushEnd[last + 1];
+        uint32_t merged_start = (next_start < start) ? next_start : start;
+        uint32_t merged_end = (next_end > end) ? next_end : end;
+        uint32_t merged_length = (merged_end - merged_start + 1) * (last + 2 - page);
+        uint32_t next_separate = separate + SSD1306_FRAME_WINDOW_COST + next_end - next_start + 1;
+
+        if ((merged_length > SSD1306_FRAME_TX_MAX) || (SSD1306_FRAME_WINDOW_COST + merged_length > next_separate))
+        {
+            break;
+        }
+        start = merged_start;
+        end = merged_end;
+        separate = next_separate;
+        last++;
+    }
+
+    frame->Page = page;
+    frame->PageEnd = last;
+    frame->Column = start;
+    frame->ColumnEnd = end;
+    return 1;
+}
+
+/**
+ * @brief Начать передачу посылки frame->Tx без ожидания окончания.
+ */
+static MIK32_RAMFUNC void HAL_SSD1306_Frame_Transmit(HAL_SSD1306_FrameTypeDef *frame, uint32_t length)
+{
+    I2C_HandleTypeDef *hi2c = frame->hi2c;
+
+    frame->BusBytes += length + 1;
+    frame->Transfers++;
+
+    if (frame->Mode == SSD1306_FLUSH_DMA)
+    {
+        HAL_I2C_Master_Transmit_DMA(hi2c, slave_address, frame->Tx, length);
+        HAL_I2C_InterruptEnable(hi2c, I2C_CR1_STOPIE_M | I2C_CR1_NACKIE_M | I2C_CR1_ERRIE_M);
+    }
+    else
+    {
+        HAL_I2C_Master_Transmit_IT(hi2c, slave_address, frame->Tx, length);
+        HAL_I2C_InterruptEnable(hi2c, I2C_CR1_STOPIE_M);
+    }
+}
+
+/**
+ * @brief Передать следующую посылку вывода или завершить вывод.
+ */
+static MIK32_RAMFUNC void HAL_SSD1306_Frame_Step(HAL_SSD1306_FrameTypeDef *frame)
+{
+    uint8_t *tx = frame->Tx;
+
+    if (frame->Stage == 0)
+    {
+        if (!HAL_SSD1306_Frame_NextWindow(frame))
+        {
+            frame->Status = HAL_OK;
+            return;
+        }
+
+        *tx++ = COMS;
+        *tx++ = 0x21;
+        *tx++ = frame->Column;
+        *tx++ = frame->ColumnEnd;
+        *tx++ = 0x22;
+        *tx++ = frame->Page;
+        *tx++ = frame->PageEnd;
+        HAL_SSD1306_Frame_Transmit(frame, tx - frame->Tx);
+    }
+    else
+    {
+        uint32_t width = frame->ColumnEnd - frame->Column + 1;
+
+        *tx++ = DATS;
+        for (uint32_t page = frame->Page; page <= frame->PageEnd; page++)
+        {
+            /* Копирование без memcpy: функции библиотеки C размещаются во флеш-памяти */
+            const uint8_t *column = &frame->Buffer[page][frame->Column];
+            for (uint32_t i = 0; i < width; i++)
+            {
+                *tx++ = column[i];
+            }
+        }
+        HAL_SSD1306_Frame_Transmit(frame, tx - frame->Tx);
+    }
+}
+
+/**
+ * @brief Инициализировать кадровый буфер.
+ * Очищает Buffer и отмечает весь кадр измененным, так что первый вывод передает весь экран.
+ * Включает горизонтальную адресацию дисплея (блокирующая передача), в режиме DMA задает
+ * настройки канала hi2c->hdmatx, назначает обработчик линии I2C в EPIC.
+ *
+ * @param frame Кадр.
+ * @param hi2c I2C после HAL_I2C_Init и HAL_SSD1306_Init. Включается AutoEnd.
+ * @param Mode Способ передачи.
+ * @return HAL_ERROR при неверном I2C, отсутствии канала DMA или ошибке передачи.
+ */
+HAL_StatusTypeDef HAL_SSD1306_Frame_Init(HAL_SSD1306_FrameTypeDef *frame, I2C_HandleTypeDef *hi2c, HAL_SSD1306_FlushModeTypeDef Mode)
+{
+    uint32_t index;
+    if (hi2c->Instance == I2C_0)
+    {
+        index = 0;
+    }
+    else if (hi2c->Instance == I2C_1)
+    {
+        index = 1;
+    }
+    else
+    {
+        return HAL_ERROR;
+    }
+
+    if ((Mode == SSD1306_FLUSH_DMA) && (hi2c->hdmatx == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    frame->hi2c = hi2c;
+    frame->Mode = Mode;
+    frame->Status = HAL_OK;
+    frame->BusBytes = 0;
+    frame->Transfers = 0;
+    memset(frame->Buffer, 0, sizeof(frame->Buffer));
+    for (uint32_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        frame->DirtyStart[page] = 0;
+        frame->DirtyEnd[page] = SSD1306_WIDTH - 1;
+        frame->FlushStart[page] = SSD1306_WIDTH;
+        frame->FlushEnd[page] = 0;
     }
 
-    return error_code;
+    hi2c->Init.AutoEnd = I2C_AUTOEND_ENABLE;
 
-}
\ No newline at end of file
+    if (Mode == SSD1306_FLUSH_DMA)
+    {
+        HAL_DMA_ChannelRequestTypeDef request = index ? DMA_CHANNEL_I2C_1_REQUEST : DMA_CHANNEL_I2C_0_REQUEST;
+        DMA_ChannelInitHandleTypeDef *init = &hi2c->hdmatx->ChannelInit;
+
+        init->ReadMode = DMA_CHANNEL_MODE_MEMORY;
+        init->ReadInc = DMA_CHANNEL_INC_ENABLE;
+        init->ReadSize = DMA_CHANNEL_SIZE_BYTE;
+        init->ReadBurstSize = 0;
+        init->ReadRequest = request;
+        init->ReadAck = DMA_CHANNEL_ACK_DISABLE;
+        init->WriteMode = DMA_CHANNEL_MODE_PERIPHERY;
+        init->WriteInc = DMA_CHANNEL_INC_DISABLE;
+        init->WriteSize = DMA_CHANNEL_SIZE_BYTE;
+        init->WriteBurstSize = 0;
+        init->WriteRequest = request;
+        init->WriteAck = DMA_CHANNEL_ACK_ENABLE;
+    }
+    else
+    {
+        hi2c->Instance->CR1 &= ~I2C_CR1_TXDMAEN_M;
+    }
+
+    /* Горизонтальная адресация: окно 0x21, 0x22 заполняется по страницам */
+    uint8_t data_mode[] = {COMS, 0x20, 0x00};
+    if (HAL_I2C_Master_Transmit(hi2c, slave_address, data_mode, sizeof(data_mode), I2C_TIMEOUT_DEFAULT) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    FrameByInstance[index] = frame;
+    if (index == 0)
+    {
+        HAL_EPIC_SetHandler(EPIC_LINE_I2C_0_S, HAL_SSD1306_Frame_I2C0_IRQHandler);
+        HAL_EPIC_MaskLevelSet(HAL_EPIC_I2C_0_MASK);
+    }
+    else
+    {
+        HAL_EPIC_SetHandler(EPIC_LINE_I2C_1_S, HAL_SSD1306_Frame_I2C1_IRQHandler);
+        HAL_EPIC_MaskLevelSet(HAL_EPIC_I2C_1_MASK);
+    }
+    HAL_IRQ_EnableInterrupts();
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Очистить кадр. Отмечаются только столбцы, в которых были точки.
+ */
+void HAL_SSD1306_Frame_Clear(HAL_SSD1306_FrameTypeDef *frame)
+{
+    for (uint32_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        uint8_t *line = frame->Buffer[page];
+        for (uint32_t column = 0; column < SSD1306_WIDTH; column++)
+        {
+            if (line[column] != 0)
+            {
+                line[column] = 0;
+                HAL_SSD1306_Frame_Mark(frame, page, column, column);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Установить или погасить точку.
+ * @param x Столбец 0..SSD1306_WIDTH - 1.
+ * @param y Строка 0..SSD1306_HEIGHT - 1, 0 - верхняя.
+ * @param on 1 - точка горит.
+ */
+void HAL_SSD1306_Frame_SetPixel(HAL_SSD1306_FrameTypeDef *frame, uint8_t x, uint8_t y, uint8_t on)
+{
+    if ((x >= SSD1306_WIDTH) || (y >= SSD1306_HEIGHT))
+    {
+        return;
+    }
+
+    uint8_t *cell = &frame->Buffer[y >> 3][x];
+    uint8_t value = on ? (*cell | (1 << (y & 7))) : (*cell & ~(1 << (y & 7)));
+    if (value != *cell)
+    {
+        *cell = value;
+        HAL_SSD1306_Frame_Mark(frame, y >> 3, x, x);
+    }
+}
+
+/**
+ * @brief Записать столбцы страницы.
+ * Измененным отмечается участок от первого до последнего байта, отличающегося от кадра.
+ * @param page Страница 0..SSD1306_PAGES - 1.
+ * @param column Первый столбец. Столбцы за краем экрана отбрасываются.
+ * @param data Байты столбцов, бит 0 сверху.
+ * @param length Число столбцов.
+ */
+void HAL_SSD1306_Frame_WriteColumns(HAL_SSD1306_FrameTypeDef *frame, uint8_t page, uint8_t column, const uint8_t *data, uint8_t length)
+{
+    if ((page >= SSD1306_PAGES) || (column >= SSD1306_WIDTH))
+    {
+        return;
+    }
+    if (length > SSD1306_WIDTH - column)
+    {
+        length = SSD1306_WIDTH - column;
+    }
+
+    uint8_t *line = &frame->Buffer[page][column];
+    uint32_t first = SSD1306_WIDTH;
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (line[i] != data[i])
+        {
+            line[i] = data[i];
+            if (first == SSD1306_WIDTH)
+            {
+                first = i;
+            }
+            last = i;
+        }
+    }
+
+    if (first != SSD1306_WIDTH)
+    {
+        HAL_SSD1306_Frame_Mark(frame, page, column + first, column + last);
+    }
+}
+
+/**
+ * @brief Нарисовать символ (см. HAL_SSD1306_Write) на страницах 0..SYMBOL_PAGES - 1.
+ * @param column Первый столбец символа (START_COLUMN_TH, START_COLUMN_H и т.д.).
+ */
+void HAL_SSD1306_Frame_DrawSymbol(HAL_SSD1306_FrameTypeDef *frame, uint8_t column, uint8_t symbol)
+{
+    const uint8_t *glyph = HAL_SSD1306_Symbol(symbol) + 1;
+
+    for (uint32_t page = 0; page < SYMBOL_PAGES; page++)
+    {
+        HAL_SSD1306_Frame_WriteColumns(frame, page, column, glyph + page * SYMBOL_WIDTH, SYMBOL_WIDTH);
+    }
+}
+
+/**
+ * @brief Начать вывод измененных участков без ожидания окончания.
+ * Если предыдущий вывод завершился ошибкой, непереданные участки выводятся повторно.
+ * Окончание вывода - HAL_SSD1306_Frame_IsBusy() == 0, результат - frame->Status.
+ * @return HAL_BUSY, если предыдущий вывод не закончен (кадр будет выведен следующим вызовом).
+ */
+HAL_StatusTypeDef HAL_SSD1306_Frame_Flush(HAL_SSD1306_FrameTypeDef *frame)
+{
+    if (frame->Status == HAL_BUSY)
+    {
+        return HAL_BUSY;
+    }
+
+    for (uint32_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        if (frame->Status == HAL_ERROR)
+        {
+            HAL_SSD1306_Frame_Mark(frame, page, frame->FlushStart[page], frame->FlushEnd[page]);
+        }
+        frame->FlushStart[page] = frame->DirtyStart[page];
+        frame->FlushEnd[page] = frame->DirtyEnd[page];
+        frame->DirtyStart[page] = SSD1306_WIDTH;
+        frame->DirtyEnd[page] = 0;
+    }
+
+    frame->Page = 0;
+    frame->Stage = 0;
+    frame->BusBytes = 0;
+    frame->Transfers = 0;
+    frame->Status = HAL_BUSY;
+    HAL_SSD1306_Frame_Step(frame);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Обработчик прерывания I2C кадра.
+ * Назначается в EPIC в HAL_SSD1306_Frame_Init; при собственном обработчике линии I2C его
+ * необходимо вызывать оттуда. Обработчик и запуск следующей посылки (включая функции I2C и
+ * HAL_DMA_Start) размещены в ОЗУ и не обращаются к флеш-памяти.
+ */
+MIK32_RAMFUNC void HAL_SSD1306_Frame_IRQHandler(HAL_SSD1306_FrameTypeDef *frame)
+{
+    I2C_HandleTypeDef *hi2c = frame->hi2c;
+    uint32_t int_mask = hi2c->Instance->CR1 & I2C_INTMASK;
+    uint32_t interrupt_status = hi2c->Instance->ISR;
+
+    if (((interrupt_status & I2C_ISR_NACKF_M) && (int_mask & I2C_CR1_NACKIE_M)) ||
+        ((interrupt_status & (I2C_ISR_BERR_M | I2C_ISR_ARLO_M | I2C_ISR_OVR_M)) && (int_mask & I2C_CR1_ERRIE_M)))
+    {
+        if (frame->Mode == SSD1306_FLUSH_DMA)
+        {
+            HAL_DMA_ChannelDisable(hi2c->hdmatx);
+        }
+        /* Выключение прерываний и сброс I2C */
+        HAL_I2C_NACK_IRQ(hi2c);
+        frame->Status = HAL_ERROR;
+        return;
+    }
+
+    if ((interrupt_status & I2C_ISR_TXIS_M) && (int_mask & I2C_CR1_TXIE_M))
+    {
+        HAL_I2C_TXIS_IRQ(hi2c);
+    }
+
+    if ((interrupt_status & I2C_ISR_STOPF_M) && (int_mask & I2C_CR1_STOPIE_M))
+    {
+        HAL_I2C_STOP_IRQ(hi2c);
+        hi2c->Instance->CR1 &= ~I2C_INTMASK;
+
+        if (frame->Stage == 0)
+        {
+            frame->Stage = 1;
+        }
+        else
+        {
+            for (uint32_t page = frame->Page; page <= frame->PageEnd; page++)
+            {
+                frame->FlushStart[page] = SSD1306_WIDTH;
+                frame->FlushEnd[page] = 0;
+            }
+            frame->Page = frame->PageEnd + 1;
+            frame->Stage = 0;
+        }
+        HAL_SSD1306_Frame_Step(frame);
+    }
+}
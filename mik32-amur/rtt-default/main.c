@@ -21,10 +21,15 @@
 #include "mik32_hal_pcc.h"
 #include "SEGGER_RTT.h"
 
+#ifdef MIK32_BENCH
+#include "bench.h"
+#endif
+
 // SEGGER RTT: IP: localhost, PORT: 19021.
-#define print(s)                        SEGGER_RTT_WriteString( 0, s ); HAL_DelayMs( &system_timer, 1 )
+// Вывод защищен блокировкой RTT (SEGGER_RTT_Conf.h), задержка после вывода не требуется.
+#define print(s)                        SEGGER_RTT_WriteString( 0, s )
 #define println(s)                      print( s "\n" )
-#define printf( format, ... )           SEGGER_RTT_printf( 0, ( const char * ) ( format ), ##__VA_ARGS__ ); HAL_DelayMs( &system_timer, 1 )
+#define printf( format, ... )           SEGGER_RTT_printf( 0, ( const char * ) ( format ), ##__VA_ARGS__ )
 
 void systemClockConfig( void );
 static void initScr1Timer( void );
@@ -86,6 +91,11 @@ int main()
     // Настраиваем терминал 0 для работы в неблокирующем режиме.
     SEGGER_RTT_ConfigUpBuffer( 0, NULL, NULL, 0, SEGGER_RTT_MODE_NO_BLOCK_TRIM );
 
+#ifdef MIK32_BENCH
+    // Запускаем тесты производительности.
+    Bench_Run();
+#endif
+
     uint8_t n = 0;
 
     // Запускаем "бесконечный" цикл выполнения программы.
@@ -180,7 +180,7 @@ void xprintf_uarts_allow(uint8_t xprintf_uarts_value)
 
     \param chr отправляемые данные
 */
-__attribute__((weak)) void xfunc_output(int chr)
+static void UART_XprintfOutput(int chr)
 {
     if (xprintf_uarts & XPRINTF_UART_0)
     {
@@ -193,3 +193,51 @@ __attribute__((weak)) void xfunc_output(int chr)
         UART_WaitTransmission(UART_1);
     }
 }
+
+__attribute__((weak, alias("UART_XprintfOutput"))) void xfunc_output(int chr);
+
+/** Передает блок данных в UART: следующий байт записывается, как только предыдущий
+    перешел в сдвиговый регистр (TXE), окончания передачи (TC) ожидает только последний.
+
+    \param uart указатель для доступа к UART
+    \param buff данные
+    \param len количество байт
+*/
+static void UART_WriteBlock(UART_TypeDef *uart, const char *buff, int len)
+{
+    while (len-- > 0)
+    {
+        UART_WriteByte(uart, (uint8_t)*buff++);
+        while (!UART_IsTxBufferFreed(uart))
+            ;
+    }
+    UART_WaitTransmission(uart);
+}
+
+/** Вывод блока функциями "xprintf" и "xputs" в порты UART_0 и/или UART_1
+    (см. xfunc_output). Если xfunc_output переопределена, блок выводится через нее.
+
+    \param buff отправляемые данные
+    \param len количество байт
+*/
+__attribute__((weak)) void xfunc_output_block(const char *buff, int len)
+{
+    /* xfunc_output переопределена пользователем - блок передается ей по байтам */
+    if (xfunc_output != UART_XprintfOutput)
+    {
+        while (len-- > 0)
+        {
+            xfunc_output(*buff++);
+        }
+        return;
+    }
+
+    if (xprintf_uarts & XPRINTF_UART_0)
+    {
+        UART_WriteBlock(UART_0, buff, len);
+    }
+    if (xprintf_uarts & XPRINTF_UART_1)
+    {
+        UART_WriteBlock(UART_1, buff, len);
+    }
+}
@@ -21,6 +21,8 @@
 #include "xprintf.h"
 
 #define SZB_OUTPUT	32
+#define SZB_BLOCK	32	/* Size of the output block buffer */
+#define SZB_NUMBER	(XF_USE_LLI ? 64 : 32)	/* Size of the integer string buffer (binary digits) */
 
 
 #if XF_USE_OUTPUT
@@ -155,6 +157,163 @@ static void ftoa (
 #endif	/* XF_USE_FLOAT */
 
 
+/*----------------------------------------------*/
+/* Block output                                 */
+/*----------------------------------------------*/
+/* Output is collected in blocks and passed to the device at once. If the
+/  default device provides xfunc_output_block() (see uart_lib.c), blocks for
+/  xfunc_output are written with a single call instead of per character. */
+
+extern void xfunc_output_block(const char* buff, int len) __attribute__((weak));
+
+typedef struct {
+	void(*func)(int);		/* Output device (null:strptr) */
+	int n;					/* Number of chars in the block */
+	char buf[SZB_BLOCK];	/* Block buffer */
+} xout_t;
+
+
+static void xfwrite (		/* Put a block of characters to the specified device */
+	void(*func)(int),		/* Pointer to the output function (null:strptr) */
+	const char* buff,		/* Pointer to the characters */
+	int len					/* Number of characters */
+)
+{
+	if (XF_CRLF) {								/* CR -> CRLF is done per character */
+		while (len-- > 0) xfputc(func, *buff++);
+	} else if (!func) {
+		if (strptr) {							/* Write to the memory */
+			memcpy(strptr, buff, len); strptr += len;
+		}
+	} else if (func == xfunc_output && xfunc_output_block) {
+		xfunc_output_block(buff, len);			/* Write to the default device at once */
+	} else {
+		while (len-- > 0) func(*buff++);
+	}
+}
+
+
+static void xout_flush (xout_t* o)
+{
+	if (o->n) {
+		xfwrite(o->func, o->buf, o->n);
+		o->n = 0;
+	}
+}
+
+
+static void xout_putc (xout_t* o, char c)
+{
+	if (o->n == SZB_BLOCK) xout_flush(o);
+	o->buf[o->n++] = c;
+}
+
+
+static void xout_write (xout_t* o, const char* str, int len)
+{
+	if (o->n + len > SZB_BLOCK) {
+		xout_flush(o);
+		if (len >= SZB_BLOCK) {		/* Large blocks bypass the buffer */
+			xfwrite(o->func, str, len);
+			return;
+		}
+	}
+	memcpy(o->buf + o->n, str, len);
+	o->n += len;
+}
+
+
+static void xout_fill (xout_t* o, char c, int n)
+{
+	while (n-- > 0) xout_putc(o, c);
+}
+
+
+
+/*----------------------------------------------*/
+/* Integer to string                            */
+/*----------------------------------------------*/
+/* Digits are written backwards from the end of the buffer. Decimal conversion
+/  uses a two-digit table and division by 100 as multiplication by the
+/  reciprocal (mulhu on RV32IM), radix 2/8/16 uses shifts and a nibble table. */
+
+static const char xdigits_lc[] = "0123456789abcdef";
+static const char xdigits_uc[] = "0123456789ABCDEF";
+
+static const char xpairs[200] = {
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899"
+};
+
+
+static char* xutoa10 (	/* Returns pointer to the first digit */
+	char* p,			/* End of the output buffer */
+	unsigned long v		/* Value (32 bits) */
+)
+{
+	unsigned long q;
+	const char *d;
+
+	while (v >= 100) {
+		q = (unsigned long)(((unsigned long long)v * 0x51EB851FUL) >> 37);	/* v / 100 */
+		d = &xpairs[(v - q * 100) * 2];
+		*--p = d[1]; *--p = d[0];
+		v = q;
+	}
+	if (v >= 10) {
+		d = &xpairs[v * 2];
+		*--p = d[1]; *--p = d[0];
+	} else {
+		*--p = '0' + (char)v;
+	}
+	return p;
+}
+
+
+#if XF_USE_LLI
+static char* xutoa10ll (	/* Returns pointer to the first digit */
+	char* p,				/* End of the output buffer */
+	unsigned long long v	/* Value */
+)
+{
+	char *e;
+
+	while (v > 0xFFFFFFFFULL) {	/* 8 digits per 64-bit division */
+		e = p - 8;
+		p = xutoa10(p, (unsigned long)(v % 100000000));
+		while (p > e) *--p = '0';
+		v /= 100000000;
+	}
+	return xutoa10(p, (unsigned long)v);
+}
+#endif
+
+
+static char* xutoa2n (	/* Returns pointer to the first digit */
+	char* p,			/* End of the output buffer */
+#if XF_USE_LLI
+	unsigned long long v,	/* Value */
+#else
+	unsigned long v,	/* Value */
+#endif
+	unsigned int sh,	/* Bits per digit: 1, 3 or 4 */
+	const char* digits	/* Digit table */
+)
+{
+	unsigned int m = (1 << sh) - 1;
+
+	do {
+		*--p = digits[v & m];
+		v >>= sh;
+	} while (v != 0);
+	return p;
+}
+
+
+
 /*----------------------------------------------*/
 /* Put a character                              */
 /*----------------------------------------------*/
@@ -200,9 +359,7 @@ void xfputs (			/* Put a string to the specified device */
 	const char*	str		/* Pointer to the string */
 )
 {
-	while (*str) {			/* Put the string */
-		xfputc(func, *str++);
-	}
+	xfwrite(func, str, strlen(str));	/* Put the string at once */
 }
 
 
@@ -217,6 +374,7 @@ void xfputs (			/* Put a string to the specified device */
     xprintf("%llu", 0x100000000);	"4294967296"	<XF_USE_LLI>
     xprintf("%lld", -1LL);			"-1"			<XF_USE_LLI>
     xprintf("%04x", 0xA3);			"00a3"
+    xprintf("%05d", -5);			"-0005"
     xprintf("%08lX", 0x123ABC);		"00123ABC"
     xprintf("%016b", 0x550F);		"0101010100001111"
     xprintf("%*d", 6, 100);			"   100"
@@ -238,9 +396,11 @@ static void xvfprintf (
 	va_list arp			/* Pointer to arguments */
 )
 {
-	unsigned int r, i, j, w, f;
+	unsigned int i, j, w, f;
 	int n, prec;
-	char str[SZB_OUTPUT], c, d, *p, pad;
+	char str[SZB_OUTPUT > SZB_NUMBER ? SZB_OUTPUT : SZB_NUMBER], c, *p, pad;
+	const char *s;
+	xout_t out;
 #if XF_USE_LLI
 	long long v;
 	unsigned long long uv;
@@ -249,12 +409,14 @@ static void xvfprintf (
 	unsigned long uv;
 #endif
 
+	out.func = func;
+	out.n = 0;
 	for (;;) {
+		s = fmt;					/* Pass through a run of plain characters */
+		while (*fmt && *fmt != '%') fmt++;
+		if (fmt != s) xout_write(&out, s, fmt - s);
 		c = *fmt++;					/* Get a format character */
 		if (!c) break;				/* End of format? */
-		if (c != '%') {				/* Pass it through if not a % sequense */
-			xfputc(func, c); continue;
-		}
 		f = w = 0;			 		/* Clear parms */
 		pad = ' '; prec = -1;
 		c = *fmt++;					/* Get first char of the sequense */
@@ -301,38 +463,39 @@ static void xvfprintf (
 		if (!c) break;				/* End of format? */
 		switch (c) {				/* Type is... */
 		case 'b':					/* Unsigned binary */
-			r = 2; break;
 		case 'o':					/* Unsigned octal */
-			r = 8; break;
 		case 'd':					/* Signed decimal */
 		case 'u':					/* Unsigned decimal */
-			r = 10; break;
 		case 'x':					/* Hexdecimal (lower case) */
 		case 'X':					/* Hexdecimal (upper case) */
-			r = 16; break;
+			break;
 		case 'c':					/* A character */
-			xfputc(func, (char)va_arg(arp, int)); continue;
+			if (!(f & 2) && w > 1) xout_fill(&out, ' ', w - 1);	/* Left pads */
+			xout_putc(&out, (char)va_arg(arp, int));
+			if ((f & 2) && w > 1) xout_fill(&out, ' ', w - 1);	/* Right pads */
+			continue;
 		case 's':					/* String */
 			p = va_arg(arp, char*);		/* Get a pointer argument */
 			if (!p) p = "";				/* Null ptr generates a null string */
 			j = strlen(p);
 			if (prec >= 0 && j > (unsigned int)prec) j = prec;	/* Limited length of string body */
-			for ( ; !(f & 2) && j < w; j++) xfputc(func, pad);	/* Left pads */
-			while (*p && prec--) xfputc(func, *p++);/* String body */
-			while (j++ < w) xfputc(func, ' ');		/* Right pads */
+			if (!(f & 2) && j < w) xout_fill(&out, pad, w - j);	/* Left pads */
+			xout_write(&out, p, j);								/* String body */
+			if ((f & 2) && j < w) xout_fill(&out, ' ', w - j);	/* Right pads */
 			continue;
 #if XF_USE_FP
 		case 'f':					/* Float (decimal) */
 		case 'e':					/* Float (e) */
 		case 'E':					/* Float (E) */
 			ftoa(p = str, va_arg(arp, double), prec, c);	/* Make fp string */
-			for (j = strlen(p); !(f & 2) && j < w; j++) xfputc(func, pad);	/* Left pads */
-			while (*p) xfputc(func, *p++);		/* Value */
-			while (j++ < w) xfputc(func, ' ');	/* Right pads */
+			j = strlen(p);
+			if (!(f & 2) && j < w) xout_fill(&out, pad, w - j);	/* Left pads */
+			xout_write(&out, p, j);								/* Value */
+			if ((f & 2) && j < w) xout_fill(&out, ' ', w - j);	/* Right pads */
 			continue;
 #endif
 		default:					/* Unknown type (passthrough) */
-			xfputc(func, c); continue;
+			xout_putc(&out, c); continue;
 		}
 
 		/* Get an integer argument and put it in numeral */
@@ -356,17 +519,33 @@ static void xvfprintf (
 		if (c == 'd' && v < 0) {	/* Negative value? */
 			v = 0 - v; f |= 1;
 		}
-		i = 0; uv = v;
-		do {	/* Make an integer number string */
-			d = (char)(uv % r); uv /= r;
-			if (d > 9) d += (c == 'x') ? 0x27 : 0x07;
-			str[i++] = d + '0';
-		} while (uv != 0 && i < sizeof str);
-		if (f & 1) str[i++] = '-';					/* Sign */
-		for (j = i; !(f & 2) && j < w; j++) xfputc(func, pad);	/* Left pads */
-		do xfputc(func, str[--i]); while (i != 0);	/* Value */
-		while (j++ < w) xfputc(func, ' ');			/* Right pads */
+		uv = v;
+		switch (c) {				/* Make an integer number string */
+		case 'b':
+			p = xutoa2n(str + sizeof str, uv, 1, xdigits_lc); break;
+		case 'o':
+			p = xutoa2n(str + sizeof str, uv, 3, xdigits_lc); break;
+		case 'x':
+			p = xutoa2n(str + sizeof str, uv, 4, xdigits_lc); break;
+		case 'X':
+			p = xutoa2n(str + sizeof str, uv, 4, xdigits_uc); break;
+		default:
+#if XF_USE_LLI
+			p = xutoa10ll(str + sizeof str, uv);
+#else
+			p = xutoa10(str + sizeof str, uv);
+#endif
+			break;
+		}
+		i = (str + sizeof str) - p;					/* Number of digits */
+		j = i + (f & 1);							/* Length with the sign */
+		if (!(f & 2) && pad == ' ' && j < w) xout_fill(&out, ' ', w - j);	/* Left pads */
+		if (f & 1) xout_putc(&out, '-');			/* Sign */
+		if (!(f & 2) && pad == '0' && j < w) xout_fill(&out, '0', w - j);	/* Zero pads after the sign */
+		xout_write(&out, p, i);						/* Value */
+		if ((f & 2) && j < w) xout_fill(&out, ' ', w - j);	/* Right pads */
 	}
+	xout_flush(&out);
 }
 
 
@@ -423,6 +602,18 @@ void xsprintf (			/* Put a formatted string to the memory */
 /* Dump a line of binary dump                   */
 /*----------------------------------------------*/
 
+static void xout_hex (xout_t* o, unsigned long v, int digits)	/* Put fixed width upper case hex */
+{
+	char str[8];
+	int i;
+
+	for (i = digits - 1; i >= 0; i--) {
+		str[i] = xdigits_uc[v & 0xF]; v >>= 4;
+	}
+	xout_write(o, str, digits);
+}
+
+
 void put_dump (
 	const void* buff,		/* Pointer to the array to be dumped */
 	unsigned long addr,		/* Heading address value */
@@ -434,35 +625,43 @@ void put_dump (
 	const unsigned char *bp;
 	const unsigned short *sp;
 	const unsigned long *lp;
+	xout_t out;
 
 
-	xprintf("%08lX ", addr);		/* address */
+	out.func = xfunc_output;
+	out.n = 0;
+	xout_hex(&out, addr, 8);		/* address */
+	xout_putc(&out, ' ');
 
 	switch (width) {
 	case sizeof (char):
 		bp = buff;
 		for (i = 0; i < len; i++) {		/* Hexdecimal dump in (char) */
-			xprintf(" %02X", bp[i]);
+			xout_putc(&out, ' ');
+			xout_hex(&out, bp[i], 2);
 		}
-		xputs("  ");
+		xout_write(&out, "  ", 2);
 		for (i = 0; i < len; i++) {		/* ASCII dump */
-			xputc((unsigned char)((bp[i] >= ' ' && bp[i] <= '~') ? bp[i] : '.'));
+			xout_putc(&out, (char)((bp[i] >= ' ' && bp[i] <= '~') ? bp[i] : '.'));
 		}
 		break;
 	case sizeof (short):
 		sp = buff;
 		do {							/* Hexdecimal dump in (short) */
-			xprintf(" %04X", *sp++);
+			xout_putc(&out, ' ');
+			xout_hex(&out, *sp++, 4);
 		} while (--len);
 		break;
 	case sizeof (long):
 		lp = buff;
-		do {							/* Hexdecimal dump in (short) */
-			xprintf(" %08lX", *lp++);
+		do {							/* Hexdecimal dump in (long) */
+			xout_putc(&out, ' ');
+			xout_hex(&out, *lp++, 8);
 		} while (--len);
 		break;
 	}
 
+	xout_flush(&out);
 	xputc('\n');
 }
 #endif	/* XF_USE_DUMP */
@@ -13,7 +13,9 @@ extern "C" {
 #define XF_USE_OUTPUT	1	/* 1: Enable output functions */
 #define	XF_CRLF			0	/* 1: Convert \n ==> \r\n in the output char */
 #define	XF_USE_DUMP		1	/* 1: Enable put_dump function */
+#ifndef XF_USE_LLI
 #define	XF_USE_LLI		0	/* 1: Enable long long integer in size prefix ll */
+#endif
 #define	XF_USE_FP		0	/* 1: Enable support for floating point in type e and f */
 #define XF_DPC			','	/* Decimal separator for floating point */
 #define XF_USE_INPUT	0	/* 1: Enable input functions */
@@ -28,6 +30,7 @@ extern "C" {
 //#define xdev_out(func) xfunc_output = (void(*)(int))(func)
 
 extern void xfunc_output(int chr); /* "xfunc_output(int chr)" in uart_lib.c, without "xdev_out(func)" in main.c */
+extern void xfunc_output_block(const char* buff, int len); /* Optional block output for xfunc_output (weak, uart_lib.c) */
 
 //extern void (*xfunc_output)(int);
 
@@ -13,6 +13,9 @@ void _exit(int code)
   write(STDERR_FILENO, message, sizeof(message) - 1);
   write_hex(STDERR_FILENO, code);
   write(STDERR_FILENO, "\n", 1);
+#ifdef MIK32_STDIO_UART
+  write_flush();
+#endif
 
   for (;;);
 }
@@ -11,6 +11,51 @@
 
 void write_hex(int fd, unsigned long int hex);
 
+/* Перевод строки в _write (write.c) */
+#define WRITE_NEWLINE_LF            0   /* '\n' передается без изменений */
+#define WRITE_NEWLINE_CRLF          1   /* '\n' заменяется на "\r\n" */
+
+/* Поведение _write при заполнении буфера передачи */
+#define WRITE_OVERFLOW_BLOCK        0   /* ожидать освобождения места */
+#define WRITE_OVERFLOW_DROP         1   /* отбросить новые данные */
+#define WRITE_OVERFLOW_OVERWRITE    2   /* отбросить самые старые непереданные данные */
+
+#ifndef WRITE_NEWLINE
+#define WRITE_NEWLINE               WRITE_NEWLINE_CRLF
+#endif
+
+#ifndef WRITE_OVERFLOW
+#define WRITE_OVERFLOW              WRITE_OVERFLOW_BLOCK
+#endif
+
+/* Поток _write по умолчанию, если приложение не вызвало write_init */
+#ifndef WRITE_UART
+#define WRITE_UART                  UART_0
+#endif
+
+#ifndef WRITE_BAUDRATE
+#define WRITE_BAUDRATE              115200
+#endif
+
+#ifndef WRITE_DMA_CHANNEL
+#define WRITE_DMA_CHANNEL           DMA_CHANNEL_3
+#endif
+
+/* Размеры буферов потока по умолчанию, степени двойки */
+#ifndef WRITE_RX_SIZE
+#define WRITE_RX_SIZE               16
+#endif
+
+#ifndef WRITE_TX_SIZE
+#define WRITE_TX_SIZE               512
+#endif
+
+struct __HAL_USART_StreamTypeDef;
+
+void write_init(struct __HAL_USART_StreamTypeDef *stream);
+void write_config(uint8_t newline, uint8_t overflow);
+void write_flush(void);
+
 static inline int _stub(int err)
 {
   return -1;
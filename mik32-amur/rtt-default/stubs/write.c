@@ -1,6 +1,15 @@
 /* See LICENSE of license details. */
 
-/* This file refers the RISC-V standard, some adjustments are made according to GigaDevice chips */
+/*
+ * _write для newlib (printf, puts) через буферизированный поток USART (mik32_hal_usart_stream.h).
+ *
+ * Данные копируются в кольцевой буфер передачи потока и отправляются DMA, printf не ожидает
+ * передачи по линии. Приложение может передать свой поток функции write_init; иначе при первом
+ * выводе создается поток по умолчанию (WRITE_UART, WRITE_BAUDRATE, канал WRITE_DMA_CHANNEL).
+ * Первый вывод в этом случае выполняется из основной программы после настройки тактирования:
+ * HAL_USART_Stream_Init разрешает прерывания. Поведение при заполнении буфера и перевод строки
+ * задаются функцией write_config (по умолчанию - макросами WRITE_OVERFLOW и WRITE_NEWLINE).
+ */
 
 #include <stdint.h>
 #include <string.h>
@@ -12,62 +21,146 @@
 #endif
 
 #include "stub.h"
-//#include "ch32v30x_usart.h"
+#include "mik32_hal_usart_stream.h"
 
-//typedef unsigned int size_t;
-extern int _put_char(int ch) __attribute__((weak));
 
-#if   defined (__ICCRISCV__)
-size_t __write(int handle, const unsigned char *buf, size_t bufSize)
+static HAL_USART_StreamTypeDef *write_stream;
+static uint8_t write_newline = WRITE_NEWLINE;
+static uint8_t write_overflow = WRITE_OVERFLOW;
+
+/* Число байт, отброшенных при заполнении буфера (WRITE_OVERFLOW_DROP, WRITE_OVERFLOW_OVERWRITE) */
+volatile uint32_t write_dropped;
+
+/* Поток по умолчанию */
+static HAL_USART_StreamTypeDef write_default;
+static DMA_InitTypeDef write_dma;
+static DMA_ChannelHandleTypeDef write_dma_channel;
+static uint8_t write_rx_buffer[WRITE_RX_SIZE];
+static uint8_t write_tx_buffer[WRITE_TX_SIZE];
+
+
+void write_init(struct __HAL_USART_StreamTypeDef *stream)
 {
-  size_t nChars = 0;
+  write_stream = stream;
+  write_dropped = 0;
+}
 
-  if (handle == -1)
+void write_config(uint8_t newline, uint8_t overflow)
+{
+  write_newline = newline;
+  write_overflow = overflow;
+}
+
+/* Ожидание передачи всех данных. Не зависит от прерываний, вызывается из обработчиков исключений */
+void write_flush(void)
+{
+  if (write_stream != NULL)
   {
-    return 0;
+    HAL_USART_Stream_Flush(write_stream);
   }
+}
 
-  for (; bufSize > 0; --bufSize)
+/* Создать поток по умолчанию. Состояние DMA других каналов не изменяется (HAL_DMA_Init не вызывается) */
+static void write_default_init(void)
+{
+  write_dma.Instance = DMA_CONFIG;
+  HAL_DMA_MspInit(&write_dma);
+  write_dma_channel.dma = &write_dma;
+  write_dma_channel.ChannelInit.Channel = WRITE_DMA_CHANNEL;
+  write_dma_channel.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_LOW;
+  write_default.hdma_channel = &write_dma_channel;
+
+  if (HAL_USART_Stream_Init(&write_default, WRITE_UART, WRITE_BAUDRATE, write_rx_buffer, sizeof(write_rx_buffer),
+                            write_tx_buffer, sizeof(write_tx_buffer)) == HAL_OK)
   {
-    _put_char((uint8_t) *buf);
-    ++buf;
-    ++nChars;
+    write_init(&write_default);
   }
+}
 
-  return nChars;
- }
+static void write_put(const uint8_t *data, uint32_t len)
+{
+  uint32_t done = HAL_USART_Stream_Write(write_stream, data, len);
 
-int puts(const char* string) {
-    return __write(0, (const void *) string, strlen(string));
-}
+  if (done == len)
+  {
+    return;
+  }
+  data += done;
+  len -= done;
 
-#elif defined ( __GNUC__ )
-ssize_t _write(int fd, const void* ptr, size_t len) {
-    const uint8_t * current = (const uint8_t *) ptr;
+  switch (write_overflow)
+  {
+  case WRITE_OVERFLOW_DROP:
+    write_dropped += len;
+    break;
+
+  case WRITE_OVERFLOW_OVERWRITE:
+    /* Отбрасываем самые старые данные. Их место за участком, который передает DMA, освобождается
+       после его передачи; если места не хватает - оставляем конец новых */
+    if (len > HAL_USART_Stream_TxFree(write_stream))
     {
-        for (size_t jj = 0; jj < len; jj++) {
-            _put_char(current[jj]);
-
-            if (current[jj] == '\n') {
-                _put_char('\r');
-            }
-        }
-        return len;
+      write_dropped += HAL_USART_Stream_Discard(write_stream, len - HAL_USART_Stream_TxFree(write_stream));
     }
+    if (len > HAL_USART_Stream_TxFree(write_stream))
+    {
+      uint32_t skip = len - HAL_USART_Stream_TxFree(write_stream);
+      write_dropped += skip;
+      data += skip;
+      len -= skip;
+    }
+    HAL_USART_Stream_Write(write_stream, data, len);
+    break;
 
-    return _stub(EBADF);
-}
-
-int puts(const char* string) {
-    return _write(0, (const void *) string, strlen(string));
+  default:
+    /* WRITE_OVERFLOW_BLOCK: Poll продвигает передачу и при запрещенных прерываниях */
+    while (len != 0)
+    {
+      HAL_USART_Stream_Poll(write_stream);
+      done = HAL_USART_Stream_Write(write_stream, data, len);
+      data += done;
+      len -= done;
+    }
+    break;
+  }
 }
-#endif
 
-int _put_char(int ch)
+ssize_t _write(int fd, const void* ptr, size_t len)
 {
-    USART_SendData(USART1, (uint8_t) ch );
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TXE)== RESET){
+  const uint8_t *current = (const uint8_t *) ptr;
+  const uint8_t *end = current + len;
+
+  if ((fd != STDOUT_FILENO) && (fd != STDERR_FILENO))
+  {
+    return _stub(EBADF);
+  }
+  if (write_stream == NULL)
+  {
+    write_default_init();
+    if (write_stream == NULL)
+    {
+      return _stub(EIO);
+    }
+  }
+
+  if (write_newline == WRITE_NEWLINE_LF)
+  {
+    write_put(current, len);
+    return len;
+  }
+
+  /* WRITE_NEWLINE_CRLF: строка передается участками между символами '\n' */
+  while (current < end)
+  {
+    const uint8_t *newline = memchr(current, '\n', end - current);
+    if (newline == NULL)
+    {
+      write_put(current, end - current);
+      break;
     }
+    write_put(current, newline - current);
+    write_put((const uint8_t *) "\r\n", 2);
+    current = newline + 1;
+  }
 
-    return ch;
+  return len;
 }
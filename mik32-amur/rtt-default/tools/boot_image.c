@@ -0,0 +1,317 @@
+/*
+ * Подготовка образа для слота A/B (hal/utilities/Include/mik32_hal_boot.h).
+ *
+ * Образ дополняется байтами 0xFF до кратной 16 длины, перед ним записывается заголовок
+ * HAL_Boot_HeaderTypeDef, дополненный 0xFF до HAL_BOOT_HEADER_SIZE, с CRC-32 и, если задан
+ * ключ, имитовставкой Кузнечик по ГОСТ Р 34.13-2015. Результат записывается в начало слота
+ * (например, HAL_SPIFI_W25_WriteRange), образ собирается для адреса слот + HAL_BOOT_HEADER_SIZE.
+ * Чтобы прерванное обновление не прошло проверку, при записи по частям заголовок записывается
+ * последним.
+ *
+ * Без аргументов проверяются шифрование и имитовставка на контрольных примерах ГОСТ Р 34.12-2015
+ * и ГОСТ Р 34.13-2015.
+ *
+ * Ключ задается 64 шестнадцатеричными цифрами в порядке стандарта. На устройстве блок Crypto
+ * должен загружать блоки в том же порядке байтов.
+ *
+ * Сборка и запуск (из каталога rtt-default):
+ *     gcc -O2 -Ihal/utilities/Include -Ihal/peripherals/Include -Ihal/core/Include -Ishared/include -Ishared/periphery -Ishared/libs -DMIK32V2 tools/boot_image.c -o boot_image
+ *     ./boot_image firmware.bin slot.bin версия [ключ]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mik32_hal_boot.h"
+
+#define IMAGE_MAX       (16 * 1024 * 1024)
+#define BLOCK           16
+
+static const uint8_t kuzPi[256] = {
+    252, 238, 221, 17, 207, 110, 49, 22, 251, 196, 250, 218, 35, 197, 4, 77,
+    233, 119, 240, 219, 147, 46, 153, 186, 23, 54, 241, 187, 20, 205, 95, 193,
+    249, 24, 101, 90, 226, 92, 239, 33, 129, 28, 60, 66, 139, 1, 142, 79,
+    5, 132, 2, 174, 227, 106, 143, 160, 6, 11, 237, 152, 127, 212, 211, 31,
+    235, 52, 44, 81, 234, 200, 72, 171, 242, 42, 104, 162, 253, 58, 206, 204,
+    181, 112, 14, 86, 8, 12, 118, 18, 191, 114, 19, 71, 156, 183, 93, 135,
+    21, 161, 150, 41, 16, 123, 154, 199, 243, 145, 120, 111, 157, 158, 178, 177,
+    50, 117, 25, 61, 255, 53, 138, 126, 109, 84, 198, 128, 195, 189, 13, 87,
+    223, 245, 36, 169, 62, 168, 67, 201, 215, 121, 214, 246, 124, 34, 185, 3,
+    224, 15, 236, 222, 122, 148, 176, 188, 220, 232, 40, 80, 78, 51, 10, 74,
+    167, 151, 96, 115, 30, 0, 98, 68, 26, 184, 56, 130, 100, 159, 38, 65,
+    173, 69, 70, 146, 39, 94, 85, 47, 140, 163, 165, 125, 105, 213, 149, 59,
+    7, 88, 179, 64, 134, 172, 29, 247, 48, 55, 107, 228, 136, 217, 231, 137,
+    225, 27, 131, 73, 76, 63, 248, 254, 141, 83, 170, 144, 202, 216, 133, 97,
+    32, 113, 103, 164, 45, 43, 9, 91, 203, 155, 37, 208, 190, 229, 108, 82,
+    89, 166, 116, 210, 230, 244, 180, 192, 209, 102, 175, 194, 57, 75, 99, 182,
+};
+
+/* Коэффициенты l для байтов a15 ... a0 */
+static const uint8_t kuzL[BLOCK] = {148, 32, 133, 16, 194, 192, 1, 251, 1, 192, 194, 16, 133, 32, 148, 1};
+
+/* Блок хранится в порядке записи стандарта: byte[0] = a15 */
+typedef struct
+{
+    uint8_t Keys[10][BLOCK];
+} kuzTypeDef;
+
+static uint8_t kuzMul(uint8_t a, uint8_t b)
+{
+    uint8_t result = 0;
+
+    while (b)
+    {
+        if (b & 1)
+        {
+            result ^= a;
+        }
+        a = (a << 1) ^ ((a & 0x80) ? 0xC3 : 0);
+        b >>= 1;
+    }
+    return result;
+}
+
+static void kuzLinear(uint8_t *block)
+{
+    for (int round = 0; round < BLOCK; round++)
+    {
+        uint8_t l = 0;
+        for (int i = 0; i < BLOCK; i++)
+        {
+            l ^= kuzMul(block[i], kuzL[i]);
+        }
+        memmove(block + 1, block, BLOCK - 1);
+        block[0] = l;
+    }
+}
+
+/* LSX[k](block) */
+static void kuzRound(uint8_t *block, const uint8_t *key)
+{
+    for (int i = 0; i < BLOCK; i++)
+    {
+        block[i] = kuzPi[block[i] ^ key[i]];
+    }
+    kuzLinear(block);
+}
+
+static void kuzInit(kuzTypeDef *kuz, const uint8_t *key)
+{
+    uint8_t a1[BLOCK], a0[BLOCK];
+
+    memcpy(a1, key, BLOCK);
+    memcpy(a0, key + BLOCK, BLOCK);
+    memcpy(kuz->Keys[0], a1, BLOCK);
+    memcpy(kuz->Keys[1], a0, BLOCK);
+
+    for (int i = 1; i <= 32; i++)
+    {
+        uint8_t c[BLOCK] = {0};
+        uint8_t t[BLOCK];
+
+        c[BLOCK - 1] = i;
+        kuzLinear(c);
+
+        /* F[C](a1, a0) = (LSX[C](a1) ^ a0, a1) */
+        memcpy(t, a1, BLOCK);
+        kuzRound(t, c);
+        for (int j = 0; j < BLOCK; j++)
+        {
+            t[j] ^= a0[j];
+        }
+        memcpy(a0, a1, BLOCK);
+        memcpy(a1, t, BLOCK);
+
+        if ((i % 8) == 0)
+        {
+            memcpy(kuz->Keys[i / 4], a1, BLOCK);
+            memcpy(kuz->Keys[i / 4 + 1], a0, BLOCK);
+        }
+    }
+}
+
+static void kuzEncrypt(const kuzTypeDef *kuz, uint8_t *block)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        kuzRound(block, kuz->Keys[i]);
+    }
+    for (int i = 0; i < BLOCK; i++)
+    {
+        block[i] ^= kuz->Keys[9][i];
+    }
+}
+
+/* Имитовставка ГОСТ Р 34.13-2015 для сообщения из целых блоков, как в HAL_Boot_CheckMac */
+static void kuzMac(const kuzTypeDef *kuz, const uint8_t *head, uint32_t headLength,
+                   const uint8_t *data, uint32_t length, uint8_t *mac)
+{
+    uint8_t r[BLOCK] = {0};
+    uint8_t key1[BLOCK];
+    uint8_t state[BLOCK] = {0};
+    uint32_t total = headLength + length;
+
+    kuzEncrypt(kuz, r);
+    for (int i = 0; i < BLOCK; i++)
+    {
+        key1[i] = (r[i] << 1) | ((i + 1 < BLOCK) ? (r[i + 1] >> 7) : 0);
+    }
+    if (r[0] & 0x80)
+    {
+        key1[BLOCK - 1] ^= 0x87;
+    }
+
+    for (uint32_t offset = 0; offset < total; offset += BLOCK)
+    {
+        for (int i = 0; i < BLOCK; i++)
+        {
+            uint32_t n = offset + i;
+            state[i] ^= (n < headLength) ? head[n] : data[n - headLength];
+            if (offset + BLOCK == total)
+            {
+                state[i] ^= key1[i];
+            }
+        }
+        kuzEncrypt(kuz, state);
+    }
+    memcpy(mac, state, BLOCK);
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    crc = ~crc;
+    while (length--)
+    {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+    return ~crc;
+}
+
+static int parseHex(const char *text, uint8_t *out, uint32_t length)
+{
+    if (strlen(text) != 2 * length)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+        unsigned value;
+        if (sscanf(text + 2 * i, "%2x", &value) != 1)
+        {
+            return 0;
+        }
+        out[i] = value;
+    }
+    return 1;
+}
+
+static int checkVector(const char *name, const uint8_t *result, const char *expected, uint32_t length)
+{
+    uint8_t reference[BLOCK];
+
+    parseHex(expected, reference, length);
+    int ok = memcmp(result, reference, length) == 0;
+    printf("%-10s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int selfTest(void)
+{
+    static const char *key = "8899aabbccddeeff0011223344556677fedcba98765432100123456789abcdef";
+    static const char *plain =
+        "1122334455667700ffeeddccbbaa9988" "00112233445566778899aabbcceeff0a"
+        "112233445566778899aabbcceeff0a00" "2233445566778899aabbcceeff0a0011";
+    uint8_t keyBytes[32], data[4 * BLOCK], block[BLOCK], mac[BLOCK];
+    kuzTypeDef kuz;
+    int ok = 1;
+
+    parseHex(key, keyBytes, sizeof(keyBytes));
+    parseHex(plain, data, sizeof(data));
+    kuzInit(&kuz, keyBytes);
+
+    /* ГОСТ Р 34.12-2015, пример А.1 */
+    memcpy(block, data, BLOCK);
+    kuzEncrypt(&kuz, block);
+    ok &= checkVector("encrypt", block, "7f679d90bebc24305a468d42b9d4edcd", BLOCK);
+
+    /* ГОСТ Р 34.13-2015, пример А.1.6, s = 64; заголовок - первый блок */
+    kuzMac(&kuz, data, BLOCK, data + BLOCK, 3 * BLOCK, mac);
+    ok &= checkVector("mac", mac, "336f4d296059fbe3", 8);
+
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        return selfTest();
+    }
+    if ((argc != 4) && (argc != 5))
+    {
+        fprintf(stderr, "usage: %s firmware.bin slot.bin version [key]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (in == NULL)
+    {
+        perror(argv[1]);
+        return 2;
+    }
+    uint8_t *slot = malloc(HAL_BOOT_HEADER_SIZE + IMAGE_MAX + BLOCK);
+    uint8_t *image = slot + HAL_BOOT_HEADER_SIZE;
+    uint32_t length = fread(image, 1, IMAGE_MAX + 1, in);
+    fclose(in);
+    if ((length == 0) || (length > IMAGE_MAX))
+    {
+        fprintf(stderr, "%s: empty or larger than %u bytes\n", argv[1], IMAGE_MAX);
+        return 2;
+    }
+    while (length % BLOCK)
+    {
+        image[length++] = 0xFF;
+    }
+
+    HAL_Boot_HeaderTypeDef header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = HAL_BOOT_MAGIC;
+    header.Version = strtoul(argv[3], NULL, 0);
+    header.Length = length;
+
+    if (argc == 5)
+    {
+        uint8_t key[32];
+        kuzTypeDef kuz;
+
+        if (!parseHex(argv[4], key, sizeof(key)))
+        {
+            fprintf(stderr, "key: 64 hex digits expected\n");
+            return 2;
+        }
+        kuzInit(&kuz, key);
+        header.Flags |= HAL_BOOT_FLAG_MAC;
+        kuzMac(&kuz, (const uint8_t *)&header, BLOCK, image, length, header.Mac);
+    }
+    header.Crc = crc32(crc32(0, (const uint8_t *)&header, BLOCK), image, length);
+
+    memset(slot, 0xFF, HAL_BOOT_HEADER_SIZE);
+    memcpy(slot, &header, sizeof(header));
+
+    FILE *out = fopen(argv[2], "wb");
+    if ((out == NULL) || (fwrite(slot, 1, HAL_BOOT_HEADER_SIZE + length, out) != HAL_BOOT_HEADER_SIZE + length))
+    {
+        perror(argv[2]);
+        return 2;
+    }
+    fclose(out);
+
+    printf("%s: version %u, %u bytes, crc %08X%s\n", argv[2], header.Version, length, header.Crc,
+           (header.Flags & HAL_BOOT_FLAG_MAC) ? ", mac" : "");
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*
+ * Модель NOR флеш-памяти для HAL_FTL (hal/utilities/Source/mik32_hal_ftl.c) на компьютере.
+ *
+ * Программирование только сбрасывает биты (И с записываемыми данными), стирание сектора
+ * записывает 0xFF. Логическая емкость - fill% от HAL_FTL_BLOCKS, все блоки сначала записываются
+ * один раз (в статистику не входит). Синтетическая нагрузка: доля hot% записей приходится на 10% логических
+ * блоков, остальные - на все блоки равновероятно. После каждой записи с вероятностью idle%
+ * вызывается HAL_FTL_Collect. Каждое значение проверяется чтением; при отключениях питания
+ * операция с флеш-памятью прерывается на случайном байте, после чего область монтируется
+ * заново, и каждый блок должен содержать последнюю записанную или (для прерванной записи)
+ * предыдущую версию.
+ *
+ * Выводятся коэффициент усиления записи (записанные слоты и байты программирования на байт
+ * данных пользователя) и счетчики стираний секторов.
+ *
+ * Сборка и запуск (из каталога rtt-default):
+ *     gcc -O2 -Ihal/utilities/Include -Ihal/peripherals/Include tools/ftl_sim.c hal/utilities/Source/mik32_hal_ftl.c -o ftl_sim
+ *     ./ftl_sim [секторов=64] [fill%=80] [записей=200000] [hot%=90] [idle%=50] [wear=16] [отключений=0] [seed=1]
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mik32_hal_ftl.h"
+
+#define SIM_MAX_SECTORS     1024
+#define SIM_PAGE_SIZE       256
+
+static uint8_t *flash;
+static uint32_t flashSize;
+static uint32_t eraseCounts[SIM_MAX_SECTORS];
+static uint64_t programBytes;
+
+/* Отключение питания: номер операции, на которой запись прерывается (0 - нет) */
+static uint32_t operations;
+static uint32_t powerLossAt;
+static jmp_buf powerLoss;
+
+static uint16_t map[HAL_FTL_BLOCKS(SIM_MAX_SECTORS)];
+static HAL_FTL_SectorTypeDef sectors[SIM_MAX_SECTORS];
+
+/* Ожидаемое содержимое: номер версии каждого блока (0 - не записывался) */
+static uint32_t *versions;
+
+
+static uint32_t simRandom(void)
+{
+    static uint64_t x = 88172645463325252ull;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return (uint32_t)(x >> 16);
+}
+
+static void simSeed(uint32_t seed)
+{
+    for (uint32_t i = 0; i < seed; i++)
+    {
+        simRandom();
+    }
+}
+
+static void simPowerCheck(void)
+{
+    if ((powerLossAt != 0) && (++operations == powerLossAt))
+    {
+        powerLossAt = 0;
+        longjmp(powerLoss, 1);
+    }
+}
+
+static HAL_StatusTypeDef simRead(void *context, uint32_t address, void *data, uint32_t length)
+{
+    (void)context;
+    if (address + length > flashSize)
+    {
+        return HAL_ERROR;
+    }
+    memcpy(data, flash + address, length);
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef simProgram(void *context, uint32_t address, const void *data, uint32_t length)
+{
+    const uint8_t *bytes = data;
+    uint32_t count = length;
+
+    (void)context;
+    if ((address + length > flashSize) || (address / SIM_PAGE_SIZE != (address + length - 1) / SIM_PAGE_SIZE))
+    {
+        fprintf(stderr, "program %08x+%u crosses a page\n", address, length);
+        exit(2);
+    }
+    if ((powerLossAt != 0) && (operations + 1 == powerLossAt))
+    {
+        count = simRandom() % (length + 1);
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        flash[address + i] &= bytes[i];
+    }
+    programBytes += length;
+    simPowerCheck();
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef simErase(void *context, uint32_t address)
+{
+    uint32_t count = HAL_FTL_SECTOR_SIZE;
+
+    (void)context;
+    if ((address % HAL_FTL_SECTOR_SIZE != 0) || (address >= flashSize))
+    {
+        return HAL_ERROR;
+    }
+    /* Прерванное стирание оставляет случайные данные в начале сектора */
+    if ((powerLossAt != 0) && (operations + 1 == powerLossAt))
+    {
+        count = simRandom() % HAL_FTL_SECTOR_SIZE;
+        for (uint32_t i = count; i < HAL_FTL_SECTOR_SIZE; i++)
+        {
+            flash[address + i] &= (uint8_t)simRandom();
+        }
+    }
+    memset(flash + address, 0xFF, count);
+    eraseCounts[address / HAL_FTL_SECTOR_SIZE]++;
+    simPowerCheck();
+    return HAL_OK;
+}
+
+static const HAL_FTL_FlashTypeDef simFlash = {
+    .Read = simRead,
+    .Program = simProgram,
+    .Erase = simErase,
+};
+
+
+static void simFill(uint8_t *data, uint32_t block, uint32_t version)
+{
+    for (uint32_t i = 0; i < HAL_FTL_BLOCK_SIZE; i++)
+    {
+        data[i] = (uint8_t)(block * 31 + version * 7 + i);
+    }
+}
+
+static int simCheck(HAL_FTL_TypeDef *ftl, uint32_t block, uint32_t version)
+{
+    uint8_t expected[HAL_FTL_BLOCK_SIZE];
+    uint8_t data[HAL_FTL_BLOCK_SIZE];
+
+    if (version == 0)
+    {
+        memset(expected, 0xFF, sizeof(expected));
+    }
+    else
+    {
+        simFill(expected, block, version);
+    }
+    return (HAL_FTL_Read(ftl, block, data) == HAL_OK) && (memcmp(data, expected, sizeof(data)) == 0);
+}
+
+static void simFail(const char *what, uint32_t write, uint32_t block)
+{
+    fprintf(stderr, "%s: write %u, block %u\n", what, write, block);
+    exit(1);
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32_t sectorCount = argc > 1 ? strtoul(argv[1], NULL, 0) : 64;
+    uint32_t fill = argc > 2 ? strtoul(argv[2], NULL, 0) : 80;
+    uint32_t writes = argc > 3 ? strtoul(argv[3], NULL, 0) : 200000;
+    uint32_t hot = argc > 4 ? strtoul(argv[4], NULL, 0) : 90;
+    uint32_t idle = argc > 5 ? strtoul(argv[5], NULL, 0) : 50;
+    uint32_t wear = argc > 6 ? strtoul(argv[6], NULL, 0) : 16;
+    uint32_t losses = argc > 7 ? strtoul(argv[7], NULL, 0) : 0;
+    uint32_t seed = argc > 8 ? strtoul(argv[8], NULL, 0) : 1;
+    HAL_FTL_TypeDef ftl;
+    uint8_t data[HAL_FTL_BLOCK_SIZE];
+
+    if ((sectorCount <= HAL_FTL_RESERVE) || (sectorCount > SIM_MAX_SECTORS) || (fill == 0) || (fill > 100))
+    {
+        fprintf(stderr, "sectors: %u..%u, fill: 1..100\n", HAL_FTL_RESERVE + 1, SIM_MAX_SECTORS);
+        return 2;
+    }
+    simSeed(seed);
+
+    flashSize = sectorCount * HAL_FTL_SECTOR_SIZE;
+    flash = malloc(flashSize);
+    memset(flash, 0xA5, flashSize);
+
+    HAL_FTL_Init(&ftl, &simFlash, NULL, 0, sectorCount, map, sectors);
+    ftl.BlockCount = ftl.BlockCount * fill / 100;
+    ftl.WearThreshold = wear;
+    if (HAL_FTL_Mount(&ftl) == HAL_OK)
+    {
+        simFail("mount of garbage succeeded", 0, 0);
+    }
+    if (HAL_FTL_Format(&ftl) != HAL_OK)
+    {
+        simFail("format", 0, 0);
+    }
+
+    /* Все блоки записываются один раз, статистика считается после этого */
+    uint32_t blocks = ftl.BlockCount;
+    versions = calloc(blocks, sizeof(versions[0]));
+    for (uint32_t i = 0; i < blocks; i++)
+    {
+        simFill(data, i, 1);
+        if (HAL_FTL_Write(&ftl, i, data) != HAL_OK)
+        {
+            simFail("prefill", 0, i);
+        }
+        versions[i] = 1;
+    }
+    ftl.HostWrites = 0;
+    ftl.FlashWrites = 0;
+    programBytes = 0;
+    memset(eraseCounts, 0, sizeof(eraseCounts));
+
+    uint32_t hotBlocks = blocks / 10 ? blocks / 10 : 1;
+    uint32_t lossEvery = losses ? writes / (losses + 1) : 0;
+    uint32_t mounts = 0;
+    uint64_t hostWrites = 0;
+    uint64_t flashWrites = 0;
+
+    for (uint32_t n = 0; n < writes; n++)
+    {
+        /* Не меняются после setjmp, volatile только для -Wclobbered */
+        volatile uint32_t block = (simRandom() % 100 < hot) ? simRandom() % hotBlocks : simRandom() % blocks;
+        uint32_t version = versions[block] + 1;
+
+        if ((lossEvery != 0) && (n % lossEvery == lossEvery - 1))
+        {
+            operations = 0;
+            powerLossAt = 1 + simRandom() % 20;
+        }
+
+        if (setjmp(powerLoss) != 0)
+        {
+            /* Питание пропало: статистика сохраняется, состояние восстанавливается монтированием */
+            hostWrites += ftl.HostWrites;
+            flashWrites += ftl.FlashWrites;
+            HAL_FTL_Init(&ftl, &simFlash, NULL, 0, sectorCount, map, sectors);
+            ftl.BlockCount = blocks;
+            ftl.WearThreshold = wear;
+            if (HAL_FTL_Mount(&ftl) != HAL_OK)
+            {
+                simFail("mount", n, block);
+            }
+            mounts++;
+
+            if (simCheck(&ftl, block, version))
+            {
+                versions[block] = version;
+            }
+            for (uint32_t i = 0; i < blocks; i++)
+            {
+                if (!simCheck(&ftl, i, versions[i]))
+                {
+                    simFail("lost data after power loss", n, i);
+                }
+            }
+            continue;
+        }
+
+        simFill(data, block, version);
+        if (HAL_FTL_Write(&ftl, block, data) != HAL_OK)
+        {
+            simFail("write", n, block);
+        }
+        versions[block] = version;
+        if (simRandom() % 100 < idle)
+        {
+            HAL_FTL_Collect(&ftl);
+        }
+        powerLossAt = 0;
+
+        if (!simCheck(&ftl, block, version))
+        {
+            simFail("read back", n, block);
+        }
+    }
+
+    for (uint32_t i = 0; i < blocks; i++)
+    {
+        if (!simCheck(&ftl, i, versions[i]))
+        {
+            simFail("final check", writes, i);
+        }
+    }
+    hostWrites += ftl.HostWrites;
+    flashWrites += ftl.FlashWrites;
+
+    uint32_t minErase = eraseCounts[0];
+    uint32_t maxErase = 0;
+    uint64_t totalErase = 0;
+    for (uint32_t i = 0; i < sectorCount; i++)
+    {
+        minErase = eraseCounts[i] < minErase ? eraseCounts[i] : minErase;
+        maxErase = eraseCounts[i] > maxErase ? eraseCounts[i] : maxErase;
+        totalErase += eraseCounts[i];
+    }
+
+    printf("sectors %u, blocks %u (%u KB), RAM %u B (map %u, sectors %u)\n", sectorCount, blocks,
+           blocks * HAL_FTL_BLOCK_SIZE / 1024, (uint32_t)(blocks * sizeof(map[0]) + sectorCount * sizeof(sectors[0]) + sizeof(ftl)),
+           (uint32_t)(blocks * sizeof(map[0])), (uint32_t)(sectorCount * sizeof(sectors[0])));
+    printf("writes %llu, fill %u%%, hot %u%% to %u blocks, idle collect %u%%, wear threshold %u, power losses %u\n",
+           (unsigned long long)hostWrites, fill, hot, hotBlocks, idle, wear, mounts);
+    printf("write amplification: slots %.3f, program bytes %.3f\n", (double)flashWrites / hostWrites,
+           (double)programBytes / ((double)hostWrites * HAL_FTL_BLOCK_SIZE));
+    printf("erases: total %llu, per 1000 writes %.2f, per sector min %u avg %.1f max %u\n", (unsigned long long)totalErase,
+           1000.0 * totalErase / hostWrites, minErase, (double)totalErase / sectorCount, maxErase);
+    printf("read-modify-write of 4 KB sectors would take %llu erases\n", (unsigned long long)hostWrites);
+    return 0;
+}
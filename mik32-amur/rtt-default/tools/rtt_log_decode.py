@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Декодер двоичного журнала RTT_LOG (RTT/rtt_log.h).
+
+Строки формата берутся из секции .rtt_log_fmt ELF-файла прошивки, строки для %s - из
+загружаемых секций того же файла. Поток записей читается из файла, stdin или TCP-сервера
+RTT (например, OpenOCD: "rtt server start 19022 1").
+
+Примеры:
+    rtt_log_decode.py build/rtt-default.elf --tcp localhost:19022
+    rtt_log_decode.py build/rtt-default.elf log.bin --freq 32000000
+"""
+
+import argparse
+import re
+import socket
+import struct
+import sys
+
+FMT_SECTION = ".rtt_log_fmt"
+ID_MASK = 0x00FFFFFF
+NARGS_POS = 24
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(\.(?:\*|\d+))?(hh|h|ll|l|z|j|t)?([diuxXocsp%])")
+
+
+class Elf:
+    """Минимальный разбор ELF32 little-endian: только таблица секций."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s: not an ELF32 little-endian file" % path)
+
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        headers = [struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize) for i in range(shnum)]
+        names = headers[shstrndx][4]
+
+        self.sections = []
+        for name, type_, flags, addr, offset, size, *_ in headers:
+            end = self.data.index(b"\0", names + name)
+            self.sections.append((self.data[names + name:end].decode(), type_, flags, addr, offset, size))
+
+    def section(self, name):
+        for s in self.sections:
+            if s[0] == name:
+                return s
+        return None
+
+    def string_at(self, address):
+        """Строка по адресу в памяти МК или None, если адрес вне загружаемых секций."""
+        for name, type_, flags, addr, offset, size in self.sections:
+            if (flags & SHF_ALLOC) and type_ != SHT_NOBITS and addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, offset + size)
+                return self.data[start:end if end >= 0 else offset + size].decode(errors="replace")
+        return None
+
+
+def load_formats(elf):
+    """Словарь {идентификатор: строка формата} из секции .rtt_log_fmt."""
+    section = elf.section(FMT_SECTION)
+    if section is None:
+        raise ValueError("section %s not found" % FMT_SECTION)
+    _, _, _, addr, offset, size = section
+    raw = elf.data[offset:offset + size]
+
+    formats = {}
+    pos = 0
+    while pos < size:
+        if raw[pos] == 0:
+            pos += 1
+            continue
+        end = raw.find(b"\0", pos)
+        end = size if end < 0 else end
+        formats[(addr + pos) & ID_MASK] = raw[pos:end].decode(errors="replace")
+        pos = end + 1
+    return formats
+
+
+def render(elf, fmt, args):
+    """Подстановка аргументов (32-р слов) в строку формата printf."""
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else 0
+
+    def replace(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if width == "*":
+            width = str(struct.unpack("<i", struct.pack("<I", take()))[0])
+        if precision == ".*":
+            precision = "." + str(take())
+        spec = "%" + flags + (width or "") + (precision or "")
+        value = take()
+
+        if conv in "di":
+            return (spec + "d") % struct.unpack("<i", struct.pack("<I", value))[0]
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "s":
+            text = elf.string_at(value)
+            return (spec + "s") % (text if text is not None else "<0x%08x>" % value)
+        if conv == "p":
+            return "0x%08x" % value
+        return (spec + conv.replace("u", "d")) % value
+
+    text = CONVERSION.sub(replace, fmt)
+    return text
+
+
+def chunks(args):
+    """Источник потока записей: блоки байт из TCP, файла или stdin."""
+    if args.tcp:
+        host, _, port = args.tcp.rpartition(":")
+        with socket.create_connection((host or "localhost", int(port))) as s:
+            while True:
+                data = s.recv(4096)
+                if not data:
+                    return
+                yield data
+    else:
+        stream = open(args.input, "rb") if args.input != "-" else sys.stdin.buffer
+        with stream:
+            while True:
+                data = stream.read(4096)
+                if not data:
+                    return
+                yield data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode RTT_LOG binary records against an ELF file.")
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("input", nargs="?", default="-", help="binary log file (default: stdin)")
+    parser.add_argument("--tcp", metavar="HOST:PORT", help="read from an RTT TCP server instead of a file")
+    parser.add_argument("--freq", type=float, default=0, help="timestamp clock, Hz (print microseconds)")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    formats = load_formats(elf)
+
+    buffer = b""
+    last = None
+    time = 0
+    for data in chunks(args):
+        buffer += data
+        while len(buffer) >= 8:
+            header, stamp = struct.unpack_from("<II", buffer)
+            nargs = header >> NARGS_POS
+            fmt = formats.get(header & ID_MASK)
+            if fmt is None or nargs > 8:
+                # Поток не синхронизирован: ищем следующий заголовок
+                print("<unknown record 0x%08x>" % header, file=sys.stderr)
+                buffer = buffer[4:]
+                continue
+            size = 8 + 4 * nargs
+            if len(buffer) < size:
+                break
+            values = struct.unpack_from("<%dI" % nargs, buffer, 8)
+            buffer = buffer[size:]
+
+            # Метка времени 32-р: восстанавливаем 64-р время по разности соседних записей
+            if last is not None:
+                delta = (stamp - last) & 0xFFFFFFFF
+                time += delta - (1 << 32) if delta & 0x80000000 else delta
+            last = stamp
+
+            text = render(elf, fmt, values).rstrip("\n")
+            if args.freq:
+                print("[%14.3f us] %s" % (time * 1e6 / args.freq, text))
+            else:
+                print("[%12d] %s" % (time, text))
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,241 @@
+/*
+ * Проверка разбора SFDP (hal/utilities/Source/mik32_hal_sfdp.c) на компьютере.
+ *
+ * Без аргументов разбираются встроенные образы SFDP и сравниваются с ожидаемыми параметрами:
+ * W25Q128FV (JESD216B, 16 слов, QPI) и Macronix MX25L32 (JESD216 ревизии 1.0, 9 слов),
+ * а также их варианты с измененными полями (нет 4-4-4, нечетное число тактов, неверный
+ * признак, только 4-байтовые адреса). Образы набраны вручную по таблицам SFDP из документации
+ * на микросхемы, а не прочитаны с устройств; образ с платы проверяется аргументом.
+ *
+ * С аргументом разбирается файл с образом SFDP, например снятый в Linux из
+ * /sys/bus/spi/devices/spiX.Y/spi-nor/sfdp или программатором, и выводятся параметры.
+ *
+ * Сборка и запуск (из каталога rtt-default):
+ *     gcc -O2 -Ihal/utilities/Include -Ihal/peripherals/Include tools/sfdp_check.c hal/utilities/Source/mik32_hal_sfdp.c -o sfdp_check
+ *     ./sfdp_check [файл]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mik32_hal_sfdp.h"
+
+#define CHECK_SFDP_MAX      512
+
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t size;
+} checkImageTypeDef;
+
+/* W25Q128FV: по таблице SFDP документации Winbond, не снят с микросхемы */
+static const uint8_t w25q128fv[] = {
+    0x53, 0x46, 0x44, 0x50, 0x05, 0x01, 0x00, 0xFF, 0x00, 0x05, 0x01, 0x10, 0x80, 0x00, 0x00, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xE5, 0x20, 0xF9, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x44, 0xEB, 0x08, 0x6B, 0x08, 0x3B, 0x42, 0xBB,
+    0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0x40, 0xEB, 0x0C, 0x20, 0x0F, 0x52,
+    0x10, 0xD8, 0x00, 0x00, 0x36, 0x02, 0xA6, 0x00, 0x82, 0xEA, 0x14, 0xC9, 0xE9, 0x63, 0x76, 0x33,
+    0x7A, 0x75, 0x7A, 0x75, 0xF7, 0xA2, 0xD5, 0x5C, 0x19, 0xF7, 0x4D, 0xFF, 0xE9, 0x30, 0xF8, 0x80,
+};
+
+/* MX25L32: по таблице SFDP документации Macronix, не снят с микросхемы */
+static const uint8_t mx25l32[] = {
+    0x53, 0x46, 0x44, 0x50, 0x00, 0x01, 0x01, 0xFF, 0x00, 0x00, 0x01, 0x09, 0x30, 0x00, 0x00, 0xFF,
+    0xC2, 0x00, 0x01, 0x04, 0x60, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xE5, 0x20, 0xF1, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x44, 0xEB, 0x08, 0x6B, 0x08, 0x3B, 0x04, 0xBB,
+    0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x44, 0xEB, 0x0C, 0x20, 0x0F, 0x52,
+    0x10, 0xD8, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x36, 0x00, 0x27, 0xF4, 0x4F, 0xFF, 0xFF, 0xD9, 0xC8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/*
+ * Ожидаемый результат; patch - замена байта образа, quadEnable != 0 - значение поля после
+ * разбора, qer != 0 - ожидаемый способ установки QE из DWORD15.
+ */
+typedef struct
+{
+    const char *name;
+    const uint8_t *image;
+    uint32_t size;
+    uint32_t patchOffset;
+    uint8_t patchValue;
+    uint8_t quadEnable;
+    HAL_SFDP_ReadModeTypeDef maxMode;
+
+    HAL_StatusTypeDef status;
+    uint32_t flashSize;
+    uint8_t mode;
+    uint8_t opcode;
+    int interim;
+    uint8_t erase4k;
+    uint8_t erase64k;
+    uint8_t qer;
+} checkCaseTypeDef;
+
+#define CHECK_NO_PATCH  0xFFFFFFFF
+
+static const checkCaseTypeDef checkCases[] = {
+    { "w25q128fv",              w25q128fv, sizeof(w25q128fv), CHECK_NO_PATCH, 0, 0, SFDP_READ_4_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_4_4_4, 0xEB, 1, 0x20, 0xD8, SFDP_QE_SR2_BIT1 },
+    /* DWORD15 биты 22:20 = 5: QE в SR2, запись 0x01 двумя байтами */
+    { "w25q128fv qer 5",        w25q128fv, sizeof(w25q128fv), 0xBA, 0x5D, 0, SFDP_READ_4_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_4_4_4, 0xEB, 1, 0x20, 0xD8, SFDP_QE_SR2_BIT1_35H },
+    /* DWORD15 биты 22:20 = 6: QE в SR2, запись 0x31 */
+    { "w25q128fv qer 6",        w25q128fv, sizeof(w25q128fv), 0xBA, 0x6D, 0, SFDP_READ_4_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_4_4_4, 0xEB, 1, 0x20, 0xD8, SFDP_QE_SR2_BIT1_31H },
+    /* DWORD15 биты 22:20 = 7: зарезервировано, четырехпроводные команды не выбираются */
+    { "w25q128fv qer 7",        w25q128fv, sizeof(w25q128fv), 0xBA, 0x7D, 0, SFDP_READ_4_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_1_1_1, 0x0B, 1, 0x20, 0xD8, SFDP_QE_UNKNOWN },
+    { "w25q128fv max 1-4-4",    w25q128fv, sizeof(w25q128fv), CHECK_NO_PATCH, 0, 0, SFDP_READ_1_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_1_4_4, 0xEB, 3, 0x20, 0xD8, 0 },
+    { "w25q128fv max 1-1-4",    w25q128fv, sizeof(w25q128fv), CHECK_NO_PATCH, 0, 0, SFDP_READ_1_1_4,
+      HAL_OK, 16 << 20, SFDP_READ_1_1_4, 0x6B, 1, 0x20, 0xD8, 0 },
+    /* DWORD5 бит 4: 4-4-4 не поддерживается */
+    { "w25q128fv no qpi",       w25q128fv, sizeof(w25q128fv), 0x90, 0xEE, 0, SFDP_READ_4_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_1_4_4, 0xEB, 3, 0x20, 0xD8, 0 },
+    /* 1-4-4: 5 холостых тактов и 2 такта режима не составляют целого числа байт */
+    { "w25q128fv odd 1-4-4",    w25q128fv, sizeof(w25q128fv), 0x88, 0x45, 0, SFDP_READ_1_4_4,
+      HAL_OK, 16 << 20, SFDP_READ_1_1_4, 0x6B, 1, 0x20, 0xD8, 0 },
+    /* DWORD1 биты 18:17 = 2: только 4-байтовые адреса */
+    { "w25q128fv 4-byte only",  w25q128fv, sizeof(w25q128fv), 0x82, 0xFD, 0, SFDP_READ_4_4_4,
+      HAL_ERROR, 0, 0, 0, 0, 0, 0, 0 },
+    { "bad signature",          w25q128fv, sizeof(w25q128fv), 0x00, 0x00, 0, SFDP_READ_4_4_4,
+      HAL_ERROR, 0, 0, 0, 0, 0, 0, 0 },
+    /* Ревизия 1.0: способ установки QE неизвестен, выбирается Fast Read */
+    { "mx25l32",                mx25l32, sizeof(mx25l32), CHECK_NO_PATCH, 0, 0, SFDP_READ_4_4_4,
+      HAL_OK, 4 << 20, SFDP_READ_1_1_1, 0x0B, 1, 0x20, 0xD8, 0 },
+    /* QE в SR1 бит 6 задан пользователем; команды QPI в ревизии 1.0 неизвестны */
+    { "mx25l32 qe sr1 bit6",    mx25l32, sizeof(mx25l32), CHECK_NO_PATCH, 0, SFDP_QE_SR1_BIT6, SFDP_READ_4_4_4,
+      HAL_OK, 4 << 20, SFDP_READ_1_4_4, 0xEB, 3, 0x20, 0xD8, 0 },
+};
+
+
+static HAL_StatusTypeDef checkRead(void *context, uint32_t address, void *data, uint32_t length)
+{
+    const checkImageTypeDef *image = context;
+
+    /* Адреса за пределами образа читаются как стертая память */
+    memset(data, 0xFF, length);
+    if (address < image->size)
+    {
+        memcpy(data, image->data + address, address + length > image->size ? image->size - address : length);
+    }
+    return HAL_OK;
+}
+
+static void checkPrint(const HAL_SFDP_TypeDef *sfdp)
+{
+    static const char * const modes[] = { "1-1-1", "1-1-4", "1-4-4", "4-4-4" };
+
+    printf("    BFPT %u.%u, %u dwords, size %u KB, page %u B, QE method %u\n", sfdp->Major, sfdp->Minor, sfdp->Dwords,
+           sfdp->Size / 1024, sfdp->PageSize, sfdp->QuadEnable);
+    for (uint32_t mode = SFDP_READ_1_1_1; mode <= SFDP_READ_4_4_4; mode++)
+    {
+        if (sfdp->Read[mode].Opcode != 0)
+        {
+            printf("    read %s: opcode %02X, %u dummy clocks (%u mode), interim %d B\n", modes[mode], sfdp->Read[mode].Opcode,
+                   sfdp->Read[mode].Dummy, sfdp->Read[mode].ModeClocks, HAL_SFDP_InterimLength(sfdp, mode));
+        }
+    }
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (sfdp->Erase[i].SizeShift != 0)
+        {
+            printf("    erase %u KB: opcode %02X\n", (1u << sfdp->Erase[i].SizeShift) / 1024, sfdp->Erase[i].Opcode);
+        }
+    }
+    printf("    QPI enter %02X exit %02X, suspend %02X resume %02X, selected %s\n", sfdp->QpiEnterOpcode, sfdp->QpiExitOpcode,
+           sfdp->SuspendOpcode, sfdp->ResumeOpcode, modes[HAL_SFDP_SelectRead(sfdp, SFDP_READ_4_4_4)]);
+}
+
+static int checkCase(const checkCaseTypeDef *test)
+{
+    uint8_t data[CHECK_SFDP_MAX];
+    checkImageTypeDef image = { data, test->size };
+    HAL_SFDP_TypeDef sfdp;
+
+    memcpy(data, test->image, test->size);
+    if (test->patchOffset != CHECK_NO_PATCH)
+    {
+        data[test->patchOffset] = test->patchValue;
+    }
+
+    HAL_StatusTypeDef status = HAL_SFDP_Parse(&sfdp, checkRead, &image);
+    if (status != test->status)
+    {
+        printf("FAIL %s: status %d, expected %d\n", test->name, status, test->status);
+        return 0;
+    }
+    if (status != HAL_OK)
+    {
+        printf("ok   %s: rejected\n", test->name);
+        return 1;
+    }
+    if ((test->qer != 0) && (sfdp.QuadEnable != test->qer))
+    {
+        printf("FAIL %s: QE method %u, expected %u\n", test->name, sfdp.QuadEnable, test->qer);
+        return 0;
+    }
+    if (test->quadEnable != 0)
+    {
+        sfdp.QuadEnable = test->quadEnable;
+    }
+
+    HAL_SFDP_ReadModeTypeDef mode = HAL_SFDP_SelectRead(&sfdp, test->maxMode);
+    int ok = (sfdp.Size == test->flashSize) && (sfdp.PageSize == 256) && (mode == test->mode) &&
+             (sfdp.Read[mode].Opcode == test->opcode) && (HAL_SFDP_InterimLength(&sfdp, mode) == test->interim) &&
+             (sfdp.Erase[0].SizeShift == 12) && (sfdp.Erase[0].Opcode == test->erase4k) &&
+             (sfdp.Erase[2].SizeShift == 16) && (sfdp.Erase[2].Opcode == test->erase64k);
+
+    printf("%s %s: mode %d, opcode %02X, interim %d\n", ok ? "ok  " : "FAIL", test->name, mode, sfdp.Read[mode].Opcode,
+           HAL_SFDP_InterimLength(&sfdp, mode));
+    if (!ok)
+    {
+        checkPrint(&sfdp);
+    }
+    return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        static uint8_t data[CHECK_SFDP_MAX];
+        FILE *file = fopen(argv[1], "rb");
+        HAL_SFDP_TypeDef sfdp;
+
+        if (file == NULL)
+        {
+            perror(argv[1]);
+            return 2;
+        }
+        checkImageTypeDef image = { data, (uint32_t)fread(data, 1, sizeof(data), file) };
+        fclose(file);
+
+        if (HAL_SFDP_Parse(&sfdp, checkRead, &image) != HAL_OK)
+        {
+            printf("%s: no valid SFDP\n", argv[1]);
+            return 1;
+        }
+        printf("%s:\n", argv[1]);
+        checkPrint(&sfdp);
+        return 0;
+    }
+
+    uint32_t failed = 0;
+    for (uint32_t i = 0; i < sizeof(checkCases) / sizeof(checkCases[0]); i++)
+    {
+        failed += !checkCase(&checkCases[i]);
+    }
+    printf("%u of %u failed\n", failed, (uint32_t)(sizeof(checkCases) / sizeof(checkCases[0])));
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,398 @@
+/*
+ * Модель таймера ядра SCR1 для HAL_SWTimer (hal/core/Source/mik32_hal_swtimer.c) на компьютере.
+ *
+ * Счетчик MTIME продвигается случайными шагами, а при достижении MTIMECMP вызывается
+ * HAL_SWTimer_IRQHandler. Между шагами таймеры запускаются со случайными сроками (от нуля до
+ * сроков за пределами колеса, то есть с повторным переносом), останавливаются и перезапускаются,
+ * в том числе из функции обратного вызова. Часть таймеров запускается парами с одним сроком, и
+ * функция обратного вызова останавливает таймер той же ячейки, еще не сработавший на этом тике.
+ * Каждое срабатывание проверяется: не раньше срока и
+ * не позже следующего тика колеса; однократный таймер срабатывает один раз, остановленный -
+ * ни разу. Счет начинается перед переходом MTIME через 2^32 и перед переносом верхнего уровня
+ * колеса, поэтому проверяются чтение MTIMEH/MTIME и переход индексов ячеек через 0.
+ *
+ * Сборка и запуск (из каталога rtt-default):
+ *     gcc -O2 -Ihal/core/Include -Ihal/peripherals/Include tools/swtimer_sim.c hal/peripherals/Source/mik32_hal_timebase.c -o swtimer_sim
+ *     ./swtimer_sim [таймеров=64] [шагов=2000000] [TickShift=4] [seed=1]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+ * Заголовки таймера ядра, EPIC и HAL заменяются моделью: их защитные макросы определяются
+ * заранее, а исходный текст колеса включается целиком.
+ */
+#define MIK32_HAL_SCR1_TIMER
+#define MIK32_HAL_IRQ
+#define MIK32_HAL
+
+#define MIK32_RAMFUNC
+#define OSC_CLOCK_VALUE                 32768
+#define SIM_SYS_CLOCK                   32000000UL
+
+#define SCR1_TIMER_CLKSRC_INTERNAL      0
+#define SCR1_TIMER_CLKSRC_EXTERNAL_RTC  1
+#define SCR1_TIMER_CTRL_ENABLE_M        (1 << 0)
+
+#define MIE_MTIE                        (1 << 7)
+#define set_csr(reg, bit)               ((void)(bit))
+
+typedef struct
+{
+    uint32_t TIMER_CTRL;
+    uint32_t TIMER_DIV;
+    uint32_t MTIME;
+    uint32_t MTIMEH;
+    uint32_t MTIMECMP;
+    uint32_t MTIMECMPH;
+} SCR1_TIMER_TypeDef;
+
+typedef struct
+{
+    SCR1_TIMER_TypeDef *Instance;
+    uint8_t ClockSource;
+    uint16_t Divider;
+} SCR1_TIMER_HandleTypeDef;
+
+static struct
+{
+    uint32_t DIV_AHB;
+} simPm;
+#define PM (&simPm)
+
+static inline uint32_t HAL_PCC_GetSysClockFreq(void)
+{
+    return SIM_SYS_CLOCK;
+}
+
+static inline void HAL_SCR1_Timer_Init(SCR1_TIMER_HandleTypeDef *hscr1_timer)
+{
+    hscr1_timer->Instance->TIMER_CTRL = 0;
+}
+
+static inline void HAL_SCR1_Timer_Enable(SCR1_TIMER_HandleTypeDef *hscr1_timer)
+{
+    hscr1_timer->Instance->TIMER_CTRL |= SCR1_TIMER_CTRL_ENABLE_M;
+}
+
+static inline uint32_t HAL_IRQ_SaveDisable(void)
+{
+    return 0;
+}
+
+static inline void HAL_IRQ_Restore(uint32_t State)
+{
+    (void)State;
+}
+
+static inline uint32_t HAL_IRQ_Ctz(uint32_t Value)
+{
+    return __builtin_ctz(Value);
+}
+
+#include "../hal/core/Source/mik32_hal_swtimer.c"
+
+
+#define SIM_MAX_TIMERS      256
+
+static SCR1_TIMER_TypeDef simTimer;
+
+/* Ожидаемое состояние каждого таймера */
+static struct
+{
+    HAL_SWTimer_TypeDef timer;
+    int active;
+    uint64_t deadline;                  /* Срок в тиках таймера ядра */
+    uint32_t periodUs;
+    uint32_t restartUs;                 /* Перезапуск из функции обратного вызова, 0 - нет */
+} sims[SIM_MAX_TIMERS];
+
+static uint32_t timerCount;
+static uint64_t fired;
+static uint64_t maxLate;
+static uint64_t farTimers;
+static uint64_t siblingStops;
+static uint32_t shift;
+
+
+static uint32_t simRandom(void)
+{
+    static uint64_t x = 88172645463325252ull;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return (uint32_t)(x >> 16);
+}
+
+static void simSeed(uint32_t seed)
+{
+    for (uint32_t i = 0; i < seed; i++)
+    {
+        simRandom();
+    }
+}
+
+static uint64_t simNow(void)
+{
+    return ((uint64_t)simTimer.MTIMEH << 32) | simTimer.MTIME;
+}
+
+static void simSetNow(uint64_t now)
+{
+    simTimer.MTIMEH = (uint32_t)(now >> 32);
+    simTimer.MTIME = (uint32_t)now;
+}
+
+static uint64_t simCompare(void)
+{
+    return ((uint64_t)simTimer.MTIMECMPH << 32) | simTimer.MTIMECMP;
+}
+
+static void simFail(const char *what, uint32_t index)
+{
+    fprintf(stderr, "%s: timer %u, mtime %016llx, deadline %016llx\n", what, index,
+            (unsigned long long)simNow(), (unsigned long long)sims[index].deadline);
+    exit(1);
+}
+
+/**
+ * Случайный срок в микросекундах: до одного тика колеса, в пределах каждого уровня и за пределами колеса.
+ */
+static uint32_t simTimeout(void)
+{
+    switch (simRandom() % 8)
+    {
+    case 0:
+        return simRandom() % 4;
+    case 1:
+        return simRandom() % 100;
+    case 2:
+        return simRandom() % 10000;
+    case 3:
+        return simRandom() % 1000000;
+    case 4:
+        return simRandom() % 100000000;
+    case 5:
+        farTimers++;
+        return simRandom();
+    default:
+        return simRandom() % 2000;
+    }
+}
+
+static void simStart(uint32_t index, uint32_t timeoutUs, uint32_t periodUs)
+{
+    HAL_SWTimer_Start(&sims[index].timer, timeoutUs, periodUs);
+    sims[index].active = 1;
+    sims[index].deadline = simNow() + HAL_SWTimer_UsToTicks(timeoutUs);
+    sims[index].periodUs = periodUs;
+}
+
+static void simCallback(HAL_SWTimer_TypeDef *timer)
+{
+    uint32_t index = (uint32_t)(uintptr_t)timer->Context;
+    uint64_t now = simNow();
+
+    if (!sims[index].active)
+    {
+        simFail("stopped timer fired", index);
+    }
+    if (now < sims[index].deadline)
+    {
+        simFail("fired early", index);
+    }
+    if (now - sims[index].deadline > (1ULL << shift))
+    {
+        simFail("fired late", index);
+    }
+    if (now - sims[index].deadline > maxLate)
+    {
+        maxLate = now - sims[index].deadline;
+    }
+    fired++;
+
+    if (sims[index].periodUs)
+    {
+        sims[index].deadline += (uint32_t)HAL_SWTimer_UsToTicks(sims[index].periodUs);
+    }
+    else
+    {
+        sims[index].active = 0;
+    }
+    if (HAL_SWTimer_IsActive(timer) != sims[index].active)
+    {
+        simFail("wrong active state", index);
+    }
+
+    /* Остановить таймер той же ячейки, ожидающий срабатывания на этом тике колеса */
+    if (simRandom() % 4 == 0)
+    {
+        uint64_t tick = now >> shift;
+        for (uint32_t i = 0; i < timerCount; i++)
+        {
+            if ((i != index) && sims[i].active &&
+                (((sims[i].deadline + (1ULL << shift) - 1) >> shift) <= tick))
+            {
+                HAL_SWTimer_Stop(&sims[i].timer);
+                sims[i].active = 0;
+                sims[i].restartUs = 0;
+                siblingStops++;
+                break;
+            }
+        }
+    }
+
+    if (sims[index].restartUs)
+    {
+        simStart(index, sims[index].restartUs, 0);
+        sims[index].restartUs = 0;
+    }
+}
+
+/**
+ * Продвинуть MTIME на step тиков, вызывая обработчик прерывания при каждом достижении MTIMECMP.
+ */
+static void simAdvance(uint64_t step)
+{
+    uint64_t end = simNow() + step;
+
+    while (simCompare() <= end)
+    {
+        if (simCompare() > simNow())
+        {
+            simSetNow(simCompare());
+        }
+        HAL_SWTimer_IRQHandler();
+    }
+    simSetNow(end);
+}
+
+/**
+ * Проверить, что ни один запущенный таймер не просрочен.
+ */
+static void simCheckPending(void)
+{
+    for (uint32_t i = 0; i < timerCount; i++)
+    {
+        if (sims[i].active && (simNow() > sims[i].deadline + (1ULL << shift)))
+        {
+            simFail("missed", i);
+        }
+    }
+}
+
+static void simRun(uint64_t start, uint32_t steps)
+{
+    SCR1_TIMER_HandleTypeDef hscr1_timer = {
+        .Instance = &simTimer,
+        .ClockSource = SCR1_TIMER_CLKSRC_INTERNAL,
+        .Divider = 0,
+    };
+
+    uint32_t minPeriodUs = (uint32_t)((1ULL << shift) * 1000000 / SIM_SYS_CLOCK) + 1;
+
+    simTimer.TIMER_CTRL = 0;
+    simSetNow(start);
+    HAL_SWTimer_Init(&hscr1_timer, shift);
+    for (uint32_t i = 0; i < timerCount; i++)
+    {
+        sims[i].timer.Callback = simCallback;
+        sims[i].timer.Context = (void *)(uintptr_t)i;
+        sims[i].timer.PPrev = 0;
+        sims[i].active = 0;
+        sims[i].restartUs = 0;
+    }
+
+    for (uint32_t n = 0; n < steps; n++)
+    {
+        uint32_t index = simRandom() % timerCount;
+        uint32_t action = simRandom() % 16;
+
+        if (action < 6)
+        {
+            /* Период не короче тика колеса: чаще одного раза за тик таймер не срабатывает */
+            uint32_t periodUs = (simRandom() % 4 == 0) ? minPeriodUs + simRandom() % 5000 : 0;
+            uint32_t timeoutUs = simTimeout();
+            simStart(index, timeoutUs, periodUs);
+
+            /* Второй таймер с тем же сроком попадает в ту же ячейку */
+            if (simRandom() % 4 == 0)
+            {
+                uint32_t sibling = simRandom() % timerCount;
+                if (sibling != index)
+                {
+                    simStart(sibling, timeoutUs, (simRandom() % 2) ? minPeriodUs + simRandom() % 5000 : 0);
+                }
+            }
+        }
+        else if (action < 8)
+        {
+            HAL_SWTimer_Stop(&sims[index].timer);
+            sims[index].active = 0;
+            sims[index].restartUs = 0;
+        }
+        else if (action < 9)
+        {
+            sims[index].restartUs = 1 + simRandom() % 3000;
+        }
+
+        /*
+         * Шаг - от доли тика колеса до 2^12 тиков. Изредка - простой до 2^38 тиков таймера ядра,
+         * дольше наибольшего срока: периодические таймеры перед ним останавливаются.
+         */
+        uint64_t step = simRandom() % (1ULL << shift << (simRandom() % 13));
+        if (simRandom() % 64 == 0)
+        {
+            for (uint32_t i = 0; i < timerCount; i++)
+            {
+                if (sims[i].periodUs)
+                {
+                    HAL_SWTimer_Stop(&sims[i].timer);
+                    sims[i].active = 0;
+                }
+            }
+            step = (uint64_t)simRandom() << (simRandom() % 7);
+        }
+        simAdvance(step);
+        simCheckPending();
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    timerCount = argc > 1 ? strtoul(argv[1], NULL, 0) : 64;
+    uint32_t steps = argc > 2 ? strtoul(argv[2], NULL, 0) : 2000000;
+    shift = argc > 3 ? strtoul(argv[3], NULL, 0) : 4;
+    uint32_t seed = argc > 4 ? strtoul(argv[4], NULL, 0) : 1;
+
+    if ((timerCount == 0) || (timerCount > SIM_MAX_TIMERS) || (shift > 24))
+    {
+        fprintf(stderr, "timers: 1..%u, TickShift: 0..24\n", SIM_MAX_TIMERS);
+        return 2;
+    }
+    simSeed(seed);
+
+    /* Начало счета: перед переходом MTIME через 2^32 и перед переносом с верхнего уровня колеса */
+    uint64_t range = 1ULL << (HAL_SWTIMER_WHEEL_BITS * HAL_SWTIMER_WHEEL_LEVELS + shift);
+    const uint64_t starts[] = {
+        0,
+        0x100000000ULL - 1000,
+        4 * range - 3,
+        0x00FFFFFFFFF00000ULL,
+    };
+
+    for (uint32_t i = 0; i < sizeof(starts) / sizeof(starts[0]); i++)
+    {
+        simRun(starts[i], steps / 4);
+        printf("start %016llx: end %016llx\n", (unsigned long long)starts[i], (unsigned long long)simNow());
+    }
+
+    printf("timers %u, steps %u, tick 2^%u, fired %llu, beyond wheel %llu, sibling stops %llu, max late %llu ticks\n",
+           timerCount, steps, shift, (unsigned long long)fired, (unsigned long long)farTimers,
+           (unsigned long long)siblingStops, (unsigned long long)maxLate);
+    return 0;
+}
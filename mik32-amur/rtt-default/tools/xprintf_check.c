@@ -0,0 +1,357 @@
+/*
+ * Проверка форматирования целых чисел xprintf (shared/libs/xprintf.c) на компьютере.
+ *
+ * Вывод xsprintf, xfprintf (посимвольная функция вывода) и xprintf (блочный вывод
+ * xfunc_output_block) сравнивается с snprintf glibc. Проверяются граничные значения (0, +-1,
+ * степени 2 и 10 и соседние с ними, INT_MIN, UINT_MAX) и случайные значения случайной
+ * разрядности для %d, %u, %x, %X, %o, %c и %s с флагами '0' и '-', шириной из формата и из
+ * аргумента '*', в том числе отрицательной, и шириной больше блока вывода. С XF_USE_LLI=1
+ * дополнительно проверяются 64-разрядные значения с префиксами l и ll. Точность для целых
+ * чисел xprintf не поддерживает и не проверяется. В конце измеряется время вызова xsprintf
+ * и snprintf на смешанном формате.
+ *
+ * Сборка и запуск (из каталога rtt-default):
+ *     gcc -O2 -Ishared/libs tools/xprintf_check.c shared/libs/xprintf.c -o xprintf_check
+ *     gcc -O2 -Ishared/libs -DXF_USE_LLI=1 tools/xprintf_check.c shared/libs/xprintf.c -o xprintf_check_lli
+ *     ./xprintf_check [случайных=1000000] [повторов времени=1000000] [seed=1]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include "xprintf.h"
+
+#define CHECK_BUFFER        256
+
+static char checkRef[CHECK_BUFFER];
+static char checkOut[CHECK_BUFFER];
+static char checkChars[CHECK_BUFFER];
+static char checkBlocks[CHECK_BUFFER];
+static int checkCharCount;
+static int checkBlockCount;
+static uint64_t checkCount;
+
+/* Устройство xprintf по умолчанию: посимвольный вывод не используется, блоки собираются */
+void xfunc_output(int chr)
+{
+    (void)chr;
+}
+
+void xfunc_output_block(const char *buff, int len)
+{
+    if (checkBlockCount + len < CHECK_BUFFER)
+    {
+        memcpy(checkBlocks + checkBlockCount, buff, len);
+    }
+    checkBlockCount += len;
+}
+
+static void checkPutChar(int chr)
+{
+    if (checkCharCount + 1 < CHECK_BUFFER)
+    {
+        checkChars[checkCharCount] = (char)chr;
+    }
+    checkCharCount++;
+}
+
+
+static uint32_t checkRandom(void)
+{
+    static uint64_t x = 88172645463325252ull;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return (uint32_t)(x >> 16);
+}
+
+static void checkSeed(uint32_t seed)
+{
+    for (uint32_t i = 0; i < seed; i++)
+    {
+        checkRandom();
+    }
+}
+
+static uint64_t checkRandom64(void)
+{
+    return ((uint64_t)checkRandom() << 32) | checkRandom();
+}
+
+/**
+ * Случайное значение случайной разрядности: короткие числа встречаются так же часто, как длинные.
+ */
+static uint64_t checkValue(void)
+{
+    uint32_t bits = 1 + checkRandom() % 64;
+
+    return checkRandom64() >> (64 - bits);
+}
+
+static void checkFail(const char *what, const char *fmt, const char *out)
+{
+    fprintf(stderr, "%s: format \"%s\": expected \"%s\", got \"%s\"\n", what, fmt, checkRef, out);
+    exit(1);
+}
+
+/*
+ * Вывести fmt тремя способами xprintf и snprintf и сравнить. Макрос, а не функция: xprintf
+ * не имеет варианта с va_list. Аргументы вычисляются четыре раза и не должны иметь побочных
+ * эффектов.
+ */
+#define CHECK(fmt, ...)                                                                         \
+    do                                                                                          \
+    {                                                                                           \
+        snprintf(checkRef, sizeof(checkRef), fmt, __VA_ARGS__);                                 \
+        xsprintf(checkOut, fmt, __VA_ARGS__);                                                   \
+        if (strcmp(checkRef, checkOut) != 0)                                                    \
+        {                                                                                       \
+            checkFail("xsprintf", fmt, checkOut);                                               \
+        }                                                                                       \
+        checkCharCount = 0;                                                                     \
+        xfprintf(checkPutChar, fmt, __VA_ARGS__);                                               \
+        checkChars[checkCharCount] = 0;                                                         \
+        if (strcmp(checkRef, checkChars) != 0)                                                  \
+        {                                                                                       \
+            checkFail("xfprintf", fmt, checkChars);                                             \
+        }                                                                                       \
+        checkBlockCount = 0;                                                                    \
+        xprintf(fmt, __VA_ARGS__);                                                              \
+        checkBlocks[checkBlockCount] = 0;                                                       \
+        if (strcmp(checkRef, checkBlocks) != 0)                                                 \
+        {                                                                                       \
+            checkFail("xprintf", fmt, checkBlocks);                                             \
+        }                                                                                       \
+        checkCount++;                                                                           \
+    } while (0)
+
+/**
+ * Случайный формат одного преобразования: "<текст>%[флаг][ширина][размер]<тип><текст>".
+ * Ширина '*' записывается в *star (-1 - ширина в формате или не задана).
+ */
+static void checkFormat(char *fmt, char type, const char *size, int *star)
+{
+    static const char *const flags[] = { "", "", "0", "-" };
+    const char *flag = flags[checkRandom() % 4];
+    char width[8] = "";
+
+    *star = -1;
+    if ((type == 'c') || (type == 's'))
+    {
+        /* Флаг '0' для %c и %s в C не определен */
+        flag = (checkRandom() % 2) ? "-" : "";
+    }
+
+    switch (checkRandom() % 4)
+    {
+    case 0:
+        break;
+    case 1:
+        snprintf(width, sizeof(width), "%u", 1 + checkRandom() % 24);
+        break;
+    case 2:
+        /* Шире блока вывода xprintf (32 байта) */
+        snprintf(width, sizeof(width), "%u", 30 + checkRandom() % 60);
+        break;
+    default:
+        strcpy(width, "*");
+        *star = checkRandom() % 40;
+        break;
+    }
+
+    snprintf(fmt, 32, "%s%%%s%s%s%c%s", (checkRandom() % 2) ? "v=" : "", flag, width, size, type,
+             (checkRandom() % 2) ? "\n" : "");
+}
+
+/**
+ * Граничные значения: 0, степени 2 и 10 и соседние с ними (с обоими знаками).
+ */
+static uint32_t checkEdges(uint64_t *values)
+{
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        uint64_t v = 1ULL << i;
+        values[n++] = v - 1;
+        values[n++] = v;
+        values[n++] = v + 1;
+    }
+    for (uint64_t v = 10; v <= 10000000000000000000ULL; v *= 10)
+    {
+        values[n++] = v - 1;
+        values[n++] = v;
+        values[n++] = v + 1;
+        if (v > UINT64_MAX / 10)
+        {
+            break;
+        }
+    }
+    values[n++] = UINT64_MAX;
+    for (uint32_t i = 0, count = n; i < count; i++)
+    {
+        values[n++] = 0 - values[i];
+    }
+    return n;
+}
+
+/**
+ * Одно целое значение во всех типах с шириной из формата и из аргумента.
+ */
+static void checkInteger(uint64_t value)
+{
+    static const char types[] = "duxXo";
+    char fmt[32];
+    int star;
+
+    for (uint32_t t = 0; t < sizeof(types) - 1; t++)
+    {
+        checkFormat(fmt, types[t], "", &star);
+        int32_t v32 = (int32_t)(uint32_t)value;
+        if (star < 0)
+        {
+            CHECK(fmt, v32);
+        }
+        else
+        {
+            /* Отрицательная ширина - выравнивание влево */
+            int width = (checkRandom() % 4) ? star : -star;
+            CHECK(fmt, width, v32);
+        }
+
+#if XF_USE_LLI
+        checkFormat(fmt, types[t], (checkRandom() % 2) ? "ll" : "l", &star);
+        long long v64 = (long long)value;
+        if (strchr(fmt, 'l')[1] != 'l')
+        {
+            /* Префикс l: long на компьютере 64-разрядный, как long long */
+            if (star < 0)
+            {
+                CHECK(fmt, (long)v64);
+            }
+            else
+            {
+                CHECK(fmt, star, (long)v64);
+            }
+        }
+        else if (star < 0)
+        {
+            CHECK(fmt, v64);
+        }
+        else
+        {
+            CHECK(fmt, star, v64);
+        }
+#endif
+    }
+}
+
+static void checkText(void)
+{
+    static const char *const strings[] = { "", "a", "mik32", "0123456789012345678901234567890123456789" };
+    char fmt[32];
+    int star;
+
+    checkFormat(fmt, 'c', "", &star);
+    char c = (char)(' ' + checkRandom() % 95);
+    if (star < 0)
+    {
+        CHECK(fmt, c);
+    }
+    else
+    {
+        CHECK(fmt, star, c);
+    }
+
+    checkFormat(fmt, 's', "", &star);
+    const char *s = strings[checkRandom() % 4];
+    if (star < 0)
+    {
+        CHECK(fmt, s);
+    }
+    else
+    {
+        CHECK(fmt, star, s);
+    }
+}
+
+static double checkSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void checkTiming(uint32_t loops)
+{
+    static const char fmt[] = "addr %08X len %u val %d crc %x\n";
+    volatile uint32_t sink = 0;
+
+    double start = checkSeconds();
+    for (uint32_t i = 0; i < loops; i++)
+    {
+        xsprintf(checkOut, fmt, i * 2654435761u, i, (int)(i * 7919) - 50000, i ^ 0xA5A5A5A5u);
+        sink += (uint8_t)checkOut[5];
+    }
+    double xs = checkSeconds() - start;
+
+    start = checkSeconds();
+    for (uint32_t i = 0; i < loops; i++)
+    {
+        snprintf(checkOut, sizeof(checkOut), fmt, i * 2654435761u, i, (int)(i * 7919) - 50000, i ^ 0xA5A5A5A5u);
+        sink += (uint8_t)checkOut[5];
+    }
+    double libc = checkSeconds() - start;
+
+    (void)sink;
+    printf("\"%.*s\": xsprintf %.1f ns, snprintf %.1f ns per call\n", (int)strlen(fmt) - 1, fmt,
+           xs * 1e9 / loops, libc * 1e9 / loops);
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32_t randoms = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    uint32_t loops = argc > 2 ? strtoul(argv[2], NULL, 0) : 1000000;
+    uint32_t seed = argc > 3 ? strtoul(argv[3], NULL, 0) : 1;
+    static uint64_t edges[512];
+
+    checkSeed(seed);
+
+    /* Фиксированные случаи */
+    CHECK("%d %d %d %u %x %X %o", 0, INT_MIN, INT_MAX, UINT_MAX, UINT_MAX, 0xABCDEFu, UINT_MAX);
+    CHECK("%05d|%-5d|%5d|%05x|%-8X|", -5, -5, -5, 0xAu, 0xBEEFu);
+    CHECK("%*d|%*d|%0*d|%-*u|", 6, -42, -6, 42, 6, -42, 3, 12345u);
+    CHECK("%c%3c%-3c|%s|%5s|%-5s|%.2s|%ld", 'a', 'b', 'c', "", "ab", "ab", "abc", -7L);
+    CHECK("100%% %s", "done");
+
+    uint32_t count = checkEdges(edges);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t j = 0; j < 16; j++)
+        {
+            checkInteger(edges[i]);
+        }
+    }
+    uint64_t edgeChecks = checkCount;
+
+    for (uint32_t i = 0; i < randoms; i++)
+    {
+        checkInteger(checkValue());
+        if ((i % 8) == 0)
+        {
+            checkText();
+        }
+    }
+
+    printf("XF_USE_LLI %d: %llu edge and %llu random formats match snprintf\n", XF_USE_LLI,
+           (unsigned long long)edgeChecks, (unsigned long long)(checkCount - edgeChecks));
+    checkTiming(loops);
+    return 0;
+}